@@ -0,0 +1,117 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Utility/Console.h"
+
+#include <cstdarg>
+#include <iostream>
+
+/*
+ * The benchmark doesn't link against the GUI, so it replaces Console.cpp with this implementation which writes
+ * every message to stderr and leaves stdout to the results.
+ */
+namespace TrenchBroom {
+    namespace Utility {
+        void Console::logToDebug(const LogMessage& /* message */) {
+        }
+        
+        void Console::logToConsole(const LogMessage& message) {
+            switch (message.level()) {
+                case LLDebug:
+                    std::cerr << "debug: ";
+                    break;
+                case LLInfo:
+                    std::cerr << "info: ";
+                    break;
+                case LLWarn:
+                    std::cerr << "warning: ";
+                    break;
+                case LLError:
+                    std::cerr << "error: ";
+                    break;
+            }
+            std::cerr << message.string() << std::endl;
+        }
+        
+        void Console::logToFile(const LogMessage& /* message */) {
+        }
+        
+        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
+            m_textCtrl = textCtrl;
+        }
+        
+        void Console::log(const LogMessage& message) {
+            if (message.string().empty())
+                return;
+            logToConsole(message);
+        }
+        
+        void Console::debug(const String& message) {
+            log(LogMessage(LLDebug, message));
+        }
+        
+        void Console::debug(const char* format, ...) {
+            String message;
+            va_list arguments;
+            va_start(arguments, format);
+            formatString(format, arguments, message);
+            va_end(arguments);
+            debug(message);
+        }
+        
+        void Console::info(const String& message) {
+            log(LogMessage(LLInfo, message));
+        }
+        
+        void Console::info(const char* format, ...) {
+            String message;
+            va_list arguments;
+            va_start(arguments, format);
+            formatString(format, arguments, message);
+            va_end(arguments);
+            info(message);
+        }
+        
+        void Console::warn(const String& message) {
+            log(LogMessage(LLWarn, message));
+        }
+        
+        void Console::warn(const char* format, ...) {
+            String message;
+            va_list arguments;
+            va_start(arguments, format);
+            formatString(format, arguments, message);
+            va_end(arguments);
+            warn(message);
+        }
+        
+        void Console::error(const String& message) {
+            log(LogMessage(LLError, message));
+        }
+        
+        void Console::error(const char* format, ...) {
+            String message;
+            va_list arguments;
+            va_start(arguments, format);
+            formatString(format, arguments, message);
+            va_end(arguments);
+            error(message);
+        }
+    }
+}
@@ -0,0 +1,281 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BenchmarkSuite_h
+#define TrenchBroom_BenchmarkSuite_h
+
+#include "Utility/Allocator.h"
+#include "Utility/Atomic.h"
+#include "Utility/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ostream>
+#include <vector>
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         * Counts every call to the global operator new. The replacement operators are defined in main.cpp.
+         */
+        extern volatile Utility::AtomicValue AllocationCount;
+        
+        /*
+         * Faces, brushes and the brush geometry are allocated from the pools of Utility::Allocator, which only call
+         * operator new for a whole chunk of blocks. The pools count their blocks separately.
+         */
+        inline Utility::AtomicValue poolAllocationCount() {
+#ifdef TB_COUNT_POOL_ALLOCATIONS
+            return Utility::atomicLoad(Utility::poolAllocationCount());
+#else
+            return 0;
+#endif
+        }
+        
+        /*
+         * Returns the current time in milliseconds.
+         */
+        inline double currentTime() {
+#if defined _WIN32
+            LARGE_INTEGER frequency, counter;
+            QueryPerformanceFrequency(&frequency);
+            QueryPerformanceCounter(&counter);
+            return 1000.0 * static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+            timeval time;
+            gettimeofday(&time, NULL);
+            return 1000.0 * static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1000.0;
+#endif
+        }
+        
+        /*
+         * Measures the time and the number of allocations between calls to start and stop. A benchmark may start and
+         * stop the timer several times per iteration to exclude its setup and cleanup work.
+         */
+        class BenchmarkTimer {
+        private:
+            double m_startTime;
+            Utility::AtomicValue m_startAllocations;
+            Utility::AtomicValue m_startPoolAllocations;
+            double m_time;
+            Utility::AtomicValue m_allocations;
+            Utility::AtomicValue m_poolAllocations;
+            bool m_running;
+        public:
+            BenchmarkTimer() :
+            m_startTime(0.0),
+            m_startAllocations(0),
+            m_startPoolAllocations(0),
+            m_time(0.0),
+            m_allocations(0),
+            m_poolAllocations(0),
+            m_running(false) {}
+            
+            inline void start() {
+                assert(!m_running);
+                m_running = true;
+                m_startAllocations = Utility::atomicLoad(AllocationCount);
+                m_startPoolAllocations = poolAllocationCount();
+                m_startTime = currentTime();
+            }
+            
+            inline void stop() {
+                const double stopTime = currentTime();
+                assert(m_running);
+                m_time += stopTime - m_startTime;
+                m_allocations += Utility::atomicLoad(AllocationCount) - m_startAllocations;
+                m_poolAllocations += poolAllocationCount() - m_startPoolAllocations;
+                m_running = false;
+            }
+            
+            inline double time() const {
+                return m_time;
+            }
+            
+            inline Utility::AtomicValue allocations() const {
+                return m_allocations;
+            }
+            
+            inline Utility::AtomicValue poolAllocations() const {
+                return m_poolAllocations;
+            }
+        };
+        
+        class BenchmarkResult {
+        public:
+            typedef std::vector<BenchmarkResult> List;
+            
+            String name;
+            size_t items;
+            size_t iterations;
+            double median;
+            double p95;
+            double min;
+            double max;
+            Utility::AtomicValue allocations;
+            Utility::AtomicValue poolAllocations;
+        };
+        
+        template <class SubClass>
+        class BenchmarkSuite {
+        protected:
+            typedef void (SubClass::*Benchmark)(BenchmarkTimer& timer);
+        private:
+            class BenchmarkCase {
+            public:
+                String name;
+                Benchmark benchmark;
+                size_t items;
+                
+                BenchmarkCase(const String& i_name, Benchmark i_benchmark, size_t i_items) :
+                name(i_name),
+                benchmark(i_benchmark),
+                items(i_items) {}
+            };
+            
+            typedef std::vector<BenchmarkCase> BenchmarkCaseList;
+            BenchmarkCaseList m_benchmarks;
+            
+            /*
+             * Returns the value at the given percentile using the nearest rank method. The given list must be sorted.
+             */
+            static double percentile(const std::vector<double>& sortedValues, double percentile) {
+                assert(!sortedValues.empty());
+                size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sortedValues.size()) + 0.5);
+                if (rank > 0)
+                    rank--;
+                if (rank >= sortedValues.size())
+                    rank = sortedValues.size() - 1;
+                return sortedValues[rank];
+            }
+        protected:
+            /*
+             * Registers a benchmark that processes the given number of items per iteration.
+             */
+            inline void registerBenchmark(const String& name, Benchmark benchmark, size_t items) {
+                m_benchmarks.push_back(BenchmarkCase(name, benchmark, items));
+            }
+            
+            virtual void registerBenchmarks() = 0;
+            virtual void setup() {}
+            virtual void teardown() {}
+        public:
+            virtual ~BenchmarkSuite() {}
+            
+            /*
+             * Runs every benchmark once to warm up the caches and then the given number of times, and appends the
+             * statistics of each benchmark to the given list.
+             */
+            inline void run(size_t iterations, BenchmarkResult::List& results) {
+                assert(iterations > 0);
+                
+                registerBenchmarks();
+                setup();
+                
+                typename BenchmarkCaseList::const_iterator it, end;
+                for (it = m_benchmarks.begin(), end = m_benchmarks.end(); it != end; ++it) {
+                    const BenchmarkCase& benchmarkCase = *it;
+                    SubClass* suite = static_cast<SubClass*>(this);
+                    
+                    BenchmarkTimer warmup;
+                    (suite->*benchmarkCase.benchmark)(warmup);
+                    
+                    std::vector<double> times;
+                    std::vector<Utility::AtomicValue> allocations;
+                    std::vector<Utility::AtomicValue> poolAllocations;
+                    times.reserve(iterations);
+                    allocations.reserve(iterations);
+                    poolAllocations.reserve(iterations);
+                    
+                    for (size_t i = 0; i < iterations; i++) {
+                        BenchmarkTimer timer;
+                        (suite->*benchmarkCase.benchmark)(timer);
+                        times.push_back(timer.time());
+                        allocations.push_back(timer.allocations());
+                        poolAllocations.push_back(timer.poolAllocations());
+                    }
+                    
+                    std::sort(times.begin(), times.end());
+                    std::sort(allocations.begin(), allocations.end());
+                    std::sort(poolAllocations.begin(), poolAllocations.end());
+                    
+                    BenchmarkResult result;
+                    result.name = benchmarkCase.name;
+                    result.items = benchmarkCase.items;
+                    result.iterations = iterations;
+                    result.median = percentile(times, 50.0);
+                    result.p95 = percentile(times, 95.0);
+                    result.min = times.front();
+                    result.max = times.back();
+                    result.allocations = allocations[allocations.size() / 2];
+                    result.poolAllocations = poolAllocations[poolAllocations.size() / 2];
+                    results.push_back(result);
+                }
+                
+                teardown();
+            }
+        };
+        
+        /*
+         * Writes the given results as a JSON document. All times are in milliseconds, the allocation count is the
+         * median number of calls to operator new per iteration, and the pool allocation count is the median number of
+         * blocks handed out by the pooled allocators per iteration. The latter is null if the pools were not counted.
+         */
+        inline void writeResults(const BenchmarkResult::List& results, float scale, std::ostream& stream) {
+            stream.precision(6);
+            stream << "{\n";
+            stream << "    \"scale\": " << scale << ",\n";
+            stream << "    \"benchmarks\": [\n";
+            
+            BenchmarkResult::List::const_iterator it, end;
+            for (it = results.begin(), end = results.end(); it != end; ++it) {
+                const BenchmarkResult& result = *it;
+                const double itemsPerSecond = result.median > 0.0 ? 1000.0 * static_cast<double>(result.items) / result.median : 0.0;
+                
+                stream << "        {\n";
+                stream << "            \"name\": \"" << result.name << "\",\n";
+                stream << "            \"items\": " << result.items << ",\n";
+                stream << "            \"iterations\": " << result.iterations << ",\n";
+                stream << "            \"median_ms\": " << result.median << ",\n";
+                stream << "            \"p95_ms\": " << result.p95 << ",\n";
+                stream << "            \"min_ms\": " << result.min << ",\n";
+                stream << "            \"max_ms\": " << result.max << ",\n";
+                stream << "            \"items_per_second\": " << itemsPerSecond << ",\n";
+                stream << "            \"allocations\": " << result.allocations << ",\n";
+#ifdef TB_COUNT_POOL_ALLOCATIONS
+                stream << "            \"pool_allocations\": " << result.poolAllocations << "\n";
+#else
+                stream << "            \"pool_allocations\": null\n";
+#endif
+                stream << "        }" << (it + 1 != end ? "," : "") << "\n";
+            }
+            
+            stream << "    ]\n";
+            stream << "}\n";
+        }
+    }
+}
+
+#endif
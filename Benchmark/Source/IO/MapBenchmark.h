@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapBenchmark_h
+#define TrenchBroom_MapBenchmark_h
+
+#include "BenchmarkSuite.h"
+#include "SyntheticData.h"
+#include "IO/MapParser.h"
+#include "IO/MapWriter.h"
+#include "Model/Map.h"
+#include "Utility/Console.h"
+#include "Utility/VecMath.h"
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapBenchmark : public Benchmark::BenchmarkSuite<MapBenchmark> {
+        private:
+            Utility::Console& m_console;
+            BBoxf m_worldBounds;
+            size_t m_brushCount;
+            size_t m_entityCount;
+            Model::Map* m_map;
+            String m_mapText;
+        protected:
+            void registerBenchmarks() {
+                registerBenchmark("MapParser::parseMap", &MapBenchmark::benchmarkParseMap, m_brushCount + m_entityCount);
+                registerBenchmark("MapWriter::writeToStream", &MapBenchmark::benchmarkWriteMap, m_brushCount + m_entityCount);
+            }
+            
+            void setup() {
+                m_map = new Model::Map(m_worldBounds, false);
+                Benchmark::SyntheticData::createMap(*m_map, m_brushCount, m_entityCount, 64);
+                
+                StringStream stream;
+                MapWriter writer;
+                writer.writeToStream(*m_map, stream);
+                m_mapText = stream.str();
+            }
+            
+            void teardown() {
+                delete m_map;
+                m_map = NULL;
+                m_mapText.clear();
+            }
+        public:
+            MapBenchmark(Utility::Console& console, size_t brushCount, size_t entityCount) :
+            m_console(console),
+            m_worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f)),
+            m_brushCount(brushCount),
+            m_entityCount(entityCount),
+            m_map(NULL) {}
+            
+            void benchmarkParseMap(Benchmark::BenchmarkTimer& timer) {
+                Model::Map map(m_worldBounds, false);
+                MapParser parser(m_mapText, m_console);
+                
+                timer.start();
+                parser.parseMap(map, NULL);
+                timer.stop();
+                
+                assert(map.entities().size() == m_entityCount + 1);
+            }
+            
+            void benchmarkWriteMap(Benchmark::BenchmarkTimer& timer) {
+                StringStream stream;
+                MapWriter writer;
+                
+                timer.start();
+                writer.writeToStream(*m_map, stream);
+                timer.stop();
+            }
+        };
+    }
+}
+
+#endif
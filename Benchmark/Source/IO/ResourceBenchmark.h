@@ -0,0 +1,159 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ResourceBenchmark_h
+#define TrenchBroom_ResourceBenchmark_h
+
+#include "BenchmarkSuite.h"
+#include "SyntheticData.h"
+#include "IO/FgdParser.h"
+#include "IO/Wad.h"
+#include "Model/Alias.h"
+#include "Model/EntityDefinition.h"
+#include "Model/EntityDefinitionTypes.h"
+#include "Renderer/Palette.h"
+#include "Utility/Color.h"
+#include "Utility/List.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        class ResourceBenchmark : public Benchmark::BenchmarkSuite<ResourceBenchmark> {
+        private:
+            String m_directory;
+            size_t m_textureCount;
+            unsigned int m_textureSize;
+            size_t m_classCount;
+            size_t m_vertexCount;
+            size_t m_frameCount;
+            String m_wadPath;
+            String m_palettePath;
+            Renderer::Palette* m_palette;
+            std::vector<unsigned char> m_indexedImage;
+            std::vector<unsigned char> m_rgbImage;
+            String m_fgd;
+            Benchmark::ByteList m_mdl;
+        protected:
+            void registerBenchmarks() {
+                registerBenchmark("Wad::loadMips(0)", &ResourceBenchmark::benchmarkLoadMipHeaders, m_textureCount);
+                registerBenchmark("Wad::loadMips(1)", &ResourceBenchmark::benchmarkLoadMips, m_textureCount);
+                registerBenchmark("Palette::indexedToRgb", &ResourceBenchmark::benchmarkIndexedToRgb, m_textureCount * m_textureSize * m_textureSize);
+                registerBenchmark("FgdParser::nextDefinition", &ResourceBenchmark::benchmarkParseFgd, m_classCount + 1);
+                registerBenchmark("Alias::Alias", &ResourceBenchmark::benchmarkParseMdl, m_frameCount);
+            }
+            
+            void setup() {
+                m_wadPath = m_directory + "TrenchBroomBenchmark.wad";
+                m_palettePath = m_directory + "TrenchBroomBenchmark.lmp";
+                
+                bool success = Benchmark::SyntheticData::createWad(m_wadPath, m_textureCount, m_textureSize);
+                assert(success);
+                success = Benchmark::SyntheticData::createPalette(m_palettePath);
+                assert(success);
+                success = success; // dummy to suppress "unused" warning
+                
+                m_palette = new Renderer::Palette(m_palettePath);
+                
+                Benchmark::Random random;
+                m_indexedImage.resize(m_textureCount * m_textureSize * m_textureSize);
+                for (size_t i = 0; i < m_indexedImage.size(); i++)
+                    m_indexedImage[i] = static_cast<unsigned char>(random.next(256));
+                m_rgbImage.resize(3 * m_indexedImage.size());
+                
+                m_fgd = Benchmark::SyntheticData::createFgd(m_classCount);
+                m_mdl = Benchmark::SyntheticData::createMdl(m_vertexCount, 2 * m_vertexCount, m_frameCount, 256);
+            }
+            
+            void teardown() {
+                delete m_palette;
+                m_palette = NULL;
+                std::remove(m_wadPath.c_str());
+                std::remove(m_palettePath.c_str());
+            }
+        public:
+            ResourceBenchmark(const String& directory, size_t textureCount, size_t classCount, size_t vertexCount) :
+            m_directory(directory),
+            m_textureCount(textureCount),
+            m_textureSize(128),
+            m_classCount(classCount),
+            m_vertexCount(vertexCount),
+            m_frameCount(64),
+            m_palette(NULL) {}
+            
+            void benchmarkLoadMipHeaders(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                Wad wad(m_wadPath);
+                Mip::List mips = wad.loadMips(0);
+                timer.stop();
+                
+                assert(mips.size() == m_textureCount);
+                Utility::deleteAll(mips);
+            }
+            
+            void benchmarkLoadMips(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                Wad wad(m_wadPath);
+                Mip::List mips = wad.loadMips(1);
+                timer.stop();
+                
+                assert(mips.size() == m_textureCount);
+                Utility::deleteAll(mips);
+            }
+            
+            void benchmarkIndexedToRgb(Benchmark::BenchmarkTimer& timer) {
+                const size_t pixelCount = m_textureSize * m_textureSize;
+                Color averageColor;
+                
+                timer.start();
+                for (size_t i = 0; i < m_textureCount; i++)
+                    m_palette->indexedToRgb(&m_indexedImage[i * pixelCount], &m_rgbImage[3 * i * pixelCount], pixelCount, averageColor);
+                timer.stop();
+            }
+            
+            void benchmarkParseFgd(Benchmark::BenchmarkTimer& timer) {
+                std::vector<char> buffer(m_fgd.begin(), m_fgd.end());
+                Model::EntityDefinitionList definitions;
+                
+                timer.start();
+                FgdParser parser(&buffer[0], &buffer[0] + buffer.size(), Color(0.6f, 0.6f, 0.6f, 1.0f));
+                Model::EntityDefinition* definition = NULL;
+                while ((definition = parser.nextDefinition()) != NULL)
+                    definitions.push_back(definition);
+                timer.stop();
+                
+                assert(definitions.size() == m_classCount + 1);
+                Utility::deleteAll(definitions);
+            }
+            
+            void benchmarkParseMdl(Benchmark::BenchmarkTimer& timer) {
+                Benchmark::ByteList buffer(m_mdl);
+                
+                timer.start();
+                Model::Alias alias("benchmark.mdl", &buffer[0], &buffer[0] + buffer.size());
+                timer.stop();
+                
+                assert(alias.frames().size() == m_frameCount);
+            }
+        };
+    }
+}
+
+#endif
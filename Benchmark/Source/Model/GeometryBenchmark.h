@@ -0,0 +1,238 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_GeometryBenchmark_h
+#define TrenchBroom_GeometryBenchmark_h
+
+#include "BenchmarkSuite.h"
+#include "SyntheticData.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Filter.h"
+#include "Model/Map.h"
+#include "Model/Octree.h"
+#include "Model/RegionQuery.h"
+#include "Utility/List.h"
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class GeometryBenchmark : public Benchmark::BenchmarkSuite<GeometryBenchmark> {
+        private:
+            class SelectAllFilter : public Filter {
+            public:
+                bool entityVisible(const Entity& entity) const {
+                    return !entity.worldspawn();
+                }
+                
+                bool entityPickable(const Entity& entity) const {
+                    return true;
+                }
+                
+                bool brushVisible(const Brush& brush) const {
+                    return true;
+                }
+                
+                bool brushPickable(const Brush& brush) const {
+                    return true;
+                }
+                
+                bool brushVerticesPickable(const Brush& brush) const {
+                    return true;
+                }
+            };
+            
+            typedef std::vector<FaceList> FaceListList;
+            typedef std::vector<BrushGeometry*> BrushGeometryList;
+            
+            BBoxf m_worldBounds;
+            size_t m_brushCount;
+            size_t m_rayCount;
+            Map* m_map;
+            Octree* m_octree;
+            FaceListList m_faces;
+            BrushGeometryList m_geometries;
+            std::vector<Rayf> m_rays;
+            Brush* m_selectionBrush;
+            size_t m_hits;
+            
+            BrushGeometryList buildGeometries() {
+                BrushGeometryList geometries;
+                geometries.reserve(m_faces.size());
+                
+                FaceListList::const_iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                    BrushGeometry* geometry = new BrushGeometry(m_worldBounds);
+                    FaceSet droppedFaces;
+                    geometry->addFaces(*it, droppedFaces);
+                    geometries.push_back(geometry);
+                }
+                
+                return geometries;
+            }
+        protected:
+            void registerBenchmarks() {
+                registerBenchmark("BrushGeometry::addFaces", &GeometryBenchmark::benchmarkBuildGeometry, m_brushCount);
+                registerBenchmark("BrushGeometry::BrushGeometry(const BrushGeometry&)", &GeometryBenchmark::benchmarkCopyGeometry, m_brushCount);
+                registerBenchmark("BrushGeometry::split", &GeometryBenchmark::benchmarkSplitGeometry, m_brushCount);
+                registerBenchmark("Octree::loadMap", &GeometryBenchmark::benchmarkBuildOctree, m_brushCount + 1);
+                registerBenchmark("Octree::intersect(const Rayf&)", &GeometryBenchmark::benchmarkIntersectOctree, m_rayCount);
+                registerBenchmark("RegionQuery::touching(const Brush&)", &GeometryBenchmark::benchmarkSelectTouching, m_brushCount);
+            }
+            
+            void setup() {
+                m_map = new Map(m_worldBounds, false);
+                Benchmark::SyntheticData::createMap(*m_map, m_brushCount, 0, 64);
+                
+                // copy the faces so that building the geometries doesn't disturb the brushes, and sort them like
+                // Brush::rebuildGeometry does
+                const BrushList& brushes = m_map->worldspawn()->brushes();
+                BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    const FaceList& brushFaces = (*brushIt)->faces();
+                    FaceList faces;
+                    FaceList::const_iterator faceIt, faceEnd;
+                    for (faceIt = brushFaces.begin(), faceEnd = brushFaces.end(); faceIt != faceEnd; ++faceIt)
+                        faces.push_back(new Face(m_worldBounds, false, **faceIt));
+                    std::sort(faces.begin(), faces.end(), Face::WeightOrder(Planef::WeightOrder(true)));
+                    std::sort(faces.begin(), faces.end(), Face::WeightOrder(Planef::WeightOrder(false)));
+                    m_faces.push_back(faces);
+                }
+                
+                m_geometries = buildGeometries();
+                
+                m_octree = new Octree(*m_map);
+                m_octree->loadMap();
+                
+                Benchmark::Random random;
+                m_rays.reserve(m_rayCount);
+                for (size_t i = 0; i < m_rayCount; i++) {
+                    const Vec3f origin(random.next(-4096.0f, 4096.0f), random.next(-4096.0f, 4096.0f), random.next(-4096.0f, 4096.0f));
+                    const Vec3f target(random.next(-1024.0f, 1024.0f), random.next(-1024.0f, 1024.0f), random.next(-1024.0f, 1024.0f));
+                    m_rays.push_back(Rayf(origin, (target - origin).normalized()));
+                }
+                
+                // a selection brush that covers a large part of the map, rotated so that the edge axes are tested, too
+                const BBoxf mapBounds = MapObject::bounds(m_map->worldspawn()->brushes());
+                const BBoxf selectionBounds(mapBounds.min * 0.75f, mapBounds.max * 0.75f);
+                const Mat4f rotation = rotationMatrix(Math<float>::radians(30.0f), Vec3f::PosZ);
+                m_selectionBrush = new Brush(m_worldBounds, false, selectionBounds, NULL);
+                m_selectionBrush->transform(rotation, rotation, false, false);
+            }
+            
+            void teardown() {
+                delete m_selectionBrush;
+                m_selectionBrush = NULL;
+                delete m_octree;
+                m_octree = NULL;
+                Utility::deleteAll(m_geometries);
+                FaceListList::iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                    Utility::deleteAll(*it);
+                m_faces.clear();
+                m_rays.clear();
+                delete m_map;
+                m_map = NULL;
+            }
+        public:
+            GeometryBenchmark(size_t brushCount, size_t rayCount) :
+            m_worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f)),
+            m_brushCount(brushCount),
+            m_rayCount(rayCount),
+            m_map(NULL),
+            m_octree(NULL),
+            m_selectionBrush(NULL),
+            m_hits(0) {}
+            
+            void benchmarkBuildGeometry(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                BrushGeometryList geometries = buildGeometries();
+                timer.stop();
+                
+                Utility::deleteAll(geometries);
+            }
+            
+            void benchmarkCopyGeometry(Benchmark::BenchmarkTimer& timer) {
+                BrushGeometryList copies;
+                copies.reserve(m_geometries.size());
+                
+                timer.start();
+                BrushGeometryList::const_iterator it, end;
+                for (it = m_geometries.begin(), end = m_geometries.end(); it != end; ++it)
+                    copies.push_back(new BrushGeometry(**it));
+                timer.stop();
+                
+                Utility::deleteAll(copies);
+            }
+            
+            void benchmarkSplitGeometry(Benchmark::BenchmarkTimer& timer) {
+                // an oblique plane through the center of the map, so that it cuts through many brushes
+                const Planef plane(Vec3f(1.0f, 2.0f, 3.0f).normalized(), 0.0f);
+                SplitPolygons below, above;
+                m_hits = 0;
+                
+                timer.start();
+                BrushGeometryList::const_iterator it, end;
+                for (it = m_geometries.begin(), end = m_geometries.end(); it != end; ++it)
+                    if ((*it)->split(plane, below, above) == PointStatus::PSInside)
+                        m_hits++;
+                timer.stop();
+            }
+            
+            void benchmarkBuildOctree(Benchmark::BenchmarkTimer& timer) {
+                Octree octree(*m_map);
+                
+                timer.start();
+                octree.loadMap();
+                timer.stop();
+            }
+            
+            void benchmarkIntersectOctree(Benchmark::BenchmarkTimer& timer) {
+                m_hits = 0;
+                
+                timer.start();
+                std::vector<Rayf>::const_iterator it, end;
+                for (it = m_rays.begin(), end = m_rays.end(); it != end; ++it)
+                    m_hits += m_octree->intersect(*it).size();
+                timer.stop();
+            }
+            
+            void benchmarkSelectTouching(Benchmark::BenchmarkTimer& timer) {
+                SelectAllFilter filter;
+                RegionQuery query(*m_octree, filter);
+                EntityList entities;
+                BrushList brushes;
+                
+                timer.start();
+                query.touching(*m_selectionBrush, entities, brushes);
+                timer.stop();
+                
+                m_hits = brushes.size();
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,332 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_SyntheticData_h
+#define TrenchBroom_SyntheticData_h
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         * A linear congruential generator so that the generated data is identical on every platform and every run.
+         */
+        class Random {
+        private:
+            unsigned int m_state;
+        public:
+            Random(unsigned int seed = 1) :
+            m_state(seed) {}
+            
+            inline unsigned int next() {
+                m_state = m_state * 1664525u + 1013904223u;
+                return m_state >> 8;
+            }
+            
+            inline unsigned int next(unsigned int max) {
+                return next() % max;
+            }
+            
+            inline float next(float min, float max) {
+                return min + (max - min) * static_cast<float>(next() & 0xFFFF) / static_cast<float>(0xFFFF);
+            }
+        };
+        
+        typedef std::vector<char> ByteList;
+        
+        class SyntheticData {
+        private:
+            template <typename T>
+            static void append(ByteList& bytes, T value) {
+                const char* begin = reinterpret_cast<const char*>(&value);
+                bytes.insert(bytes.end(), begin, begin + sizeof(T));
+            }
+            
+            static void append(ByteList& bytes, const Vec3f& vec) {
+                for (size_t i = 0; i < 3; i++)
+                    append(bytes, vec[i]);
+            }
+            
+            static void append(ByteList& bytes, const String& str, size_t length) {
+                for (size_t i = 0; i < length; i++)
+                    bytes.push_back(i < str.size() ? str[i] : 0);
+            }
+            
+            static String textureName(size_t index) {
+                StringStream name;
+                name << "tex" << index;
+                return name.str();
+            }
+            
+            static bool writeFile(const String& path, const ByteList& bytes) {
+                std::ofstream stream(path.c_str(), std::ios::binary | std::ios::out);
+                if (!stream.is_open())
+                    return false;
+                stream.write(&bytes[0], static_cast<std::streamsize>(bytes.size()));
+                return stream.good();
+            }
+        public:
+            /*
+             * Fills the given map with a worldspawn entity that contains the given number of cuboid brushes and with
+             * the given number of point entities. The brushes are spread over a grid so that they don't overlap.
+             */
+            static void createMap(Model::Map& map, size_t brushCount, size_t entityCount, size_t textureCount) {
+                Random random;
+                const BBoxf& worldBounds = map.worldBounds();
+                
+                Model::Entity* worldspawn = new Model::Entity(worldBounds);
+                worldspawn->setProperty(Model::Entity::ClassnameKey, Model::Entity::WorldspawnClassname);
+                worldspawn->setProperty(Model::Entity::WadKey, "benchmark.wad");
+                
+                const size_t gridSize = static_cast<size_t>(std::ceil(std::pow(static_cast<float>(brushCount), 1.0f / 3.0f)));
+                const float cellSize = 128.0f;
+                const float offset = -static_cast<float>(gridSize) * cellSize / 2.0f;
+                
+                Model::BrushList brushes;
+                brushes.reserve(brushCount);
+                for (size_t i = 0; i < brushCount; i++) {
+                    const size_t x = i % gridSize;
+                    const size_t y = (i / gridSize) % gridSize;
+                    const size_t z = i / (gridSize * gridSize);
+                    
+                    BBoxf bounds;
+                    bounds.min = Vec3f(offset + x * cellSize, offset + y * cellSize, offset + z * cellSize);
+                    bounds.max = bounds.min + Vec3f(random.next(8.0f, 120.0f), random.next(8.0f, 120.0f), random.next(8.0f, 120.0f));
+                    bounds.min.round();
+                    bounds.max.round();
+                    
+                    Model::Brush* brush = new Model::Brush(worldBounds, map.forceIntegerFacePoints(), bounds, NULL);
+                    const Model::FaceList& faces = brush->faces();
+                    Model::FaceList::const_iterator faceIt, faceEnd;
+                    for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                        (*faceIt)->setTextureName(textureName(random.next(static_cast<unsigned int>(textureCount))));
+                    brushes.push_back(brush);
+                }
+                worldspawn->addBrushes(brushes);
+                map.addEntity(*worldspawn);
+                
+                for (size_t i = 0; i < entityCount; i++) {
+                    Model::Entity* entity = new Model::Entity(worldBounds);
+                    StringStream classname;
+                    classname << "point_class" << random.next(static_cast<unsigned int>(entityCount));
+                    entity->setProperty(Model::Entity::ClassnameKey, classname.str());
+                    
+                    const Vec3f origin(random.next(-2048.0f, 2048.0f), random.next(-2048.0f, 2048.0f), random.next(-2048.0f, 2048.0f));
+                    entity->setProperty(Model::Entity::OriginKey, origin, true);
+                    entity->setProperty(Model::Entity::AngleKey, static_cast<int>(random.next(360)));
+                    map.addEntity(*entity);
+                }
+            }
+            
+            /*
+             * Writes a WAD2 file containing the given number of square mip textures with four mip levels each.
+             */
+            static bool createWad(const String& path, size_t textureCount, unsigned int textureSize) {
+                static const size_t MipHeaderLength = 40;
+                
+                Random random;
+                ByteList bytes;
+                std::vector<int32_t> addresses;
+                std::vector<int32_t> lengths;
+                
+                append(bytes, String("WAD2"), 4);
+                append(bytes, static_cast<int32_t>(textureCount));
+                append(bytes, static_cast<int32_t>(0)); // directory offset, patched below
+                
+                for (size_t i = 0; i < textureCount; i++) {
+                    const size_t address = bytes.size();
+                    append(bytes, textureName(i), 16);
+                    append(bytes, static_cast<int32_t>(textureSize));
+                    append(bytes, static_cast<int32_t>(textureSize));
+                    
+                    int32_t mipOffset = static_cast<int32_t>(MipHeaderLength);
+                    for (unsigned int j = 0; j < 4; j++) {
+                        append(bytes, mipOffset);
+                        mipOffset += static_cast<int32_t>((textureSize >> j) * (textureSize >> j));
+                    }
+                    
+                    for (int32_t j = static_cast<int32_t>(MipHeaderLength); j < mipOffset; j++)
+                        bytes.push_back(static_cast<char>(random.next(256)));
+                    
+                    addresses.push_back(static_cast<int32_t>(address));
+                    lengths.push_back(static_cast<int32_t>(bytes.size() - address));
+                }
+                
+                const int32_t directoryOffset = static_cast<int32_t>(bytes.size());
+                std::memcpy(&bytes[8], &directoryOffset, sizeof(int32_t));
+                
+                for (size_t i = 0; i < textureCount; i++) {
+                    append(bytes, addresses[i]);
+                    append(bytes, lengths[i]);
+                    append(bytes, lengths[i]);
+                    bytes.push_back('D');
+                    bytes.push_back(0); // compression
+                    bytes.push_back(0);
+                    bytes.push_back(0);
+                    append(bytes, textureName(i), 16);
+                }
+                
+                return writeFile(path, bytes);
+            }
+            
+            /*
+             * Writes a palette file with 256 random RGB colors.
+             */
+            static bool createPalette(const String& path) {
+                Random random;
+                ByteList bytes;
+                for (size_t i = 0; i < 3 * 256; i++)
+                    bytes.push_back(static_cast<char>(random.next(256)));
+                return writeFile(path, bytes);
+            }
+            
+            /*
+             * Returns an FGD file with the given number of point entity classes, each of which inherits from a few
+             * base classes and declares some properties of their own.
+             */
+            static String createFgd(size_t classCount) {
+                Random random;
+                StringStream fgd;
+                
+                fgd << "// synthetic entity definitions\n\n";
+                fgd << "@SolidClass = worldspawn : \"World entity\"\n";
+                fgd << "[\n";
+                fgd << "\tmessage(string) : \"Text on entering the world\"\n";
+                fgd << "\tworldtype(choices) : \"Ambience\" : 0 =\n";
+                fgd << "\t[\n";
+                fgd << "\t\t0 : \"Medieval\"\n";
+                fgd << "\t\t1 : \"Metal (runic)\"\n";
+                fgd << "\t\t2 : \"Base\"\n";
+                fgd << "\t]\n";
+                fgd << "]\n\n";
+                fgd << "@baseclass = Appearflags [\n";
+                fgd << "\tspawnflags(Flags) =\n";
+                fgd << "\t[\n";
+                fgd << "\t\t256 : \"Not on Easy\" : 0\n";
+                fgd << "\t\t512 : \"Not on Normal\" : 0\n";
+                fgd << "\t\t1024 : \"Not on Hard\" : 0\n";
+                fgd << "\t\t2048 : \"Not in Deathmatch\" : 0\n";
+                fgd << "\t]\n";
+                fgd << "]\n\n";
+                fgd << "@baseclass = Targetname [ targetname(target_source) : \"Name\" ]\n";
+                fgd << "@baseclass = Target [\n";
+                fgd << "\ttarget(target_destination) : \"Target\"\n";
+                fgd << "\tkilltarget(target_destination) : \"Killtarget\"\n";
+                fgd << "]\n\n";
+                
+                for (size_t i = 0; i < classCount; i++) {
+                    const unsigned int size = 8 + random.next(32);
+                    fgd << "@PointClass base(Appearflags, Target, Targetname) ";
+                    fgd << "size(-" << size << " -" << size << " -" << size << ", " << size << " " << size << " " << size << ") ";
+                    fgd << "color(" << random.next(256) << " " << random.next(256) << " " << random.next(256) << ") ";
+                    fgd << "model(\":progs/model" << i << ".mdl\") = point_class" << i << " : \"Point class " << i << "\"\n";
+                    fgd << "[\n";
+                    fgd << "\tmessage(string) : \"Message\"\n";
+                    fgd << "\tdelay(integer) : \"Delay\" : " << random.next(10) << "\n";
+                    fgd << "\twait(integer) : \"Wait\" : " << random.next(10) << "\n";
+                    fgd << "\tstyle(choices) : \"Style\" : 0 =\n";
+                    fgd << "\t[\n";
+                    fgd << "\t\t0 : \"Normal\"\n";
+                    fgd << "\t\t1 : \"Flicker\"\n";
+                    fgd << "\t\t2 : \"Pulse\"\n";
+                    fgd << "\t]\n";
+                    fgd << "]\n\n";
+                }
+                
+                return fgd.str();
+            }
+            
+            /*
+             * Returns the contents of an MDL file with one skin and the given number of vertices, triangles and single
+             * frames.
+             */
+            static ByteList createMdl(size_t vertexCount, size_t triangleCount, size_t frameCount, unsigned int skinSize) {
+                Random random;
+                ByteList bytes;
+                
+                append(bytes, String("IDPO"), 4);
+                append(bytes, static_cast<int32_t>(6));
+                append(bytes, Vec3f(0.25f, 0.25f, 0.25f));                // scale
+                append(bytes, Vec3f(-32.0f, -32.0f, -32.0f));             // origin
+                append(bytes, 64.0f);                                       // radius
+                append(bytes, Vec3f(0.0f, 0.0f, 24.0f));                  // eye position
+                append(bytes, static_cast<int32_t>(1));                     // skins
+                append(bytes, static_cast<int32_t>(skinSize));
+                append(bytes, static_cast<int32_t>(skinSize));
+                append(bytes, static_cast<int32_t>(vertexCount));
+                append(bytes, static_cast<int32_t>(triangleCount));
+                append(bytes, static_cast<int32_t>(frameCount));
+                append(bytes, static_cast<int32_t>(0));                     // sync type
+                append(bytes, static_cast<int32_t>(0));                     // flags
+                append(bytes, 1.0f);                                        // size
+                
+                append(bytes, static_cast<int32_t>(0));                     // single skin
+                for (size_t i = 0; i < skinSize * skinSize; i++)
+                    bytes.push_back(static_cast<char>(random.next(256)));
+                
+                for (size_t i = 0; i < vertexCount; i++) {
+                    append(bytes, static_cast<int32_t>(random.next(2)));
+                    append(bytes, static_cast<int32_t>(random.next(skinSize)));
+                    append(bytes, static_cast<int32_t>(random.next(skinSize)));
+                }
+                
+                for (size_t i = 0; i < triangleCount; i++) {
+                    append(bytes, static_cast<int32_t>(random.next(2)));
+                    for (size_t j = 0; j < 3; j++)
+                        append(bytes, static_cast<int32_t>(random.next(static_cast<unsigned int>(vertexCount))));
+                }
+                
+                for (size_t i = 0; i < frameCount; i++) {
+                    append(bytes, static_cast<int32_t>(0));                 // single frame
+                    append(bytes, static_cast<int32_t>(0));                 // min, ignored
+                    append(bytes, static_cast<int32_t>(0));                 // max, ignored
+                    StringStream name;
+                    name << "frame" << i;
+                    append(bytes, name.str(), 16);
+                    for (size_t j = 0; j < vertexCount; j++) {
+                        for (size_t k = 0; k < 3; k++)
+                            bytes.push_back(static_cast<char>(random.next(256)));
+                        bytes.push_back(static_cast<char>(random.next(162))); // normal index
+                    }
+                }
+                
+                return bytes;
+            }
+        };
+    }
+}
+
+#endif
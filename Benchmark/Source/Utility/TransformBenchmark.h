@@ -0,0 +1,118 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TransformBenchmark_h
+#define TrenchBroom_TransformBenchmark_h
+
+#include "BenchmarkSuite.h"
+#include "SyntheticData.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace VecMath {
+        /*
+         * Compares the batch kernels of Mat.h, BBox.h and Plane.h with transforming one element at a time.
+         */
+        class TransformBenchmark : public Benchmark::BenchmarkSuite<TransformBenchmark> {
+        private:
+            size_t m_pointCount;
+            Mat4f m_pointTransform;
+            Mat4f m_vectorTransform;
+            Vec3f::List m_points;
+            Vec3f::List m_transformedPoints;
+            std::vector<Planef> m_planes;
+            std::vector<Planef> m_transformedPlanes;
+            BBoxf m_bounds;
+        protected:
+            void registerBenchmarks() {
+                registerBenchmark("Mat4f * Vec3f", &TransformBenchmark::benchmarkTransformPointsSingly, m_pointCount);
+                registerBenchmark("transformPoints", &TransformBenchmark::benchmarkTransformPoints, m_pointCount);
+                registerBenchmark("transformedBounds", &TransformBenchmark::benchmarkTransformedBounds, m_pointCount);
+                registerBenchmark("Planef::transformed", &TransformBenchmark::benchmarkTransformPlanesSingly, m_pointCount);
+                registerBenchmark("transformPlanes", &TransformBenchmark::benchmarkTransformPlanes, m_pointCount);
+            }
+            
+            void setup() {
+                Benchmark::Random random;
+                const Vec3f axis = Vec3f(random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f), 1.0f).normalized();
+                m_vectorTransform = rotationMatrix(Math<float>::radians(30.0f), axis);
+                m_pointTransform = translationMatrix(Vec3f(16.0f, 32.0f, 64.0f)) * m_vectorTransform;
+                
+                m_points.reserve(m_pointCount);
+                m_planes.reserve(m_pointCount);
+                for (size_t i = 0; i < m_pointCount; i++) {
+                    const Vec3f point(random.next(-4096.0f, 4096.0f), random.next(-4096.0f, 4096.0f), random.next(-4096.0f, 4096.0f));
+                    const Vec3f normal = Vec3f(random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f), random.next(0.1f, 1.0f)).normalized();
+                    m_points.push_back(point);
+                    m_planes.push_back(Planef(normal, point));
+                }
+                m_transformedPoints.resize(m_pointCount);
+                m_transformedPlanes.resize(m_pointCount);
+            }
+            
+            void teardown() {
+                m_points.clear();
+                m_transformedPoints.clear();
+                m_planes.clear();
+                m_transformedPlanes.clear();
+            }
+        public:
+            TransformBenchmark(size_t pointCount) :
+            m_pointCount(pointCount) {}
+            
+            void benchmarkTransformPointsSingly(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                for (size_t i = 0; i < m_pointCount; i++)
+                    m_transformedPoints[i] = m_pointTransform * m_points[i];
+                timer.stop();
+            }
+            
+            void benchmarkTransformPoints(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                transformPoints(m_pointTransform, &m_points[0], m_pointCount, &m_transformedPoints[0]);
+                timer.stop();
+            }
+            
+            void benchmarkTransformedBounds(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                m_bounds = transformedBounds(m_pointTransform, &m_points[0], m_pointCount);
+                timer.stop();
+            }
+            
+            void benchmarkTransformPlanesSingly(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                for (size_t i = 0; i < m_pointCount; i++)
+                    m_transformedPlanes[i] = m_planes[i].transformed(m_pointTransform, m_vectorTransform);
+                timer.stop();
+            }
+            
+            void benchmarkTransformPlanes(Benchmark::BenchmarkTimer& timer) {
+                timer.start();
+                transformPlanes(m_pointTransform, m_vectorTransform, &m_planes[0], m_pointCount, &m_transformedPlanes[0]);
+                timer.stop();
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+#include "BenchmarkSuite.h"
+#include "IO/MapBenchmark.h"
+#include "IO/ResourceBenchmark.h"
+#include "Model/GeometryBenchmark.h"
+#include "Utility/TransformBenchmark.h"
+#include "Utility/Console.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        volatile Utility::AtomicValue AllocationCount = 0;
+    }
+}
+
+void* operator new(size_t size) throw (std::bad_alloc) {
+    TrenchBroom::Utility::atomicIncrement(TrenchBroom::Benchmark::AllocationCount);
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (memory == NULL)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size) throw (std::bad_alloc) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) throw () {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) throw () {
+    std::free(memory);
+}
+
+static const char* optionValue(const char* argument, const char* option) {
+    const size_t length = std::strlen(option);
+    if (std::strncmp(argument, option, length) == 0 && argument[length] == '=')
+        return argument + length + 1;
+    return NULL;
+}
+
+/*
+ * Usage: TrenchBroom-Benchmark [--scale=<factor>] [--iterations=<count>] [--directory=<path>] [--output=<file>]
+ *
+ * The scale factor multiplies the size of the generated data, the directory receives the temporary WAD and palette
+ * files, and the JSON results are written to the output file or to stdout.
+ */
+int main(int argc, const char * argv[]) {
+    using namespace TrenchBroom;
+    
+    float scale = 1.0f;
+    size_t iterations = 20;
+    String directory = "";
+    String outputPath = "";
+    
+    for (int i = 1; i < argc; i++) {
+        const char* value = NULL;
+        if ((value = optionValue(argv[i], "--scale")) != NULL) {
+            scale = static_cast<float>(std::atof(value));
+        } else if ((value = optionValue(argv[i], "--iterations")) != NULL) {
+            iterations = static_cast<size_t>(std::atoi(value));
+        } else if ((value = optionValue(argv[i], "--directory")) != NULL) {
+            directory = value;
+            if (!directory.empty() && directory[directory.size() - 1] != '/')
+                directory += '/';
+        } else if ((value = optionValue(argv[i], "--output")) != NULL) {
+            outputPath = value;
+        } else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    
+    if (scale <= 0.0f || iterations == 0) {
+        std::cerr << "Scale and iterations must be positive" << std::endl;
+        return 1;
+    }
+    
+    const size_t brushCount = static_cast<size_t>(2000.0f * scale);
+    const size_t entityCount = static_cast<size_t>(200.0f * scale);
+    const size_t rayCount = static_cast<size_t>(1000.0f * scale);
+    const size_t textureCount = static_cast<size_t>(64.0f * scale);
+    const size_t classCount = static_cast<size_t>(200.0f * scale);
+    const size_t vertexCount = static_cast<size_t>(256.0f * scale);
+    const size_t pointCount = static_cast<size_t>(100000.0f * scale);
+    
+    Utility::Console console;
+    Benchmark::BenchmarkResult::List results;
+    
+    IO::MapBenchmark mapBenchmark(console, brushCount, entityCount);
+    mapBenchmark.run(iterations, results);
+    
+    Model::GeometryBenchmark geometryBenchmark(brushCount, rayCount);
+    geometryBenchmark.run(iterations, results);
+    
+    IO::ResourceBenchmark resourceBenchmark(directory, textureCount, classCount, vertexCount);
+    resourceBenchmark.run(iterations, results);
+    
+    VecMath::TransformBenchmark transformBenchmark(pointCount);
+    transformBenchmark.run(iterations, results);
+    
+    if (outputPath.empty()) {
+        Benchmark::writeResults(results, scale, std::cout);
+    } else {
+        std::ofstream stream(outputPath.c_str());
+        if (!stream.is_open()) {
+            std::cerr << "Cannot open " << outputPath << std::endl;
+            return 1;
+        }
+        Benchmark::writeResults(results, scale, stream);
+    }
+    
+    return 0;
+}
@@ -42,6 +42,8 @@
 #include "View/EditorView.h"
 #include "Utility/Grid.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
+#include "Utility/ThreadPool.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -57,6 +59,21 @@ namespace TrenchBroom {
     }
     
     namespace Controller {
+        class ClipTool::SplitBrushesTask : public Utility::ParallelTask {
+        private:
+            const Planef& m_plane;
+            BrushPreviewList& m_previews;
+        public:
+            SplitBrushesTask(const Planef& plane, BrushPreviewList& previews) :
+            m_plane(plane),
+            m_previews(previews) {}
+            
+            void run(size_t index) {
+                BrushPreview& preview = m_previews[index];
+                preview.status = preview.brush->split(m_plane, preview.below, preview.above);
+            }
+        };
+        
         Vec3f ClipTool::selectNormal(const Vec3f::List& normals1, const Vec3f::List& normals2) const {
             assert(!normals1.empty());
             
@@ -78,124 +95,151 @@ namespace TrenchBroom {
             return sum / static_cast<float>((normals1.size() + normals2.size()));
         }
 
-        void ClipTool::updateBrushes() {
-            m_frontBrushes.clear();
-            m_backBrushes.clear();
-            
-            Model::BrushList allFrontBrushes, allBackBrushes;
+        bool ClipTool::computePlanePoints(Vec3f planePoints[3]) const {
+            if (m_numPoints == 0)
+                return false;
             
             Renderer::Camera& camera = view().camera();
-            Vec3f planePoints[3];
-            bool validPlane = false;
-            if (m_numPoints > 0) {
-                if (m_numPoints == 1) {
-                    assert(!m_normals[0].empty());
-
-                    if (m_normals[0].size() <= 2) { // the point is not on a vertex
-                        validPlane = true;
-                        planePoints[0] = m_points[0].rounded();
-                        
-                        const Vec3f normal = m_normals[0].size() == 1 ? m_normals[0][0] : (m_normals[0][0] + m_normals[0][1]) / 2.0f;
-                        planePoints[1] = planePoints[0] + 128.0f * Vec3f::PosZ;
-                        if (normal.firstComponent() == Axis::AZ) {
-                            const Vec3f dir = camera.direction().firstComponent() != Axis::AZ ? camera.direction().firstAxis() : camera.direction().secondAxis();
-                            planePoints[2] = planePoints[0] + 128.0f * dir;
-                        } else {
-                            planePoints[2] = planePoints[0] + 128.0f * normal.firstAxis();
-                        }
-                    }
-                } else if (m_numPoints == 2) {
-                    assert(!m_normals[0].empty());
-                    assert(!m_normals[1].empty());
-                    
-                    validPlane = true;
-                    planePoints[0] = m_points[0].rounded();
-                    planePoints[2] = m_points[1].rounded();
-                    
-                    const Vec3f normal = selectNormal(m_normals[0], m_normals[1]);
-                    planePoints[1] = planePoints[0] + 128.0f * normal.firstAxis();
+            if (m_numPoints == 1) {
+                assert(!m_normals[0].empty());
+                
+                if (m_normals[0].size() > 2) // the point is on a vertex
+                    return false;
+                
+                planePoints[0] = m_points[0].rounded();
+                
+                const Vec3f normal = m_normals[0].size() == 1 ? m_normals[0][0] : (m_normals[0][0] + m_normals[0][1]) / 2.0f;
+                planePoints[1] = planePoints[0] + 128.0f * Vec3f::PosZ;
+                if (normal.firstComponent() == Axis::AZ) {
+                    const Vec3f dir = camera.direction().firstComponent() != Axis::AZ ? camera.direction().firstAxis() : camera.direction().secondAxis();
+                    planePoints[2] = planePoints[0] + 128.0f * dir;
                 } else {
-                    validPlane = true;
-                    planePoints[0] = m_points[0].rounded();
-                    planePoints[1] = m_points[1].rounded();
-                    planePoints[2] = m_points[2].rounded();
+                    planePoints[2] = planePoints[0] + 128.0f * normal.firstAxis();
                 }
+            } else if (m_numPoints == 2) {
+                assert(!m_normals[0].empty());
+                assert(!m_normals[1].empty());
                 
-                // make sure the plane's normal points towards the camera or to its left if the camera position is on the plane
-                if (validPlane) {
-                    Planef plane;
-                    plane.setPoints(planePoints[0], planePoints[1], planePoints[2]);
-                    if (plane.pointStatus(camera.position()) == PointStatus::PSInside) {
-                        if (plane.normal.dot(camera.right()) < 0.0f)
-                            std::swap(planePoints[1], planePoints[2]);
-                    } else {
-                        if (plane.normal.dot(camera.direction()) > 0.0f)
-                            std::swap(planePoints[1], planePoints[2]);
-                    }
-                }
+                planePoints[0] = m_points[0].rounded();
+                planePoints[2] = m_points[1].rounded();
+                
+                const Vec3f normal = selectNormal(m_normals[0], m_normals[1]);
+                planePoints[1] = planePoints[0] + 128.0f * normal.firstAxis();
+            } else {
+                planePoints[0] = m_points[0].rounded();
+                planePoints[1] = m_points[1].rounded();
+                planePoints[2] = m_points[2].rounded();
             }
             
+            // make sure the plane's normal points towards the camera or to its left if the camera position is on the plane
+            Planef plane;
+            plane.setPoints(planePoints[0], planePoints[1], planePoints[2]);
+            if (plane.pointStatus(camera.position()) == PointStatus::PSInside) {
+                if (plane.normal.dot(camera.right()) < 0.0f)
+                    std::swap(planePoints[1], planePoints[2]);
+            } else {
+                if (plane.normal.dot(camera.direction()) > 0.0f)
+                    std::swap(planePoints[1], planePoints[2]);
+            }
+            return true;
+        }
+
+        void ClipTool::updatePreview() {
+            TB_PROFILE_ZONE("ClipTool::updatePreview");
+            Vec3f planePoints[3];
+            const bool validPlane = computePlanePoints(planePoints);
             const Model::BrushList& brushes = document().editStateManager().selectedBrushes();
+            
+            if (m_previewValid && validPlane == m_validPlane && m_previews.size() == brushes.size()) {
+                bool changed = validPlane && (planePoints[0] != m_planePoints[0] ||
+                                              planePoints[1] != m_planePoints[1] ||
+                                              planePoints[2] != m_planePoints[2]);
+                for (size_t i = 0; i < brushes.size() && !changed; i++)
+                    changed = m_previews[i].brush != brushes[i];
+                if (!changed)
+                    return;
+            }
+            
+            m_validPlane = validPlane;
+            for (size_t i = 0; i < 3; i++)
+                m_planePoints[i] = planePoints[i];
+            m_previews.resize(brushes.size());
+            m_previewValid = true;
+            
+            Model::BrushList frontBrushes, backBrushes;
+            Model::SplitPolygonsList frontPolygons, backPolygons;
             if (validPlane) {
-                const BBoxf& worldBounds = document().map().worldBounds();
-                const bool forceIntegerFacePoints = document().map().forceIntegerFacePoints();
-                const String textureName = document().mruTexture() != NULL ? document().mruTexture()->name() : Model::Texture::Empty;
+                Planef plane;
+                plane.setPoints(planePoints[0], planePoints[1], planePoints[2]);
                 
-                Model::BrushList::const_iterator brushIt, brushEnd;
-                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                    Model::Brush& brush = **brushIt;
-                    Model::Entity* entity = brush.entity();
-                    Model::Face* frontFace = new Model::Face(worldBounds, forceIntegerFacePoints, planePoints[0], planePoints[1], planePoints[2], textureName);
-                    Model::Face* backFace = new Model::Face(worldBounds, forceIntegerFacePoints, planePoints[0], planePoints[2], planePoints[1], textureName);
-                    
-                    // determine the texture for the new faces
-                    // we will use the texture of the face whose normal is closest to the newly inserted face
-                    const Model::FaceList& faces = brush.faces();
-                    Model::FaceList::const_iterator faceIt = faces.begin();
-                    Model::FaceList::const_iterator faceEnd = faces.end();
-                    const Model::Face* bestFrontFace = *faceIt++;
-                    const Model::Face* bestBackFace = bestFrontFace;
-                    
-                    while (faceIt != faceEnd) {
-                        const Model::Face* face = *faceIt++;
-                        
-                        const Vec3f bestFrontDiff = bestFrontFace->boundary().normal - frontFace->boundary().normal;
-                        const Vec3f frontDiff = face->boundary().normal - frontFace->boundary().normal;
-                        if (frontDiff.lengthSquared() < bestFrontDiff.lengthSquared())
-                            bestFrontFace = face;
-                        
-                        const Vec3f bestBackDiff = bestBackFace->boundary().normal - backFace->boundary().normal;
-                        const Vec3f backDiff = face->boundary().normal - backFace->boundary().normal;
-                        if (backDiff.lengthSquared() < bestBackDiff.lengthSquared())
-                            bestBackFace = face;
-                    }
-                    
-                    frontFace->setAttributes(*bestFrontFace);
-                    backFace->setAttributes(*bestBackFace);
-                    
-                    Model::Brush* frontBrush = new Model::Brush(worldBounds, forceIntegerFacePoints, brush);
-                    if (frontBrush->clip(*frontFace)) {
-                        m_frontBrushes[entity].push_back(frontBrush);
-                        allFrontBrushes.push_back(frontBrush);
-                    } else {
-                        delete frontBrush;
-                    }
-                    
-                    Model::Brush* backBrush = new Model::Brush(worldBounds, forceIntegerFacePoints, brush);
-                    if (backBrush->clip(*backFace)) {
-                        m_backBrushes[entity].push_back(backBrush);
-                        allBackBrushes.push_back(backBrush);
-                    } else {
-                        delete backBrush;
+                for (size_t i = 0; i < brushes.size(); i++)
+                    m_previews[i].brush = brushes[i];
+                SplitBrushesTask task(plane, m_previews);
+                Utility::ThreadPool::pool().parallelFor(m_previews.size(), task, 16);
+                
+                BrushPreviewList::const_iterator it, end;
+                for (it = m_previews.begin(), end = m_previews.end(); it != end; ++it) {
+                    const BrushPreview& preview = *it;
+                    switch (preview.status) {
+                        case PointStatus::PSBelow:
+                            frontBrushes.push_back(preview.brush);
+                            break;
+                        case PointStatus::PSAbove:
+                            backBrushes.push_back(preview.brush);
+                            break;
+                        default:
+                            frontPolygons.push_back(&preview.below);
+                            backPolygons.push_back(&preview.above);
+                            break;
                     }
                 }
             } else {
-                allFrontBrushes = brushes;
-                m_frontBrushes = entityBrushes(allFrontBrushes);
+                for (size_t i = 0; i < brushes.size(); i++) {
+                    m_previews[i].brush = brushes[i];
+                    m_previews[i].status = PointStatus::PSBelow;
+                    m_previews[i].below.clear();
+                    m_previews[i].above.clear();
+                }
+                frontBrushes = brushes;
             }
 
-            m_frontBrushFigure->setBrushes(allFrontBrushes);
-            m_backBrushFigure->setBrushes(allBackBrushes);
+            m_frontBrushFigure->setBrushes(frontBrushes, frontPolygons);
+            m_backBrushFigure->setBrushes(backBrushes, backPolygons);
+        }
+        
+        Model::Brush* ClipTool::clipBrush(const Model::Brush& brush, const bool front) const {
+            const BBoxf& worldBounds = document().map().worldBounds();
+            const bool forceIntegerFacePoints = document().map().forceIntegerFacePoints();
+            const String textureName = document().mruTexture() != NULL ? document().mruTexture()->name() : Model::Texture::Empty;
+            
+            Model::Face* clipFace = front ?
+                new Model::Face(worldBounds, forceIntegerFacePoints, m_planePoints[0], m_planePoints[1], m_planePoints[2], textureName) :
+                new Model::Face(worldBounds, forceIntegerFacePoints, m_planePoints[0], m_planePoints[2], m_planePoints[1], textureName);
+            
+            // determine the texture for the new face
+            // we will use the texture of the face whose normal is closest to the newly inserted face
+            const Model::FaceList& faces = brush.faces();
+            Model::FaceList::const_iterator faceIt = faces.begin();
+            Model::FaceList::const_iterator faceEnd = faces.end();
+            const Model::Face* bestFace = *faceIt++;
+            
+            while (faceIt != faceEnd) {
+                const Model::Face* face = *faceIt++;
+                
+                const Vec3f bestDiff = bestFace->boundary().normal - clipFace->boundary().normal;
+                const Vec3f diff = face->boundary().normal - clipFace->boundary().normal;
+                if (diff.lengthSquared() < bestDiff.lengthSquared())
+                    bestFace = face;
+            }
+            
+            clipFace->setAttributes(*bestFace);
+            
+            Model::Brush* clippedBrush = new Model::Brush(worldBounds, forceIntegerFacePoints, brush);
+            if (!clippedBrush->clip(*clipFace)) {
+                delete clippedBrush;
+                return NULL;
+            }
+            return clippedBrush;
         }
         
         Vec3f::List ClipTool::getNormals(const Vec3f& hitPoint, const Model::Face& hitFace) const {
@@ -256,7 +300,8 @@ namespace TrenchBroom {
             m_frontBrushFigure = new Renderer::BrushFigure(textureRendererManager);
             m_backBrushFigure = new Renderer::BrushFigure(textureRendererManager);
             
-            updateBrushes();
+            m_previewValid = false;
+            updatePreview();
             
             return true;
         }
@@ -266,6 +311,7 @@ namespace TrenchBroom {
             m_frontBrushFigure = NULL;
             deleteFigure(m_backBrushFigure);
             m_backBrushFigure = NULL;
+            m_previews.clear();
             
             view().viewOptions().setRenderSelection(true);
             return true;
@@ -451,6 +497,11 @@ namespace TrenchBroom {
             m_backBrushFigure = NULL;
         }
 
+        bool ClipTool::handleTracksMouse(InputState& inputState) {
+            // the point under the mouse is shown as the next clip point
+            return m_hitIndex >= 0;
+        }
+
         bool ClipTool::handleMouseUp(InputState& inputState) {
             if (inputState.mouseButtons() != MouseButtons::MBLeft ||
                 inputState.modifierKeys() != ModifierKeys::MKNone)
@@ -460,7 +511,7 @@ namespace TrenchBroom {
             
             m_numPoints++;
             m_hitIndex = -1;
-            updateBrushes();
+            updatePreview();
             
             Controller::Command* command = new Controller::DocumentCommand(Controller::Command::ClipToolChange, document());
             submitCommand(command, false);
@@ -510,7 +561,7 @@ namespace TrenchBroom {
                 }
             }
             
-            updateBrushes();
+            updatePreview();
             
             Controller::Command* command = new Controller::DocumentCommand(Controller::Command::ClipToolChange, document());
             submitCommand(command, false);
@@ -525,7 +576,7 @@ namespace TrenchBroom {
             assert(active());
             if (m_numPoints > 0) {
                 m_numPoints = 0;
-                updateBrushes();
+                updatePreview();
                 
                 Controller::Command* command = new Controller::DocumentCommand(Controller::Command::ClipToolChange, document());
                 submitCommand(command, false);
@@ -543,7 +594,8 @@ namespace TrenchBroom {
                     case Controller::Command::ClearMap:
                     case Controller::Command::TransformObjects:
                     case Controller::Command::ResizeBrushes:
-                        updateBrushes();
+                        m_previewValid = false;
+                        updatePreview();
                         break;
                     default:
                         break;
@@ -558,6 +610,8 @@ namespace TrenchBroom {
         m_hitIndex(-1),
         m_directHit(false),
         m_clipSide(CMFront),
+        m_validPlane(false),
+        m_previewValid(false),
         m_frontBrushFigure(NULL),
         m_backBrushFigure(NULL) {}
         
@@ -579,7 +633,7 @@ namespace TrenchBroom {
             assert(active());
             assert(m_numPoints > 0);
             m_numPoints--;
-            updateBrushes();
+            updatePreview();
 
             Controller::Command* command = new Controller::DocumentCommand(Controller::Command::ClipToolChange, document());
             submitCommand(command, false);
@@ -589,17 +643,36 @@ namespace TrenchBroom {
             assert(active());
             assert(m_numPoints > 0);
 
+            // the brushes are only created now, the preview just shows the split geometries
+            const bool front = m_clipSide == CMFront || m_clipSide == CMBoth;
+            const bool back = m_clipSide == CMBack || m_clipSide == CMBoth;
+            const BBoxf& worldBounds = document().map().worldBounds();
+            const bool forceIntegerFacePoints = document().map().forceIntegerFacePoints();
+            
             Model::EntityBrushesMap addBrushes;
-            switch (m_clipSide) {
-                case CMFront:
-                    addBrushes = m_frontBrushes;
-                    break;
-                case CMBack:
-                    addBrushes = m_backBrushes;
-                    break;
-                default:
-                    addBrushes = mergeEntityBrushes(m_frontBrushes, m_backBrushes);
-                    break;
+            BrushPreviewList::const_iterator previewIt, previewEnd;
+            for (previewIt = m_previews.begin(), previewEnd = m_previews.end(); previewIt != previewEnd; ++previewIt) {
+                const BrushPreview& preview = *previewIt;
+                const Model::Brush& brush = *preview.brush;
+                Model::BrushList& entityBrushes = addBrushes[brush.entity()];
+                
+                if (preview.status == PointStatus::PSBelow) {
+                    if (front)
+                        entityBrushes.push_back(new Model::Brush(worldBounds, forceIntegerFacePoints, brush));
+                } else if (preview.status == PointStatus::PSAbove) {
+                    if (back)
+                        entityBrushes.push_back(new Model::Brush(worldBounds, forceIntegerFacePoints, brush));
+                } else {
+                    Model::Brush* frontBrush = front ? clipBrush(brush, true) : NULL;
+                    if (frontBrush != NULL)
+                        entityBrushes.push_back(frontBrush);
+                    Model::Brush* backBrush = back ? clipBrush(brush, false) : NULL;
+                    if (backBrush != NULL)
+                        entityBrushes.push_back(backBrush);
+                }
+                
+                if (entityBrushes.empty())
+                    addBrushes.erase(brush.entity());
             }
             
             const Model::BrushList removeBrushes = document().editStateManager().selectedBrushes();
@@ -627,10 +700,11 @@ namespace TrenchBroom {
             
             m_numPoints = 0;
             m_hitIndex = -1;
+            m_previewValid = false;
             
             // only update if there are still brushes left because otherwise we have been deactivated
             if (active())
-                updateBrushes();
+                updatePreview();
             
             Controller::Command* command = new Controller::DocumentCommand(Controller::Command::ClipToolChange, document());
             submitCommand(command, false);
@@ -21,10 +21,12 @@
 #define __TrenchBroom__ClipTool__
 
 #include "Controller/Tool.h"
+#include "Model/BrushGeometryTypes.h"
 #include "Model/Filter.h"
 #include "Utility/VecMath.h"
 
 #include <cassert>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
@@ -103,14 +105,38 @@ namespace TrenchBroom {
             int m_hitIndex;
             bool m_directHit;
             
+            /*
+             * The parts of a selected brush on either side of the clip plane. The front part is the part below the
+             * plane. The polygons keep their memory from one update of the preview to the next.
+             */
+            struct BrushPreview {
+                Model::Brush* brush;
+                PointStatus::Type status;
+                Model::SplitPolygons below;
+                Model::SplitPolygons above;
+            };
+            
+            typedef std::vector<BrushPreview> BrushPreviewList;
+            class SplitBrushesTask;
+            
             ClipSide m_clipSide;
-            Model::EntityBrushesMap m_frontBrushes;
-            Model::EntityBrushesMap m_backBrushes;
+            Vec3f m_planePoints[3];
+            bool m_validPlane;
+            BrushPreviewList m_previews;
+            bool m_previewValid;
             Renderer::BrushFigure* m_frontBrushFigure;
             Renderer::BrushFigure* m_backBrushFigure;
             
             Vec3f selectNormal(const Vec3f::List& normals1, const Vec3f::List& normals2) const;
-            void updateBrushes();
+            bool computePlanePoints(Vec3f planePoints[3]) const;
+            
+            /*
+             * Splits the selected brushes by the current clip plane for the preview, without creating any brushes.
+             * Does nothing if neither the plane nor the selected brushes have changed since the last update, unless
+             * the preview was invalidated because the brushes were changed.
+             */
+            void updatePreview();
+            Model::Brush* clipBrush(const Model::Brush& brush, bool front) const;
             Vec3f::List getNormals(const Vec3f& hitPoint, const Model::Face& hitFace) const;
             bool isPointIdenticalWithExistingPoint(const Vec3f& point) const;
         protected:
@@ -121,6 +147,7 @@ namespace TrenchBroom {
             void handlePick(InputState& inputState);
             void handleRender(InputState& inputState, Renderer::Vbo& vbo, Renderer::RenderContext& renderContext);
             void handleFreeRenderResources();
+            bool handleTracksMouse(InputState& inputState);
 
             bool handleMouseUp(InputState& inputState);
 
@@ -23,6 +23,8 @@
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
 #include "Model/MapDocument.h"
+#include "Model/Picker.h"
+#include "Utility/ThreadPool.h"
 
 #include <wx/cmdproc.h>
 
@@ -134,6 +136,16 @@ namespace TrenchBroom {
                 return m_document;
             }
             
+            /*
+             * Calls the given function object for every element on the thread pool. The function must only modify the
+             * object it is called with, so the document must be notified of the changes (brushesWillChange etc.) in one
+             * batch before and after this is called.
+             */
+            template <typename T, class Function>
+            inline void parallelForEach(const std::vector<T>& elements, const Function& function, size_t minBatchSize = 16) const {
+                Utility::parallelForEach(elements, function, minBatchSize);
+            }
+            
             virtual void updateViews() {
                 m_document.UpdateAllViews(NULL, this);
             }
@@ -143,7 +155,12 @@ namespace TrenchBroom {
             m_document(document),
             m_modifiesDocument(modifiesDocument) {}
             
+            /*
+             * The background pick reads the objects that the command may change, so it must finish first, see
+             * Picker::waitForAsyncPick. This covers the dry runs in canDo, too, which are made from performDo.
+             */
             bool Do() {
+                m_document.picker().waitForAsyncPick();
                 bool result = Command::Do();
                 if (result && m_modifiesDocument)
                     document().incModificationCount();
@@ -151,6 +168,7 @@ namespace TrenchBroom {
             }
             
             bool Undo() {
+                m_document.picker().waitForAsyncPick();
                 bool result = Command::Undo();
                 if (result && m_modifiesDocument)
                     document().decModificationCount();
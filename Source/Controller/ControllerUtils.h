@@ -22,14 +22,20 @@
 
 #include "Controller/AddObjectsCommand.h"
 #include "Controller/ChangeEditStateCommand.h"
+#include "Controller/RemoveObjectsCommand.h"
+#include "Controller/ReparentBrushesCommand.h"
 #include "Utility/CommandProcessor.h"
 #include "Model/Brush.h"
+#include "Model/BrushCSG.h"
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/EntityDefinition.h"
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
+#include "Model/Octree.h"
+#include "Utility/Grid.h"
 #include "Utility/List.h"
+#include "Utility/ThreadPool.h"
 
 namespace TrenchBroom {
     namespace Controller {
@@ -91,6 +97,183 @@ namespace TrenchBroom {
             commandProcessor->Submit(changeEditStateCommand);
             CommandProcessor::EndGroup(commandProcessor);
         }
+        
+        /*
+         * Replaces the given brushes by the given new brushes in a single undoable command group and selects the given
+         * brushes afterwards.
+         */
+        inline void replaceBrushes(Model::MapDocument& document, const wxString& name, const Model::BrushList& removeBrushes, const Model::EntityBrushesMap& addBrushes, const Model::BrushList& selectBrushes) {
+            wxCommandProcessor* commandProcessor = document.GetCommandProcessor();
+            CommandProcessor::BeginGroup(commandProcessor, name);
+            commandProcessor->Submit(Controller::ChangeEditStateCommand::deselectAll(document));
+            
+            Model::EntityBrushesMap::const_iterator it, end;
+            for (it = addBrushes.begin(), end = addBrushes.end(); it != end; ++it) {
+                Model::Entity* entity = it->first;
+                const Model::BrushList& entityBrushes = it->second;
+                if (!entityBrushes.empty()) {
+                    commandProcessor->Submit(Controller::AddObjectsCommand::addBrushes(document, entityBrushes));
+                    if (!entity->worldspawn())
+                        commandProcessor->Submit(Controller::ReparentBrushesCommand::reparent(document, entityBrushes, *entity));
+                }
+            }
+            
+            commandProcessor->Submit(Controller::RemoveObjectsCommand::removeBrushes(document, removeBrushes));
+            if (!selectBrushes.empty())
+                commandProcessor->Submit(Controller::ChangeEditStateCommand::select(document, selectBrushes));
+            CommandProcessor::EndGroup(commandProcessor);
+        }
+        
+        class SubtractBrushes : public Utility::ParallelTask {
+        private:
+            const Model::BrushCSG& m_csg;
+            const Model::BrushList& m_minuends;
+            const Model::BrushList& m_subtrahends;
+            std::vector<char>& m_touched;
+            std::vector<Model::BrushList>& m_fragments;
+        public:
+            SubtractBrushes(const Model::BrushCSG& csg, const Model::BrushList& minuends, const Model::BrushList& subtrahends, std::vector<char>& touched, std::vector<Model::BrushList>& fragments) :
+            m_csg(csg),
+            m_minuends(minuends),
+            m_subtrahends(subtrahends),
+            m_touched(touched),
+            m_fragments(fragments) {}
+            
+            void run(size_t index) {
+                m_touched[index] = m_csg.subtract(*m_minuends[index], m_subtrahends, m_fragments[index]) ? 1 : 0;
+            }
+        };
+        
+        /*
+         * Subtracts the selected brushes from all visible and unlocked brushes that they intersect. Returns false if
+         * the selected brushes do not intersect any other brush.
+         */
+        inline bool subtractBrushes(Model::MapDocument& document) {
+            const Model::BrushList subtrahends = document.editStateManager().selectedBrushes();
+            assert(!subtrahends.empty());
+            
+            BBoxf bounds = subtrahends.front()->bounds();
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = subtrahends.begin() + 1, brushEnd = subtrahends.end(); brushIt != brushEnd; ++brushIt)
+                bounds.mergeWith((*brushIt)->bounds());
+            
+            // only the candidates found in the octree are checked against the subtrahends
+            Model::BrushList minuends;
+            const Model::MapObjectList objects = document.octree().intersect(bounds);
+            Model::MapObjectList::const_iterator objectIt, objectEnd;
+            for (objectIt = objects.begin(), objectEnd = objects.end(); objectIt != objectEnd; ++objectIt) {
+                Model::MapObject* object = *objectIt;
+                if (object->objectType() == Model::MapObject::BrushObject && object->editState() == Model::EditState::Default) {
+                    Model::Brush* brush = static_cast<Model::Brush*>(object);
+                    for (brushIt = subtrahends.begin(), brushEnd = subtrahends.end(); brushIt != brushEnd; ++brushIt) {
+                        if ((*brushIt)->bounds().intersects(brush->bounds())) {
+                            minuends.push_back(brush);
+                            break;
+                        }
+                    }
+                }
+            }
+            
+            if (minuends.empty())
+                return false;
+            
+            const Model::Map& map = document.map();
+            const Model::BrushCSG csg(map.worldBounds(), map.forceIntegerFacePoints());
+            std::vector<char> touched(minuends.size(), 0);
+            std::vector<Model::BrushList> fragments(minuends.size());
+            
+            SubtractBrushes task(csg, minuends, subtrahends, touched, fragments);
+            Utility::ThreadPool::pool().parallelFor(minuends.size(), task);
+            
+            Model::BrushList removeBrushes;
+            Model::EntityBrushesMap addBrushes;
+            for (size_t i = 0; i < minuends.size(); i++) {
+                if (touched[i] != 0) {
+                    Model::Brush* minuend = minuends[i];
+                    Model::BrushList& entityBrushes = addBrushes[minuend->entity()];
+                    entityBrushes.insert(entityBrushes.end(), fragments[i].begin(), fragments[i].end());
+                    removeBrushes.push_back(minuend);
+                }
+            }
+            
+            if (removeBrushes.empty())
+                return false;
+            
+            replaceBrushes(document, Controller::Command::makeObjectActionName(wxT("Subtract"), Model::EmptyEntityList, subtrahends), removeBrushes, addBrushes, subtrahends);
+            return true;
+        }
+        
+        /*
+         * Merges the selected brushes of each entity into as few convex brushes as possible. Returns false if no
+         * brushes could be merged.
+         */
+        inline bool mergeBrushes(Model::MapDocument& document) {
+            const Model::BrushList& brushes = document.editStateManager().selectedBrushes();
+            assert(!brushes.empty());
+            
+            const Model::Map& map = document.map();
+            const Model::BrushCSG csg(map.worldBounds(), map.forceIntegerFacePoints());
+            
+            Model::BrushList removeBrushes;
+            Model::BrushList newBrushes;
+            Model::EntityBrushesMap addBrushes;
+            const Model::EntityBrushesMap selectedBrushes = Model::entityBrushes(brushes);
+            Model::EntityBrushesMap::const_iterator it, end;
+            for (it = selectedBrushes.begin(), end = selectedBrushes.end(); it != end; ++it) {
+                Model::BrushList mergedBrushes;
+                if (csg.merge(it->second, removeBrushes, mergedBrushes)) {
+                    addBrushes[it->first] = mergedBrushes;
+                    newBrushes.insert(newBrushes.end(), mergedBrushes.begin(), mergedBrushes.end());
+                }
+            }
+            
+            if (removeBrushes.empty())
+                return false;
+            
+            // brushes that were not merged remain selected
+            Model::BrushList selectBrushes = newBrushes;
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt)
+                if (std::find(removeBrushes.begin(), removeBrushes.end(), *brushIt) == removeBrushes.end())
+                    selectBrushes.push_back(*brushIt);
+            
+            replaceBrushes(document, Controller::Command::makeObjectActionName(wxT("Merge"), Model::EmptyEntityList, brushes), removeBrushes, addBrushes, selectBrushes);
+            return true;
+        }
+        
+        /*
+         * Hollows out the selected brushes, using the current grid size as the wall thickness. Returns false if none
+         * of the brushes is thick enough to be hollowed.
+         */
+        inline bool hollowBrushes(Model::MapDocument& document) {
+            const Model::BrushList brushes = document.editStateManager().selectedBrushes();
+            assert(!brushes.empty());
+            
+            const Model::Map& map = document.map();
+            const Model::BrushCSG csg(map.worldBounds(), map.forceIntegerFacePoints());
+            const float thickness = static_cast<float>(document.grid().actualSize());
+            
+            Model::BrushList removeBrushes;
+            Model::BrushList newBrushes;
+            Model::EntityBrushesMap addBrushes;
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                Model::Brush* brush = *it;
+                Model::BrushList walls;
+                if (csg.hollow(*brush, thickness, walls)) {
+                    Model::BrushList& entityBrushes = addBrushes[brush->entity()];
+                    entityBrushes.insert(entityBrushes.end(), walls.begin(), walls.end());
+                    newBrushes.insert(newBrushes.end(), walls.begin(), walls.end());
+                    removeBrushes.push_back(brush);
+                }
+            }
+            
+            if (removeBrushes.empty())
+                return false;
+            
+            replaceBrushes(document, Controller::Command::makeObjectActionName(wxT("Hollow"), Model::EmptyEntityList, brushes), removeBrushes, addBrushes, newBrushes);
+            return true;
+        }
     }
 }
 
@@ -125,6 +125,10 @@ namespace TrenchBroom {
             Rayf m_pickRay;
             Model::Picker& m_picker;
             Model::PickResult* m_pickResult;
+            
+            // the ray and the octree revision that the pick result was computed for
+            Rayf m_pickedRay;
+            unsigned int m_pickedRevision;
         public:
             InputState(const Renderer::Camera& camera, Model::Picker& picker) :
             m_mouseButtons(MouseButtons::MBNone),
@@ -137,7 +141,8 @@ namespace TrenchBroom {
             m_camera(camera),
             m_valid(false),
             m_picker(picker),
-            m_pickResult(NULL) {
+            m_pickResult(NULL),
+            m_pickedRevision(0) {
                 wxMouseState mouseState = wxGetMouseState();
                 // make sure the mouse deltas are 0:
                 m_mouseX = mouseState.GetX();
@@ -240,14 +245,53 @@ namespace TrenchBroom {
                 m_valid = false;
             }
             
+            inline Rayf currentPickRay() const {
+                return m_camera.pickRay(static_cast<float>(m_mouseX), static_cast<float>(m_mouseY));
+            }
+            
+            /*
+             * Returns true if the pick result was computed for the current mouse position and camera, and if the
+             * octree has not changed since.
+             */
+            inline bool pickResultCurrent() const {
+                return m_pickResult != NULL && m_pickedRevision == m_picker.revision() && m_pickedRay == currentPickRay();
+            }
+            
+            /*
+             * The objects hit by the pick ray are only picked again if the ray or the octree has changed. The hits of
+             * the tools are always removed because the tools add them again depending on their current state.
+             * While a background pick is running for a newer ray, the last result is kept until the background pick
+             * delivers, so that painting does not have to wait for it.
+             */
             inline void validate() {
                 if (m_valid)
                     return;
                 m_valid = true;
-                m_pickRay = m_camera.pickRay(static_cast<float>(m_mouseX), static_cast<float>(m_mouseY));
+                m_pickRay = currentPickRay();
+                if (m_pickResult != NULL && m_pickedRevision == m_picker.revision() &&
+                    (m_pickedRay == m_pickRay || m_picker.asyncPickRunning())) {
+                    m_pickResult->removeHits(~Model::HitType::ObjectHit);
+                } else {
+                    if (m_pickResult != NULL)
+                        delete m_pickResult;
+                    m_pickResult = m_picker.pick(m_pickRay);
+                    m_pickedRay = m_pickRay;
+                    m_pickedRevision = m_picker.revision();
+                }
+            }
+            
+            /*
+             * Replaces the pick result with the given result of a background pick along the given ray. The result is
+             * used until the state is invalidated, even if the mouse has moved on since the pick was started.
+             */
+            inline void setPickResult(Model::PickResult* pickResult, const Rayf& ray, unsigned int revision) {
                 if (m_pickResult != NULL)
                     delete m_pickResult;
-                m_pickResult = m_picker.pick(pickRay());
+                m_pickResult = pickResult;
+                m_pickedRay = ray;
+                m_pickedRevision = revision;
+                m_pickRay = currentPickRay();
+                m_valid = true;
             }
         
             inline Model::PickResult& pickResult() {
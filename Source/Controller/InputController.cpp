@@ -47,6 +47,7 @@
 #include "Renderer/SharedResources.h"
 #include "Utility/Console.h"
 #include "Utility/Grid.h"
+#include "Utility/Profiler.h"
 #include "View/DocumentViewHolder.h"
 
 namespace TrenchBroom {
@@ -74,14 +75,55 @@ namespace TrenchBroom {
             }
         }
 
+        void InputController::finishAsyncPick() {
+            if (!m_documentViewHolder.valid())
+                return;
+            
+            Model::Picker& picker = m_documentViewHolder.document().picker();
+            if (!picker.asyncPickRunning())
+                return;
+            
+            Rayf ray;
+            unsigned int revision;
+            Model::PickResult* pickResult = picker.takeAsyncPickResult(ray, revision);
+            if (pickResult != NULL && revision == picker.revision())
+                m_inputState.setPickResult(pickResult, ray, revision);
+            else
+                delete pickResult;
+            m_pickPending = false;
+        }
+
         void InputController::updateHits() {
+            finishAsyncPick();
             m_inputState.invalidate();
             m_toolChain->updateHits(m_inputState);
         }
 
+        void InputController::updateFeedback() {
+            m_inputState.pickResult().targets(m_feedbackHitTargets);
+            m_feedbackModalTool = m_modalTool;
+            m_feedbackTracksMouse = m_toolChain->tracksMouse(m_inputState);
+        }
+
         void InputController::updateViews() {
-            if (m_documentViewHolder.valid())
-                m_documentViewHolder.document().UpdateAllViews();
+            if (!m_documentViewHolder.valid())
+                return;
+            
+            updateFeedback();
+            m_documentViewHolder.document().UpdateAllViews();
+        }
+
+        void InputController::updateViewsIfFeedbackChanged() {
+            if (m_dragTool != NULL || m_modalTool != m_feedbackModalTool ||
+                m_feedbackTracksMouse || m_toolChain->tracksMouse(m_inputState)) {
+                updateViews();
+                return;
+            }
+            
+            Model::HitTargetList hitTargets;
+            m_inputState.pickResult().targets(hitTargets);
+            if (hitTargets != m_feedbackHitTargets)
+                updateViews();
         }
 
         void InputController::toggleTool(Tool* tool) {
@@ -123,6 +165,9 @@ namespace TrenchBroom {
         m_cancelledDrag(false),
         m_discardNextMouseUp(false),
         m_modifierKeys(ModifierKeys::MKNone),
+        m_feedbackModalTool(NULL),
+        m_feedbackTracksMouse(false),
+        m_pickPending(false),
         m_selectionGuideRenderer(NULL),
         m_selectedFilter(Model::SelectedFilter(m_documentViewHolder.view().filter())) {
             m_cameraTool = new CameraTool(m_documentViewHolder, *this);
@@ -210,6 +255,7 @@ namespace TrenchBroom {
         }
 
         bool InputController::mouseDown(int x, int y, MouseButtonState mouseButton) {
+            TB_PROFILE_ZONE("InputController::mouseDown");
             if (m_dragTool != NULL)
                 return false;
 
@@ -224,6 +270,7 @@ namespace TrenchBroom {
         }
 
         bool InputController::mouseUp(int x, int y, MouseButtonState mouseButton) {
+            TB_PROFILE_ZONE("InputController::mouseUp");
             m_inputState.mouseMove(x, y);
             if (m_discardNextMouseUp) {
                 m_discardNextMouseUp = false;
@@ -250,6 +297,7 @@ namespace TrenchBroom {
         }
 
         bool InputController::mouseDClick(int x, int y, MouseButtonState mouseButton) {
+            TB_PROFILE_ZONE("InputController::mouseDClick");
             m_discardNextMouseUp = true;
 
             m_inputState.mouseMove(x, y);
@@ -262,6 +310,7 @@ namespace TrenchBroom {
         }
 
         void InputController::mouseMove(int x, int y) {
+            TB_PROFILE_ZONE("InputController::mouseMove");
             if (m_inputState.mouseButtons() != MouseButtons::MBNone) {
                 if (m_dragTool == NULL && !m_cancelledDrag &&
                     (std::abs(m_clickPos.x - x) > 1 ||
@@ -284,15 +333,59 @@ namespace TrenchBroom {
                 }
             } else {
                 m_inputState.mouseMove(x, y);
+                if (m_documentViewHolder.valid() && !m_inputState.pickResultCurrent()) {
+                    // pick in the background so that the event loop is not blocked, see updateAsyncPick
+                    Model::Picker& picker = m_documentViewHolder.document().picker();
+                    if (picker.asyncPickRunning())
+                        m_pickPending = true;
+                    else
+                        picker.pickAsync(m_inputState.currentPickRay());
+                    return;
+                }
+                
                 updateHits();
                 m_toolChain->mouseMove(m_inputState);
             }
 
             updateModalTool();
-            updateViews();
+            updateViewsIfFeedbackChanged();
+        }
+
+        void InputController::updateAsyncPick() {
+            if (!m_documentViewHolder.valid())
+                return;
+            
+            Model::Picker& picker = m_documentViewHolder.document().picker();
+            if (!picker.asyncPickFinished())
+                return;
+            
+            TB_PROFILE_ZONE("InputController::updateAsyncPick");
+            Rayf ray;
+            unsigned int revision;
+            Model::PickResult* pickResult = picker.takeAsyncPickResult(ray, revision);
+            if (pickResult != NULL && revision == picker.revision()) {
+                m_inputState.setPickResult(pickResult, ray, revision);
+                m_toolChain->updateHits(m_inputState);
+            } else {
+                // the octree has changed while the pick was running
+                delete pickResult;
+                updateHits();
+            }
+            
+            if (m_inputState.mouseButtons() == MouseButtons::MBNone)
+                m_toolChain->mouseMove(m_inputState);
+            updateModalTool();
+            updateViewsIfFeedbackChanged();
+            
+            if (m_pickPending) {
+                m_pickPending = false;
+                if (!m_inputState.pickResultCurrent())
+                    picker.pickAsync(m_inputState.currentPickRay());
+            }
         }
 
         void InputController::scroll(float x, float y) {
+            TB_PROFILE_ZONE("InputController::scroll");
             m_inputState.scroll(x, y);
             updateHits();
 
@@ -433,7 +526,9 @@ namespace TrenchBroom {
             updateHits();
             m_toolChain->update(command, m_inputState);
             updateModalTool();
-            updateViews();
+            
+            // the view redraws itself once it has passed the command on
+            updateFeedback();
         }
 
         void InputController::cameraChanged() {
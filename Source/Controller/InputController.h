@@ -24,6 +24,7 @@
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
 #include "Model/Filter.h"
+#include "Model/Picker.h"
 #include "Renderer/Figure.h"
 
 namespace TrenchBroom {
@@ -85,9 +86,30 @@ namespace TrenchBroom {
             bool m_discardNextMouseUp;
             ModifierKeyState m_modifierKeys;
 
+            // the feedback that was shown by the last view update
+            Model::HitTargetList m_feedbackHitTargets;
+            Tool* m_feedbackModalTool;
+            bool m_feedbackTracksMouse;
+            
+            // set if the mouse has moved while a background pick was running
+            bool m_pickPending;
+
             void updateModalTool();
+            
+            /*
+             * Waits for a running background pick and keeps its result if it is still up to date, so that it can be
+             * reused if the mouse has not moved on since the pick was started.
+             */
+            void finishAsyncPick();
             void updateHits();
+            void updateFeedback();
             void updateViews();
+            
+            /*
+             * Only updates the views if the feedback may have changed since the last update, that is, if a tool is
+             * dragging or tracks the mouse, or if the modal tool or the objects and handles under the mouse have changed.
+             */
+            void updateViewsIfFeedbackChanged();
 
             Renderer::BoxGuideRenderer* m_selectionGuideRenderer;
             Model::SelectedFilter m_selectedFilter;
@@ -108,6 +130,13 @@ namespace TrenchBroom {
             bool mouseUp(int x, int y, MouseButtonState mouseButton);
             bool mouseDClick(int x, int y, MouseButtonState mouseButton);
             void mouseMove(int x, int y);
+            
+            /*
+             * Applies the result of the background pick that was started when the mouse moved without any buttons
+             * being pressed. Called when the picker notifies that a background pick has finished; does nothing if the
+             * result has already been taken in the meantime.
+             */
+            void updateAsyncPick();
             void scroll(float x, float y);
             void cancelDrag();
             void endDrag();
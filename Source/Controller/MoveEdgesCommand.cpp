@@ -23,11 +23,47 @@
 #include "Model/BrushGeometry.h"
 #include "Model/Face.h"
 #include "Utility/Console.h"
+#include "Utility/List.h"
 
 namespace TrenchBroom {
     namespace Controller {
+        class DryRunMoveEdges : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const Model::BrushEdgesMap& m_brushEdges;
+            const Vec3f& m_delta;
+            Model::DryRunList& m_dryRuns;
+        public:
+            DryRunMoveEdges(const Model::BrushList& brushes, const Model::BrushEdgesMap& brushEdges, const Vec3f& delta, Model::DryRunList& dryRuns) :
+            m_brushes(brushes),
+            m_brushEdges(brushEdges),
+            m_delta(delta),
+            m_dryRuns(dryRuns) {}
+
+            void run(size_t index) {
+                Model::Brush* brush = m_brushes[index];
+                Model::BrushEdgesMap::const_iterator it = m_brushEdges.find(brush);
+                assert(it != m_brushEdges.end());
+                m_dryRuns[index] = brush->dryRunMoveEdges(it->second, m_delta);
+            }
+        };
+
+        bool MoveEdgesCommand::dryRun() const {
+            if (m_dryRuns.empty()) {
+                m_dryRuns.resize(m_brushes.size(), NULL);
+                DryRunMoveEdges task(m_brushes, m_brushEdges, m_delta, m_dryRuns);
+                Utility::ThreadPool::pool().parallelFor(m_brushes.size(), task, 4);
+            }
+
+            Model::DryRunList::const_iterator it, end;
+            for (it = m_dryRuns.begin(), end = m_dryRuns.end(); it != end; ++it)
+                if (!(*it)->valid())
+                    return false;
+            return true;
+        }
+
         bool MoveEdgesCommand::performDo() {
-            if (!canDo())
+            if (!dryRun())
                 return false;
 
             m_handleManager.remove(m_brushes);
@@ -35,13 +71,13 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_edgesAfter.clear();
             
-            Model::BrushEdgesMap::const_iterator it, end;
-            for (it = m_brushEdges.begin(), end = m_brushEdges.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::EdgeInfoList& edgeInfos = it->second;
-                const Model::EdgeInfoList newEdgeInfos = brush->moveEdges(edgeInfos, m_delta);
-                m_edgesAfter.insert(m_edgesAfter.end(), newEdgeInfos.begin(), newEdgeInfos.end());
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Model::Brush* brush = m_brushes[i];
+                Model::BrushGeometry::DryRun& brushDryRun = *m_dryRuns[i];
+                brush->commit(brushDryRun);
+                m_edgesAfter.insert(m_edgesAfter.end(), brushDryRun.newEdgeInfos().begin(), brushDryRun.newEdgeInfos().end());
             }
+            Utility::deleteAll(m_dryRuns);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -87,19 +123,16 @@ namespace TrenchBroom {
             assert(m_brushes.size() == m_brushEdges.size());
         }
 
+        MoveEdgesCommand::~MoveEdgesCommand() {
+            Utility::deleteAll(m_dryRuns);
+        }
+
         MoveEdgesCommand* MoveEdgesCommand::moveEdges(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta) {
             return new MoveEdgesCommand(document, handleManager.selectedEdgeHandles().size() == 1 ? wxT("Move Edge") : wxT("Move Edges"), handleManager, delta);
         }
 
         bool MoveEdgesCommand::canDo() const {
-            Model::BrushEdgesMap::const_iterator it, end;
-            for (it = m_brushEdges.begin(), end = m_brushEdges.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::EdgeInfoList& edges = it->second;
-                if (!brush->canMoveEdges(edges, m_delta))
-                    return false;
-            }
-            return true;
+            return dryRun();
         }
     }
 }
@@ -21,6 +21,7 @@
 #define __TrenchBroom__MoveEdgesCommand__
 
 #include "Controller/SnapshotCommand.h"
+#include "Model/BrushGeometry.h"
 #include "Model/BrushGeometryTypes.h"
 #include "Model/BrushTypes.h"
 #include "Utility/VecMath.h"
@@ -42,12 +43,17 @@ namespace TrenchBroom {
             Model::EdgeInfoList m_edgesBefore;
             Model::EdgeInfoList m_edgesAfter;
             Vec3f m_delta;
+            mutable Model::DryRunList m_dryRuns;
+
+            bool dryRun() const;
 
             bool performDo();
             bool performUndo();
 
             MoveEdgesCommand(Model::MapDocument& document, const wxString& name, VertexHandleManager& handleManager, const Vec3f& delta);
         public:
+            ~MoveEdgesCommand();
+
             static MoveEdgesCommand* moveEdges(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta);
 
             bool canDo() const;
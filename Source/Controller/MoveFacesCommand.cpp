@@ -22,11 +22,47 @@
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
 #include "Model/Face.h"
+#include "Utility/List.h"
 
 namespace TrenchBroom {
     namespace Controller {
+        class DryRunMoveFaces : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const Model::BrushFacesMap& m_brushFaces;
+            const Vec3f& m_delta;
+            Model::DryRunList& m_dryRuns;
+        public:
+            DryRunMoveFaces(const Model::BrushList& brushes, const Model::BrushFacesMap& brushFaces, const Vec3f& delta, Model::DryRunList& dryRuns) :
+            m_brushes(brushes),
+            m_brushFaces(brushFaces),
+            m_delta(delta),
+            m_dryRuns(dryRuns) {}
+
+            void run(size_t index) {
+                Model::Brush* brush = m_brushes[index];
+                Model::BrushFacesMap::const_iterator it = m_brushFaces.find(brush);
+                assert(it != m_brushFaces.end());
+                m_dryRuns[index] = brush->dryRunMoveFaces(it->second, m_delta);
+            }
+        };
+
+        bool MoveFacesCommand::dryRun() const {
+            if (m_dryRuns.empty()) {
+                m_dryRuns.resize(m_brushes.size(), NULL);
+                DryRunMoveFaces task(m_brushes, m_brushFaces, m_delta, m_dryRuns);
+                Utility::ThreadPool::pool().parallelFor(m_brushes.size(), task, 4);
+            }
+
+            Model::DryRunList::const_iterator it, end;
+            for (it = m_dryRuns.begin(), end = m_dryRuns.end(); it != end; ++it)
+                if (!(*it)->valid())
+                    return false;
+            return true;
+        }
+
         bool MoveFacesCommand::performDo() {
-            if (!canDo())
+            if (!dryRun())
                 return false;
 
             m_handleManager.remove(m_brushes);
@@ -34,13 +70,13 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_facesAfter.clear();
 
-            Model::BrushFacesMap::const_iterator it, end;
-            for (it = m_brushFaces.begin(), end = m_brushFaces.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::FaceInfoList& faceInfos = it->second;
-                const Model::FaceInfoList newFaces = brush->moveFaces(faceInfos, m_delta);
-                m_facesAfter.insert(m_facesAfter.end(), newFaces.begin(), newFaces.end());
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Model::Brush* brush = m_brushes[i];
+                Model::BrushGeometry::DryRun& brushDryRun = *m_dryRuns[i];
+                brush->commit(brushDryRun);
+                m_facesAfter.insert(m_facesAfter.end(), brushDryRun.newFaceInfos().begin(), brushDryRun.newFaceInfos().end());
             }
+            Utility::deleteAll(m_dryRuns);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -86,19 +122,16 @@ namespace TrenchBroom {
             assert(m_brushes.size() == m_brushFaces.size());
         }
 
+        MoveFacesCommand::~MoveFacesCommand() {
+            Utility::deleteAll(m_dryRuns);
+        }
+
         MoveFacesCommand* MoveFacesCommand::moveFaces(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta) {
             return new MoveFacesCommand(document, handleManager.selectedFaceHandles().size() == 1 ? wxT("Move Face") : wxT("Move Faces"), handleManager, delta);
         }
 
         bool MoveFacesCommand::canDo() const {
-            Model::BrushFacesMap::const_iterator it, end;
-            for (it = m_brushFaces.begin(), end = m_brushFaces.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::FaceInfoList& faces = it->second;
-                if (!brush->canMoveFaces(faces, m_delta))
-                    return false;
-            }
-            return true;
+            return dryRun();
         }
     }
 }
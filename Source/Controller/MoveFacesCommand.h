@@ -21,6 +21,7 @@
 #define __TrenchBroom__MoveFacesCommand__
 
 #include "Controller/SnapshotCommand.h"
+#include "Model/BrushGeometry.h"
 #include "Model/BrushGeometryTypes.h"
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
@@ -43,12 +44,17 @@ namespace TrenchBroom {
             Model::FaceInfoList m_facesBefore;
             Model::FaceInfoList m_facesAfter;
             Vec3f m_delta;
+            mutable Model::DryRunList m_dryRuns;
+
+            bool dryRun() const;
 
             bool performDo();
             bool performUndo();
 
             MoveFacesCommand(Model::MapDocument& document, const wxString& name, VertexHandleManager& handleManager, const Vec3f& delta);
         public:
+            ~MoveFacesCommand();
+
             static MoveFacesCommand* moveFaces(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta);
 
             bool canDo() const;
@@ -26,23 +26,31 @@
 
 namespace TrenchBroom {
     namespace Controller {
-        bool MoveTexturesCommand::performDo() {
-            Model::FaceList::const_iterator it, end;
-            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
-                Model::Face& face = **it;
-                face.moveTexture(m_up, m_right, m_direction, m_distance);
-            }
+        class MoveTexture {
+        private:
+            const Vec3f& m_up;
+            const Vec3f& m_right;
+            Direction m_direction;
+            float m_distance;
+        public:
+            MoveTexture(const Vec3f& up, const Vec3f& right, Direction direction, float distance) :
+            m_up(up),
+            m_right(right),
+            m_direction(direction),
+            m_distance(distance) {}
             
+            inline void operator()(Model::Face* face) const {
+                face->moveTexture(m_up, m_right, m_direction, m_distance);
+            }
+        };
+        
+        bool MoveTexturesCommand::performDo() {
+            parallelForEach(m_faces, MoveTexture(m_up, m_right, m_direction, m_distance), 256);
             return true;
         }
         
         bool MoveTexturesCommand::performUndo() {
-            Model::FaceList::const_iterator it, end;
-            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
-                Model::Face& face = **it;
-                face.moveTexture(m_up, m_right, m_direction, -m_distance);
-            }
-            
+            parallelForEach(m_faces, MoveTexture(m_up, m_right, m_direction, -m_distance), 256);
             return true;
         }
         
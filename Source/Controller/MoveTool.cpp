@@ -59,6 +59,12 @@ namespace TrenchBroom {
             m_indicator = NULL;
         }
         
+        bool MoveTool::handleTracksMouse(InputState& inputState) {
+            // the movement indicator is drawn next to the mouse cursor
+            Vec3f hitPoint;
+            return isApplicable(inputState, hitPoint);
+        }
+        
         void MoveTool::handleModifierKeyChange(InputState& inputState) {
             inputState.axisRestriction().setVerticalRestriction((inputState.modifierKeys() & ModifierKeys::MKAlt) != 0);
             
@@ -49,6 +49,7 @@ namespace TrenchBroom {
             
             virtual void handleRender(InputState& inputState, Renderer::Vbo& vbo, Renderer::RenderContext& renderContext);
             virtual void handleFreeRenderResources();
+            virtual bool handleTracksMouse(InputState& inputState);
             
             virtual void handleModifierKeyChange(InputState& inputState);
             
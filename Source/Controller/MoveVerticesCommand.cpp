@@ -26,11 +26,48 @@
 #include "Utility/List.h"
 
 #include <cassert>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Controller {
+        class DryRunMoveVertices : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const std::map<Model::Brush*, Vec3f::List>& m_brushVertices;
+            const Vec3f& m_delta;
+            Model::DryRunList& m_dryRuns;
+        public:
+            DryRunMoveVertices(const Model::BrushList& brushes, const std::map<Model::Brush*, Vec3f::List>& brushVertices, const Vec3f& delta, Model::DryRunList& dryRuns) :
+            m_brushes(brushes),
+            m_brushVertices(brushVertices),
+            m_delta(delta),
+            m_dryRuns(dryRuns) {}
+            
+            void run(size_t index) {
+                Model::Brush* brush = m_brushes[index];
+                std::map<Model::Brush*, Vec3f::List>::const_iterator it = m_brushVertices.find(brush);
+                assert(it != m_brushVertices.end());
+                m_dryRuns[index] = brush->dryRunMoveVertices(it->second, m_delta);
+            }
+        };
+        
+        bool MoveVerticesCommand::dryRun() const {
+            if (m_dryRuns.empty()) {
+                m_dryRuns.resize(m_brushes.size(), NULL);
+                DryRunMoveVertices task(m_brushes, m_brushVertices, m_delta, m_dryRuns);
+                Utility::ThreadPool::pool().parallelFor(m_brushes.size(), task, 4);
+            }
+            
+            Model::DryRunList::const_iterator it, end;
+            for (it = m_dryRuns.begin(), end = m_dryRuns.end(); it != end; ++it)
+                if (!(*it)->valid())
+                    return false;
+            return true;
+        }
+        
         bool MoveVerticesCommand::performDo() {
-            if (!canDo())
+            // the dry runs are committed as the actual move, so the geometry of every brush is only changed once
+            if (!dryRun())
                 return false;
             
             m_handleManager.remove(m_brushes);
@@ -38,14 +75,13 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
 
-            BrushVerticesMap::const_iterator mapIt, mapEnd;
-            for (mapIt = m_brushVertices.begin(), mapEnd = m_brushVertices.end(); mapIt != mapEnd; ++mapIt) {
-                Model::Brush* brush = mapIt->first;
-                const Vec3f::List& oldVertexPositions = mapIt->second;
-                const Vec3f::List newVertexPositions = brush->moveVertices(oldVertexPositions, m_delta);
-                
-                m_verticesAfter.insert(newVertexPositions.begin(), newVertexPositions.end());
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Model::Brush* brush = m_brushes[i];
+                Model::BrushGeometry::DryRun& brushDryRun = *m_dryRuns[i];
+                brush->commit(brushDryRun);
+                m_verticesAfter.insert(brushDryRun.newVertexPositions().begin(), brushDryRun.newVertexPositions().end());
             }
+            Utility::deleteAll(m_dryRuns);
             
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -89,19 +125,16 @@ namespace TrenchBroom {
             assert(m_brushes.size() == m_brushVertices.size());
         }
 
+        MoveVerticesCommand::~MoveVerticesCommand() {
+            Utility::deleteAll(m_dryRuns);
+        }
+
         MoveVerticesCommand* MoveVerticesCommand::moveVertices(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta) {
             return new MoveVerticesCommand(document, handleManager.selectedVertexHandles().size() == 1 ? wxT("Move Vertex") : wxT("Move Vertices"), handleManager, delta);
         }
 
         bool MoveVerticesCommand::canDo() const {
-            BrushVerticesMap::const_iterator it, end;
-            for (it = m_brushVertices.begin(), end = m_brushVertices.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Vec3f::List& vertices = it->second;
-                if (!brush->canMoveVertices(vertices, m_delta))
-                    return false;
-            }
-            return true;
+            return dryRun();
         }
 
         bool MoveVerticesCommand::hasRemainingVertices() const {
@@ -21,6 +21,7 @@
 #define __TrenchBroom__MoveVerticesCommand__
 
 #include "Controller/SnapshotCommand.h"
+#include "Model/BrushGeometry.h"
 #include "Model/BrushGeometryTypes.h"
 #include "Model/BrushTypes.h"
 #include "Utility/VecMath.h"
@@ -46,12 +47,21 @@ namespace TrenchBroom {
             Vec3f::Set m_verticesBefore;
             Vec3f::Set m_verticesAfter;
             Vec3f m_delta;
+            mutable Model::DryRunList m_dryRuns;
+            
+            /*
+             * Makes the dry runs unless canDo has already made them, and returns whether all of them are valid. The dry
+             * runs are kept until performDo commits them.
+             */
+            bool dryRun() const;
             
             bool performDo();
             bool performUndo();
 
             MoveVerticesCommand(Model::MapDocument& document, const wxString& name, VertexHandleManager& handleManager, const Vec3f& delta);
         public:
+            ~MoveVerticesCommand();
+
             static MoveVerticesCommand* moveVertices(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta);
             
             bool canDo() const;
@@ -516,7 +516,10 @@ namespace TrenchBroom {
                         break;
                     case Controller::Command::PreferenceChange: {
                         const Controller::PreferenceChangeEvent& preferenceChangeEvent = static_cast<const Controller::PreferenceChangeEvent&>(command);
-                        if (preferenceChangeEvent.isPreferenceChanged(Preferences::RendererInstancingMode))
+                        if (preferenceChangeEvent.isPreferenceChanged(Preferences::RendererInstancingMode) ||
+                            preferenceChangeEvent.isPreferenceChanged(Preferences::HandleRadius) ||
+                            preferenceChangeEvent.isPreferenceChanged(Preferences::HandleScalingFactor) ||
+                            preferenceChangeEvent.isPreferenceChanged(Preferences::MaximumHandleDistance))
                             m_handleManager.recreateRenderers();
                         break;
                     }
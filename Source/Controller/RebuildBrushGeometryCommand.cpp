@@ -25,14 +25,19 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class RebuildBrush {
+        public:
+            inline void operator()(Model::Brush* brush) const {
+                brush->rebuildGeometry();
+            }
+        };
+        
         bool RebuildBrushGeometryCommand::performDo() {
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
-            
-            Model::BrushList::const_iterator it, end;
-            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
-                Model::Brush& brush = **it;
-                brush.rebuildGeometry();
+            {
+                Model::DeferEntityInvalidation deferInvalidation(m_brushes);
+                parallelForEach(m_brushes, RebuildBrush());
             }
             document().brushesDidChange(m_brushes);
             return true;
@@ -22,41 +22,93 @@
 #include "Model/Brush.h"
 #include "Model/Face.h"
 
+#include <algorithm>
+#include <cassert>
+#include <map>
+
 namespace TrenchBroom {
     namespace Controller {
-        bool ResizeBrushesCommand::performDo() {
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
-                Model::Face& face = **faceIt;
-                Model::Brush& brush = *face.brush();
-                if (!brush.canMoveBoundary(face, m_delta))
-                    return false;
-            }
+        // the faces of one brush are handled by the same thread because they share the brush's geometry
+        class CanMoveBrushBoundaries : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const std::vector<Model::FaceList>& m_brushFaces;
+            const Vec3f& m_delta;
+            std::vector<char>& m_result;
+        public:
+            CanMoveBrushBoundaries(const Model::BrushList& brushes, const std::vector<Model::FaceList>& brushFaces, const Vec3f& delta, std::vector<char>& result) :
+            m_brushes(brushes),
+            m_brushFaces(brushFaces),
+            m_delta(delta),
+            m_result(result) {}
             
-            document().brushesWillChange(m_brushes);
+            void run(size_t index) {
+                const Model::Brush& brush = *m_brushes[index];
+                const Model::FaceList& faces = m_brushFaces[index];
+                
+                m_result[index] = 1;
+                Model::FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd && m_result[index] != 0; ++faceIt) {
+                    const Model::Face& face = **faceIt;
+                    if (!brush.canMoveBoundary(face, m_delta))
+                        m_result[index] = 0;
+                }
+            }
+        };
+        
+        class MoveBrushBoundaries : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const std::vector<Model::FaceList>& m_brushFaces;
+            const Vec3f& m_delta;
+            bool m_lockTextures;
+        public:
+            MoveBrushBoundaries(const Model::BrushList& brushes, const std::vector<Model::FaceList>& brushFaces, const Vec3f& delta, bool lockTextures) :
+            m_brushes(brushes),
+            m_brushFaces(brushFaces),
+            m_delta(delta),
+            m_lockTextures(lockTextures) {}
             
-            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
-                Model::Face& face = **faceIt;
-                Model::Brush& brush = *face.brush();
-                brush.moveBoundary(face, m_delta, m_lockTextures);
+            void run(size_t index) {
+                Model::Brush& brush = *m_brushes[index];
+                const Model::FaceList& faces = m_brushFaces[index];
+                
+                Model::FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                    Model::Face& face = **faceIt;
+                    assert(brush.canMoveBoundary(face, m_delta));
+                    brush.moveBoundary(face, m_delta, m_lockTextures);
+                }
             }
+        };
+        
+        bool ResizeBrushesCommand::performDo() {
+            Utility::ThreadPool& threadPool = Utility::ThreadPool::pool();
+            
+            std::vector<char> canMove(m_brushes.size(), 0);
+            CanMoveBrushBoundaries canMoveTask(m_brushes, m_brushFaces, m_delta, canMove);
+            threadPool.parallelFor(m_brushes.size(), canMoveTask, 16);
+            if (std::find(canMove.begin(), canMove.end(), 0) != canMove.end())
+                return false;
             
+            document().brushesWillChange(m_brushes);
+            {
+                Model::DeferEntityInvalidation deferInvalidation(m_brushes);
+                MoveBrushBoundaries moveTask(m_brushes, m_brushFaces, m_delta, m_lockTextures);
+                threadPool.parallelFor(m_brushes.size(), moveTask, 16);
+            }
             document().brushesDidChange(m_brushes);
             return true;
         }
         
         bool ResizeBrushesCommand::performUndo() {
+            const Vec3f inverseDelta = -m_delta;
             document().brushesWillChange(m_brushes);
-            Model::FaceList::const_iterator faceIt, faceEnd;
-
-            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
-                Model::Face& face = **faceIt;
-                Model::Brush& brush = *face.brush();
-                
-                assert(brush.canMoveBoundary(face, -m_delta));
-                brush.moveBoundary(face, -m_delta, m_lockTextures);
+            {
+                Model::DeferEntityInvalidation deferInvalidation(m_brushes);
+                MoveBrushBoundaries moveTask(m_brushes, m_brushFaces, inverseDelta, m_lockTextures);
+                Utility::ThreadPool::pool().parallelFor(m_brushes.size(), moveTask, 16);
             }
-            
             document().brushesDidChange(m_brushes);
             return true;
         }
@@ -65,8 +117,20 @@ namespace TrenchBroom {
         DocumentCommand(Command::ResizeBrushes, document, true, name, true),
         m_faces(faces),
         m_brushes(brushes),
+        m_brushFaces(brushes.size()),
         m_delta(delta),
-        m_lockTextures(lockTextures) {}
+        m_lockTextures(lockTextures) {
+            std::map<Model::Brush*, size_t> brushIndices;
+            for (size_t i = 0; i < m_brushes.size(); i++)
+                brushIndices[m_brushes[i]] = i;
+            
+            Model::FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
+                Model::Face* face = *faceIt;
+                assert(brushIndices.count(face->brush()) == 1);
+                m_brushFaces[brushIndices[face->brush()]].push_back(face);
+            }
+        }
 
         ResizeBrushesCommand* ResizeBrushesCommand::resizeBrushes(Model::MapDocument& document, const Model::FaceList& faces, const Vec3f& delta, bool lockTextures) {
             Model::BrushSet brushSet;
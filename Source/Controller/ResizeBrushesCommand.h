@@ -25,14 +25,19 @@
 #include "Model/FaceTypes.h"
 #include "Utility/VecMath.h"
 
+#include <vector>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Controller {
         class ResizeBrushesCommand : public DocumentCommand {
         protected:
+            typedef std::vector<Model::FaceList> BrushFacesList;
+            
             const Model::FaceList m_faces;
             const Model::BrushList m_brushes;
+            BrushFacesList m_brushFaces; // the faces to move for each brush in m_brushes
             const Vec3f m_delta;
             const bool m_lockTextures;
             
@@ -48,6 +48,10 @@ namespace TrenchBroom {
             inline Face& referenceFace() const {
                 return m_referenceFace;
             }
+            
+            HitTarget target() const {
+                return HitTarget(type(), &m_dragFace, Vec3f::Null);
+            }
         };
     }
 
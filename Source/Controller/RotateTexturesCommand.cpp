@@ -26,23 +26,25 @@
 
 namespace TrenchBroom {
     namespace Controller {
-        bool RotateTexturesCommand::performDo() {
-            Model::FaceList::const_iterator it, end;
-            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
-                Model::Face& face = **it;
-                face.rotateTexture(m_angle);
-            }
+        class RotateTexture {
+        private:
+            float m_angle;
+        public:
+            RotateTexture(float angle) :
+            m_angle(angle) {}
             
+            inline void operator()(Model::Face* face) const {
+                face->rotateTexture(m_angle);
+            }
+        };
+        
+        bool RotateTexturesCommand::performDo() {
+            parallelForEach(m_faces, RotateTexture(m_angle), 256);
             return true;
         }
         
         bool RotateTexturesCommand::performUndo() {
-            Model::FaceList::const_iterator it, end;
-            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
-                Model::Face& face = **it;
-                face.rotateTexture(-m_angle);
-            }
-            
+            parallelForEach(m_faces, RotateTexture(-m_angle), 256);
             return true;
         }
         
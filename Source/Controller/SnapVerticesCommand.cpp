@@ -24,20 +24,28 @@
 
 namespace TrenchBroom {
     namespace Controller {
-        bool SnapVerticesCommand::performDo() {
+        class SnapBrush {
+        private:
+            unsigned int m_snapTo;
+        public:
+            SnapBrush(unsigned int snapTo) :
+            m_snapTo(snapTo) {}
             
-            makeSnapshots(m_brushes);
-            document().brushesWillChange(m_brushes);
-            
-            Model::BrushList::const_iterator it, end;
-            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
-                Model::Brush& brush = **it;
+            inline void operator()(Model::Brush* brush) const {
                 if (m_snapTo == 0)
-                    brush.correct(0.01f);
+                    brush->correct(0.01f);
                 else
-                    brush.snap(m_snapTo);
+                    brush->snap(m_snapTo);
+            }
+        };
+        
+        bool SnapVerticesCommand::performDo() {
+            makeSnapshots(m_brushes);
+            document().brushesWillChange(m_brushes);
+            {
+                Model::DeferEntityInvalidation deferInvalidation(m_brushes);
+                parallelForEach(m_brushes, SnapBrush(m_snapTo));
             }
-            
             document().brushesDidChange(m_brushes);
             return true;
         }
@@ -26,6 +26,7 @@
 #include "Utility/Map.h"
 
 #include <cassert>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Controller {
@@ -90,6 +91,34 @@ namespace TrenchBroom {
                 face.setTextureName(m_textureName);
         }
         
+        class MakeBrushSnapshot : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            std::vector<BrushSnapshot*>& m_snapshots;
+        public:
+            MakeBrushSnapshot(const Model::BrushList& brushes, std::vector<BrushSnapshot*>& snapshots) :
+            m_brushes(brushes),
+            m_snapshots(snapshots) {}
+            
+            void run(size_t index) {
+                m_snapshots[index] = new BrushSnapshot(*m_brushes[index]);
+            }
+        };
+        
+        class RestoreBrushSnapshot : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const std::vector<BrushSnapshot*>& m_snapshots;
+        public:
+            RestoreBrushSnapshot(const Model::BrushList& brushes, const std::vector<BrushSnapshot*>& snapshots) :
+            m_brushes(brushes),
+            m_snapshots(snapshots) {}
+            
+            void run(size_t index) {
+                m_snapshots[index]->restore(*m_brushes[index]);
+            }
+        };
+        
         void SnapshotCommand::makeSnapshots(const Model::EntityList& entities) {
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Model::Entity& entity = *entities[i];
@@ -98,9 +127,13 @@ namespace TrenchBroom {
         }
         
         void SnapshotCommand::makeSnapshots(const Model::BrushList& brushes) {
+            std::vector<BrushSnapshot*> snapshots(brushes.size(), NULL);
+            MakeBrushSnapshot task(brushes, snapshots);
+            Utility::ThreadPool::pool().parallelFor(brushes.size(), task, 16);
+            
             for (unsigned int i = 0; i < brushes.size(); i++) {
                 Model::Brush& brush = *brushes[i];
-                m_brushes[brush.uniqueId()] = new BrushSnapshot(brush);
+                m_brushes[brush.uniqueId()] = snapshots[i];
             }
         }
         
@@ -133,11 +166,17 @@ namespace TrenchBroom {
         void SnapshotCommand::restoreSnapshots(const Model::BrushList& brushes) {
             assert(m_brushes.size() == brushes.size());
             
+            std::vector<BrushSnapshot*> snapshots(brushes.size(), NULL);
             for (unsigned int i = 0; i < brushes.size(); i++) {
                 Model::Brush& brush = *brushes[i];
-                BrushSnapshot& snapshot = *m_brushes[brush.uniqueId()];
-                snapshot.restore(brush);
+                BrushSnapshotMap::iterator it = m_brushes.find(brush.uniqueId());
+                assert(it != m_brushes.end());
+                snapshots[i] = it->second;
             }
+            
+            Model::DeferEntityInvalidation deferInvalidation(brushes);
+            RestoreBrushSnapshot task(brushes, snapshots);
+            Utility::ThreadPool::pool().parallelFor(brushes.size(), task, 16);
         }
         
         void SnapshotCommand::restoreSnapshots(const Model::FaceList& faces) {
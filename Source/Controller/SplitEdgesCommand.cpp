@@ -23,11 +23,49 @@
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
 #include "Model/Face.h"
+#include "Utility/List.h"
 
 namespace TrenchBroom {
     namespace Controller {
+        class DryRunSplitEdges : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const Model::BrushEdgesMap& m_brushEdges;
+            const Vec3f& m_delta;
+            Model::DryRunList& m_dryRuns;
+        public:
+            DryRunSplitEdges(const Model::BrushList& brushes, const Model::BrushEdgesMap& brushEdges, const Vec3f& delta, Model::DryRunList& dryRuns) :
+            m_brushes(brushes),
+            m_brushEdges(brushEdges),
+            m_delta(delta),
+            m_dryRuns(dryRuns) {}
+
+            void run(size_t index) {
+                Model::Brush* brush = m_brushes[index];
+                Model::BrushEdgesMap::const_iterator it = m_brushEdges.find(brush);
+                assert(it != m_brushEdges.end());
+                // only a single edge is split at a time, and every brush contains it at most once
+                assert(it->second.size() == 1);
+                m_dryRuns[index] = brush->dryRunSplitEdge(it->second.front(), m_delta);
+            }
+        };
+
+        bool SplitEdgesCommand::dryRun() const {
+            if (m_dryRuns.empty()) {
+                m_dryRuns.resize(m_brushes.size(), NULL);
+                DryRunSplitEdges task(m_brushes, m_brushEdges, m_delta, m_dryRuns);
+                Utility::ThreadPool::pool().parallelFor(m_brushes.size(), task, 4);
+            }
+
+            Model::DryRunList::const_iterator it, end;
+            for (it = m_dryRuns.begin(), end = m_dryRuns.end(); it != end; ++it)
+                if (!(*it)->valid())
+                    return false;
+            return true;
+        }
+
         bool SplitEdgesCommand::performDo() {
-            if (!canDo())
+            if (!dryRun())
                 return false;
             
             m_handleManager.remove(m_brushes);
@@ -35,17 +73,13 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
 
-            Model::BrushEdgesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushEdges.begin(), bEnd = m_brushEdges.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::EdgeInfoList& edgeInfos = bIt->second;
-                Model::EdgeInfoList::const_iterator eIt, eEnd;
-                for (eIt = edgeInfos.begin(), eEnd = edgeInfos.end(); eIt != eEnd; ++eIt) {
-                    const Model::EdgeInfo& edgeInfo = *eIt;
-                    const Vec3f newVertexPosition = brush->splitEdge(edgeInfo, m_delta);
-                    m_verticesAfter.insert(newVertexPosition);
-                }
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Model::Brush* brush = m_brushes[i];
+                Model::BrushGeometry::DryRun& brushDryRun = *m_dryRuns[i];
+                brush->commit(brushDryRun);
+                m_verticesAfter.insert(brushDryRun.newVertexPositions().begin(), brushDryRun.newVertexPositions().end());
             }
+            Utility::deleteAll(m_dryRuns);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -88,23 +122,16 @@ namespace TrenchBroom {
             }
         }
 
+        SplitEdgesCommand::~SplitEdgesCommand() {
+            Utility::deleteAll(m_dryRuns);
+        }
+
         SplitEdgesCommand* SplitEdgesCommand::splitEdges(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta) {
             return new SplitEdgesCommand(document, handleManager.selectedEdgeHandles().size() == 1 ? wxT("Split Edge") : wxT("Split Edges"), handleManager, delta);
         }
 
         bool SplitEdgesCommand::canDo() const {
-            Model::BrushEdgesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushEdges.begin(), bEnd = m_brushEdges.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::EdgeInfoList& edgeInfos = bIt->second;
-                Model::EdgeInfoList::const_iterator eIt, eEnd;
-                for (eIt = edgeInfos.begin(), eEnd = edgeInfos.end(); eIt != eEnd; ++eIt) {
-                    const Model::EdgeInfo& edgeInfo = *eIt;
-                    if (!brush->canSplitEdge(edgeInfo, m_delta))
-                        return false;
-                }
-            }
-            return true;
+            return dryRun();
         }
     }
 }
@@ -23,11 +23,49 @@
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
 #include "Model/Face.h"
+#include "Utility/List.h"
 
 namespace TrenchBroom {
     namespace Controller {
+        class DryRunSplitFaces : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const Model::BrushFacesMap& m_brushFaces;
+            const Vec3f& m_delta;
+            Model::DryRunList& m_dryRuns;
+        public:
+            DryRunSplitFaces(const Model::BrushList& brushes, const Model::BrushFacesMap& brushFaces, const Vec3f& delta, Model::DryRunList& dryRuns) :
+            m_brushes(brushes),
+            m_brushFaces(brushFaces),
+            m_delta(delta),
+            m_dryRuns(dryRuns) {}
+
+            void run(size_t index) {
+                Model::Brush* brush = m_brushes[index];
+                Model::BrushFacesMap::const_iterator it = m_brushFaces.find(brush);
+                assert(it != m_brushFaces.end());
+                // only a single face is split at a time, and every brush contains it at most once
+                assert(it->second.size() == 1);
+                m_dryRuns[index] = brush->dryRunSplitFace(it->second.front(), m_delta);
+            }
+        };
+
+        bool SplitFacesCommand::dryRun() const {
+            if (m_dryRuns.empty()) {
+                m_dryRuns.resize(m_brushes.size(), NULL);
+                DryRunSplitFaces task(m_brushes, m_brushFaces, m_delta, m_dryRuns);
+                Utility::ThreadPool::pool().parallelFor(m_brushes.size(), task, 4);
+            }
+
+            Model::DryRunList::const_iterator it, end;
+            for (it = m_dryRuns.begin(), end = m_dryRuns.end(); it != end; ++it)
+                if (!(*it)->valid())
+                    return false;
+            return true;
+        }
+
         bool SplitFacesCommand::performDo() {
-            if (!canDo())
+            if (!dryRun())
                 return false;
             
             m_handleManager.remove(m_brushes);
@@ -35,17 +73,13 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
 
-            Model::BrushFacesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushFaces.begin(), bEnd = m_brushFaces.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::FaceInfoList& faceInfos = bIt->second;
-                Model::FaceInfoList::const_iterator fIt, fEnd;
-                for (fIt = faceInfos.begin(), fEnd = faceInfos.end(); fIt != fEnd; ++fIt) {
-                    const Model::FaceInfo& faceInfo = *fIt;
-                    Vec3f newVertexPosition = brush->splitFace(faceInfo, m_delta);
-                    m_verticesAfter.insert(newVertexPosition);
-                }
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Model::Brush* brush = m_brushes[i];
+                Model::BrushGeometry::DryRun& brushDryRun = *m_dryRuns[i];
+                brush->commit(brushDryRun);
+                m_verticesAfter.insert(brushDryRun.newVertexPositions().begin(), brushDryRun.newVertexPositions().end());
             }
+            Utility::deleteAll(m_dryRuns);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -91,23 +125,16 @@ namespace TrenchBroom {
             assert(m_brushes.size() == m_brushFaces.size());
         }
 
+        SplitFacesCommand::~SplitFacesCommand() {
+            Utility::deleteAll(m_dryRuns);
+        }
+
         SplitFacesCommand* SplitFacesCommand::splitFaces(Model::MapDocument& document, VertexHandleManager& handleManager, const Vec3f& delta) {
             return new SplitFacesCommand(document, handleManager.selectedFaceHandles().size() == 1 ? wxT("Split Face") : wxT("Split Faces"), handleManager, delta);
         }
 
         bool SplitFacesCommand::canDo() const {
-            Model::BrushFacesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushFaces.begin(), bEnd = m_brushFaces.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::FaceInfoList& faceInfos = bIt->second;
-                Model::FaceInfoList::const_iterator fIt, fEnd;
-                for (fIt = faceInfos.begin(), fEnd = faceInfos.end(); fIt != fEnd; ++fIt) {
-                    const Model::FaceInfo& faceInfo = *fIt;
-                    if (!brush->canSplitFace(faceInfo, m_delta))
-                        return false;
-                }
-            }
-            return true;
+            return dryRun();
         }
     }
 }
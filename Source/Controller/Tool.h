@@ -184,6 +184,7 @@ namespace TrenchBroom {
             virtual void handleRender(InputState& inputState, Renderer::Vbo& vbo, Renderer::RenderContext& renderContext) {}
             virtual void handleRenderOverlay(InputState& inputState, Renderer::Vbo& vbo, Renderer::RenderContext& renderContext) {}
             virtual void handleFreeRenderResources() {}
+            virtual bool handleTracksMouse(InputState& inputState) { return false; }
             
             inline void deleteFigure(Renderer::Figure* figure) {
                 m_deleteFigures.push_back(figure);
@@ -295,6 +296,18 @@ namespace TrenchBroom {
                     nextTool()->freeRenderResources();
             }
             
+            /*
+             * Returns true if the feedback of an active tool follows the mouse position, so that every mouse move
+             * changes what is rendered even if the pick result stays the same.
+             */
+            inline bool tracksMouse(InputState& inputState) {
+                if ((active() && !m_suppressed) && handleTracksMouse(inputState))
+                    return true;
+                if (nextTool() != NULL)
+                    return nextTool()->tracksMouse(inputState);
+                return false;
+            }
+            
             inline void updateHits(InputState& inputState) {
                 if ((active() && !m_suppressed))
                     handlePick(inputState);
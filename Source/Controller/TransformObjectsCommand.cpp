@@ -28,6 +28,24 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class TransformBrush {
+        private:
+            const Mat4f& m_pointTransform;
+            const Mat4f& m_vectorTransform;
+            bool m_lockTextures;
+            bool m_invertOrientation;
+        public:
+            TransformBrush(const Mat4f& pointTransform, const Mat4f& vectorTransform, bool lockTextures, bool invertOrientation) :
+            m_pointTransform(pointTransform),
+            m_vectorTransform(vectorTransform),
+            m_lockTextures(lockTextures),
+            m_invertOrientation(invertOrientation) {}
+            
+            inline void operator()(Model::Brush* brush) const {
+                brush->transform(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation);
+            }
+        };
+        
         bool TransformObjectsCommand::performDo() {
             if (!m_entities.empty()) {
                 makeSnapshots(m_entities);
@@ -44,11 +62,9 @@ namespace TrenchBroom {
             if (!m_brushes.empty()) {
                 makeSnapshots(m_brushes);
                 document().brushesWillChange(m_brushes);
-                
-                Model::BrushList::const_iterator brushIt, brushEnd;
-                for (brushIt = m_brushes.begin(), brushEnd = m_brushes.end(); brushIt != brushEnd; ++brushIt) {
-                    Model::Brush& brush = **brushIt;
-                    brush.transform(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation);
+                {
+                    Model::DeferEntityInvalidation deferInvalidation(m_brushes);
+                    parallelForEach(m_brushes, TransformBrush(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation));
                 }
                 document().brushesDidChange(m_brushes);
             }
@@ -21,6 +21,7 @@
 
 #include "Renderer/LinesRenderer.h"
 #include "Renderer/PointHandleRenderer.h"
+#include "Renderer/RenderContext.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -38,21 +39,36 @@ namespace TrenchBroom {
     }
 
     namespace Controller {
+        const float VertexHandleManager::GridCellSize = 64.0f;
+        
+        void VertexHandleManager::pickHandles(const Rayf& ray, const Utility::PointGrid& grid, Model::HitType::Type type, Model::PickResult& pickResult) const {
+            Vec3f::List candidates;
+            grid.findInCone(ray, 2.0f * m_handleRadius * m_scalingFactor, m_maxDistance, candidates);
+            
+            Vec3f::List::const_iterator it, end;
+            for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+                Model::VertexHandleHit* hit = pickHandle(ray, *it, type);
+                if (hit != NULL)
+                    pickResult.add(hit);
+            }
+        }
+        
+        void VertexHandleManager::loadPreferences() {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            m_handleRadius = prefs.getFloat(Preferences::HandleRadius);
+            m_scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
+            m_maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
+        }
+        
         void VertexHandleManager::createRenderers() {
-            assert(m_selectedHandleRenderer == NULL);
-            assert(m_unselectedVertexHandleRenderer == NULL);
-            assert(m_unselectedEdgeHandleRenderer == NULL);
-            assert(m_unselectedFaceHandleRenderer == NULL);
+            assert(m_vertexHandleRenderer == NULL);
+            assert(m_edgeHandleRenderer == NULL);
+            assert(m_faceHandleRenderer == NULL);
             assert(m_selectedEdgeRenderer == NULL);
 
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            float handleRadius = prefs.getFloat(Preferences::HandleRadius);
-            float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
-            float maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
-            m_selectedHandleRenderer = Renderer::PointHandleRenderer::create(handleRadius, 2, scalingFactor, maxDistance);
-            m_unselectedVertexHandleRenderer = Renderer::PointHandleRenderer::create(handleRadius, 2, scalingFactor, maxDistance);
-            m_unselectedEdgeHandleRenderer = Renderer::PointHandleRenderer::create(handleRadius, 2, scalingFactor, maxDistance);
-            m_unselectedFaceHandleRenderer = Renderer::PointHandleRenderer::create(handleRadius, 2, scalingFactor, maxDistance);
+            m_vertexHandleRenderer = Renderer::PointHandleRenderer::create(m_handleRadius, 2, m_scalingFactor, m_maxDistance, m_vertexHandleInstances);
+            m_edgeHandleRenderer = Renderer::PointHandleRenderer::create(m_handleRadius, 2, m_scalingFactor, m_maxDistance, m_edgeHandleInstances);
+            m_faceHandleRenderer = Renderer::PointHandleRenderer::create(m_handleRadius, 2, m_scalingFactor, m_maxDistance, m_faceHandleInstances);
             m_selectedEdgeRenderer = new Renderer::LinesRenderer();
             
             m_renderStateValid = false;
@@ -60,32 +76,37 @@ namespace TrenchBroom {
         }
         
         void VertexHandleManager::destroyRenderers() {
-            delete m_unselectedVertexHandleRenderer;
-            m_unselectedVertexHandleRenderer = NULL;
-            delete m_unselectedEdgeHandleRenderer;
-            m_unselectedEdgeHandleRenderer = NULL;
-            delete m_unselectedFaceHandleRenderer;
-            m_unselectedFaceHandleRenderer = NULL;
-            delete m_selectedHandleRenderer;
-            m_selectedHandleRenderer = NULL;
+            delete m_vertexHandleRenderer;
+            m_vertexHandleRenderer = NULL;
+            delete m_edgeHandleRenderer;
+            m_edgeHandleRenderer = NULL;
+            delete m_faceHandleRenderer;
+            m_faceHandleRenderer = NULL;
             delete m_selectedEdgeRenderer;
             m_selectedEdgeRenderer = NULL;
         }
 
         VertexHandleManager::VertexHandleManager() :
+        m_unselectedVertexGrid(GridCellSize),
+        m_selectedVertexGrid(GridCellSize),
+        m_unselectedEdgeGrid(GridCellSize),
+        m_selectedEdgeGrid(GridCellSize),
+        m_unselectedFaceGrid(GridCellSize),
+        m_selectedFaceGrid(GridCellSize),
         m_totalVertexCount(0),
         m_selectedVertexCount(0),
         m_totalEdgeCount(0),
         m_selectedEdgeCount(0),
         m_totalFaceCount(0),
         m_selectedFaceCount(0),
-        m_selectedHandleRenderer(NULL),
-        m_unselectedVertexHandleRenderer(NULL),
-        m_unselectedEdgeHandleRenderer(NULL),
-        m_unselectedFaceHandleRenderer(NULL),
+        m_vertexHandleRenderer(NULL),
+        m_edgeHandleRenderer(NULL),
+        m_faceHandleRenderer(NULL),
         m_selectedEdgeRenderer(NULL),
         m_renderStateValid(false),
-        m_recreateRenderers(true) {}
+        m_recreateRenderers(true) {
+            loadPreferences();
+        }
         
         const Model::BrushList& VertexHandleManager::brushes(const Vec3f& handlePosition) const {
             Model::VertexToBrushesMap::const_iterator mapIt = m_selectedVertexHandles.find(handlePosition);
@@ -127,7 +148,7 @@ namespace TrenchBroom {
                     mapIt->second.push_back(&brush);
                     m_selectedVertexCount++;
                 } else {
-                    m_unselectedVertexHandles[vertex.position].push_back(&brush);
+                    addHandle(vertex.position, brush, m_unselectedVertexHandles, m_unselectedVertexGrid, m_vertexHandleInstances, false);
                 }
             }
             m_totalVertexCount += brushVertices.size();
@@ -142,7 +163,7 @@ namespace TrenchBroom {
                     mapIt->second.push_back(&edge);
                     m_selectedEdgeCount++;
                 } else {
-                    m_unselectedEdgeHandles[position].push_back(&edge);
+                    addHandle(position, edge, m_unselectedEdgeHandles, m_unselectedEdgeGrid, m_edgeHandleInstances, false);
                 }
             }
             m_totalEdgeCount+= brushEdges.size();
@@ -157,7 +178,7 @@ namespace TrenchBroom {
                     mapIt->second.push_back(&face);
                     m_selectedFaceCount++;
                 } else {
-                    m_unselectedFaceHandles[position].push_back(&face);
+                    addHandle(position, face, m_unselectedFaceHandles, m_unselectedFaceGrid, m_faceHandleInstances, false);
                 }
             }
             m_totalFaceCount += brushFaces.size();
@@ -176,11 +197,11 @@ namespace TrenchBroom {
             Model::VertexList::const_iterator vIt, vEnd;
             for (vIt = brushVertices.begin(), vEnd = brushVertices.end(); vIt != vEnd; ++vIt) {
                 const Model::Vertex& vertex = **vIt;
-                if (removeHandle(vertex.position, brush, m_selectedVertexHandles)) {
+                if (removeHandle(vertex.position, brush, m_selectedVertexHandles, m_selectedVertexGrid, m_vertexHandleInstances)) {
                     assert(m_selectedVertexCount > 0);
                     m_selectedVertexCount--;
                 } else {
-                    removeHandle(vertex.position, brush, m_unselectedVertexHandles);
+                    removeHandle(vertex.position, brush, m_unselectedVertexHandles, m_unselectedVertexGrid, m_vertexHandleInstances);
                 }
             }
             assert(m_totalVertexCount >= brushVertices.size());
@@ -191,11 +212,11 @@ namespace TrenchBroom {
             for (eIt = brushEdges.begin(), eEnd = brushEdges.end(); eIt != eEnd; ++eIt) {
                 Model::Edge& edge = **eIt;
                 Vec3f position = edge.center();
-                if (removeHandle(position, edge, m_selectedEdgeHandles)) {
+                if (removeHandle(position, edge, m_selectedEdgeHandles, m_selectedEdgeGrid, m_edgeHandleInstances)) {
                     assert(m_selectedEdgeCount > 0);
                     m_selectedEdgeCount--;
                 } else {
-                    removeHandle(position, edge, m_unselectedEdgeHandles);
+                    removeHandle(position, edge, m_unselectedEdgeHandles, m_unselectedEdgeGrid, m_edgeHandleInstances);
                 }
             }
             assert(m_totalEdgeCount >= brushEdges.size());
@@ -206,11 +227,11 @@ namespace TrenchBroom {
             for (fIt = brushFaces.begin(), fEnd = brushFaces.end(); fIt != fEnd; ++fIt) {
                 Model::Face& face = **fIt;
                 Vec3f position = face.center();
-                if (removeHandle(position, face, m_selectedFaceHandles)) {
+                if (removeHandle(position, face, m_selectedFaceHandles, m_selectedFaceGrid, m_faceHandleInstances)) {
                     assert(m_selectedFaceCount > 0);
                     m_selectedFaceCount--;
                 } else {
-                    removeHandle(position, face, m_unselectedFaceHandles);
+                    removeHandle(position, face, m_unselectedFaceHandles, m_unselectedFaceGrid, m_faceHandleInstances);
                 }
             }
             assert(m_totalFaceCount >= brushFaces.size());
@@ -228,14 +249,23 @@ namespace TrenchBroom {
         void VertexHandleManager::clear() {
             m_unselectedVertexHandles.clear();
             m_selectedVertexHandles.clear();
+            m_unselectedVertexGrid.clear();
+            m_selectedVertexGrid.clear();
+            m_vertexHandleInstances.clear();
             m_totalVertexCount = 0;
             m_selectedVertexCount = 0;
             m_unselectedEdgeHandles.clear();
             m_selectedEdgeHandles.clear();
+            m_unselectedEdgeGrid.clear();
+            m_selectedEdgeGrid.clear();
+            m_edgeHandleInstances.clear();
             m_totalEdgeCount = 0;
             m_selectedEdgeCount = 0;
             m_unselectedFaceHandles.clear();
             m_selectedFaceHandles.clear();
+            m_unselectedFaceGrid.clear();
+            m_selectedFaceGrid.clear();
+            m_faceHandleInstances.clear();
             m_totalFaceCount = 0;
             m_selectedFaceCount = 0;
             m_renderStateValid = false;
@@ -243,7 +273,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::selectVertexHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_unselectedVertexHandles, m_selectedVertexHandles)) > 0) {
+            if ((count = moveHandle(position, m_unselectedVertexHandles, m_unselectedVertexGrid, m_selectedVertexHandles, m_selectedVertexGrid, m_vertexHandleInstances, true)) > 0) {
                 m_selectedVertexCount += count;
                 m_renderStateValid = false;
             }
@@ -251,7 +281,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::deselectVertexHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_selectedVertexHandles, m_unselectedVertexHandles)) > 0) {
+            if ((count = moveHandle(position, m_selectedVertexHandles, m_selectedVertexGrid, m_unselectedVertexHandles, m_unselectedVertexGrid, m_vertexHandleInstances, false)) > 0) {
                 assert(m_selectedVertexCount >= count);
                 m_selectedVertexCount -= count;
                 m_renderStateValid = false;
@@ -265,21 +295,14 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::deselectVertexHandles() {
-            Model::VertexToBrushesMap::const_iterator vIt, vEnd;
-            for (vIt = m_selectedVertexHandles.begin(), vEnd = m_selectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                const Vec3f& position = vIt->first;
-                const Model::BrushList& selectedBrushes = vIt->second;
-                Model::BrushList& unselectedBrushes = m_unselectedVertexHandles[position];
-                unselectedBrushes.insert(unselectedBrushes.begin(), selectedBrushes.begin(), selectedBrushes.end());
-            }
-            m_selectedVertexHandles.clear();
+            moveAllHandles(m_selectedVertexHandles, m_selectedVertexGrid, m_unselectedVertexHandles, m_unselectedVertexGrid, m_vertexHandleInstances, false);
             m_selectedVertexCount = 0;
             m_renderStateValid = false;
         }
 
         void VertexHandleManager::selectEdgeHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_unselectedEdgeHandles, m_selectedEdgeHandles)) > 0) {
+            if ((count = moveHandle(position, m_unselectedEdgeHandles, m_unselectedEdgeGrid, m_selectedEdgeHandles, m_selectedEdgeGrid, m_edgeHandleInstances, true)) > 0) {
                 m_selectedEdgeCount += count;
                 m_renderStateValid = false;
             }
@@ -287,7 +310,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::deselectEdgeHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_selectedEdgeHandles, m_unselectedEdgeHandles)) > 0) {
+            if ((count = moveHandle(position, m_selectedEdgeHandles, m_selectedEdgeGrid, m_unselectedEdgeHandles, m_unselectedEdgeGrid, m_edgeHandleInstances, false)) > 0) {
                 assert(m_selectedEdgeCount >= count);
                 m_selectedEdgeCount -= count;
                 m_renderStateValid = false;
@@ -303,21 +326,14 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::deselectEdgeHandles() {
-            Model::VertexToEdgesMap::const_iterator eIt, eEnd;
-            for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                const Vec3f& position = eIt->first;
-                const Model::EdgeList& selectedEdges = eIt->second;
-                Model::EdgeList& unselectedEdges = m_unselectedEdgeHandles[position];
-                unselectedEdges.insert(unselectedEdges.begin(), selectedEdges.begin(), selectedEdges.end());
-            }
-            m_selectedEdgeHandles.clear();
+            moveAllHandles(m_selectedEdgeHandles, m_selectedEdgeGrid, m_unselectedEdgeHandles, m_unselectedEdgeGrid, m_edgeHandleInstances, false);
             m_selectedEdgeCount = 0;
             m_renderStateValid = false;
         }
 
         void VertexHandleManager::selectFaceHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_unselectedFaceHandles, m_selectedFaceHandles)) > 0) {
+            if ((count = moveHandle(position, m_unselectedFaceHandles, m_unselectedFaceGrid, m_selectedFaceHandles, m_selectedFaceGrid, m_faceHandleInstances, true)) > 0) {
                 m_selectedFaceCount += count;
                 m_renderStateValid = false;
             }
@@ -325,7 +341,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::deselectFaceHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_selectedFaceHandles, m_unselectedFaceHandles)) > 0) {
+            if ((count = moveHandle(position, m_selectedFaceHandles, m_selectedFaceGrid, m_unselectedFaceHandles, m_unselectedFaceGrid, m_faceHandleInstances, false)) > 0) {
                 assert(m_selectedFaceCount >= count);
                 m_selectedFaceCount -= count;
                 m_renderStateValid = false;
@@ -341,14 +357,7 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::deselectFaceHandles() {
-            Model::VertexToFacesMap::const_iterator fIt, fEnd;
-            for (fIt = m_selectedFaceHandles.begin(), fEnd = m_selectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                const Vec3f& position = fIt->first;
-                const Model::FaceList& selectedFaces = fIt->second;
-                Model::FaceList& unselectedFaces = m_unselectedFaceHandles[position];
-                unselectedFaces.insert(unselectedFaces.begin(), selectedFaces.begin(), selectedFaces.end());
-            }
-            m_selectedFaceHandles.clear();
+            moveAllHandles(m_selectedFaceHandles, m_selectedFaceGrid, m_unselectedFaceHandles, m_unselectedFaceGrid, m_faceHandleInstances, false);
             m_selectedFaceCount = 0;
             m_renderStateValid = false;
         }
@@ -360,99 +369,31 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::pick(const Rayf& ray, Model::PickResult& pickResult, bool splitMode) const {
-            Model::VertexToBrushesMap::const_iterator vIt, vEnd;
-            Model::VertexToEdgesMap::const_iterator eIt, eEnd;
-            Model::VertexToFacesMap::const_iterator fIt, fEnd;
-
-            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode) {
-                for (vIt = m_unselectedVertexHandles.begin(), vEnd = m_unselectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                    const Vec3f& position = vIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::VertexHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
-
-            for (vIt = m_selectedVertexHandles.begin(), vEnd = m_selectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                const Vec3f& position = vIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::VertexHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
-
-            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode) {
-                for (eIt = m_unselectedEdgeHandles.begin(), eEnd = m_unselectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                    const Vec3f& position = eIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::EdgeHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
-
-            for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                const Vec3f& position = eIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::EdgeHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
-
-            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode) {
-                for (fIt = m_unselectedFaceHandles.begin(), fEnd = m_unselectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                    const Vec3f& position = fIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::FaceHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
-
-            for (fIt = m_selectedFaceHandles.begin(), fEnd = m_selectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                const Vec3f& position = fIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::FaceHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
+            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode)
+                pickHandles(ray, m_unselectedVertexGrid, Model::HitType::VertexHandleHit, pickResult);
+            pickHandles(ray, m_selectedVertexGrid, Model::HitType::VertexHandleHit, pickResult);
+            
+            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode)
+                pickHandles(ray, m_unselectedEdgeGrid, Model::HitType::EdgeHandleHit, pickResult);
+            pickHandles(ray, m_selectedEdgeGrid, Model::HitType::EdgeHandleHit, pickResult);
+            
+            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode)
+                pickHandles(ray, m_unselectedFaceGrid, Model::HitType::FaceHandleHit, pickResult);
+            pickHandles(ray, m_selectedFaceGrid, Model::HitType::FaceHandleHit, pickResult);
         }
 
         void VertexHandleManager::render(Renderer::Vbo& vbo, Renderer::RenderContext& renderContext, bool splitMode) {
-            if (!m_renderStateValid || m_recreateRenderers) {
-                if (m_recreateRenderers) {
-                    destroyRenderers();
-                    createRenderers();
-                }
+            if (m_recreateRenderers) {
+                destroyRenderers();
+                createRenderers();
+            }
+            
+            // the handle renderers follow the instance buffers, so only the selected edges must be collected again
+            if (!m_renderStateValid) {
+                m_selectedEdgeRenderer->clear();
                 
-                Model::VertexToBrushesMap::const_iterator vIt, vEnd;
                 Model::VertexToEdgesMap::const_iterator eIt, eEnd;
-                Model::VertexToFacesMap::const_iterator fIt, fEnd;
-
-                m_unselectedVertexHandleRenderer->clear();
-                m_unselectedEdgeHandleRenderer->clear();
-                m_unselectedFaceHandleRenderer->clear();
-                m_selectedHandleRenderer->clear();
-                m_selectedEdgeRenderer->clear();
-
-                if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode) {
-                    for (vIt = m_unselectedVertexHandles.begin(), vEnd = m_unselectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                        const Vec3f& position = vIt->first;
-                        m_unselectedVertexHandleRenderer->add(position);
-                    }
-                }
-
-                for (vIt = m_selectedVertexHandles.begin(), vEnd = m_selectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                    const Vec3f& position = vIt->first;
-                    m_selectedHandleRenderer->add(position);
-                }
-
-                if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode) {
-                    for (eIt = m_unselectedEdgeHandles.begin(), eEnd = m_unselectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                        const Vec3f& position = eIt->first;
-                        m_unselectedEdgeHandleRenderer->add(position);
-                    }
-                }
-
                 for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                    const Vec3f& position = eIt->first;
-                    m_selectedHandleRenderer->add(position);
-                    
                     const Model::EdgeList& edges = eIt->second;
                     Model::EdgeList::const_iterator edgeIt, edgeEnd;
                     for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
@@ -460,18 +401,9 @@ namespace TrenchBroom {
                         m_selectedEdgeRenderer->add(edge.start->position, edge.end->position);
                     }
                 }
-
-                if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode) {
-                    for (fIt = m_unselectedFaceHandles.begin(), fEnd = m_unselectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                        const Vec3f& position = fIt->first;
-                        m_unselectedFaceHandleRenderer->add(position);
-                    }
-                }
-
+                
+                Model::VertexToFacesMap::const_iterator fIt, fEnd;
                 for (fIt = m_selectedFaceHandles.begin(), fEnd = m_selectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                    const Vec3f& position = fIt->first;
-                    m_selectedHandleRenderer->add(position);
-                    
                     const Model::FaceList& faces = fIt->second;
                     Model::FaceList::const_iterator faceIt, faceEnd;
                     for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
@@ -484,7 +416,7 @@ namespace TrenchBroom {
                         }
                     }
                 }
-
+                
                 m_renderStateValid = true;
             }
             
@@ -498,32 +430,28 @@ namespace TrenchBroom {
                 m_selectedEdgeRenderer->render(vbo, renderContext);
             }
             
-            m_unselectedVertexHandleRenderer->setColor(prefs.getColor(Preferences::VertexHandleColor));
-            m_unselectedEdgeHandleRenderer->setColor(prefs.getColor(Preferences::EdgeHandleColor));
-            m_unselectedFaceHandleRenderer->setColor(prefs.getColor(Preferences::FaceHandleColor));
-            if (splitMode)
-                m_selectedHandleRenderer->setColor(prefs.getColor(Preferences::SelectedSplitHandleColor));
-            else
-                m_selectedHandleRenderer->setColor(prefs.getColor(Preferences::SelectedVertexHandleColor));
-
-            m_unselectedVertexHandleRenderer->render(vbo, renderContext);
-            m_unselectedEdgeHandleRenderer->render(vbo, renderContext);
-            m_unselectedFaceHandleRenderer->render(vbo, renderContext);
-            m_selectedHandleRenderer->render(vbo, renderContext);
-
-            m_unselectedVertexHandleRenderer->setColor(prefs.getColor(Preferences::OccludedVertexHandleColor));
-            m_unselectedEdgeHandleRenderer->setColor(prefs.getColor(Preferences::OccludedEdgeHandleColor));
-            m_unselectedFaceHandleRenderer->setColor(prefs.getColor(Preferences::OccludedFaceHandleColor));
-            if (splitMode)
-                m_selectedHandleRenderer->setColor(prefs.getColor(Preferences::OccludedSelectedSplitHandleColor));
-            else
-                m_selectedHandleRenderer->setColor(prefs.getColor(Preferences::OccludedSelectedVertexHandleColor));
+            m_vertexHandleRenderer->setRenderUnselected((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode);
+            m_edgeHandleRenderer->setRenderUnselected(m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode);
+            m_faceHandleRenderer->setRenderUnselected(m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode);
+            
+            const Color& selectedColor = prefs.getColor(splitMode ? Preferences::SelectedSplitHandleColor : Preferences::SelectedVertexHandleColor);
+            m_vertexHandleRenderer->setColor(prefs.getColor(Preferences::VertexHandleColor), selectedColor);
+            m_edgeHandleRenderer->setColor(prefs.getColor(Preferences::EdgeHandleColor), selectedColor);
+            m_faceHandleRenderer->setColor(prefs.getColor(Preferences::FaceHandleColor), selectedColor);
+
+            m_vertexHandleRenderer->render(vbo, renderContext);
+            m_edgeHandleRenderer->render(vbo, renderContext);
+            m_faceHandleRenderer->render(vbo, renderContext);
+
+            const Color& occludedSelectedColor = prefs.getColor(splitMode ? Preferences::OccludedSelectedSplitHandleColor : Preferences::OccludedSelectedVertexHandleColor);
+            m_vertexHandleRenderer->setColor(prefs.getColor(Preferences::OccludedVertexHandleColor), occludedSelectedColor);
+            m_edgeHandleRenderer->setColor(prefs.getColor(Preferences::OccludedEdgeHandleColor), occludedSelectedColor);
+            m_faceHandleRenderer->setColor(prefs.getColor(Preferences::OccludedFaceHandleColor), occludedSelectedColor);
 
             glDisable(GL_DEPTH_TEST);
-            m_unselectedVertexHandleRenderer->render(vbo, renderContext);
-            m_unselectedEdgeHandleRenderer->render(vbo, renderContext);
-            m_unselectedFaceHandleRenderer->render(vbo, renderContext);
-            m_selectedHandleRenderer->render(vbo, renderContext);
+            m_vertexHandleRenderer->render(vbo, renderContext);
+            m_edgeHandleRenderer->render(vbo, renderContext);
+            m_faceHandleRenderer->render(vbo, renderContext);
             glEnable(GL_DEPTH_TEST);
         }
     }
@@ -23,6 +23,8 @@
 #include "Model/Brush.h"
 #include "Model/BrushGeometryTypes.h"
 #include "Model/Picker.h"
+#include "Utility/InstanceBuffer.h"
+#include "Utility/PointGrid.h"
 #include "Utility/Preferences.h"
 #include "Utility/VecMath.h"
 
@@ -48,6 +50,10 @@ namespace TrenchBroom {
             inline const Vec3f& vertex() const {
                 return m_vertex;
             }
+            
+            HitTarget target() const {
+                return HitTarget(type(), NULL, m_vertex);
+            }
         };
     }
 
@@ -61,6 +67,8 @@ namespace TrenchBroom {
     namespace Controller {
         class VertexHandleManager {
         private:
+            static const float GridCellSize;
+            
             Model::VertexToBrushesMap m_unselectedVertexHandles;
             Model::VertexToBrushesMap m_selectedVertexHandles;
             Model::VertexToEdgesMap m_unselectedEdgeHandles;
@@ -68,6 +76,19 @@ namespace TrenchBroom {
             Model::VertexToFacesMap m_unselectedFaceHandles;
             Model::VertexToFacesMap m_selectedFaceHandles;
             
+            // spatial indices of the positions of the handle maps above
+            Utility::PointGrid m_unselectedVertexGrid;
+            Utility::PointGrid m_selectedVertexGrid;
+            Utility::PointGrid m_unselectedEdgeGrid;
+            Utility::PointGrid m_selectedEdgeGrid;
+            Utility::PointGrid m_unselectedFaceGrid;
+            Utility::PointGrid m_selectedFaceGrid;
+            
+            // the positions of all handles and their selection states, rendered directly by the handle renderers
+            Utility::InstanceBuffer m_vertexHandleInstances;
+            Utility::InstanceBuffer m_edgeHandleInstances;
+            Utility::InstanceBuffer m_faceHandleInstances;
+            
             size_t m_totalVertexCount;
             size_t m_selectedVertexCount;
             size_t m_totalEdgeCount;
@@ -75,16 +96,29 @@ namespace TrenchBroom {
             size_t m_totalFaceCount;
             size_t m_selectedFaceCount;
             
-            Renderer::PointHandleRenderer* m_selectedHandleRenderer;
-            Renderer::PointHandleRenderer* m_unselectedVertexHandleRenderer;
-            Renderer::PointHandleRenderer* m_unselectedEdgeHandleRenderer;
-            Renderer::PointHandleRenderer* m_unselectedFaceHandleRenderer;
+            Renderer::PointHandleRenderer* m_vertexHandleRenderer;
+            Renderer::PointHandleRenderer* m_edgeHandleRenderer;
+            Renderer::PointHandleRenderer* m_faceHandleRenderer;
             Renderer::LinesRenderer* m_selectedEdgeRenderer;
             bool m_renderStateValid;
             bool m_recreateRenderers;
             
+            float m_handleRadius;
+            float m_scalingFactor;
+            float m_maxDistance;
+            
+            template <typename Element>
+            inline void addHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map, Utility::PointGrid& grid, Utility::InstanceBuffer& instances, const bool selected) {
+                std::vector<Element*>& elements = map[position];
+                if (elements.empty()) {
+                    grid.add(position);
+                    instances.add(position, selected);
+                }
+                elements.push_back(&element);
+            }
+            
             template <typename Element>
-            inline bool removeHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map) {
+            inline bool removeHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map, Utility::PointGrid& grid, Utility::InstanceBuffer& instances) {
                 typedef std::vector<Element*> List;
                 typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
                 
@@ -98,13 +132,16 @@ namespace TrenchBroom {
                     return false;
                 
                 elements.erase(listIt);
-                if (elements.empty())
+                if (elements.empty()) {
                     map.erase(mapIt);
+                    grid.remove(position);
+                    instances.remove(position);
+                }
                 return true;
             }
             
             template <typename Element>
-            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to) {
+            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, Utility::PointGrid& fromGrid, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to, Utility::PointGrid& toGrid, Utility::InstanceBuffer& instances, const bool select) {
                 typedef std::vector<Element*> List;
                 typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
                 
@@ -114,20 +151,38 @@ namespace TrenchBroom {
                 
                 List& fromElements = mapIt->second;
                 List& toElements = to[position];
+                if (toElements.empty())
+                    toGrid.add(position);
                 size_t elementCount = fromElements.size();
                 toElements.insert(toElements.end(), fromElements.begin(), fromElements.end());
                 
                 from.erase(mapIt);
+                fromGrid.remove(position);
+                instances.setSelected(position, select);
                 return elementCount;
             }
             
+            template <typename Element>
+            inline void moveAllHandles(std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, Utility::PointGrid& fromGrid, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to, Utility::PointGrid& toGrid, Utility::InstanceBuffer& instances, const bool select) {
+                typedef std::vector<Element*> List;
+                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                
+                typename Map::const_iterator it, end;
+                for (it = from.begin(), end = from.end(); it != end; ++it) {
+                    const Vec3f& position = it->first;
+                    const List& fromElements = it->second;
+                    List& toElements = to[position];
+                    if (toElements.empty())
+                        toGrid.add(position);
+                    toElements.insert(toElements.begin(), fromElements.begin(), fromElements.end());
+                    instances.setSelected(position, select);
+                }
+                from.clear();
+                fromGrid.clear();
+            }
+            
             inline Model::VertexHandleHit* pickHandle(const Rayf& ray, const Vec3f& position, Model::HitType::Type type) const {
-                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-                float handleRadius = prefs.getFloat(Preferences::HandleRadius);
-                float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
-                float maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
-
-                float distance = ray.intersectWithSphere(position, 2.0f * handleRadius, scalingFactor, maxDistance);
+                float distance = ray.intersectWithSphere(position, 2.0f * m_handleRadius, m_scalingFactor, m_maxDistance);
                 if (!Math<float>::isnan(distance)) {
                     Vec3f hitPoint = ray.pointAtDistance(distance);
                     return new Model::VertexHandleHit(type, hitPoint, distance, position);
@@ -136,6 +191,9 @@ namespace TrenchBroom {
                 return NULL;
             }
             
+            void pickHandles(const Rayf& ray, const Utility::PointGrid& grid, Model::HitType::Type type, Model::PickResult& pickResult) const;
+            
+            void loadPreferences();
             void createRenderers();
             void destroyRenderers();
         public:
@@ -240,6 +298,7 @@ namespace TrenchBroom {
             }
             
             inline void recreateRenderers() {
+                loadPreferences();
                 m_recreateRenderers = true;
             }
         };
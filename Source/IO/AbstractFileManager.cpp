@@ -21,6 +21,7 @@
 
 #include <wx/wx.h>
 #include <wx/filename.h>
+#include <wx/stdpaths.h>
 
 #include <map> 
 
@@ -77,6 +78,13 @@ namespace TrenchBroom {
             return wxRenameFile(sourcePath, destPath, overwrite);
         }
         
+        long AbstractFileManager::modificationTime(const String& path) {
+            const wxDateTime time = wxFileName(path).GetModificationTime();
+            if (!time.IsValid())
+                return 0;
+            return static_cast<long>(time.GetTicks());
+        }
+        
         char AbstractFileManager::pathSeparator() {
             static const char c = wxFileName::GetPathSeparator();
             return c;
@@ -280,6 +288,11 @@ namespace TrenchBroom {
             return path.substr(0, pos);
         }
 
+        String AbstractFileManager::cacheDirectory() {
+            const String userDataDirectory = wxStandardPaths::Get().GetUserDataDir().ToStdString();
+            return appendPath(userDataDirectory, "Cache");
+        }
+
 #ifndef _WIN32
         MappedFile::Ptr AbstractFileManager::mapFile(const String& path, std::ios_base::openmode mode) {
             int filedesc = -1;
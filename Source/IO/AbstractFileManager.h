@@ -77,6 +77,7 @@ namespace TrenchBroom {
             bool makeDirectory(const String& path);
             bool deleteFile(const String& path);
             bool moveFile(const String& sourcePath, const String& destPath, bool overwrite);
+            long modificationTime(const String& path);
             char pathSeparator();
             StringList directoryContents(const String& path, String extension = "", bool directories = true, bool files = true);
             bool resolveRelativePath(const String& relativePath, const StringList& rootPaths, String& absolutePath);
@@ -96,6 +97,7 @@ namespace TrenchBroom {
             String appendExtension(const String& path, const String& ext);
             String deleteExtension(const String& path);
             
+            String cacheDirectory();
             virtual String logDirectory() = 0;
             virtual String resourceDirectory() = 0;
             virtual String resolveFontPath(const String& fontName) = 0;
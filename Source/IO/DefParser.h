@@ -96,6 +96,10 @@ namespace TrenchBroom {
             m_defaultEntityColor(defaultEntityColor) {}
         
             Model::EntityDefinition* nextDefinition();
+            
+            inline size_t position() const {
+                return m_tokenizer.position();
+            }
         };
     }
 }
@@ -0,0 +1,425 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityDefinitionCache.h"
+
+#include "Model/EntityDefinition.h"
+#include "Model/PropertyDefinition.h"
+#include "Utility/List.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace CacheFormat {
+            static const char Magic[4] = { 'T', 'B', 'E', 'D' };
+            static const uint32_t Version = 2;
+            
+            static const uint8_t PointEntity = 0;
+            static const uint8_t BrushEntity = 1;
+            
+            static const uint8_t PlainProperty      = 0;
+            static const uint8_t StringProperty     = 1;
+            static const uint8_t IntegerProperty    = 2;
+            static const uint8_t FloatProperty      = 3;
+            static const uint8_t ChoiceProperty     = 4;
+            static const uint8_t FlagsProperty      = 5;
+            
+            static const uint8_t NoEvaluator        = 0;
+            static const uint8_t PropertyEvaluator  = 1;
+            static const uint8_t FlagEvaluator      = 2;
+        }
+        
+        class EntityDefinitionCache::Reader {
+        private:
+            const char* m_cursor;
+            const char* m_end;
+        public:
+            class Exception {};
+            
+            Reader(const char* begin, const char* end) :
+            m_cursor(begin),
+            m_end(end) {}
+            
+            template <typename T>
+            inline T read() {
+                if (m_cursor + sizeof(T) > m_end)
+                    throw Exception();
+                T value;
+                memcpy(&value, m_cursor, sizeof(T));
+                m_cursor += sizeof(T);
+                return value;
+            }
+            
+            inline String readString() {
+                const uint32_t length = read<uint32_t>();
+                if (m_cursor + length > m_end)
+                    throw Exception();
+                const String str(m_cursor, length);
+                m_cursor += length;
+                return str;
+            }
+            
+            inline Vec3f readVec3f() {
+                const float x = read<float>();
+                const float y = read<float>();
+                const float z = read<float>();
+                return Vec3f(x, y, z);
+            }
+            
+            inline bool eof() const {
+                return m_cursor == m_end;
+            }
+        };
+        
+        template <typename T>
+        inline void writeValue(std::ostream& stream, T value) {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+        
+        inline void writeVec(std::ostream& stream, const Vec3f& vec) {
+            writeValue<float>(stream, vec.x());
+            writeValue<float>(stream, vec.y());
+            writeValue<float>(stream, vec.z());
+        }
+
+        void EntityDefinitionCache::writeString(std::ostream& stream, const String& str) const {
+            writeValue<uint32_t>(stream, static_cast<uint32_t>(str.size()));
+            stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+        }
+        
+        void EntityDefinitionCache::writeModelDefinition(std::ostream& stream, const Model::ModelDefinition& definition) const {
+            writeString(stream, definition.name());
+            writeValue<uint32_t>(stream, definition.skinIndex());
+            writeValue<uint32_t>(stream, definition.frameIndex());
+            
+            const Model::ModelDefinitionEvaluator* evaluator = definition.evaluator();
+            if (const Model::ModelDefinitionPropertyEvaluator* propertyEvaluator = dynamic_cast<const Model::ModelDefinitionPropertyEvaluator*>(evaluator)) {
+                writeValue<uint8_t>(stream, CacheFormat::PropertyEvaluator);
+                writeString(stream, propertyEvaluator->propertyKey());
+                writeString(stream, propertyEvaluator->propertyValue());
+            } else if (const Model::ModelDefinitionFlagEvaluator* flagEvaluator = dynamic_cast<const Model::ModelDefinitionFlagEvaluator*>(evaluator)) {
+                writeValue<uint8_t>(stream, CacheFormat::FlagEvaluator);
+                writeString(stream, flagEvaluator->propertyKey());
+                writeValue<int32_t>(stream, flagEvaluator->flagValue());
+            } else {
+                writeValue<uint8_t>(stream, CacheFormat::NoEvaluator);
+            }
+        }
+        
+        void EntityDefinitionCache::writePropertyDefinition(std::ostream& stream, const Model::PropertyDefinition& definition) const {
+            // float properties report the integer type, so the concrete class must be checked first
+            if (const Model::StringPropertyDefinition* stringDefinition = dynamic_cast<const Model::StringPropertyDefinition*>(&definition)) {
+                writeValue<uint8_t>(stream, CacheFormat::StringProperty);
+                writeString(stream, definition.name());
+                writeString(stream, definition.description());
+                writeString(stream, stringDefinition->defaultPropertyValue());
+            } else if (const Model::IntegerPropertyDefinition* integerDefinition = dynamic_cast<const Model::IntegerPropertyDefinition*>(&definition)) {
+                writeValue<uint8_t>(stream, CacheFormat::IntegerProperty);
+                writeString(stream, definition.name());
+                writeString(stream, definition.description());
+                writeValue<int32_t>(stream, integerDefinition->defaultValue());
+            } else if (const Model::FloatPropertyDefinition* floatDefinition = dynamic_cast<const Model::FloatPropertyDefinition*>(&definition)) {
+                writeValue<uint8_t>(stream, CacheFormat::FloatProperty);
+                writeString(stream, definition.name());
+                writeString(stream, definition.description());
+                writeValue<float>(stream, floatDefinition->defaultValue());
+            } else if (const Model::ChoicePropertyDefinition* choiceDefinition = dynamic_cast<const Model::ChoicePropertyDefinition*>(&definition)) {
+                writeValue<uint8_t>(stream, CacheFormat::ChoiceProperty);
+                writeString(stream, definition.name());
+                writeString(stream, definition.description());
+                writeValue<int32_t>(stream, choiceDefinition->defaultValue());
+                
+                const Model::ChoicePropertyOption::List& options = choiceDefinition->options();
+                writeValue<uint32_t>(stream, static_cast<uint32_t>(options.size()));
+                Model::ChoicePropertyOption::List::const_iterator it, end;
+                for (it = options.begin(), end = options.end(); it != end; ++it) {
+                    writeString(stream, it->value());
+                    writeString(stream, it->description());
+                }
+            } else if (const Model::FlagsPropertyDefinition* flagsDefinition = dynamic_cast<const Model::FlagsPropertyDefinition*>(&definition)) {
+                writeValue<uint8_t>(stream, CacheFormat::FlagsProperty);
+                writeString(stream, definition.name());
+                writeString(stream, definition.description());
+                
+                const Model::FlagsPropertyOption::List& options = flagsDefinition->options();
+                writeValue<uint32_t>(stream, static_cast<uint32_t>(options.size()));
+                Model::FlagsPropertyOption::List::const_iterator it, end;
+                for (it = options.begin(), end = options.end(); it != end; ++it) {
+                    writeValue<int32_t>(stream, it->value());
+                    writeString(stream, it->description());
+                    writeValue<uint8_t>(stream, it->isDefault() ? 1 : 0);
+                }
+            } else {
+                writeValue<uint8_t>(stream, CacheFormat::PlainProperty);
+                writeString(stream, definition.name());
+                writeString(stream, definition.description());
+                writeValue<uint8_t>(stream, static_cast<uint8_t>(definition.type()));
+            }
+        }
+        
+        void EntityDefinitionCache::writeEntityDefinition(std::ostream& stream, const Model::EntityDefinition& definition) const {
+            const bool pointEntity = definition.type() == Model::EntityDefinition::PointEntity;
+            writeValue<uint8_t>(stream, pointEntity ? CacheFormat::PointEntity : CacheFormat::BrushEntity);
+            writeString(stream, definition.name());
+            writeString(stream, definition.description());
+            
+            const Color& color = definition.color();
+            for (size_t i = 0; i < 4; i++)
+                writeValue<float>(stream, color[i]);
+            
+            if (pointEntity) {
+                const Model::PointEntityDefinition& pointDefinition = static_cast<const Model::PointEntityDefinition&>(definition);
+                writeVec(stream, pointDefinition.bounds().min);
+                writeVec(stream, pointDefinition.bounds().max);
+                
+                const Model::ModelDefinition::List& modelDefinitions = pointDefinition.modelDefinitions();
+                writeValue<uint32_t>(stream, static_cast<uint32_t>(modelDefinitions.size()));
+                Model::ModelDefinition::List::const_iterator it, end;
+                for (it = modelDefinitions.begin(), end = modelDefinitions.end(); it != end; ++it)
+                    writeModelDefinition(stream, **it);
+            }
+            
+            const Model::PropertyDefinition::List& propertyDefinitions = definition.propertyDefinitions();
+            writeValue<uint32_t>(stream, static_cast<uint32_t>(propertyDefinitions.size()));
+            Model::PropertyDefinition::List::const_iterator it, end;
+            for (it = propertyDefinitions.begin(), end = propertyDefinitions.end(); it != end; ++it)
+                writePropertyDefinition(stream, **it);
+        }
+
+        Model::EntityDefinition* EntityDefinitionCache::readEntityDefinition(Reader& reader) const {
+            const uint8_t type = reader.read<uint8_t>();
+            if (type != CacheFormat::PointEntity && type != CacheFormat::BrushEntity)
+                throw Reader::Exception();
+            
+            const String name = reader.readString();
+            const String description = reader.readString();
+            
+            float rgba[4];
+            for (size_t i = 0; i < 4; i++)
+                rgba[i] = reader.read<float>();
+            const Color color(rgba[0], rgba[1], rgba[2], rgba[3]);
+            
+            BBoxf bounds;
+            Model::ModelDefinition::List modelDefinitions;
+            if (type == CacheFormat::PointEntity) {
+                bounds.min = reader.readVec3f();
+                bounds.max = reader.readVec3f();
+                
+                const uint32_t modelCount = reader.read<uint32_t>();
+                for (uint32_t i = 0; i < modelCount; i++) {
+                    const String modelName = reader.readString();
+                    const unsigned int skinIndex = reader.read<uint32_t>();
+                    const unsigned int frameIndex = reader.read<uint32_t>();
+                    const uint8_t evaluator = reader.read<uint8_t>();
+                    if (evaluator == CacheFormat::PropertyEvaluator) {
+                        const String propertyKey = reader.readString();
+                        const String propertyValue = reader.readString();
+                        modelDefinitions.push_back(Model::ModelDefinition::Ptr(new Model::ModelDefinition(modelName, skinIndex, frameIndex, propertyKey, propertyValue)));
+                    } else if (evaluator == CacheFormat::FlagEvaluator) {
+                        const String propertyKey = reader.readString();
+                        const int flagValue = reader.read<int32_t>();
+                        modelDefinitions.push_back(Model::ModelDefinition::Ptr(new Model::ModelDefinition(modelName, skinIndex, frameIndex, propertyKey, flagValue)));
+                    } else if (evaluator == CacheFormat::NoEvaluator) {
+                        modelDefinitions.push_back(Model::ModelDefinition::Ptr(new Model::ModelDefinition(modelName, skinIndex, frameIndex)));
+                    } else {
+                        throw Reader::Exception();
+                    }
+                }
+            }
+            
+            Model::PropertyDefinition::List propertyDefinitions;
+            const uint32_t propertyCount = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < propertyCount; i++) {
+                const uint8_t propertyType = reader.read<uint8_t>();
+                const String propertyName = reader.readString();
+                const String propertyDescription = reader.readString();
+                
+                Model::PropertyDefinition* propertyDefinition = NULL;
+                switch (propertyType) {
+                    case CacheFormat::StringProperty: {
+                        const String defaultValue = reader.readString();
+                        propertyDefinition = new Model::StringPropertyDefinition(propertyName, propertyDescription, defaultValue);
+                        break;
+                    }
+                    case CacheFormat::IntegerProperty: {
+                        const int defaultValue = reader.read<int32_t>();
+                        propertyDefinition = new Model::IntegerPropertyDefinition(propertyName, propertyDescription, defaultValue);
+                        break;
+                    }
+                    case CacheFormat::FloatProperty: {
+                        const float defaultValue = reader.read<float>();
+                        propertyDefinition = new Model::FloatPropertyDefinition(propertyName, propertyDescription, defaultValue);
+                        break;
+                    }
+                    case CacheFormat::ChoiceProperty: {
+                        const int defaultValue = reader.read<int32_t>();
+                        Model::ChoicePropertyDefinition* choiceDefinition = new Model::ChoicePropertyDefinition(propertyName, propertyDescription, defaultValue);
+                        propertyDefinitions.push_back(Model::PropertyDefinition::Ptr(choiceDefinition));
+                        
+                        const uint32_t optionCount = reader.read<uint32_t>();
+                        for (uint32_t j = 0; j < optionCount; j++) {
+                            const String value = reader.readString();
+                            const String optionDescription = reader.readString();
+                            choiceDefinition->addOption(value, optionDescription);
+                        }
+                        break;
+                    }
+                    case CacheFormat::FlagsProperty: {
+                        Model::FlagsPropertyDefinition* flagsDefinition = new Model::FlagsPropertyDefinition(propertyName, propertyDescription);
+                        propertyDefinitions.push_back(Model::PropertyDefinition::Ptr(flagsDefinition));
+                        
+                        const uint32_t optionCount = reader.read<uint32_t>();
+                        for (uint32_t j = 0; j < optionCount; j++) {
+                            const int value = reader.read<int32_t>();
+                            const String optionDescription = reader.readString();
+                            const bool isDefault = reader.read<uint8_t>() != 0;
+                            flagsDefinition->addOption(value, optionDescription, isDefault);
+                        }
+                        break;
+                    }
+                    case CacheFormat::PlainProperty: {
+                        const uint8_t plainType = reader.read<uint8_t>();
+                        propertyDefinition = new Model::PropertyDefinition(propertyName, static_cast<Model::PropertyDefinition::Type>(plainType), propertyDescription);
+                        break;
+                    }
+                    default:
+                        throw Reader::Exception();
+                }
+                
+                // choice and flags definitions are owned by the list as soon as they are created
+                if (propertyDefinition != NULL)
+                    propertyDefinitions.push_back(Model::PropertyDefinition::Ptr(propertyDefinition));
+            }
+            
+            if (type == CacheFormat::PointEntity)
+                return new Model::PointEntityDefinition(name, color, bounds, description, propertyDefinitions, modelDefinitions);
+            return new Model::BrushEntityDefinition(name, color, description, propertyDefinitions);
+        }
+
+        EntityDefinitionCache::EntityDefinitionCache(const String& cacheDirectory, const String& definitionPath, long modificationTime, const String& parserType, const Color& defaultColor) :
+        m_definitionPath(definitionPath),
+        m_modificationTime(modificationTime),
+        m_parserType(parserType),
+        m_defaultColor(defaultColor) {
+            // the file name of the definition file is kept to make the cache directory easier to inspect
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < definitionPath.size(); i++) {
+                hash ^= static_cast<unsigned char>(definitionPath[i]);
+                hash *= 16777619u;
+            }
+            
+            const size_t separatorIndex = definitionPath.find_last_of("/\\");
+            const String fileName = separatorIndex == String::npos ? definitionPath : definitionPath.substr(separatorIndex + 1);
+            
+            StringStream cachePath;
+            cachePath << cacheDirectory;
+            if (!cacheDirectory.empty() && cacheDirectory[cacheDirectory.size() - 1] != '/' && cacheDirectory[cacheDirectory.size() - 1] != '\\')
+                cachePath << '/';
+            cachePath << fileName << "-" << std::hex << std::setw(8) << std::setfill('0') << hash << ".tbdefs";
+            m_cachePath = cachePath.str();
+        }
+        
+        bool EntityDefinitionCache::read(Model::EntityDefinitionList& definitions) const {
+            std::ifstream stream(m_cachePath.c_str(), std::ios::in | std::ios::binary);
+            if (!stream.is_open())
+                return false;
+            
+            const std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            if (buffer.empty())
+                return false;
+            
+            Model::EntityDefinitionList result;
+            try {
+                Reader reader(&buffer.front(), &buffer.front() + buffer.size());
+                for (size_t i = 0; i < 4; i++)
+                    if (reader.read<char>() != CacheFormat::Magic[i])
+                        return false;
+                if (reader.read<uint32_t>() != CacheFormat::Version)
+                    return false;
+                if (reader.readString() != m_definitionPath)
+                    return false;
+                if (reader.read<int64_t>() != static_cast<int64_t>(m_modificationTime))
+                    return false;
+                if (reader.readString() != m_parserType)
+                    return false;
+                for (size_t i = 0; i < 4; i++)
+                    if (reader.read<float>() != m_defaultColor[i])
+                        return false;
+                
+                const uint32_t count = reader.read<uint32_t>();
+                result.reserve(count);
+                for (uint32_t i = 0; i < count; i++)
+                    result.push_back(readEntityDefinition(reader));
+                
+                if (!reader.eof()) {
+                    Utility::deleteAll(result);
+                    return false;
+                }
+            } catch (Reader::Exception&) {
+                Utility::deleteAll(result);
+                return false;
+            }
+            
+            definitions.insert(definitions.end(), result.begin(), result.end());
+            return true;
+        }
+        
+        void EntityDefinitionCache::write(const Model::EntityDefinitionList& definitions) const {
+            // write to a temporary file first so that a concurrent reader never sees a partial cache
+            const String tempPath = m_cachePath + ".tmp";
+            {
+                std::ofstream stream(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!stream.is_open())
+                    return;
+                
+                stream.write(CacheFormat::Magic, 4);
+                writeValue<uint32_t>(stream, CacheFormat::Version);
+                writeString(stream, m_definitionPath);
+                writeValue<int64_t>(stream, static_cast<int64_t>(m_modificationTime));
+                writeString(stream, m_parserType);
+                for (size_t i = 0; i < 4; i++)
+                    writeValue<float>(stream, m_defaultColor[i]);
+                writeValue<uint32_t>(stream, static_cast<uint32_t>(definitions.size()));
+                
+                Model::EntityDefinitionList::const_iterator it, end;
+                for (it = definitions.begin(), end = definitions.end(); it != end; ++it)
+                    writeEntityDefinition(stream, **it);
+                
+                if (!stream.good()) {
+                    stream.close();
+                    std::remove(tempPath.c_str());
+                    return;
+                }
+            }
+            
+            std::remove(m_cachePath.c_str());
+            std::rename(tempPath.c_str(), m_cachePath.c_str());
+        }
+    }
+}
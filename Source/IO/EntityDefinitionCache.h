@@ -0,0 +1,76 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__EntityDefinitionCache__
+#define __TrenchBroom__EntityDefinitionCache__
+
+#include "Model/EntityDefinitionTypes.h"
+#include "Utility/Color.h"
+#include "Utility/String.h"
+
+#include <iostream>
+
+namespace TrenchBroom {
+    namespace Model {
+        class EntityDefinition;
+        class ModelDefinition;
+        class PropertyDefinition;
+    }
+    
+    namespace IO {
+        /*
+         * Stores parsed entity definitions in a binary file so that a definition file does not have to be parsed again
+         * as long as it is unchanged. A cache file belongs to the path of a definition file and is only valid for the
+         * modification time, the parser type and the default color that were recorded when it was written, because
+         * the parser assigns the default color to every definition that does not specify one.
+         */
+        class EntityDefinitionCache {
+        private:
+            class Reader;
+            
+            String m_cachePath;
+            String m_definitionPath;
+            long m_modificationTime;
+            String m_parserType;
+            Color m_defaultColor;
+            
+            void writeString(std::ostream& stream, const String& str) const;
+            void writeModelDefinition(std::ostream& stream, const Model::ModelDefinition& definition) const;
+            void writePropertyDefinition(std::ostream& stream, const Model::PropertyDefinition& definition) const;
+            void writeEntityDefinition(std::ostream& stream, const Model::EntityDefinition& definition) const;
+            
+            Model::EntityDefinition* readEntityDefinition(Reader& reader) const;
+        public:
+            /*
+             * The cache and definition file paths and the modification time should be determined on the main thread,
+             * after that, the cache may be read and written on any thread.
+             */
+            EntityDefinitionCache(const String& cacheDirectory, const String& definitionPath, long modificationTime, const String& parserType, const Color& defaultColor);
+            
+            /*
+             * Appends the cached definitions to the given list and returns true if the cache is valid. Otherwise,
+             * returns false and leaves the list unchanged.
+             */
+            bool read(Model::EntityDefinitionList& definitions) const;
+            void write(const Model::EntityDefinitionList& definitions) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityDefinitionCache__) */
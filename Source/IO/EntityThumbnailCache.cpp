@@ -0,0 +1,148 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityThumbnailCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace ThumbnailFormat {
+            static const char Magic[4] = { 'T', 'B', 'E', 'T' };
+            static const uint32_t Version = 2;
+        }
+        
+        String EntityThumbnailCache::cachePath(const String& key) const {
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < key.size(); i++) {
+                hash ^= static_cast<unsigned char>(key[i]);
+                hash *= 16777619u;
+            }
+            
+            StringStream cachePath;
+            cachePath << m_directory;
+            if (!m_directory.empty() && m_directory[m_directory.size() - 1] != '/' && m_directory[m_directory.size() - 1] != '\\')
+                cachePath << '/';
+            cachePath << std::hex << std::setw(8) << std::setfill('0') << hash << ".tbthumb";
+            return cachePath.str();
+        }
+
+        EntityThumbnailCache::EntityThumbnailCache(const String& directory) :
+        m_directory(directory) {}
+        
+        String EntityThumbnailCache::key(const StringList& searchPaths, const String& modelPath, unsigned int skinIndex, unsigned int frameIndex, unsigned int width, unsigned int height) {
+            StringStream key;
+            for (size_t i = 0; i < searchPaths.size(); i++)
+                key << searchPaths[i] << ";";
+            key << modelPath << " " << skinIndex << " " << frameIndex << " " << width << "x" << height;
+            return Utility::toLower(key.str());
+        }
+        
+        bool EntityThumbnailCache::read(const String& key, long modificationTime, unsigned int paletteChecksum, unsigned int width, unsigned int height, unsigned char* rgbaData) const {
+            if (m_directory.empty())
+                return false;
+            
+            std::ifstream stream(cachePath(key).c_str(), std::ios::in | std::ios::binary);
+            if (!stream.is_open())
+                return false;
+            
+            char magic[4];
+            uint32_t version, keyLength;
+            stream.read(magic, 4);
+            stream.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+            stream.read(reinterpret_cast<char*>(&keyLength), sizeof(uint32_t));
+            if (!stream.good() || std::memcmp(magic, ThumbnailFormat::Magic, 4) != 0 || version != ThumbnailFormat::Version || keyLength != key.size())
+                return false;
+            
+            std::vector<char> storedKey(keyLength + 1, 0);
+            int64_t storedModificationTime;
+            uint32_t storedPaletteChecksum, storedWidth, storedHeight;
+            stream.read(&storedKey.front(), static_cast<std::streamsize>(keyLength));
+            stream.read(reinterpret_cast<char*>(&storedModificationTime), sizeof(int64_t));
+            stream.read(reinterpret_cast<char*>(&storedPaletteChecksum), sizeof(uint32_t));
+            stream.read(reinterpret_cast<char*>(&storedWidth), sizeof(uint32_t));
+            stream.read(reinterpret_cast<char*>(&storedHeight), sizeof(uint32_t));
+            if (!stream.good() || key.compare(0, key.size(), &storedKey.front(), keyLength) != 0)
+                return false;
+            if (storedModificationTime != static_cast<int64_t>(modificationTime) || storedPaletteChecksum != static_cast<uint32_t>(paletteChecksum))
+                return false;
+            if (storedWidth != width || storedHeight != height)
+                return false;
+            
+            // the pixels are read into a separate buffer so that a truncated file leaves the given one unchanged
+            const size_t size = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+            std::vector<char> pixels(size);
+            stream.read(&pixels.front(), static_cast<std::streamsize>(size));
+            if (stream.gcount() != static_cast<std::streamsize>(size))
+                return false;
+            
+            std::memcpy(rgbaData, &pixels.front(), size);
+            return true;
+        }
+        
+        void EntityThumbnailCache::write(const String& key, long modificationTime, unsigned int paletteChecksum, unsigned int width, unsigned int height, const unsigned char* rgbaData) const {
+            if (m_directory.empty())
+                return;
+            
+            const String path = cachePath(key);
+            const String tempPath = path + ".tmp";
+            {
+                std::ofstream stream(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!stream.is_open())
+                    return;
+                
+                const uint32_t version = ThumbnailFormat::Version;
+                const uint32_t keyLength = static_cast<uint32_t>(key.size());
+                const int64_t storedModificationTime = static_cast<int64_t>(modificationTime);
+                const uint32_t storedPaletteChecksum = static_cast<uint32_t>(paletteChecksum);
+                const uint32_t storedWidth = width;
+                const uint32_t storedHeight = height;
+                
+                stream.write(ThumbnailFormat::Magic, 4);
+                stream.write(reinterpret_cast<const char*>(&version), sizeof(uint32_t));
+                stream.write(reinterpret_cast<const char*>(&keyLength), sizeof(uint32_t));
+                stream.write(key.data(), static_cast<std::streamsize>(key.size()));
+                stream.write(reinterpret_cast<const char*>(&storedModificationTime), sizeof(int64_t));
+                stream.write(reinterpret_cast<const char*>(&storedPaletteChecksum), sizeof(uint32_t));
+                stream.write(reinterpret_cast<const char*>(&storedWidth), sizeof(uint32_t));
+                stream.write(reinterpret_cast<const char*>(&storedHeight), sizeof(uint32_t));
+                stream.write(reinterpret_cast<const char*>(rgbaData), static_cast<std::streamsize>(static_cast<size_t>(width) * static_cast<size_t>(height) * 4));
+                
+                if (!stream.good()) {
+                    stream.close();
+                    std::remove(tempPath.c_str());
+                    return;
+                }
+            }
+            
+            std::remove(path.c_str());
+            std::rename(tempPath.c_str(), path.c_str());
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__EntityThumbnailCache__
+#define __TrenchBroom__EntityThumbnailCache__
+
+#include "Utility/String.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        /*
+         * Stores the thumbnails of the entity browser so that the models do not have to be rendered again in the next
+         * session. Every thumbnail is stored in a file of its own that is named after the hash of its key. The key
+         * itself is stored in the file, too, so that hash collisions are detected. Like the entity definition cache,
+         * the file also stores the modification time of the model file and the checksum of the palette it was
+         * rendered with, and a thumbnail is only read back if both still match.
+         */
+        class EntityThumbnailCache {
+        private:
+            String m_directory;
+        public:
+            /*
+             * The given directory must exist. If it is empty, nothing is read or written.
+             */
+            EntityThumbnailCache(const String& directory);
+            
+            /*
+             * Returns the path of the file that stores the thumbnail with the given key.
+             */
+            String cachePath(const String& key) const;
+            
+            /*
+             * Returns the key of the thumbnail of the given model. A model is identified by the search paths it was
+             * found in, its path, skin and frame. The size is part of the key because the thumbnails are rendered
+             * at the size of the cells that show them.
+             */
+            static String key(const StringList& searchPaths, const String& modelPath, unsigned int skinIndex, unsigned int frameIndex, unsigned int width, unsigned int height);
+            
+            /*
+             * Reads the thumbnail with the given key into the given buffer, which must hold four bytes per pixel, and
+             * returns true if it was found and is up to date. Otherwise, the buffer is left unchanged.
+             */
+            bool read(const String& key, long modificationTime, unsigned int paletteChecksum, unsigned int width, unsigned int height, unsigned char* rgbaData) const;
+            void write(const String& key, long modificationTime, unsigned int paletteChecksum, unsigned int width, unsigned int height, const unsigned char* rgbaData) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityThumbnailCache__) */
@@ -100,6 +100,10 @@ namespace TrenchBroom {
             m_tokenizer(begin, end) {}
             
             Model::EntityDefinition* nextDefinition();
+            
+            inline size_t position() const {
+                return m_tokenizer.position();
+            }
         };
     }
 }
@@ -58,6 +58,28 @@ namespace TrenchBroom {
 
             return mappedFile;
         }
+        
+        /*
+         * Returns the modification time of the file that findGameFile would map for the given path, which is the pak
+         * file if the game file is stored in one. Returns 0 if the game file cannot be found.
+         */
+        inline long gameFileModificationTime(const String& filePath, const StringList& searchPaths) {
+            FileManager fileManager;
+            
+            StringList::const_reverse_iterator pathIt, pathEnd;
+            for (pathIt = searchPaths.rbegin(), pathEnd = searchPaths.rend(); pathIt != pathEnd; ++pathIt) {
+                const String& searchPath = *pathIt;
+                const String path = fileManager.appendPath(searchPath, filePath);
+                if (fileManager.exists(path) && !fileManager.isDirectory(path))
+                    return fileManager.modificationTime(path);
+                
+                const String pakPath = PakManager::sharedManager->pakPath(filePath, searchPath);
+                if (!pakPath.empty())
+                    return fileManager.modificationTime(pakPath);
+            }
+            
+            return 0;
+        }
 
         template <typename T>
         inline T read(char*& cursor) {
@@ -26,6 +26,7 @@
 #include "Model/Texture.h"
 #include "Utility/Console.h"
 #include "Utility/List.h"
+#include "Utility/Profiler.h"
 #include "Utility/ProgressIndicator.h"
 
 namespace TrenchBroom {
@@ -205,17 +206,21 @@ namespace TrenchBroom {
         m_size(str.size()) {}
 
         void MapParser::parseMap(Model::Map& map, Utility::ProgressIndicator* indicator) {
+            TB_PROFILE_ZONE("MapParser::parseMap");
             Model::Entity* entity = NULL;
+            Model::EntityList entities;
             
             if (indicator != NULL) indicator->reset(static_cast<int>(m_size));
             try {
                 FacePointFormat facePointFormat = Unknown;
                 while ((entity = parseEntity(map.worldBounds(), facePointFormat, indicator)) != NULL)
-                    map.addEntity(*entity);
+                    entities.push_back(entity);
             } catch (MapParserException& e) {
                 m_console.error(e.what());
             }
             
+            map.addEntities(entities);
+            
             if (indicator != NULL)
                 indicator->update(static_cast<int>(m_size));
         }
@@ -351,8 +356,14 @@ namespace TrenchBroom {
             size_t oldSize = entities.size();
             try {
                 Model::Entity* entity = NULL;
-                while ((entity = parseEntity(worldBounds, forceIntegerFacePoints ? Integer : Float, NULL)) != NULL)
+                while ((entity = parseEntity(worldBounds, forceIntegerFacePoints ? Integer : Float, NULL)) != NULL) {
+                    // the lines of pasted objects do not refer to the map file, see Model::LineIndex
+                    entity->setFilePosition(0, 0);
+                    const Model::BrushList& brushes = entity->brushes();
+                    for (unsigned int i = 0; i < brushes.size(); i++)
+                        brushes[i]->setFilePosition(0, 0);
                     entities.push_back(entity);
+                }
                 return !entities.empty();
             } catch (MapParserException&) {
                 Utility::deleteAll(entities, oldSize);
@@ -365,8 +376,10 @@ namespace TrenchBroom {
             size_t oldSize = brushes.size();
             try {
                 Model::Brush* brush = NULL;
-                while ((brush = parseBrush(worldBounds, forceIntegerFacePoints, NULL)) != NULL)
+                while ((brush = parseBrush(worldBounds, forceIntegerFacePoints, NULL)) != NULL) {
+                    brush->setFilePosition(0, 0);
                     brushes.push_back(brush);
+                }
                 return !brushes.empty();
             } catch (MapParserException&) {
                 Utility::deleteAll(brushes, oldSize);
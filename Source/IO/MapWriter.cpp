@@ -28,6 +28,7 @@
 #include "Model/Map.h"
 #include "IO/FileManager.h"
 #include "IO/IOException.h"
+#include "Utility/Profiler.h"
 
 #include <cassert>
 #include <fstream>
@@ -246,6 +247,7 @@ namespace TrenchBroom {
         }
         
         void MapWriter::writeToFileAtPath(Model::Map& map, const String& path, bool overwrite) {
+            TB_PROFILE_ZONE("MapWriter::writeToFileAtPath");
             FileManager fileManager;
             if (fileManager.exists(path) && !overwrite)
                 return;
@@ -259,10 +261,16 @@ namespace TrenchBroom {
                 throw IOException::openError(path);
             // std::fstream stream(path.c_str(), std::ios::out | std::ios::trunc);
 
+            // writing the entities moves them to new lines, so the line index is rebuilt as they are written
+            Model::LineIndex& lineIndex = map.lineIndex();
+            lineIndex.clear();
+            
             size_t lineNumber = 1;
             const Model::EntityList& entities = map.entities();
-            for (unsigned int i = 0; i < entities.size(); i++)
+            for (unsigned int i = 0; i < entities.size(); i++) {
                 lineNumber += writeEntity(*entities[i], lineNumber, stream);
+                lineIndex.addEntity(*entities[i]);
+            }
             fclose(stream);
         }
     }
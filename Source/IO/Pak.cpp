@@ -110,5 +110,18 @@ namespace TrenchBroom {
             
             return MappedFile::Ptr();
         }
+
+        String PakManager::pakPath(const String& name, const String& searchPath) {
+            PakList paks;
+            if (findPaks(searchPath, paks)) {
+                PakList::reverse_iterator pak, endPak;
+                for (pak = paks.rbegin(), endPak = paks.rend(); pak != endPak; ++pak) {
+                    if (pak->entry(name).get() != NULL)
+                        return pak->path();
+                }
+            }
+            
+            return "";
+        }
     }
 }
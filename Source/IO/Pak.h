@@ -97,6 +97,12 @@ namespace TrenchBroom {
             static PakManager* sharedManager;
 
             MappedFile::Ptr entry(const String& name, const String& searchPath);
+            
+            /*
+             * Returns the path of the pak file in the given search path that provides the entry with the given name,
+             * or an empty string if there is no such pak file.
+             */
+            String pakPath(const String& name, const String& searchPath);
         };
     }
 }
@@ -138,6 +138,10 @@ namespace TrenchBroom {
                 return m_column;
             }
 
+            inline size_t position() const {
+                return offset(m_cur);
+            }
+
             inline size_t offset(const char* ptr) const {
                 assert(ptr >= m_begin);
                 return static_cast<size_t>(ptr - m_begin);
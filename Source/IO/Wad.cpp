@@ -20,6 +20,7 @@
 #include "Wad.h"
 
 #include "IO/IOUtils.h"
+#include "Utility/Profiler.h"
 
 #include <cassert>
 
@@ -64,6 +65,7 @@ namespace TrenchBroom {
         }
 
         Wad::Wad(const String& path) throw (IOException) {
+            TB_PROFILE_ZONE("Wad::Wad");
             FileManager fileManager;
             m_file = fileManager.mapFile(path);
             
@@ -112,6 +114,7 @@ namespace TrenchBroom {
         }
 
         Mip::List Wad::loadMips(unsigned int mipCount) const throw (IOException) {
+            TB_PROFILE_ZONE("Wad::loadMips");
             Mip::List mips;
             EntryMap::const_iterator it, end;
             for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
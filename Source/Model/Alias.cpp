@@ -22,7 +22,9 @@
 #include "Model/AliasNormals.h"
 #include "IO/IOUtils.h"
 #include "Utility/List.h"
+#include "Utility/Profiler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <numeric>
@@ -49,16 +51,66 @@ namespace TrenchBroom {
             Utility::deleteAll(m_pictures);
         }
 
-        AliasSingleFrame::AliasSingleFrame(const String& name, const AliasFrameTriangleList& triangles, const Vec3f& center, const BBoxf& bounds) :
+        void AliasSingleFrame::decode() const {
+            const AliasSkinVertexList& vertices = m_mesh.vertices;
+            const AliasSkinTriangleList& triangles = m_mesh.triangles;
+            assert(m_packedVertices.size() == vertices.size());
+
+            Vec3f::List positions(vertices.size());
+            m_center = Vec3f::Null;
+            for (size_t i = 0; i < vertices.size(); i++) {
+                positions[i] = m_mesh.unpackPosition(m_packedVertices[i]);
+                m_center += positions[i];
+            }
+            if (!vertices.empty())
+                m_center /= static_cast<float>(vertices.size());
+
+            m_triangles.reserve(triangles.size());
+            for (size_t i = 0; i < triangles.size(); i++) {
+                AliasFrameTriangle* frameTriangle = new AliasFrameTriangle();
+                for (size_t j = 0; j < 3; j++) {
+                    size_t index = triangles[i].vertices[j];
+
+                    Vec2f texCoords;
+                    texCoords[0] = static_cast<float>(vertices[index].s) / static_cast<float>(m_mesh.skinWidth);
+                    texCoords[1] = static_cast<float>(vertices[index].t) / static_cast<float>(m_mesh.skinHeight);
+
+                    if (vertices[index].onseam && !triangles[i].front)
+                        texCoords[0] += 0.5f;
+
+                    (*frameTriangle)[j].setPosition(positions[index]);
+                    (*frameTriangle)[j].setNormal(AliasNormals[m_packedVertices[index][3]]);
+                    (*frameTriangle)[j].setTexCoords(texCoords);
+                }
+
+                m_triangles.push_back(frameTriangle);
+            }
+
+            m_decoded = true;
+        }
+
+        AliasSingleFrame::AliasSingleFrame(const AliasMesh& mesh, const String& name, const AliasPackedFrameVertexList& packedVertices, const BBoxf& bounds) :
+        m_mesh(mesh),
         m_name(name),
-        m_triangles(triangles),
-        m_center(center),
-        m_bounds(bounds) {}
+        m_packedVertices(packedVertices),
+        m_bounds(bounds),
+        m_decoded(false) {}
+
+        AliasSingleFrame::~AliasSingleFrame() {
+            Utility::deleteAll(m_triangles);
+        }
 
         AliasSingleFrame* AliasSingleFrame::firstFrame() {
             return this;
         }
 
+        size_t AliasSingleFrame::memorySize() const {
+            size_t size = sizeof(AliasSingleFrame) + m_packedVertices.size() * sizeof(AliasPackedFrameVertex);
+            if (m_decoded)
+                size += m_triangles.size() * (sizeof(AliasFrameTriangle) + sizeof(AliasFrameTriangle*));
+            return size;
+        }
+
         AliasFrameGroup::AliasFrameGroup(const AliasTimeList& times, const AliasSingleFrameList& frames) :
         m_times(times),
         m_frames(frames) {
@@ -81,82 +133,63 @@ namespace TrenchBroom {
             return m_frames[0];
         }
 
-        Vec3f Alias::unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size) {
-            Vec3f vertex;
-            for (size_t i = 0; i < 3; i++)
-                vertex[i] = size[i] * packedVertex[i] + origin[i];
-            return vertex;
+        size_t AliasFrameGroup::memorySize() const {
+            size_t size = sizeof(AliasFrameGroup) + m_times.size() * sizeof(float);
+            for (size_t i = 0; i < m_frames.size(); i++)
+                size += m_frames[i]->memorySize();
+            return size;
         }
 
-        AliasSingleFrame* Alias::readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles) {
+        AliasSingleFrame* Alias::readFrame(char*& cursor) {
             using namespace IO;
             
             char name[AliasLayout::SimpleFrameLength];
             cursor += AliasLayout::SimpleFrameName;
             readBytes(cursor, name, AliasLayout::SimpleFrameLength);
 
-            std::vector<AliasPackedFrameVertex> packedFrameVertices(vertices.size());
-            readBytes(cursor, reinterpret_cast<char*>(&packedFrameVertices[0]), vertices.size() * 4);
+            const size_t vertexCount = m_mesh.vertices.size();
+            AliasPackedFrameVertexList packedVertices(vertexCount);
+            if (vertexCount > 0)
+                readBytes(cursor, reinterpret_cast<char*>(&packedVertices[0]), vertexCount * AliasLayout::FrameVertexSize);
 
-            Vec3f::List frameVertices(vertices.size());
-            Vec3f center;
+            // the bounds can be computed from the packed coordinates without unpacking every vertex
             BBoxf bounds;
-
-            frameVertices[0] = unpackFrameVertex(packedFrameVertices[0], origin, scale);
-            center = frameVertices[0];
-            bounds.min = frameVertices[0];
-            bounds.max = frameVertices[0];
-
-            for (unsigned int i = 1; i < vertices.size(); i++) {
-                frameVertices[i] = unpackFrameVertex(packedFrameVertices[i], origin, scale);
-                center += frameVertices[i];
-                bounds.mergeWith(frameVertices[i]);
-            }
-
-            center /= static_cast<float>(vertices.size());
-
-            AliasFrameTriangleList frameTriangles;
-            frameTriangles.reserve(triangles.size());
-            for (unsigned int i = 0; i < triangles.size(); i++) {
-                AliasFrameTriangle* frameTriangle = new AliasFrameTriangle();
-                for (unsigned int j = 0; j < 3; j++) {
-                    size_t index = triangles[i].vertices[j];
-
-                    Vec2f texCoords;
-                    texCoords[0] = static_cast<float>(vertices[index].s) / static_cast<float>(skinWidth);
-                    texCoords[1] = static_cast<float>(vertices[index].t) / static_cast<float>(skinHeight);
-
-                    if (vertices[index].onseam && !triangles[i].front)
-                        texCoords[0] += 0.5f;
-
-                    (*frameTriangle)[j].setPosition(frameVertices[index]);
-                    (*frameTriangle)[j].setNormal(AliasNormals[packedFrameVertices[index][3]]);
-                    (*frameTriangle)[j].setTexCoords(texCoords);
+            if (vertexCount > 0) {
+                AliasPackedFrameVertex min = packedVertices[0];
+                AliasPackedFrameVertex max = packedVertices[0];
+                for (size_t i = 1; i < vertexCount; i++) {
+                    const AliasPackedFrameVertex& vertex = packedVertices[i];
+                    for (size_t j = 0; j < 3; j++) {
+                        min[j] = std::min(min[j], vertex[j]);
+                        max[j] = std::max(max[j], vertex[j]);
+                    }
                 }
-
-                frameTriangles.push_back(frameTriangle);
+                
+                bounds.min = bounds.max = m_mesh.unpackPosition(min);
+                bounds.mergeWith(m_mesh.unpackPosition(max));
+            } else {
+                bounds.min = bounds.max = Vec3f::Null;
             }
 
-            return new AliasSingleFrame(name, frameTriangles, center, bounds);
-        }
-
-        AliasSingleFrame::~AliasSingleFrame() {
-            Utility::deleteAll(m_triangles);
+            return new AliasSingleFrame(m_mesh, name, packedVertices, bounds);
         }
 
         Alias::Alias(const String& name, char* begin, char* end) :
         m_name(name) {
+            TB_PROFILE_ZONE("Alias::Alias");
             using namespace IO;
             
             char* cursor = begin + AliasLayout::HeaderScale;
-            Vec3f scale = readVec3f(cursor);
-            Vec3f origin = readVec3f(cursor);
+            m_mesh.scale = readVec3f(cursor);
+            m_mesh.origin = readVec3f(cursor);
 
             cursor = begin + AliasLayout::HeaderNumSkins;
             unsigned int skinCount = readUnsignedInt<int32_t>(cursor);
             unsigned int skinWidth = readUnsignedInt<int32_t>(cursor);
             unsigned int skinHeight = readUnsignedInt<int32_t>(cursor);
             unsigned int skinSize = skinWidth * skinHeight;
+            m_mesh.skinWidth = skinWidth;
+            m_mesh.skinHeight = skinHeight;
 
             unsigned int vertexCount = readUnsignedInt<int32_t>(cursor);
             unsigned int triangleCount = readUnsignedInt<int32_t>(cursor);
@@ -180,13 +213,13 @@ namespace TrenchBroom {
                     char* base = cursor;
                     for (size_t j = 0; j < static_cast<size_t>(numPics); j++) {
                         cursor = base + j * sizeof(float);
-                        times[i] = readFloat<float>(cursor);
+                        times[j] = readFloat<float>(cursor);
 
                         unsigned char* skinPicture = new unsigned char[skinSize];
                         cursor = base + numPics * 4 + j * skinSize;
                         readBytes(cursor, skinPicture, skinSize);
 
-                        skinPictures[i] = skinPicture;
+                        skinPictures[j] = skinPicture;
                     }
 
                     AliasSkin* skin = new AliasSkin(skinPictures, times, numPics, skinWidth, skinHeight);
@@ -195,7 +228,8 @@ namespace TrenchBroom {
             }
 
             // now cursor is at the first skin vertex
-            std::vector<AliasSkinVertex> vertices(vertexCount);
+            AliasSkinVertexList& vertices = m_mesh.vertices;
+            vertices.resize(vertexCount);
             for (unsigned int i = 0; i < vertexCount; i++) {
                 vertices[i].onseam = readBool<int32_t>(cursor);
                 vertices[i].s = readInt<int32_t>(cursor);
@@ -203,7 +237,8 @@ namespace TrenchBroom {
             }
 
             // now cursor is at the first skin triangle
-            std::vector<AliasSkinTriangle> triangles(triangleCount);
+            AliasSkinTriangleList& triangles = m_mesh.triangles;
+            triangles.resize(triangleCount);
             for (unsigned int i = 0; i < triangleCount; i++) {
                 triangles[i].front = readBool<int32_t>(cursor);
                 for (unsigned int j = 0; j < 3; j++)
@@ -214,7 +249,7 @@ namespace TrenchBroom {
             for (unsigned int i = 0; i < frameCount; i++) {
                 int type = readInt<int32_t>(cursor);
                 if (type == 0) { // single frame
-                    m_frames.push_back(readFrame(cursor, origin, scale, skinWidth, skinHeight, vertices, triangles));
+                    m_frames.push_back(readFrame(cursor));
                 } else { // frame group
                     char* base = cursor;
                     unsigned int groupFrameCount = readUnsignedInt<int32_t>(cursor);
@@ -225,8 +260,8 @@ namespace TrenchBroom {
                     AliasTimeList groupFrameTimes(groupFrameCount);
                     AliasSingleFrameList groupFrames(groupFrameCount);
                     for (unsigned int j = 0; j < groupFrameCount; j++) {
-                        groupFrameTimes[i] = readFloat<float>(timeCursor);
-                        groupFrames[j] = readFrame(frameCursor, origin, scale, skinWidth, skinHeight, vertices, triangles);
+                        groupFrameTimes[j] = readFloat<float>(timeCursor);
+                        groupFrames[j] = readFrame(frameCursor);
                     }
 
                     m_frames.push_back(new AliasFrameGroup(groupFrameTimes, groupFrames));
@@ -240,36 +275,18 @@ namespace TrenchBroom {
             Utility::deleteAll(m_skins);
         }
 
-        AliasManager* AliasManager::sharedManager = NULL;
-
-        Alias const * const AliasManager::alias(const String& name, const StringList& paths, Utility::Console& console) {
-            String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
-
-            AliasMap::iterator it = m_aliases.find(key);
-            if (it != m_aliases.end())
-                return it->second;
-
-            console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
-
-            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
-            if (file.get() != NULL) {
-                Alias* alias = new Alias(name, file->begin(), file->end());
-                m_aliases[key] = alias;
-                return alias;
-            }
-
-            console.warn("Unable to find MDL '%s'", name.c_str());
-            return NULL;
+        size_t Alias::memorySize() const {
+            size_t size = sizeof(Alias);
+            for (size_t i = 0; i < m_frames.size(); i++)
+                size += m_frames[i]->memorySize();
+            for (size_t i = 0; i < m_skins.size(); i++)
+                size += m_skins[i]->memorySize();
+            return size;
         }
 
-        AliasManager::AliasManager() {}
+        AliasManager* AliasManager::sharedManager = NULL;
 
-        AliasManager::~AliasManager() {
-            AliasMap::iterator it, end;
-            for (it = m_aliases.begin(), end = m_aliases.end(); it != end; ++it)
-                delete it->second;
-            m_aliases.clear();
-        }
+        AliasManager::AliasManager() :
+        ModelManager<Alias>("MDL", 32 * 1024 * 1024) {}
     }
 }
@@ -21,7 +21,9 @@
 #define TrenchBroom_Alias_h
 
 #include "IO/Pak.h"
+#include "Model/ModelManager.h"
 #include "Utility/Console.h"
+#include "Utility/SharedPointer.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 
@@ -83,6 +85,29 @@ namespace TrenchBroom {
             }
         };
         
+        typedef std::vector<AliasPackedFrameVertex> AliasPackedFrameVertexList;
+        
+        /*
+         * The parts of a model that all of its frames share. A frame only stores its packed vertex positions and
+         * normals, and needs these to decode them.
+         */
+        class AliasMesh {
+        public:
+            Vec3f origin;
+            Vec3f scale;
+            unsigned int skinWidth;
+            unsigned int skinHeight;
+            AliasSkinVertexList vertices;
+            AliasSkinTriangleList triangles;
+            
+            inline Vec3f unpackPosition(const AliasPackedFrameVertex& packedVertex) const {
+                Vec3f position;
+                for (size_t i = 0; i < 3; i++)
+                    position[i] = scale[i] * packedVertex[i] + origin[i];
+                return position;
+            }
+        };
+        
         // publicly visible classes below
         
         class AliasFrameVertex {
@@ -159,6 +184,10 @@ namespace TrenchBroom {
             inline const AliasPictureList& pictures() const {
                 return m_pictures;
             }
+            
+            inline size_t memorySize() const {
+                return m_pictures.size() * m_width * m_height;
+            }
         };
         
         class AliasSingleFrame;
@@ -169,18 +198,29 @@ namespace TrenchBroom {
         public:
             virtual ~AliasFrame() {};
             virtual AliasSingleFrame* firstFrame() = 0;
+            virtual size_t memorySize() const = 0;
         };
         
         typedef std::vector<AliasFrame*> AliasFrameList;
         
+        /*
+         * Keeps its vertices in the packed form in which they are stored in the file. They are only decoded into
+         * triangles when the triangles or the center are requested for the first time. The bounds are known up front.
+         */
         class AliasSingleFrame : public AliasFrame {
         private:
+            const AliasMesh& m_mesh;
             String m_name;
-            AliasFrameTriangleList m_triangles;
-            Vec3f m_center;
+            AliasPackedFrameVertexList m_packedVertices;
             BBoxf m_bounds;
+            
+            mutable AliasFrameTriangleList m_triangles;
+            mutable Vec3f m_center;
+            mutable bool m_decoded;
+            
+            void decode() const;
         public:
-            AliasSingleFrame(const String& name, const AliasFrameTriangleList& triangles, const Vec3f& center, const BBoxf& bounds);
+            AliasSingleFrame(const AliasMesh& mesh, const String& name, const AliasPackedFrameVertexList& packedVertices, const BBoxf& bounds);
             ~AliasSingleFrame();
             
             inline const String& name() const {
@@ -188,10 +228,14 @@ namespace TrenchBroom {
             }
             
             inline const AliasFrameTriangleList& triangles() const {
+                if (!m_decoded)
+                    decode();
                 return m_triangles;
             }
             
             inline const Vec3f& center() const {
+                if (!m_decoded)
+                    decode();
                 return m_center;
             }
             
@@ -200,6 +244,7 @@ namespace TrenchBroom {
             }
             
             AliasSingleFrame* firstFrame();
+            size_t memorySize() const;
         };
         
         class AliasFrameGroup : public AliasFrame {
@@ -211,16 +256,19 @@ namespace TrenchBroom {
             AliasFrameGroup(const AliasTimeList& times, const AliasSingleFrameList& frames);
             ~AliasFrameGroup();
             AliasSingleFrame* firstFrame();
+            size_t memorySize() const;
         };
         
         class Alias {
+        public:
+            typedef std::tr1::shared_ptr<Alias> Ptr;
         private:
             String m_name;
+            AliasMesh m_mesh;
             AliasFrameList m_frames;
             AliasSkinList m_skins;
             
-            Vec3f unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size);
-            AliasSingleFrame* readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles);
+            AliasSingleFrame* readFrame(char*& cursor);
         public:
             Alias(const String& name, char* begin, char* end);
             ~Alias();
@@ -245,18 +293,18 @@ namespace TrenchBroom {
             inline const AliasSkinList& skins() const {
                 return m_skins;
             }
+            
+            size_t memorySize() const;
         };
         
-        class AliasManager {
-        private:
-            typedef std::map<String, Alias*> AliasMap;
-            
-            AliasMap m_aliases;
+        class AliasManager : public ModelManager<Alias> {
         public:
             static AliasManager* sharedManager;
             AliasManager();
-            ~AliasManager();
-            Alias const * const alias(const String& name, const StringList& paths, Utility::Console& console);
+            
+            inline Alias::Ptr alias(const String& name, const StringList& paths, Utility::Console& console, ModelState& state) {
+                return model(name, paths, console, state);
+            }
         };
     }
 }
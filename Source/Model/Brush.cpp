@@ -34,6 +34,18 @@ namespace TrenchBroom {
             m_entity = NULL;
             setEditState(EditState::Default);
             m_selectedFaceCount = 0;
+            m_contentFlags = ContentFlags::None;
+            m_contentFlagsValid = false;
+            m_deferEntityInvalidation = false;
+            m_entityInvalidationPending = false;
+        }
+
+        void Brush::validateContentFlags() const {
+            m_contentFlags = m_faces.empty() ? ContentFlags::None : ContentFlags::All;
+            FaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end && m_contentFlags != ContentFlags::None; ++it)
+                m_contentFlags &= (*it)->contentFlags();
+            m_contentFlagsValid = true;
         }
 
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces) :
@@ -246,16 +258,30 @@ namespace TrenchBroom {
                 face->invalidateVertexCache();
             }
 
-            if (m_entity != NULL)
-                m_entity->invalidateGeometry();
+            if (m_entity != NULL) {
+                if (m_deferEntityInvalidation)
+                    m_entityInvalidationPending = true;
+                else
+                    m_entity->invalidateGeometry();
+            }
         }
 
         void Brush::transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation) {
-            FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
-                Face& face = **faceIt;
-                face.transform(pointTransform, vectorTransform, lockTextures, invertOrientation);
-            }
+            // the planes and points of all faces are transformed in one batch each
+            const size_t faceCount = m_faces.size();
+            std::vector<Planef> boundaries(faceCount);
+            Vec3f::List points(3 * faceCount);
+            for (size_t i = 0; i < faceCount; i++) {
+                const Face& face = *m_faces[i];
+                boundaries[i] = face.boundary();
+                face.getPoints(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+            }
+            
+            transformPlanes(pointTransform, vectorTransform, boundaries);
+            transformPoints(pointTransform, points);
+            
+            for (size_t i = 0; i < faceCount; i++)
+                m_faces[i]->transform(pointTransform, boundaries[i], &points[3 * i], lockTextures, invertOrientation);
 
             rebuildGeometry();
         }
@@ -352,30 +378,12 @@ namespace TrenchBroom {
         }
 
         Vec3f::List Brush::moveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) {
-            FaceSet newFaces;
-            FaceSet droppedFaces;
-
-            const Vec3f::List newVertexPositions = m_geometry->moveVertices(m_worldBounds, vertexPositions, delta, newFaces, droppedFaces);
-
-            for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(NULL);
-                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
-                delete face;
-            }
-
-            for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
-                Face* face = *it;
-                face->invalidateTexAxes();
-                face->invalidateVertexCache();
-            }
-
-            for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(this);
-                m_faces.push_back(face);
-            }
-
+            BrushGeometry::DryRun* dryRun = dryRunMoveVertices(vertexPositions, delta);
+            assert(dryRun->valid());
+            
+            commit(*dryRun);
+            const Vec3f::List newVertexPositions = dryRun->newVertexPositions();
+            delete dryRun;
             return newVertexPositions;
         }
 
@@ -384,30 +392,12 @@ namespace TrenchBroom {
         }
 
         EdgeInfoList Brush::moveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) {
-            FaceSet newFaces;
-            FaceSet droppedFaces;
-
-            const EdgeInfoList newEdgeInfos = m_geometry->moveEdges(m_worldBounds, edgeInfos, delta, newFaces, droppedFaces);
-
-            for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(NULL);
-                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
-                delete face;
-            }
-
-            for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
-                Face* face = *it;
-                face->invalidateTexAxes();
-                face->invalidateVertexCache();
-            }
-
-            for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(this);
-                m_faces.push_back(face);
-            }
+            BrushGeometry::DryRun* dryRun = dryRunMoveEdges(edgeInfos, delta);
+            assert(dryRun->valid());
 
+            commit(*dryRun);
+            const EdgeInfoList newEdgeInfos = dryRun->newEdgeInfos();
+            delete dryRun;
             return newEdgeInfos;
         }
 
@@ -416,30 +406,12 @@ namespace TrenchBroom {
         }
 
         FaceInfoList Brush::moveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) {
-            FaceSet newFaces;
-            FaceSet droppedFaces;
-
-            const FaceInfoList newFaceInfos = m_geometry->moveFaces(m_worldBounds, faceInfos, delta, newFaces, droppedFaces);
-
-            for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(NULL);
-                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
-                delete face;
-            }
-
-            for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
-                Face* face = *it;
-                face->invalidateTexAxes();
-                face->invalidateVertexCache();
-            }
-
-            for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(this);
-                m_faces.push_back(face);
-            }
+            BrushGeometry::DryRun* dryRun = dryRunMoveFaces(faceInfos, delta);
+            assert(dryRun->valid());
 
+            commit(*dryRun);
+            const FaceInfoList newFaceInfos = dryRun->newFaceInfos();
+            delete dryRun;
             return newFaceInfos;
         }
 
@@ -448,30 +420,12 @@ namespace TrenchBroom {
         }
 
         Vec3f Brush::splitEdge(const EdgeInfo& edge, const Vec3f& delta) {
-            FaceSet newFaces;
-            FaceSet droppedFaces;
-
-            Vec3f newVertexPosition = m_geometry->splitEdge(m_worldBounds, edge, delta, newFaces, droppedFaces);
-
-            for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(NULL);
-                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
-                delete face;
-            }
-
-            for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
-                Face* face = *it;
-                face->invalidateTexAxes();
-                face->invalidateVertexCache();
-            }
-
-            for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(this);
-                m_faces.push_back(face);
-            }
+            BrushGeometry::DryRun* dryRun = dryRunSplitEdge(edge, delta);
+            assert(dryRun->valid());
 
+            commit(*dryRun);
+            const Vec3f newVertexPosition = dryRun->newVertexPositions().front();
+            delete dryRun;
             return newVertexPosition;
         }
 
@@ -480,16 +434,46 @@ namespace TrenchBroom {
         }
 
         Vec3f Brush::splitFace(const FaceInfo& faceInfo, const Vec3f& delta) {
+            BrushGeometry::DryRun* dryRun = dryRunSplitFace(faceInfo, delta);
+            assert(dryRun->valid());
+
+            commit(*dryRun);
+            const Vec3f newVertexPosition = dryRun->newVertexPositions().front();
+            delete dryRun;
+            return newVertexPosition;
+        }
+
+        BrushGeometry::DryRun* Brush::dryRunMoveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) const {
+            return m_geometry->dryRunMoveVertices(m_worldBounds, vertexPositions, delta);
+        }
+
+        BrushGeometry::DryRun* Brush::dryRunMoveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) const {
+            return m_geometry->dryRunMoveEdges(m_worldBounds, edgeInfos, delta);
+        }
+
+        BrushGeometry::DryRun* Brush::dryRunMoveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) const {
+            return m_geometry->dryRunMoveFaces(m_worldBounds, faceInfos, delta);
+        }
+
+        BrushGeometry::DryRun* Brush::dryRunSplitEdge(const EdgeInfo& edgeInfo, const Vec3f& delta) const {
+            return m_geometry->dryRunSplitEdge(m_worldBounds, edgeInfo, delta);
+        }
+
+        BrushGeometry::DryRun* Brush::dryRunSplitFace(const FaceInfo& faceInfo, const Vec3f& delta) const {
+            return m_geometry->dryRunSplitFace(m_worldBounds, faceInfo, delta);
+        }
+
+        void Brush::commit(BrushGeometry::DryRun& dryRun) {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            Vec3f newVertexPosition = m_geometry->splitFace(m_worldBounds, faceInfo, delta, newFaces, droppedFaces);
+            m_geometry->commit(dryRun, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
-                Face* dropFace = *it;
-                dropFace->setBrush(NULL);
-                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), dropFace), m_faces.end());
-                delete dropFace;
+                Face* face = *it;
+                face->setBrush(NULL);
+                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
+                delete face;
             }
 
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
@@ -499,12 +483,10 @@ namespace TrenchBroom {
             }
 
             for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
-                Face* newFace = *it;
-                newFace->setBrush(this);
-                m_faces.push_back(newFace);
+                Face* face = *it;
+                face->setBrush(this);
+                m_faces.push_back(face);
             }
-
-            return newVertexPosition;
         }
 
         void Brush::pick(const Rayf& ray, PickResult& pickResults) {
@@ -673,5 +655,32 @@ namespace TrenchBroom {
                 return false;
             return true;
         }
+
+        DeferEntityInvalidation::DeferEntityInvalidation(const BrushList& brushes) :
+        m_brushes(brushes) {
+            BrushList::const_iterator it, end;
+            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
+                Brush& brush = **it;
+                assert(!brush.m_deferEntityInvalidation);
+                brush.m_deferEntityInvalidation = true;
+                brush.m_entityInvalidationPending = false;
+            }
+        }
+        
+        DeferEntityInvalidation::~DeferEntityInvalidation() {
+            EntitySet entities;
+            BrushList::const_iterator it, end;
+            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
+                Brush& brush = **it;
+                if (brush.m_entityInvalidationPending && brush.m_entity != NULL)
+                    entities.insert(brush.m_entity);
+                brush.m_deferEntityInvalidation = false;
+                brush.m_entityInvalidationPending = false;
+            }
+            
+            EntitySet::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt)
+                (*entityIt)->invalidateGeometry();
+        }
     }
 }
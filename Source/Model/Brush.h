@@ -22,6 +22,7 @@
 
 #include "IO/ByteBuffer.h"
 #include "Model/BrushGeometry.h"
+#include "Model/ContentFlags.h"
 #include "Model/EditState.h"
 #include "Model/FaceTypes.h"
 #include "Model/MapObject.h"
@@ -47,11 +48,18 @@ namespace TrenchBroom {
             BrushGeometry* m_geometry;
 
             unsigned int m_selectedFaceCount;
+            mutable ContentFlags::Type m_contentFlags;
+            mutable bool m_contentFlagsValid;
 
             const BBoxf& m_worldBounds;
             bool m_forceIntegerFacePoints;
 
+            bool m_deferEntityInvalidation;
+            bool m_entityInvalidationPending;
+            friend class DeferEntityInvalidation;
+
             void init();
+            void validateContentFlags() const;
         public:
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate);
@@ -87,6 +95,20 @@ namespace TrenchBroom {
                 m_selectedFaceCount--;
             }
 
+            /*
+             * Returns the content flags that all faces of this brush have in common. The flags are cached until a face
+             * is added or removed or a face's texture changes.
+             */
+            inline ContentFlags::Type contentFlags() const {
+                if (!m_contentFlagsValid)
+                    validateContentFlags();
+                return m_contentFlags;
+            }
+
+            inline void invalidateContentFlags() {
+                m_contentFlagsValid = false;
+            }
+
             virtual EditState::Type setEditState(EditState::Type editState);
 
             inline const BBoxf& worldBounds() const {
@@ -138,6 +160,14 @@ namespace TrenchBroom {
             void transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation);
 
             bool clip(Face& face);
+
+            /*
+             * Computes the polygons that clipping this brush at the given plane would leave on either side, without
+             * changing the brush, see BrushGeometry::split.
+             */
+            inline PointStatus::Type split(const Planef& plane, SplitPolygons& below, SplitPolygons& above) const {
+                return m_geometry->split(plane, below, above);
+            }
             
             void correct(float epsilon);
             void snap(unsigned int snapTo);
@@ -157,6 +187,17 @@ namespace TrenchBroom {
             bool canSplitFace(const FaceInfo& faceInfo, const Vec3f& delta) const;
             Vec3f splitFace(const FaceInfo& faceInfo, const Vec3f& delta);
 
+            /*
+             * The dry runs leave this brush untouched, so they can be made on worker threads. A valid dry run is
+             * committed to change the brush accordingly, and the caller deletes it afterwards.
+             */
+            BrushGeometry::DryRun* dryRunMoveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) const;
+            BrushGeometry::DryRun* dryRunMoveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) const;
+            BrushGeometry::DryRun* dryRunMoveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) const;
+            BrushGeometry::DryRun* dryRunSplitEdge(const EdgeInfo& edgeInfo, const Vec3f& delta) const;
+            BrushGeometry::DryRun* dryRunSplitFace(const FaceInfo& faceInfo, const Vec3f& delta) const;
+            void commit(BrushGeometry::DryRun& dryRun);
+
             void pick(const Rayf& ray, PickResult& pickResults);
             bool containsPoint(const Vec3f point) const;
             bool intersectsBrush(const Brush& brush) const;
@@ -165,6 +206,23 @@ namespace TrenchBroom {
             bool containsEntity(const Entity& entity) const;
         };
         
+        /*
+         * While an instance exists, the given brushes do not invalidate the geometry of their entities when their own
+         * geometry changes. The affected entities are invalidated once the instance is destroyed. Commands that change
+         * brushes on the thread pool use this, because all world brushes share the worldspawn entity and the workers
+         * must not write its cached bounds concurrently. Instances must not be nested for the same brushes.
+         */
+        class DeferEntityInvalidation {
+        private:
+            const BrushList& m_brushes;
+            
+            DeferEntityInvalidation(const DeferEntityInvalidation& other);
+            DeferEntityInvalidation& operator=(const DeferEntityInvalidation& other);
+        public:
+            DeferEntityInvalidation(const BrushList& brushes);
+            ~DeferEntityInvalidation();
+        };
+        
         inline static EntityBrushesMap entityBrushes(const BrushList& brushes) {
             EntityBrushesMap entityBrushesMap;
             BrushList::const_iterator it, end;
@@ -0,0 +1,402 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrushCSG.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Face.h"
+#include "Utility/List.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace TrenchBroom {
+    namespace Model {
+        namespace PlaneStatus {
+            typedef enum {
+                Behind,
+                InFront,
+                Split
+            } Type;
+        }
+        
+        /*
+         * Classifies the given vertices against the given plane. Vertices on the plane are ignored, and the epsilon is
+         * the one that BrushGeometry::addFace uses to decide whether a face cuts the geometry.
+         */
+        static PlaneStatus::Type planeStatus(const Planef& plane, const VertexList& vertices) {
+            bool above = false;
+            bool below = false;
+            VertexList::const_iterator it, end;
+            for (it = vertices.begin(), end = vertices.end(); it != end && !(above && below); ++it) {
+                const Vertex& vertex = **it;
+                const PointStatus::Type status = plane.pointStatus(vertex.position, 0.1f);
+                if (status == PointStatus::PSAbove)
+                    above = true;
+                else if (status == PointStatus::PSBelow)
+                    below = true;
+            }
+            
+            if (!above)
+                return PlaneStatus::Behind;
+            if (!below)
+                return PlaneStatus::InFront;
+            return PlaneStatus::Split;
+        }
+        
+        static float volume(const FaceList& faces, const Vec3f& center) {
+            float volume = 0.0f;
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                const VertexList& vertices = (*it)->vertices();
+                const Vec3f v0 = vertices[0]->position - center;
+                for (size_t i = 1; i < vertices.size() - 1; i++) {
+                    const Vec3f v1 = vertices[i]->position - center;
+                    const Vec3f v2 = vertices[i + 1]->position - center;
+                    volume += v0.dot(crossed(v1, v2));
+                }
+            }
+            return std::abs(volume) / 6.0f;
+        }
+        
+        /*
+         * A convex volume that owns its faces and that is clipped incrementally by adding single faces to its geometry.
+         */
+        class ClipVolume {
+        private:
+            const BBoxf& m_worldBounds;
+            bool m_forceIntegerFacePoints;
+            FaceList m_faces;
+            BrushGeometry m_geometry;
+            bool m_valid;
+            
+            void deleteFaces(const FaceSet& faces) {
+                FaceSet::const_iterator it, end;
+                for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                    Face* face = *it;
+                    m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
+                    delete face;
+                }
+            }
+            
+            void build() {
+                // sort the faces by the weight of their plane normals like Brush::rebuildGeometry does
+                FaceList sortedFaces = m_faces;
+                std::sort(sortedFaces.begin(), sortedFaces.end(), Face::WeightOrder(Planef::WeightOrder(true)));
+                std::sort(sortedFaces.begin(), sortedFaces.end(), Face::WeightOrder(Planef::WeightOrder(false)));
+                
+                FaceSet droppedFaces;
+                try {
+                    m_valid = m_geometry.addFaces(sortedFaces, droppedFaces) && m_geometry.closed();
+                } catch (GeometryException&) {
+                    m_valid = false;
+                }
+                deleteFaces(droppedFaces);
+            }
+        public:
+            ClipVolume(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brush) :
+            m_worldBounds(worldBounds),
+            m_forceIntegerFacePoints(forceIntegerFacePoints),
+            m_geometry(worldBounds),
+            m_valid(false) {
+                const FaceList& faces = brush.faces();
+                FaceList::const_iterator it, end;
+                for (it = faces.begin(), end = faces.end(); it != end; ++it)
+                    m_faces.push_back(new Face(m_worldBounds, m_forceIntegerFacePoints, **it));
+                build();
+            }
+            
+            /*
+             * Takes ownership of the given faces.
+             */
+            ClipVolume(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces) :
+            m_worldBounds(worldBounds),
+            m_forceIntegerFacePoints(forceIntegerFacePoints),
+            m_faces(faces),
+            m_geometry(worldBounds),
+            m_valid(false) {
+                build();
+            }
+            
+            ~ClipVolume() {
+                Utility::deleteAll(m_faces);
+            }
+            
+            inline bool valid() const {
+                return m_valid;
+            }
+            
+            inline const FaceList& faces() const {
+                return m_faces;
+            }
+            
+            inline const VertexList& vertices() const {
+                return m_geometry.vertices;
+            }
+            
+            inline float volume() const {
+                return Model::volume(m_faces, m_geometry.center);
+            }
+            
+            inline PlaneStatus::Type status(const Planef& plane) const {
+                return planeStatus(plane, m_geometry.vertices);
+            }
+            
+            /*
+             * Removes the part of this volume that lies in front of the given face's plane. The given face must split
+             * this volume.
+             */
+            void clip(const Face& face) {
+                assert(m_valid);
+                Face* clipFace = new Face(m_worldBounds, m_forceIntegerFacePoints, face);
+                
+                FaceSet droppedFaces;
+                const BrushGeometry::CutResult result = m_geometry.addFace(*clipFace, droppedFaces);
+                if (result == BrushGeometry::Split) {
+                    m_faces.push_back(clipFace);
+                    deleteFaces(droppedFaces);
+                } else {
+                    delete clipFace;
+                    if (result == BrushGeometry::Null)
+                        m_valid = false;
+                }
+            }
+            
+            Brush* createBrush() const {
+                assert(m_valid);
+                FaceList faces;
+                FaceList::const_iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                    faces.push_back(new Face(m_worldBounds, m_forceIntegerFacePoints, **it));
+                return new Brush(m_worldBounds, m_forceIntegerFacePoints, faces);
+            }
+            
+            /*
+             * Creates a brush from the part of this volume that lies in front of the given face's plane. The given face
+             * must split this volume. The new face of the brush has the given face's attributes.
+             */
+            Brush* createBrush(const Face& face) const {
+                assert(m_valid);
+                FaceList faces;
+                FaceList::const_iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                    faces.push_back(new Face(m_worldBounds, m_forceIntegerFacePoints, **it));
+                
+                Vec3f p1, p2, p3;
+                face.getPoints(p1, p2, p3);
+                Face* invertedFace = new Face(m_worldBounds, m_forceIntegerFacePoints, p1, p3, p2, face.textureName());
+                invertedFace->setAttributes(face);
+                faces.push_back(invertedFace);
+                
+                return new Brush(m_worldBounds, m_forceIntegerFacePoints, faces);
+            }
+        };
+        
+        bool BrushCSG::subtract(const Brush& minuend, const FaceList& subtrahendFaces, const VertexList& subtrahendVertices, BrushList& result) const {
+            // look for a separating plane among the faces of both volumes before copying anything
+            FaceList::const_iterator it, end;
+            for (it = subtrahendFaces.begin(), end = subtrahendFaces.end(); it != end; ++it)
+                if (planeStatus((*it)->boundary(), minuend.vertices()) == PlaneStatus::InFront)
+                    return false;
+            const FaceList& minuendFaces = minuend.faces();
+            for (it = minuendFaces.begin(), end = minuendFaces.end(); it != end; ++it)
+                if (planeStatus((*it)->boundary(), subtrahendVertices) == PlaneStatus::InFront)
+                    return false;
+            
+            ClipVolume remainder(m_worldBounds, m_forceIntegerFacePoints, minuend);
+            if (!remainder.valid())
+                return false;
+            
+            // every subtrahend face that splits the remainder cuts off a fragment that lies outside of the subtrahend
+            BrushList fragments;
+            for (it = subtrahendFaces.begin(), end = subtrahendFaces.end(); it != end; ++it) {
+                const Face& face = **it;
+                const PlaneStatus::Type status = remainder.status(face.boundary());
+                if (status == PlaneStatus::InFront) {
+                    // the volumes do not intersect after all
+                    Utility::deleteAll(fragments);
+                    return false;
+                }
+                
+                if (status == PlaneStatus::Split) {
+                    fragments.push_back(remainder.createBrush(face));
+                    remainder.clip(face);
+                    if (!remainder.valid())
+                        break;
+                }
+            }
+            
+            // the remainder is now covered by the subtrahend and is dropped
+            result.insert(result.end(), fragments.begin(), fragments.end());
+            return true;
+        }
+        
+        Brush* BrushCSG::merge(const Brush& brush1, const Brush& brush2) const {
+            if (!brush1.bounds().intersects(brush2.bounds()))
+                return NULL;
+            
+            // a single pass over the planes of both brushes: the union is bounded by those faces of either brush that
+            // the other brush lies behind, and the intersection is brush1 clipped by those faces of brush2 that split it
+            FaceList faces;
+            FaceList::const_iterator it, end;
+            for (it = brush1.faces().begin(), end = brush1.faces().end(); it != end; ++it)
+                if (planeStatus((*it)->boundary(), brush2.vertices()) == PlaneStatus::Behind)
+                    faces.push_back(new Face(m_worldBounds, m_forceIntegerFacePoints, **it));
+            
+            FaceList splitFaces;
+            bool disjoint = false;
+            for (it = brush2.faces().begin(), end = brush2.faces().end(); it != end; ++it) {
+                const PlaneStatus::Type status = planeStatus((*it)->boundary(), brush1.vertices());
+                if (status == PlaneStatus::Behind)
+                    faces.push_back(new Face(m_worldBounds, m_forceIntegerFacePoints, **it));
+                else if (status == PlaneStatus::Split)
+                    splitFaces.push_back(*it);
+                else
+                    disjoint = true;
+            }
+            
+            ClipVolume merged(m_worldBounds, m_forceIntegerFacePoints, faces);
+            if (!merged.valid())
+                return NULL;
+            
+            // if the union is convex, then its vertices are vertices of the brushes
+            const VertexList& vertices = merged.vertices();
+            VertexList::const_iterator vIt, vEnd;
+            for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd; ++vIt) {
+                const Vec3f& position = (*vIt)->position;
+                if (findVertex(brush1.vertices(), position, Math<float>::PointStatusEpsilon) == NULL &&
+                    findVertex(brush2.vertices(), position, Math<float>::PointStatusEpsilon) == NULL)
+                    return NULL;
+            }
+            
+            // and it does not cover any space that is not covered by one of the brushes
+            float intersectionVolume = 0.0f;
+            if (!disjoint) {
+                ClipVolume intersection(m_worldBounds, m_forceIntegerFacePoints, brush1);
+                for (it = splitFaces.begin(), end = splitFaces.end(); it != end && intersection.valid(); ++it)
+                    intersection.clip(**it);
+                if (intersection.valid())
+                    intersectionVolume = intersection.volume();
+            }
+            
+            const float brushVolume1 = volume(brush1.faces(), brush1.center());
+            const float brushVolume2 = volume(brush2.faces(), brush2.center());
+            const float unionVolume = brushVolume1 + brushVolume2 - intersectionVolume;
+            if (std::abs(merged.volume() - unionVolume) > 0.001f * unionVolume)
+                return NULL;
+            
+            return merged.createBrush();
+        }
+        
+        BrushCSG::BrushCSG(const BBoxf& worldBounds, bool forceIntegerFacePoints) :
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints) {}
+        
+        bool BrushCSG::subtract(const Brush& minuend, const BrushList& subtrahends, BrushList& result) const {
+            bool touched = false;
+            BrushList fragments;
+            
+            BrushList::const_iterator it, end;
+            for (it = subtrahends.begin(), end = subtrahends.end(); it != end; ++it) {
+                const Brush& subtrahend = **it;
+                if (!touched) {
+                    if (subtrahend.bounds().intersects(minuend.bounds()))
+                        touched = subtract(minuend, subtrahend.faces(), subtrahend.vertices(), fragments);
+                } else {
+                    // only the fragments that the subtrahend intersects are replaced
+                    BrushList remainingFragments;
+                    BrushList::iterator fIt, fEnd;
+                    for (fIt = fragments.begin(), fEnd = fragments.end(); fIt != fEnd; ++fIt) {
+                        Brush* fragment = *fIt;
+                        if (subtrahend.bounds().intersects(fragment->bounds()) &&
+                            subtract(*fragment, subtrahend.faces(), subtrahend.vertices(), remainingFragments)) {
+                            delete fragment;
+                        } else {
+                            remainingFragments.push_back(fragment);
+                        }
+                    }
+                    fragments.swap(remainingFragments);
+                }
+            }
+            
+            result.insert(result.end(), fragments.begin(), fragments.end());
+            return touched;
+        }
+        
+        bool BrushCSG::merge(const BrushList& brushes, BrushList& removed, BrushList& result) const {
+            // no two brushes in this list can be merged, so every brush only needs to be tried against it once, and a
+            // merged brush only needs to be tried against the brushes that are left in it
+            BrushList current;
+            BrushSet merged;
+            
+            BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                Brush* candidate = *it;
+                size_t i = 0;
+                while (i < current.size()) {
+                    Brush* brush = merge(*current[i], *candidate);
+                    if (brush != NULL) {
+                        Brush* pair[2] = { current[i], candidate };
+                        for (size_t k = 0; k < 2; k++) {
+                            if (merged.erase(pair[k]) > 0)
+                                delete pair[k];
+                            else
+                                removed.push_back(pair[k]);
+                        }
+                        
+                        current.erase(current.begin() + static_cast<BrushList::difference_type>(i));
+                        merged.insert(brush);
+                        candidate = brush;
+                        i = 0;
+                    } else {
+                        i++;
+                    }
+                }
+                current.push_back(candidate);
+            }
+            
+            for (it = current.begin(), end = current.end(); it != end; ++it)
+                if (merged.count(*it) > 0)
+                    result.push_back(*it);
+            return !merged.empty();
+        }
+        
+        bool BrushCSG::hollow(const Brush& brush, float thickness, BrushList& result) const {
+            assert(thickness > 0.0f);
+            
+            FaceList innerFaces;
+            const FaceList& faces = brush.faces();
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                const Face& face = **it;
+                Face* innerFace = new Face(m_worldBounds, m_forceIntegerFacePoints, face);
+                innerFace->transform(translationMatrix(face.boundary().normal * -thickness), Mat4f::Identity, false, false);
+                innerFaces.push_back(innerFace);
+            }
+            
+            ClipVolume inner(m_worldBounds, m_forceIntegerFacePoints, innerFaces);
+            if (!inner.valid())
+                return false;
+            
+            return subtract(brush, inner.faces(), inner.vertices(), result);
+        }
+    }
+}
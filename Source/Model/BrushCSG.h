@@ -0,0 +1,75 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__BrushCSG__
+#define __TrenchBroom__BrushCSG__
+
+#include "Model/BrushGeometryTypes.h"
+#include "Model/BrushTypes.h"
+#include "Model/FaceTypes.h"
+#include "Utility/VecMath.h"
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class Face;
+        
+        /*
+         * Constructive solid geometry on convex brushes. All operations leave the given brushes untouched and return
+         * newly created brushes instead, so that the caller can replace the original brushes with undoable commands.
+         * The operations are built on clipping convex volumes with single planes, and brushes that are not touched by
+         * an operation are never copied or rebuilt.
+         */
+        class BrushCSG {
+        private:
+            const BBoxf& m_worldBounds;
+            bool m_forceIntegerFacePoints;
+            
+            bool subtract(const Brush& minuend, const FaceList& subtrahendFaces, const VertexList& subtrahendVertices, BrushList& result) const;
+            Brush* merge(const Brush& brush1, const Brush& brush2) const;
+        public:
+            BrushCSG(const BBoxf& worldBounds, bool forceIntegerFacePoints);
+            
+            /*
+             * Subtracts the given brushes from the given minuend. Returns false if none of the subtrahends intersects
+             * the minuend. Otherwise, returns true and adds the fragments of the minuend that lie outside of all
+             * subtrahends to the given result, which remains empty if the minuend is completely covered.
+             */
+            bool subtract(const Brush& minuend, const BrushList& subtrahends, BrushList& result) const;
+            
+            /*
+             * Merges the given brushes into as few convex brushes as possible. Two brushes are merged if their union is
+             * convex, that is, if it is bounded by their own face planes. Returns false if no brushes could be merged.
+             * Otherwise, returns true, adds the brushes that were merged to the given list of removed brushes and the
+             * merged brushes to the given result.
+             */
+            bool merge(const BrushList& brushes, BrushList& removed, BrushList& result) const;
+            
+            /*
+             * Hollows out the given brush by subtracting a copy whose faces are moved inward by the given thickness.
+             * Returns false if the brush is too thin to be hollowed.
+             */
+            bool hollow(const Brush& brush, float thickness, BrushList& result) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__BrushCSG__) */
@@ -22,11 +22,68 @@
 #include "Model/Face.h"
 #include "Utility/List.h"
 
-#include <map>
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <map>
+#include <numeric>
 
 namespace TrenchBroom {
     namespace Model {
+        namespace {
+            /*
+             * Returns the point where the segment from the given point below the plane to the given point above it
+             * crosses the plane. Both sides that share an edge compute the point from the same arguments, so that they
+             * yield exactly the same point.
+             */
+            inline Vec3f splitPoint(const Planef& plane, const Vec3f& below, const Vec3f& above) {
+                const float belowDistance = plane.pointDistance(below);
+                const float aboveDistance = plane.pointDistance(above);
+                return below + (above - below) * (belowDistance / (belowDistance - aboveDistance));
+            }
+
+            /*
+             * Keeps the polygon that was last appended to the given list if it has at least three vertices, and drops
+             * its vertices otherwise.
+             */
+            inline void closePolygon(SplitPolygons& polygons, const size_t begin, Face* face, const bool cap) {
+                if (polygons.vertices.size() - begin >= 3)
+                    polygons.addPolygon(face, cap);
+                else
+                    polygons.vertices.resize(begin);
+            }
+
+            inline bool equalPoints(const Vec3f& lhs, const Vec3f& rhs) {
+                return lhs.equals(rhs);
+            }
+
+            inline bool compareAngles(const std::pair<float, Vec3f>& lhs, const std::pair<float, Vec3f>& rhs) {
+                return lhs.first < rhs.first;
+            }
+
+            /*
+             * Sorts the given points of a convex polygon on the given plane so that they wind clockwise when viewed
+             * from above the plane, like the sides of a brush when viewed from outside.
+             */
+            void sortCapVertices(const Vec3f& normal, Vec3f::List& points) {
+                const Vec3f center = std::accumulate(points.begin(), points.end(), Vec3f::Null) / static_cast<float>(points.size());
+                const Vec3f xAxis = (points.front() - center).normalized();
+                const Vec3f yAxis = crossed(normal, xAxis);
+
+                std::vector<std::pair<float, Vec3f> > angles;
+                angles.reserve(points.size());
+                Vec3f::List::const_iterator it, end;
+                for (it = points.begin(), end = points.end(); it != end; ++it) {
+                    const Vec3f offset = *it - center;
+                    angles.push_back(std::make_pair(-std::atan2(offset.dot(yAxis), offset.dot(xAxis)), *it));
+                }
+
+                std::sort(angles.begin(), angles.end(), compareAngles);
+                for (size_t i = 0; i < angles.size(); i++)
+                    points[i] = angles[i].second;
+            }
+        }
+
         SideList Vertex::incidentSides(const EdgeList& edges) const {
             SideList result;
 
@@ -507,6 +564,38 @@ namespace TrenchBroom {
             m_droppedFaces.clear();
         }
 
+        BrushGeometry::DryRun::DryRun(const BrushGeometry& original) :
+        m_original(original),
+        m_geometry(new BrushGeometry(original)),
+        m_valid(false) {
+            // the working copy gets its own faces so that the operation does not change the points of the original faces
+            for (size_t i = 0; i < m_geometry->sides.size(); i++) {
+                Side* side = m_geometry->sides[i];
+                Face* originalFace = side->face;
+                Face* faceCopy = new Face(originalFace->worldBounds(), originalFace->forceIntegerFacePoints(), *originalFace);
+                m_originalFaces[faceCopy] = originalFace;
+                side->face = faceCopy;
+            }
+            m_geometry->restoreFaceSides();
+        }
+
+        BrushGeometry::DryRun::~DryRun() {
+            delete m_geometry;
+            m_geometry = NULL;
+
+            FaceMap::iterator it, end;
+            for (it = m_originalFaces.begin(), end = m_originalFaces.end(); it != end; ++it)
+                delete it->first;
+            m_originalFaces.clear();
+        }
+
+        Face* BrushGeometry::DryRun::originalFace(Face* face) const {
+            FaceMap::const_iterator it = m_originalFaces.find(face);
+            if (it == m_originalFaces.end())
+                return NULL;
+            return it->second;
+        }
+
         void BrushGeometry::deleteDegenerateTriangle(Side* side, Edge* edge, FaceManager& faceManager) {
             assert(side->edges.size() == 3);
 
@@ -1544,73 +1633,138 @@ namespace TrenchBroom {
             return vertex->incidentSides(edges);
         }
 
-        bool BrushGeometry::canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) {
-            FaceManager faceManager;
-
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
+        PointStatus::Type BrushGeometry::split(const Planef& plane, SplitPolygons& below, SplitPolygons& above) const {
+            below.clear();
+            above.clear();
 
-            Vec3f::List sortedVertexPositions = vertexPositions;
-            std::sort(sortedVertexPositions.begin(), sortedVertexPositions.end(), Vec3f::InverseDotOrder(delta));
+            size_t belowCount = 0;
+            size_t aboveCount = 0;
+            VertexList::const_iterator vertexIt, vertexEnd;
+            for (vertexIt = vertices.begin(), vertexEnd = vertices.end(); vertexIt != vertexEnd; ++vertexIt) {
+                const PointStatus::Type status = plane.pointStatus((*vertexIt)->position);
+                if (status == PointStatus::PSBelow)
+                    belowCount++;
+                else if (status == PointStatus::PSAbove)
+                    aboveCount++;
+            }
 
-            bool canMove = true;
-            Vec3f::List::const_iterator vertexIt, vertexEnd;
-            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd && canMove; ++vertexIt) {
-                const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
-                assert(vertex != NULL);
+            if (aboveCount == 0)
+                return PointStatus::PSBelow;
+            if (belowCount == 0)
+                return PointStatus::PSAbove;
+
+            below.capNormal = plane.normal;
+            above.capNormal = -plane.normal;
+
+            Face* belowCapFace = NULL;
+            Face* aboveCapFace = NULL;
+            float belowCapDiff = 0.0f;
+            float aboveCapDiff = 0.0f;
+            Vec3f::List capVertices;
+
+            SideList::const_iterator sideIt, sideEnd;
+            for (sideIt = sides.begin(), sideEnd = sides.end(); sideIt != sideEnd; ++sideIt) {
+                const Side& side = **sideIt;
+                Face* face = side.face;
+
+                const float belowDiff = (face->boundary().normal - below.capNormal).lengthSquared();
+                if (belowCapFace == NULL || belowDiff < belowCapDiff) {
+                    belowCapFace = face;
+                    belowCapDiff = belowDiff;
+                }
+                const float aboveDiff = (face->boundary().normal - above.capNormal).lengthSquared();
+                if (aboveCapFace == NULL || aboveDiff < aboveCapDiff) {
+                    aboveCapFace = face;
+                    aboveCapDiff = aboveDiff;
+                }
 
-                const Vec3f start = vertex->position;
-                const Vec3f end = start + delta;
+                const size_t belowBegin = below.vertices.size();
+                const size_t aboveBegin = above.vertices.size();
+                const size_t count = side.vertices.size();
+                for (size_t i = 0; i < count; i++) {
+                    const Vec3f& current = side.vertices[i]->position;
+                    const Vec3f& next = side.vertices[(i + 1) % count]->position;
+                    const PointStatus::Type currentStatus = plane.pointStatus(current);
+                    const PointStatus::Type nextStatus = plane.pointStatus(next);
+
+                    if (currentStatus != PointStatus::PSAbove)
+                        below.vertices.push_back(current);
+                    if (currentStatus != PointStatus::PSBelow)
+                        above.vertices.push_back(current);
+                    if (currentStatus == PointStatus::PSInside)
+                        capVertices.push_back(current);
+
+                    if ((currentStatus == PointStatus::PSBelow && nextStatus == PointStatus::PSAbove) ||
+                        (currentStatus == PointStatus::PSAbove && nextStatus == PointStatus::PSBelow)) {
+                        const Vec3f point = currentStatus == PointStatus::PSBelow ? splitPoint(plane, current, next) : splitPoint(plane, next, current);
+                        below.vertices.push_back(point);
+                        above.vertices.push_back(point);
+                        capVertices.push_back(point);
+                    }
+                }
 
-                MoveVertexResult result = testGeometry.moveVertex(vertex, true, start, end, faceManager);
-                canMove = result.type != MoveVertexResult::VertexUnchanged;
+                closePolygon(below, belowBegin, face, false);
+                closePolygon(above, aboveBegin, face, false);
             }
 
-            canMove &= testGeometry.sides.size() >= 3;
-            canMove &= worldBounds.contains(testGeometry.bounds);
+            // every point of the cap was found by both sides that share it
+            std::sort(capVertices.begin(), capVertices.end(), Vec3f::LexicographicOrder());
+            capVertices.erase(std::unique(capVertices.begin(), capVertices.end(), equalPoints), capVertices.end());
+            if (capVertices.size() >= 3) {
+                sortCapVertices(below.capNormal, capVertices);
+                const size_t belowBegin = below.vertices.size();
+                below.vertices.insert(below.vertices.end(), capVertices.begin(), capVertices.end());
+                closePolygon(below, belowBegin, belowCapFace, true);
+
+                const size_t aboveBegin = above.vertices.size();
+                above.vertices.insert(above.vertices.end(), capVertices.rbegin(), capVertices.rend());
+                closePolygon(above, aboveBegin, aboveCapFace, true);
+            }
 
-            restoreFaceSides();
-            return canMove;
+            return PointStatus::PSInside;
         }
 
-        Vec3f::List BrushGeometry::moveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canMoveVertices(worldBounds, vertexPositions, delta));
+        BrushGeometry::DryRun* BrushGeometry::dryRunMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) const {
+            DryRun* dryRun = new DryRun(*this);
+            BrushGeometry& testGeometry = *dryRun->m_geometry;
 
-            FaceManager faceManager;
-            VertexList movedVertices;
             Vec3f::List sortedVertexPositions = vertexPositions;
             std::sort(sortedVertexPositions.begin(), sortedVertexPositions.end(), Vec3f::InverseDotOrder(delta));
 
+            bool canMove = true;
+            VertexList movedVertices;
             Vec3f::List::const_iterator vertexIt, vertexEnd;
-            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
+            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd && canMove; ++vertexIt) {
                 const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(vertices, vertexPosition);
+                Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
                 assert(vertex != NULL);
 
                 const Vec3f start = vertex->position;
                 const Vec3f end = start + delta;
 
-                MoveVertexResult result = moveVertex(vertex, true, start, end, faceManager);
-                if (result.type == MoveVertexResult::VertexMoved)
-                    movedVertices.push_back(result.vertex);
-                updateFacePoints(faceManager);
+                MoveVertexResult result = testGeometry.moveVertex(vertex, true, start, end, dryRun->m_faceManager);
+                canMove = result.type != MoveVertexResult::VertexUnchanged;
+                if (canMove) {
+                    if (result.type == MoveVertexResult::VertexMoved)
+                        movedVertices.push_back(result.vertex);
+                    testGeometry.updateFacePoints(dryRun->m_faceManager);
+                }
             }
 
-            Vec3f::List newVertexPositions;
-            newVertexPositions.reserve(movedVertices.size());
-            for (unsigned int i = 0; i < movedVertices.size(); i++)
-                newVertexPositions.push_back(movedVertices[i]->position);
+            dryRun->m_newVertexPositions.reserve(movedVertices.size());
+            for (size_t i = 0; i < movedVertices.size(); i++)
+                dryRun->m_newVertexPositions.push_back(movedVertices[i]->position);
 
-            faceManager.getFaces(newFaces, droppedFaces);
-            return newVertexPositions;
+            canMove &= testGeometry.sides.size() >= 3;
+            canMove &= testGeometry.closed();
+            canMove &= worldBounds.contains(testGeometry.bounds);
+            dryRun->m_valid = canMove;
+            return dryRun;
         }
 
-        bool BrushGeometry::canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta) {
-            FaceManager faceManager;
-
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
+        BrushGeometry::DryRun* BrushGeometry::dryRunMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta) const {
+            DryRun* dryRun = new DryRun(*this);
+            BrushGeometry& testGeometry = *dryRun->m_geometry;
 
             Vec3f::List sortedVertexPositions;
             EdgeInfoList::const_iterator edgeIt, edgeEnd;
@@ -1623,81 +1777,39 @@ namespace TrenchBroom {
 
             bool canMove = true;
             Vec3f::List::const_iterator vertexIt, vertexEnd;
-            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
+            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd && canMove; ++vertexIt) {
                 const Vec3f& vertexPosition = *vertexIt;
                 Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
                 if (vertex == NULL) {
                     canMove = false;
-                    break;
-                }
-
-                const Vec3f start = vertex->position;
-                const Vec3f end = start + delta;
+                } else {
+                    const Vec3f start = vertex->position;
+                    const Vec3f end = start + delta;
 
-                MoveVertexResult result = testGeometry.moveVertex(vertex, false, start, end, faceManager);
-                if (result.type != MoveVertexResult::VertexMoved) {
-                    canMove = false;
-                    break;
+                    MoveVertexResult result = testGeometry.moveVertex(vertex, false, start, end, dryRun->m_faceManager);
+                    canMove = result.type == MoveVertexResult::VertexMoved;
+                    if (canMove)
+                        testGeometry.updateFacePoints(dryRun->m_faceManager);
                 }
             }
 
             for (edgeIt = edgeInfos.begin(), edgeEnd = edgeInfos.end(); edgeIt != edgeEnd && canMove; ++edgeIt) {
                 const EdgeInfo& edgeInfo = *edgeIt;
-                canMove = findEdge(testGeometry.edges, edgeInfo.start + delta, edgeInfo.end + delta) != NULL;
+                const EdgeInfo translated(edgeInfo.start + delta, edgeInfo.end + delta);
+                canMove = findEdge(testGeometry.edges, translated.start, translated.end) != NULL;
+                dryRun->m_newEdgeInfos.push_back(translated);
             }
 
             canMove &= testGeometry.sides.size() >= 3;
+            canMove &= testGeometry.closed();
             canMove &= worldBounds.contains(testGeometry.bounds);
-
-            restoreFaceSides();
-            return canMove;
+            dryRun->m_valid = canMove;
+            return dryRun;
         }
 
-        EdgeInfoList BrushGeometry::moveEdges(const BBoxf& worldBounds, const EdgeInfoList& i_edges, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canMoveEdges(worldBounds, i_edges, delta));
-
-            FaceManager faceManager;
-            Vec3f::List sortedVertexPositions;
-            EdgeInfoList::const_iterator edgeIt, edgeEnd;
-            for (edgeIt = i_edges.begin(), edgeEnd = i_edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                const EdgeInfo& edgeInfo = *edgeIt;
-                sortedVertexPositions.push_back(edgeInfo.start);
-                sortedVertexPositions.push_back(edgeInfo.end);
-            }
-            std::sort(sortedVertexPositions.begin(), sortedVertexPositions.end(), Vec3f::InverseDotOrder(delta));
-
-            Vec3f::List::const_iterator vertexIt, vertexEnd;
-            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
-                const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(vertices, vertexPosition);
-                assert(vertex != NULL);
-
-                const Vec3f start = vertex->position;
-                const Vec3f end = start + delta;
-
-                MoveVertexResult result = moveVertex(vertex, false, start, end, faceManager);
-                assert(result.type == MoveVertexResult::VertexMoved);
-                updateFacePoints(faceManager);
-            }
-
-            faceManager.getFaces(newFaces, droppedFaces);
-
-            EdgeInfoList result;
-            EdgeInfoList::const_iterator infoIt, infoEnd;
-            for (infoIt = i_edges.begin(), infoEnd = i_edges.end(); infoIt != infoEnd; ++infoIt) {
-                const EdgeInfo& info = *infoIt;
-                assert(findEdge(edges, info.start + delta, info.end + delta) != NULL);
-                result.push_back(EdgeInfo(info.start + delta, info.end + delta));
-            }
-
-            return result;
-        }
-
-        bool BrushGeometry::canMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta) {
-            FaceManager faceManager;
-
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
+        BrushGeometry::DryRun* BrushGeometry::dryRunMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta) const {
+            DryRun* dryRun = new DryRun(*this);
+            BrushGeometry& testGeometry = *dryRun->m_geometry;
 
             Vec3f::List sortedVertexPositions;
             FaceInfoList::const_iterator faceIt, faceEnd;
@@ -1711,84 +1823,44 @@ namespace TrenchBroom {
 
             bool canMove = true;
             Vec3f::List::const_iterator vertexIt, vertexEnd;
-            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
+            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd && canMove; ++vertexIt) {
                 const Vec3f& vertexPosition = *vertexIt;
                 Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
                 if (vertex == NULL) {
                     canMove = false;
-                    break;
-                }
-
-                const Vec3f start = vertex->position;
-                const Vec3f end = start + delta;
+                } else {
+                    const Vec3f start = vertex->position;
+                    const Vec3f end = start + delta;
 
-                MoveVertexResult result = testGeometry.moveVertex(vertex, false, start, end, faceManager);
-                if (result.type != MoveVertexResult::VertexMoved) {
-                    canMove = false;
-                    break;
+                    MoveVertexResult result = testGeometry.moveVertex(vertex, false, start, end, dryRun->m_faceManager);
+                    canMove = result.type == MoveVertexResult::VertexMoved;
                 }
             }
 
-            canMove &= testGeometry.sides.size() >= 3;
-            canMove &= worldBounds.contains(testGeometry.bounds);
+            if (canMove)
+                testGeometry.updateFacePoints(dryRun->m_faceManager);
 
-            for (faceIt = faceInfos.begin(), faceEnd = faceInfos.end(); faceIt != faceEnd; ++faceIt) {
+            for (faceIt = faceInfos.begin(), faceEnd = faceInfos.end(); faceIt != faceEnd && canMove; ++faceIt) {
                 const FaceInfo& faceInfo = *faceIt;
                 const FaceInfo translated = faceInfo.translated(delta);
                 canMove = findSide(testGeometry.sides, translated.vertices) != NULL;
+                dryRun->m_newFaceInfos.push_back(translated);
             }
 
-            restoreFaceSides();
-            return canMove;
+            canMove &= testGeometry.sides.size() >= 3;
+            canMove &= testGeometry.closed();
+            canMove &= worldBounds.contains(testGeometry.bounds);
+            dryRun->m_valid = canMove;
+            return dryRun;
         }
 
-        FaceInfoList BrushGeometry::moveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canMoveFaces(worldBounds, faceInfos, delta));
-
-            FaceManager faceManager;
-            Vec3f::List sortedVertexPositions;
-            FaceInfoList::const_iterator faceIt, faceEnd;
-            for (faceIt = faceInfos.begin(), faceEnd = faceInfos.end(); faceIt != faceEnd; ++faceIt) {
-                const FaceInfo& faceInfo = *faceIt;
-                Vec3f::List::const_iterator vertexIt, vertexEnd;
-                for (vertexIt = faceInfo.vertices.begin(), vertexEnd = faceInfo.vertices.end(); vertexIt != vertexEnd; ++vertexIt)
-                    sortedVertexPositions.push_back(*vertexIt);
-            }
-            std::sort(sortedVertexPositions.begin(), sortedVertexPositions.end(), Vec3f::InverseDotOrder(delta));
+        BrushGeometry::DryRun* BrushGeometry::dryRunSplitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta) const {
+            DryRun* dryRun = new DryRun(*this);
 
-            Vec3f::List::const_iterator vertexIt, vertexEnd;
-            for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
-                const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(vertices, vertexPosition);
-                assert(vertex != NULL);
-
-                const Vec3f start = vertex->position;
-                const Vec3f end = start + delta;
-
-                MoveVertexResult result = moveVertex(vertex, false, start, end, faceManager);
-                assert(result.type == MoveVertexResult::VertexMoved);
-            }
-
-            updateFacePoints(faceManager);
-            faceManager.getFaces(newFaces, droppedFaces);
-
-            FaceInfoList result;
-            for (faceIt = faceInfos.begin(), faceEnd = faceInfos.end(); faceIt != faceEnd; ++faceIt) {
-                const FaceInfo& faceInfo = *faceIt;
-                const FaceInfo translated = faceInfo.translated(delta);
-                Side* side = findSide(sides, translated.vertices);
-                assert(side != NULL);
-                assert(side->face != NULL);
-                result.push_back(translated);
-            }
-            return result;
-        }
-
-        bool BrushGeometry::canSplitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta) {
             // find the edge
-            Edge* edge = findEdge(edges, edgeInfo.start, edgeInfo.end);
+            const Edge* edge = findEdge(edges, edgeInfo.start, edgeInfo.end);
             if (edge == NULL)
-                return false;
+                return dryRun;
 
             // detect whether the drag would make the incident faces invalid
             const Vec3f& leftNorm = edge->left->face->boundary().normal;
@@ -1797,12 +1869,9 @@ namespace TrenchBroom {
             // we allow a bit more leeway when testing here, as otherwise edges sometimes cannot be split
             if (Math<float>::neg(delta.dot(leftNorm), 0.01f) ||
                 Math<float>::neg(delta.dot(rightNorm), 0.01f))
-                return false;
+                return dryRun;
 
-            FaceManager faceManager;
-
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
+            BrushGeometry& testGeometry = *dryRun->m_geometry;
 
             // The given edge is not an edge of testGeometry!
             Edge* testEdge = findEdge(testGeometry.edges, edgeInfo.start, edgeInfo.end);
@@ -1811,81 +1880,181 @@ namespace TrenchBroom {
             Vertex* newVertex = testGeometry.splitEdge(testEdge);
             const Vec3f start = newVertex->position;
             const Vec3f end = start + delta;
-            MoveVertexResult result = testGeometry.moveVertex(newVertex, false, start, end, faceManager);
+            MoveVertexResult result = testGeometry.moveVertex(newVertex, false, start, end, dryRun->m_faceManager);
             bool canSplit = result.type == MoveVertexResult::VertexMoved;
+            if (canSplit) {
+                testGeometry.updateFacePoints(dryRun->m_faceManager);
+                dryRun->m_newVertexPositions.push_back(result.vertex->position);
+            }
+
             canSplit &= testGeometry.sides.size() >= 3;
+            canSplit &= testGeometry.closed();
             canSplit &= worldBounds.contains(testGeometry.bounds);
-
-            restoreFaceSides();
-            return canSplit;
+            dryRun->m_valid = canSplit;
+            return dryRun;
         }
 
-        Vec3f BrushGeometry::splitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canSplitEdge(worldBounds, edgeInfo, delta));
-
-            Edge* edge = findEdge(edges, edgeInfo.start, edgeInfo.end);
+        BrushGeometry::DryRun* BrushGeometry::dryRunSplitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta) const {
+            DryRun* dryRun = new DryRun(*this);
 
-            FaceManager faceManager;
-            Vertex* newVertex = splitEdge(edge);
-            const Vec3f start = newVertex->position;
-            const Vec3f end = start + delta;
-            MoveVertexResult result = moveVertex(newVertex, false, start, end, faceManager);
-            assert(result.type == MoveVertexResult::VertexMoved);
-
-            updateFacePoints(faceManager);
-            faceManager.getFaces(newFaces, droppedFaces);
-            return result.vertex->position;
-        }
-
-        bool BrushGeometry::canSplitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta) {
-            Side* side = findSide(sides, faceInfo.vertices);
+            const Side* side = findSide(sides, faceInfo.vertices);
             if (side == NULL)
-                return false;
+                return dryRun;
 
-            Face* face = side->face;
+            const Face* face = side->face;
             assert(face != NULL);
 
             // detect whether the drag would lead to an indented face
             const Vec3f& norm = face->boundary().normal;
             if (Math<float>::zero(delta.dot(norm)))
-                return false;
+                return dryRun;
 
-            FaceManager faceManager;
+            BrushGeometry& testGeometry = *dryRun->m_geometry;
 
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
+            // The given face is not a face of testGeometry!
+            Side* testSide = findSide(testGeometry.sides, faceInfo.vertices);
+            assert(testSide != NULL);
 
-            Vertex* newVertex = testGeometry.splitFace(face, faceManager);
+            Vertex* newVertex = testGeometry.splitFace(testSide->face, dryRun->m_faceManager);
             const Vec3f start = newVertex->position;
             const Vec3f end = start + delta;
-            MoveVertexResult result = testGeometry.moveVertex(newVertex, false, start, end, faceManager);
+            MoveVertexResult result = testGeometry.moveVertex(newVertex, false, start, end, dryRun->m_faceManager);
             bool canSplit = result.type == MoveVertexResult::VertexMoved;
+            if (canSplit) {
+                testGeometry.updateFacePoints(dryRun->m_faceManager);
+                dryRun->m_newVertexPositions.push_back(result.vertex->position);
+            }
+
             canSplit &= testGeometry.sides.size() >= 3;
+            canSplit &= testGeometry.closed();
             canSplit &= worldBounds.contains(testGeometry.bounds);
+            dryRun->m_valid = canSplit;
+            return dryRun;
+        }
 
+        void BrushGeometry::commit(DryRun& dryRun, FaceSet& newFaces, FaceSet& droppedFaces) {
+            assert(&dryRun.m_original == this);
+            assert(dryRun.valid());
+
+            // the original faces take over the points of their copies and replace them in the working copy
+            BrushGeometry& geometry = *dryRun.m_geometry;
+            for (size_t i = 0; i < geometry.sides.size(); i++) {
+                Side* side = geometry.sides[i];
+                Face* original = dryRun.originalFace(side->face);
+                if (original != NULL) {
+                    Vec3f point1, point2, point3;
+                    side->face->getPoints(point1, point2, point3);
+                    original->setPoints(point1, point2, point3);
+                    side->face = original;
+                }
+            }
+
+            // the working copy takes our old vertices, edges and sides with it when the dry run is deleted
+            vertices.swap(geometry.vertices);
+            edges.swap(geometry.edges);
+            sides.swap(geometry.sides);
+            std::swap(center, geometry.center);
+            std::swap(bounds, geometry.bounds);
             restoreFaceSides();
+
+            FaceSet droppedCopies;
+            dryRun.m_faceManager.getFaces(newFaces, droppedCopies);
+
+            droppedFaces.clear();
+            FaceSet::const_iterator faceIt, faceEnd;
+            for (faceIt = droppedCopies.begin(), faceEnd = droppedCopies.end(); faceIt != faceEnd; ++faceIt) {
+                Face* original = dryRun.originalFace(*faceIt);
+                assert(original != NULL);
+                original->setSide(NULL);
+                droppedFaces.insert(original);
+            }
+
+            dryRun.m_valid = false;
+        }
+
+        bool BrushGeometry::canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) const {
+            DryRun* dryRun = dryRunMoveVertices(worldBounds, vertexPositions, delta);
+            const bool canMove = dryRun->valid();
+            delete dryRun;
+            return canMove;
+        }
+
+        Vec3f::List BrushGeometry::moveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
+            DryRun* dryRun = dryRunMoveVertices(worldBounds, vertexPositions, delta);
+            assert(dryRun->valid());
+
+            commit(*dryRun, newFaces, droppedFaces);
+            const Vec3f::List newVertexPositions = dryRun->newVertexPositions();
+            delete dryRun;
+            return newVertexPositions;
+        }
+
+        bool BrushGeometry::canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta) const {
+            DryRun* dryRun = dryRunMoveEdges(worldBounds, edgeInfos, delta);
+            const bool canMove = dryRun->valid();
+            delete dryRun;
+            return canMove;
+        }
+
+        EdgeInfoList BrushGeometry::moveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
+            DryRun* dryRun = dryRunMoveEdges(worldBounds, edgeInfos, delta);
+            assert(dryRun->valid());
+
+            commit(*dryRun, newFaces, droppedFaces);
+            const EdgeInfoList newEdgeInfos = dryRun->newEdgeInfos();
+            delete dryRun;
+            return newEdgeInfos;
+        }
+
+        bool BrushGeometry::canMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta) const {
+            DryRun* dryRun = dryRunMoveFaces(worldBounds, faceInfos, delta);
+            const bool canMove = dryRun->valid();
+            delete dryRun;
+            return canMove;
+        }
+
+        FaceInfoList BrushGeometry::moveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
+            DryRun* dryRun = dryRunMoveFaces(worldBounds, faceInfos, delta);
+            assert(dryRun->valid());
+
+            commit(*dryRun, newFaces, droppedFaces);
+            const FaceInfoList newFaceInfos = dryRun->newFaceInfos();
+            delete dryRun;
+            return newFaceInfos;
+        }
+
+        bool BrushGeometry::canSplitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta) const {
+            DryRun* dryRun = dryRunSplitEdge(worldBounds, edgeInfo, delta);
+            const bool canSplit = dryRun->valid();
+            delete dryRun;
             return canSplit;
         }
 
-        Vec3f BrushGeometry::splitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canSplitFace(worldBounds, faceInfo, delta));
+        Vec3f BrushGeometry::splitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
+            DryRun* dryRun = dryRunSplitEdge(worldBounds, edgeInfo, delta);
+            assert(dryRun->valid());
 
-            Side* side = findSide(sides, faceInfo.vertices);
-            assert(side != NULL);
+            commit(*dryRun, newFaces, droppedFaces);
+            const Vec3f newVertexPosition = dryRun->newVertexPositions().front();
+            delete dryRun;
+            return newVertexPosition;
+        }
 
-            Face* face = side->face;
-            assert(face != NULL);
+        bool BrushGeometry::canSplitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta) const {
+            DryRun* dryRun = dryRunSplitFace(worldBounds, faceInfo, delta);
+            const bool canSplit = dryRun->valid();
+            delete dryRun;
+            return canSplit;
+        }
 
-            FaceManager faceManager;
-            Vertex* newVertex = splitFace(face, faceManager);
-            const Vec3f start = newVertex->position;
-            const Vec3f end = start + delta;
-            MoveVertexResult result = moveVertex(newVertex, false, start, end, faceManager);
-            assert(result.type == MoveVertexResult::VertexMoved);
+        Vec3f BrushGeometry::splitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
+            DryRun* dryRun = dryRunSplitFace(worldBounds, faceInfo, delta);
+            assert(dryRun->valid());
 
-            updateFacePoints(faceManager);
-            faceManager.getFaces(newFaces, droppedFaces);
-            return result.vertex->position;
+            commit(*dryRun, newFaces, droppedFaces);
+            const Vec3f newVertexPosition = dryRun->newVertexPositions().front();
+            delete dryRun;
+            return newVertexPosition;
         }
 
         Vertex* findVertex(const VertexList& vertices, const Vec3f& position, float epsilon) {
@@ -318,7 +318,53 @@ namespace TrenchBroom {
                 void dropFace(Side* side);
                 void getFaces(FaceSet& newFaces, FaceSet& droppedFaces);
             };
+        public:
+            /*
+             * The result of a vertex operation on a working copy of a geometry. The working copy has its own copies of
+             * the faces, so neither the original geometry nor its faces are changed by a dry run. A dry run can be
+             * discarded by deleting it, or it can be committed to the geometry it was made from, which is then the same
+             * as if the operation had been performed directly.
+             */
+            class DryRun {
+            private:
+                typedef std::map<Face*, Face*> FaceMap;
+
+                const BrushGeometry& m_original;
+                BrushGeometry* m_geometry;
+                FaceMap m_originalFaces;
+                FaceManager m_faceManager;
+                Vec3f::List m_newVertexPositions;
+                EdgeInfoList m_newEdgeInfos;
+                FaceInfoList m_newFaceInfos;
+                bool m_valid;
+
+                DryRun(const BrushGeometry& original);
+                DryRun(const DryRun& other);
+                DryRun& operator=(const DryRun& other);
+
+                Face* originalFace(Face* face) const;
+
+                friend class BrushGeometry;
+            public:
+                ~DryRun();
+
+                inline bool valid() const {
+                    return m_valid;
+                }
 
+                inline const Vec3f::List& newVertexPositions() const {
+                    return m_newVertexPositions;
+                }
+
+                inline const EdgeInfoList& newEdgeInfos() const {
+                    return m_newEdgeInfos;
+                }
+
+                inline const FaceInfoList& newFaceInfos() const {
+                    return m_newFaceInfos;
+                }
+            };
+        private:
             void deleteDegenerateTriangle(Side* side, Edge* edge, FaceManager& faceManager);
             void mergeEdges();
             void mergeNeighbours(Side* side, size_t edgeIndex, FaceManager& faceManager);
@@ -355,19 +401,35 @@ namespace TrenchBroom {
 
             SideList incidentSides(const Vertex* vertex);
 
-            bool canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta);
+            /*
+             * Splits this geometry by the given plane without changing it. If the plane cuts through the geometry, the
+             * polygons of the parts below and above the plane are stored in the given lists and PSInside is returned.
+             * Otherwise, the lists are left empty and the side of the plane that the whole geometry lies on is returned.
+             */
+            PointStatus::Type split(const Planef& plane, SplitPolygons& below, SplitPolygons& above) const;
+
+            DryRun* dryRunMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) const;
+            DryRun* dryRunMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta) const;
+            DryRun* dryRunMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta) const;
+            DryRun* dryRunSplitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta) const;
+            DryRun* dryRunSplitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta) const;
+            void commit(DryRun& dryRun, FaceSet& newFaces, FaceSet& droppedFaces);
+
+            bool canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) const;
             Vec3f::List moveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
-            bool canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta);
+            bool canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta) const;
             EdgeInfoList moveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
-            bool canMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta);
+            bool canMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta) const;
             FaceInfoList moveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
 
-            bool canSplitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta);
+            bool canSplitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta) const;
             Vec3f splitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
-            bool canSplitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta);
+            bool canSplitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta) const;
             Vec3f splitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
         };
 
+        typedef std::vector<BrushGeometry::DryRun*> DryRunList;
+
         template <class T>
         inline size_t findElement(const std::vector<T*>& vec, const T* element) {
 //            return vec.find(element) - vec.begin();
@@ -103,6 +103,51 @@ namespace TrenchBroom {
         typedef std::vector<EdgeInfo> EdgeInfoList;
         typedef std::vector<FaceInfo> FaceInfoList;
 
+        /*
+         * The polygons of one part of a brush that was split by a plane, see BrushGeometry::split. The vertices of all
+         * polygons are stored in one list, in the same winding order as the sides of the brush. Every polygon keeps
+         * the face it was cut from. The cap, which closes the part on the splitting plane, keeps the face whose
+         * normal is closest to the cap normal instead, just like a clipped brush takes the attributes of its new face
+         * from that face.
+         */
+        struct SplitPolygons {
+            struct Polygon {
+                Face* face;
+                size_t end;
+                bool cap;
+            };
+
+            typedef std::vector<Polygon> PolygonList;
+
+            Vec3f::List vertices;
+            PolygonList polygons;
+            Vec3f capNormal;
+
+            inline void clear() {
+                vertices.clear();
+                polygons.clear();
+            }
+
+            inline bool empty() const {
+                return polygons.empty();
+            }
+
+            inline size_t begin(const size_t index) const {
+                return index == 0 ? 0 : polygons[index - 1].end;
+            }
+
+            inline void addPolygon(Face* face, const bool cap) {
+                Polygon polygon;
+                polygon.face = face;
+                polygon.end = vertices.size();
+                polygon.cap = cap;
+                polygons.push_back(polygon);
+            }
+        };
+
+        typedef std::vector<const SplitPolygons*> SplitPolygonsList;
+        static const SplitPolygonsList EmptySplitPolygonsList;
+
         typedef std::map<Vec3f, Model::BrushList, Vec3f::LexicographicOrder> VertexToBrushesMap;
         typedef std::map<Vec3f, Model::EdgeList, Vec3f::LexicographicOrder> VertexToEdgesMap;
         typedef std::map<Vec3f, Model::FaceList, Vec3f::LexicographicOrder> VertexToFacesMap;
@@ -21,7 +21,9 @@
 
 #include "IO/IOUtils.h"
 #include "Utility/List.h"
+#include "Utility/Profiler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <numeric>
@@ -39,25 +41,6 @@ namespace TrenchBroom {
             m_image = NULL;
         }
 
-        BspFace::BspFace(BspTextureInfo* textureInfo, const Vec3f::List& vertices) :
-        m_textureInfo(textureInfo),
-        m_vertices(vertices) {
-            m_bounds.min = m_bounds.max = m_vertices.front();
-
-            for (unsigned int i = 1; i < m_vertices.size(); i++)
-                m_bounds.mergeWith(m_vertices[i]);
-        }
-
-        BspModel::BspModel(const BspFaceList& faces, unsigned int vertexCount, const Vec3f& center, const BBoxf& bounds) :
-        m_faces(faces),
-        m_vertexCount(vertexCount),
-        m_center(center),
-        m_bounds(bounds) {}
-
-        BspModel::~BspModel() {
-            Utility::deleteAll(m_faces);
-        }
-
         void Bsp::readTextures(char*& cursor, unsigned int count) {
             using namespace IO;
             
@@ -84,75 +67,24 @@ namespace TrenchBroom {
             }
         }
 
-        void Bsp::readTextureInfos(char*& cursor, unsigned int count, std::vector<BspTexture*>& textures) {
+        void Bsp::readTextureInfos(char*& cursor, unsigned int count, BspTextureInfoList& textureInfos) {
             using namespace IO;
             
+            textureInfos.resize(count);
             for (unsigned int i = 0; i < count; i++) {
-                BspTextureInfo* textureInfo = new BspTextureInfo();
-                textureInfo->sAxis = readVec3f(cursor);
-                textureInfo->sOffset = readFloat<float>(cursor);
-                textureInfo->tAxis = readVec3f(cursor);
-                textureInfo->tOffset = readFloat<float>(cursor);
-
-                unsigned int textureIndex = readUnsignedInt<uint32_t>(cursor);
-                textureInfo->texture = textures[textureIndex];
-
-                m_textureInfos[i] = textureInfo;
+                BspTextureInfo& textureInfo = textureInfos[i];
+                textureInfo.sAxis = readVec3f(cursor);
+                textureInfo.sOffset = readFloat<float>(cursor);
+                textureInfo.tAxis = readVec3f(cursor);
+                textureInfo.tOffset = readFloat<float>(cursor);
+                textureInfo.textureIndex = readUnsignedInt<uint32_t>(cursor);
                 cursor += BspLayout::TexInfoRest;
             }
         }
 
-        void Bsp::readVertices(char*& cursor, unsigned int count, Vec3f::List& vertices) {
-            using namespace IO;
-            
-            vertices.reserve(count);
-            for (unsigned int i = 0; i < count; i++) {
-                Vec3f vertex = readVec3f(cursor);
-                vertices.push_back(vertex);
-            }
-        }
-
-        void Bsp::readEdges(char*& cursor, unsigned int count, BspEdgeInfoList& edges) {
-            using namespace IO;
-            
-            edges.reserve(count);
-            BspEdgeInfo edgeInfo;
-            for (unsigned int i = 0; i < count; i++) {
-                edgeInfo.vertex0 = readUnsignedInt<uint16_t>(cursor);
-                edgeInfo.vertex1 = readUnsignedInt<uint16_t>(cursor);
-                edges.push_back(edgeInfo);
-            }
-        }
-
-        void Bsp::readFaces(char*& cursor, unsigned int count, BspFaceInfoList& faces) {
-            using namespace IO;
-            
-            faces.reserve(count);
-            BspFaceInfo face;
-            for (unsigned int i = 0; i < count; i++) {
-                cursor += BspLayout::FaceEdgeIndex;
-
-                face.edgeIndex = readUnsignedInt<int32_t>(cursor);
-                face.edgeCount = readUnsignedInt<uint16_t>(cursor);
-                face.textureInfoIndex = readUnsignedInt<uint16_t>(cursor);
-                faces.push_back(face);
-
-                cursor += BspLayout::FaceRest;
-            }
-        }
-
-        void Bsp::readFaceEdges(char*& cursor, unsigned int count, BspFaceEdgeIndexList& indices) {
-            using namespace IO;
-            
-            indices.reserve(count);
-            for (unsigned int i = 0; i < count; i++) {
-                int index = readInt<int32_t>(cursor);
-                indices.push_back(index);
-            }
-        }
-
         Bsp::Bsp(const String& name, char* begin, char* end) :
         m_name(name) {
+            TB_PROFILE_ZONE("Bsp::Bsp");
             using namespace IO;
             
             char* cursor = begin;
@@ -170,149 +102,126 @@ namespace TrenchBroom {
             int texInfosAddr = readInt<int32_t>(cursor);
             unsigned int texInfosLength = readUnsignedInt<int32_t>(cursor);
             unsigned int texInfoCount = texInfosLength / BspLayout::TexInfoSize;
-            m_textureInfos.resize(texInfoCount);
+            BspTextureInfoList textureInfos;
             cursor = begin + texInfosAddr;
-            readTextureInfos(cursor, texInfoCount, m_textures);
+            readTextureInfos(cursor, texInfoCount, textureInfos);
 
+            // the geometry lumps are not copied, the models read their vertices directly from the file
             cursor = begin + BspLayout::DirVerticesAddress;
-            int verticesAddr = readInt<int32_t>(cursor);
-            unsigned int verticesLength = readUnsignedInt<int32_t>(cursor);
-            unsigned int vertexCount = verticesLength / sizeof(Vec3f);
-            Vec3f::List vertices;
-            cursor = begin + verticesAddr;
-            readVertices(cursor, vertexCount, vertices);
-
+            char* vertices = begin + readInt<int32_t>(cursor);
+            unsigned int vertexCount = readUnsignedInt<int32_t>(cursor) / BspLayout::VertexSize;
+            
             cursor = begin + BspLayout::DirEdgesAddress;
-            int edgesAddr = readInt<int32_t>(cursor);
-            unsigned int edgesLength = readUnsignedInt<int32_t>(cursor);
-            unsigned int edgeCount = edgesLength / (2 * sizeof(uint16_t));
-            BspEdgeInfoList edges;
-            cursor = begin + edgesAddr;
-            readEdges(cursor, edgeCount, edges);
+            char* edges = begin + readInt<int32_t>(cursor);
 
             cursor = begin + BspLayout::DirFacesAddress;
-            int facesAddr = readInt<int32_t>(cursor);
-            unsigned int facesLength = readUnsignedInt<int32_t>(cursor);
-            unsigned int faceCount = facesLength / BspLayout::FaceSize;
-            BspFaceInfoList faces;
-            cursor = begin + facesAddr;
-            readFaces(cursor, faceCount, faces);
+            char* faces = begin + readInt<int32_t>(cursor);
 
             cursor = begin + BspLayout::DirFaceEdgesAddress;
-            int faceEdgesAddr = readInt<int32_t>(cursor);
-            unsigned int faceEdgesLength = readUnsignedInt<int32_t>(cursor);
-            unsigned int faceEdgesCount = faceEdgesLength / BspLayout::FaceEdgeSize;
-            BspFaceEdgeIndexList faceEdges;
-            cursor = begin + faceEdgesAddr;
-            readFaceEdges(cursor, faceEdgesCount, faceEdges);
+            char* faceEdges = begin + readInt<int32_t>(cursor);
 
             cursor = begin + BspLayout::DirModelAddress;
-            int modelsAddr = readInt<int32_t>(cursor);
-            unsigned int modelsLength = readUnsignedInt<int32_t>(cursor);
-            unsigned int modelCount = modelsLength / BspLayout::ModelSize;
+            char* models = begin + readInt<int32_t>(cursor);
+            unsigned int modelCount = readUnsignedInt<int32_t>(cursor) / BspLayout::ModelSize;
 
-            typedef std::vector<bool> MarkList;
-            MarkList vertexMarks;
-            vertexMarks.resize(vertexCount);
-            for (unsigned int i = 0; i < vertexCount; i++) vertexMarks[i] = false;
-            
-            typedef std::vector<unsigned int> ModelVertexIndexList;
-            ModelVertexIndexList modelVertices;
-            modelVertices.resize(vertexCount);
+            std::vector<bool> vertexMarks(vertexCount, false);
+            std::vector<unsigned int> modelVertices;
+            BspFaceInfoList faceInfos;
 
-            cursor = begin + modelsAddr;
             for (unsigned int i = 0; i < modelCount; i++) {
-                cursor += BspLayout::ModelFaceIndex;
+                cursor = models + i * BspLayout::ModelSize + BspLayout::ModelFaceIndex;
                 unsigned int modelFaceIndex = readUnsignedInt<int32_t>(cursor);
                 unsigned int modelFaceCount = readUnsignedInt<int32_t>(cursor);
                 
                 unsigned int totalVertexCount = 0;
-                unsigned int modelVertexCount = 0;
-
-                BspFaceList bspFaces;
-                for (unsigned int j = 0; j < static_cast<unsigned int>(modelFaceCount); j++) {
-                    BspFaceInfo& faceInfo = faces[modelFaceIndex + j];
-                    BspTextureInfo* textureInfo = m_textureInfos[faceInfo.textureInfoIndex];
-
-                    unsigned int faceVertexCount = faceInfo.edgeCount;
-                    std::vector<Vec3f> faceVertices;
+                faceInfos.resize(modelFaceCount);
+                for (unsigned int j = 0; j < modelFaceCount; j++) {
+                    cursor = faces + (modelFaceIndex + j) * BspLayout::FaceSize + BspLayout::FaceEdgeIndex;
+                    BspFaceInfo& faceInfo = faceInfos[j];
+                    faceInfo.edgeIndex = readUnsignedInt<int32_t>(cursor);
+                    faceInfo.edgeCount = readUnsignedInt<uint16_t>(cursor);
+                    faceInfo.textureInfo = &textureInfos[readUnsignedInt<uint16_t>(cursor)];
+                    faceInfo.textureIndex = faceInfo.textureInfo->textureIndex;
+                    totalVertexCount += faceInfo.edgeCount;
+                }
+                std::stable_sort(faceInfos.begin(), faceInfos.end());
+                
+                BspModel* model = new BspModel();
+                model->m_vertices.reserve(totalVertexCount);
+                model->m_faces.reserve(modelFaceCount);
+                modelVertices.clear();
+                
+                for (unsigned int j = 0; j < modelFaceCount; j++) {
+                    const BspFaceInfo& faceInfo = faceInfos[j];
+                    const BspTextureInfo& textureInfo = *faceInfo.textureInfo;
+                    const BspTexture& texture = *m_textures[faceInfo.textureIndex];
+                    const float width = static_cast<float>(texture.width());
+                    const float height = static_cast<float>(texture.height());
+                    
+                    BspFace face;
+                    face.textureIndex = faceInfo.textureIndex;
+                    face.vertexIndex = static_cast<unsigned int>(model->m_vertices.size());
+                    face.vertexCount = faceInfo.edgeCount;
+                    model->m_faces.push_back(face);
+                    
                     for (unsigned int k = 0; k < faceInfo.edgeCount; k++) {
-                        int faceEdgeIndex = faceEdges[faceInfo.edgeIndex + k];
-                        unsigned int vertexIndex;
+                        cursor = faceEdges + (faceInfo.edgeIndex + k) * BspLayout::FaceEdgeSize;
+                        int faceEdgeIndex = readInt<int32_t>(cursor);
                         if (faceEdgeIndex < 0)
-                            vertexIndex = edges[static_cast<size_t>(-faceEdgeIndex)].vertex1;
+                            cursor = edges + static_cast<size_t>(-faceEdgeIndex) * BspLayout::EdgeSize + sizeof(uint16_t);
                         else
-                            vertexIndex = edges[static_cast<size_t>(faceEdgeIndex)].vertex0;
+                            cursor = edges + static_cast<size_t>(faceEdgeIndex) * BspLayout::EdgeSize;
+                        unsigned int vertexIndex = readUnsignedInt<uint16_t>(cursor);
+                        
+                        cursor = vertices + vertexIndex * BspLayout::VertexSize;
+                        BspVertex vertex;
+                        vertex.position = readVec3f(cursor);
+                        vertex.texCoords[0] = (vertex.position.dot(textureInfo.sAxis) + textureInfo.sOffset) / width;
+                        vertex.texCoords[1] = (vertex.position.dot(textureInfo.tAxis) + textureInfo.tOffset) / height;
+                        model->m_vertices.push_back(vertex);
                         
-                        faceVertices.push_back(vertices[vertexIndex]);
                         if (!vertexMarks[vertexIndex]) {
                             vertexMarks[vertexIndex] = true;
-                            modelVertices[modelVertexCount++] = vertexIndex;
+                            modelVertices.push_back(vertexIndex);
+                            if (modelVertices.size() == 1) {
+                                model->m_center = vertex.position;
+                                model->m_bounds.min = model->m_bounds.max = vertex.position;
+                            } else {
+                                model->m_center += vertex.position;
+                                model->m_bounds.mergeWith(vertex.position);
+                            }
                         }
                     }
-
-                    BspFace* bspFace = new BspFace(textureInfo, faceVertices);
-                    bspFaces.push_back(bspFace);
-                    totalVertexCount += static_cast<unsigned int>(faceVertexCount);
                 }
+                
+                for (unsigned int j = 0; j < modelVertices.size(); j++)
+                    vertexMarks[modelVertices[j]] = false;
+                if (!modelVertices.empty())
+                    model->m_center /= static_cast<float>(modelVertices.size());
 
-                Vec3f center;
-                BBoxf bounds;
-
-                center = vertices[modelVertices[0]];
-                bounds.min = vertices[modelVertices[0]];
-                bounds.max = vertices[modelVertices[0]];
-
-                for (unsigned int j = 1; j < modelVertexCount; j++) {
-                    unsigned int vertexIndex = modelVertices[j];
-                    center += vertices[vertexIndex];
-                    bounds.mergeWith(vertices[vertexIndex]);
-                    vertexMarks[vertexIndex] = false;
-                }
-
-                center /= static_cast<float>(modelVertexCount);
-
-                BspModel* bspModel = new BspModel(bspFaces, totalVertexCount, center, bounds);
-                m_models.push_back(bspModel);
+                m_models.push_back(model);
             }
         }
 
         Bsp::~Bsp() {
-            Utility::deleteAll(m_textureInfos);
             Utility::deleteAll(m_textures);
             Utility::deleteAll(m_models);
         }
 
-        BspManager* BspManager::sharedManager = NULL;
-
-        const Bsp* BspManager::bsp(const String& name, const StringList& paths, Utility::Console& console) {
-            String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
-
-            BspMap::iterator it = m_bsps.find(key);
-            if (it != m_bsps.end())
-                return it->second;
-
-            console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
-
-            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
-            if (file.get() != NULL) {
-                Bsp* bsp = new Bsp(name, file->begin(), file->end());
-                m_bsps[key] = bsp;
-                return bsp;
+        size_t Bsp::memorySize() const {
+            size_t size = sizeof(Bsp);
+            for (size_t i = 0; i < m_textures.size(); i++)
+                size += sizeof(BspTexture) + m_textures[i]->width() * m_textures[i]->height();
+            for (size_t i = 0; i < m_models.size(); i++) {
+                const BspModel& model = *m_models[i];
+                size += sizeof(BspModel) + model.faces().size() * sizeof(BspFace) + model.vertices().size() * sizeof(BspVertex);
             }
-
-            console.warn("Unable to find BSP '%s'", name.c_str());
-            return NULL;
+            return size;
         }
 
-        BspManager::BspManager() {}
+        BspManager* BspManager::sharedManager = NULL;
 
-        BspManager::~BspManager() {
-            BspMap::iterator it, end;
-            for (it = m_bsps.begin(), end = m_bsps.end(); it != end; ++it)
-                delete it->second;
-            m_bsps.clear();
-        }
+        BspManager::BspManager() :
+        ModelManager<Bsp>("BSP", 32 * 1024 * 1024) {}
     }
 }
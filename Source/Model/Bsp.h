@@ -21,7 +21,9 @@
 #define TrenchBroom_Bsp_h
 
 #include "IO/Pak.h"
+#include "Model/ModelManager.h"
 #include "Utility/Console.h"
+#include "Utility/SharedPointer.h"
 #include "Utility/VecMath.h"
 
 #include <istream>
@@ -63,6 +65,8 @@ namespace TrenchBroom {
             static const unsigned int TexInfoSize           = 0x28;
             static const unsigned int TexInfoRest           = 0x4;
 
+            static const unsigned int VertexSize            = 0xC;
+            static const unsigned int EdgeSize              = 0x4;
             static const unsigned int FaceEdgeSize          = 0x4;
             static const unsigned int ModelSize             = 0x40;
             static const unsigned int ModelOrigin           = 0x18;
@@ -70,27 +74,25 @@ namespace TrenchBroom {
             static const unsigned int ModelFaceCount        = 0x3c;
         }
         
-        class BspEdgeInfo {
-        public:
-            unsigned int vertex0;
-            unsigned int vertex1;
-        };
-        
-        class BspTexture;
         class BspTextureInfo {
         public:
             Vec3f sAxis;
             Vec3f tAxis;
             float sOffset;
             float tOffset;
-            BspTexture* texture;
+            unsigned int textureIndex;
         };
         
         class BspFaceInfo {
         public:
             unsigned int edgeIndex;
             unsigned int edgeCount;
-            unsigned int textureInfoIndex;
+            unsigned int textureIndex;
+            const BspTextureInfo* textureInfo;
+            
+            inline bool operator<(const BspFaceInfo& other) const {
+                return textureIndex < other.textureIndex;
+            }
         };
         
         class BspTexture {
@@ -120,45 +122,51 @@ namespace TrenchBroom {
             }
         };
         
+        typedef std::vector<BspTexture*> BspTextureList;
+        
+        /*
+         * The memory layout matches the vertex attributes of the model renderer, so the vertices can be copied into a
+         * VBO as they are.
+         */
+        class BspVertex {
+        public:
+            Vec3f position;
+            Vec2f texCoords;
+        };
+        
+        typedef std::vector<BspVertex> BspVertexList;
+        
+        /*
+         * A face is a convex polygon made of the vertexCount consecutive vertices of its model, starting at vertexIndex,
+         * and can be rendered as a triangle fan.
+         */
         class BspFace {
-            BBoxf m_bounds;
-            BspTextureInfo* m_textureInfo;
-            Vec3f::List m_vertices;
         public:
-            BspFace(BspTextureInfo* textureInfo, const Vec3f::List& vertices);
-
-            inline void textureCoordinates(const Vec3f& vertex, Vec2f& result) const {
-                result[0] = (vertex.dot(m_textureInfo->sAxis) + m_textureInfo->sOffset) / m_textureInfo->texture->width();
-                result[1] = (vertex.dot(m_textureInfo->tAxis) + m_textureInfo->tOffset) / m_textureInfo->texture->height();
-            }
-            
-            inline const BspTexture& texture() const {
-                return *m_textureInfo->texture;
-            }
-            
-            inline const String& textureName() const {
-                return m_textureInfo->texture->name();
-            }
-            
-            inline const Vec3f::List& vertices() const {
-                return m_vertices;
-            }
+            unsigned int textureIndex;
+            unsigned int vertexIndex;
+            unsigned int vertexCount;
         };
         
-        typedef std::vector<BspFace*> BspFaceList;
+        typedef std::vector<BspFace> BspFaceList;
 
+        /*
+         * The faces of a model are sorted by their texture index.
+         */
         class BspModel {
         private:
+            BspVertexList m_vertices;
             BspFaceList m_faces;
-            unsigned int m_vertexCount;
             Vec3f m_center;
             BBoxf m_bounds;
-        public:
-            BspModel(const BspFaceList& faces, unsigned int vertexCount, const Vec3f& center, const BBoxf& bounds);
-            ~BspModel();
             
+            friend class Bsp;
+        public:
             inline unsigned int vertexCount() const {
-                return m_vertexCount;
+                return static_cast<unsigned int>(m_vertices.size());
+            }
+            
+            inline const BspVertexList& vertices() const {
+                return m_vertices;
             }
             
             inline const BspFaceList& faces() const {
@@ -173,29 +181,22 @@ namespace TrenchBroom {
                 return m_bounds;
             }
         };
-        
 
         typedef std::vector<BspModel*> BspModelList;
 
         class Bsp {
+        public:
+            typedef std::tr1::shared_ptr<Bsp> Ptr;
         private:
-            typedef std::vector<BspTexture*> BspTextureList;
-            typedef std::vector<BspEdgeInfo> BspEdgeInfoList;
+            typedef std::vector<BspTextureInfo> BspTextureInfoList;
             typedef std::vector<BspFaceInfo> BspFaceInfoList;
-            typedef std::vector<BspTextureInfo*> BspTextureInfoList;
-            typedef std::vector<int> BspFaceEdgeIndexList;
 
             String m_name;
             BspModelList m_models;
             BspTextureList m_textures;
-            BspTextureInfoList m_textureInfos;
 
             void readTextures(char*& cursor, unsigned int count);
-            void readTextureInfos(char*& cursor, unsigned int count, BspTextureList& textures);
-            void readVertices(char*& cursor, unsigned int count, Vec3f::List& vertices);
-            void readEdges(char*& cursor, unsigned int count, BspEdgeInfoList& edges);
-            void readFaces(char*& cursor, unsigned int count, BspFaceInfoList& faces);
-            void readFaceEdges(char*& cursor, unsigned int count, BspFaceEdgeIndexList& indices);
+            void readTextureInfos(char*& cursor, unsigned int count, BspTextureInfoList& textureInfos);
         public:
             Bsp(const String& name, char* begin, char* end);
             ~Bsp();
@@ -203,20 +204,23 @@ namespace TrenchBroom {
             inline const BspModelList& models() const {
                 return m_models;
             }
+            
+            inline const BspTextureList& textures() const {
+                return m_textures;
+            }
+            
+            size_t memorySize() const;
         };
         
-        class BspManager {
-        private:
-            typedef std::map<String, Bsp*> BspMap;
-            
-            BspMap m_bsps;
+        class BspManager : public ModelManager<Bsp> {
         public:
             static BspManager* sharedManager;
             
             BspManager();
-            ~BspManager();
 
-            const Bsp* bsp(const String& name, const StringList& paths, Utility::Console& console);
+            inline Bsp::Ptr bsp(const String& name, const StringList& paths, Utility::Console& console, ModelState& state) {
+                return model(name, paths, console, state);
+            }
         };
     }
 }
@@ -0,0 +1,42 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ContentFlags_h
+#define TrenchBroom_ContentFlags_h
+
+namespace TrenchBroom {
+    namespace Model {
+        /*
+         * Special contents of a face, derived from its texture name. A brush has a content flag if all of its faces
+         * have it.
+         */
+        namespace ContentFlags {
+            typedef unsigned int Type;
+            static const Type None      = 0;
+            static const Type Clip      = 1 << 0;
+            static const Type Skip      = 1 << 1;
+            static const Type Hint      = 1 << 2;
+            static const Type Liquid    = 1 << 3;
+            static const Type Trigger   = 1 << 4;
+            static const Type All       = Clip | Skip | Hint | Liquid | Trigger;
+        }
+    }
+}
+
+#endif
@@ -50,6 +50,14 @@ namespace TrenchBroom {
         String const Entity::DefKey              = "_def";
         String const Entity::DefaultDefinition   = "Quake.fgd";
         String const Entity::FacePointFormatKey  = "_point_format";
+        
+        PropertyKeyId const Entity::ClassnameKeyId   = internPropertyKey(Entity::ClassnameKey);
+        PropertyKeyId const Entity::OriginKeyId      = internPropertyKey(Entity::OriginKey);
+        PropertyKeyId const Entity::AngleKeyId       = internPropertyKey(Entity::AngleKey);
+        PropertyKeyId const Entity::AnglesKeyId      = internPropertyKey(Entity::AnglesKey);
+        PropertyKeyId const Entity::MangleKeyId      = internPropertyKey(Entity::MangleKey);
+        PropertyKeyId const Entity::TargetKeyId      = internPropertyKey(Entity::TargetKey);
+        PropertyKeyId const Entity::TargetnameKeyId  = internPropertyKey(Entity::TargetnameKey);
 
         void Entity::addLinkTarget(Entity& entity) {
             m_linkTargets.push_back(&entity);
@@ -85,8 +93,8 @@ namespace TrenchBroom {
 
         void Entity::addLinkTarget(const PropertyValue& targetname) {
             if (m_map != NULL) {
-                const EntityList targets = m_map->entitiesWithTargetname(targetname);
-                EntityList::const_iterator it, end;
+                const EntitySet& targets = m_map->entitiesWithTargetname(targetname);
+                EntitySet::const_iterator it, end;
                 for (it = targets.begin(), end = targets.end(); it != end; ++it) {
                     Entity& entity = **it;
                     entity.addLinkSource(*this);
@@ -99,7 +107,7 @@ namespace TrenchBroom {
             EntityList::iterator it = m_linkTargets.begin();
             while (it != m_linkTargets.end()) {
                 Entity& target = **it;
-                const PropertyValue* currentTargetname = target.propertyForKey(TargetnameKey);
+                const PropertyValue* currentTargetname = target.propertyForKey(TargetnameKeyId);
                 if (currentTargetname == NULL) { // gracefully remove this one
                     it = m_linkTargets.erase(it);
                     continue;
@@ -110,13 +118,15 @@ namespace TrenchBroom {
                     it = m_linkTargets.erase(it);
                     continue;
                 }
+                
+                ++it;
             }
         }
         
         void Entity::addKillTarget(const PropertyValue& targetname) {
             if (m_map != NULL) {
-                const EntityList targets = m_map->entitiesWithTargetname(targetname);
-                EntityList::const_iterator it, end;
+                const EntitySet& targets = m_map->entitiesWithTargetname(targetname);
+                EntitySet::const_iterator it, end;
                 for (it = targets.begin(), end = targets.end(); it != end; ++it) {
                     Entity& entity = **it;
                     entity.addKillSource(*this);
@@ -129,7 +139,7 @@ namespace TrenchBroom {
             EntityList::iterator it = m_killTargets.begin();
             while (it != m_killTargets.end()) {
                 Entity& target = **it;
-                const PropertyValue* currentTargetname = target.propertyForKey(TargetnameKey);
+                const PropertyValue* currentTargetname = target.propertyForKey(TargetnameKeyId);
                 if (currentTargetname == NULL) { // gracefully remove this one
                     it = m_killTargets.erase(it);
                     continue;
@@ -140,6 +150,8 @@ namespace TrenchBroom {
                     it = m_killTargets.erase(it);
                     continue;
                 }
+                
+                ++it;
             }
         }
         
@@ -151,7 +163,7 @@ namespace TrenchBroom {
                 const StringList l_linkTargetnames = linkTargetnames();
                 for (nameIt = l_linkTargetnames.begin(), nameEnd = l_linkTargetnames.end(); nameIt != nameEnd; ++nameIt) {
                     const String& targetname = *nameIt;
-                    const EntityList linkTargets = m_map->entitiesWithTargetname(targetname);
+                    const EntitySet& linkTargets = m_map->entitiesWithTargetname(targetname);
                     m_linkTargets.insert(m_linkTargets.end(), linkTargets.begin(), linkTargets.end());
                 }
                 
@@ -170,7 +182,7 @@ namespace TrenchBroom {
                 const StringList l_killTargetnames = killTargetnames();
                 for (nameIt = l_killTargetnames.begin(), nameEnd = l_killTargetnames.end(); nameIt != nameEnd; ++nameIt) {
                     const String& targetname = *nameIt;
-                    const EntityList killTargets = m_map->entitiesWithTargetname(targetname);
+                    const EntitySet& killTargets = m_map->entitiesWithTargetname(targetname);
                     m_killTargets.insert(m_killTargets.end(), killTargets.begin(), killTargets.end());
                 }
                 
@@ -201,8 +213,8 @@ namespace TrenchBroom {
 
         void Entity::addAllLinkSources(const PropertyValue& targetname) {
             if (m_map != NULL) {
-                const EntityList linkSources = m_map->entitiesWithTarget(targetname);
-                EntityList::const_iterator it, end;
+                const EntitySet& linkSources = m_map->entitiesWithTarget(targetname);
+                EntitySet::const_iterator it, end;
                 for (it = linkSources.begin(), end = linkSources.end(); it != end; ++it) {
                     Entity& source = **it;
                     source.addLinkTarget(*this);
@@ -213,8 +225,8 @@ namespace TrenchBroom {
         
         void Entity::addAllKillSources(const PropertyValue& targetname) {
             if (m_map != NULL) {
-                const EntityList killSources = m_map->entitiesWithKillTarget(targetname);
-                EntityList::const_iterator it, end;
+                const EntitySet& killSources = m_map->entitiesWithKillTarget(targetname);
+                EntitySet::const_iterator it, end;
                 for (it = killSources.begin(), end = killSources.end(); it != end; ++it) {
                     Entity& source = **it;
                     source.addKillTarget(*this);
@@ -248,6 +260,7 @@ namespace TrenchBroom {
             setEditState(EditState::Default);
             m_selectedBrushCount = 0;
             m_hiddenBrushCount = 0;
+            m_patternGeneration = 0;
             setProperty(SpawnFlagsKey, "0");
             invalidateGeometry();
         }
@@ -282,13 +295,13 @@ namespace TrenchBroom {
             const String* classn = classname();
             if (classn != NULL) {
                 if (Utility::startsWith(*classn, "light")) {
-                    if (propertyForKey(MangleKey) != NULL) {
+                    if (propertyForKey(MangleKeyId) != NULL) {
                         // spotlight without a target, update mangle
                         type = RTEulerAngles;
                         property = MangleKey;
-                    } else if (propertyForKey(TargetKey) == NULL) {
+                    } else if (propertyForKey(TargetKeyId) == NULL) {
                         // not a spotlight, but might have a rotatable model, so change angle or angles
-                        if (propertyForKey(AnglesKey) != NULL) {
+                        if (propertyForKey(AnglesKeyId) != NULL) {
                             type = RTEulerAngles;
                             property = AnglesKey;
                         } else {
@@ -301,10 +314,10 @@ namespace TrenchBroom {
                 } else {
                     bool brushEntity = !m_brushes.empty() || (m_definition != NULL && m_definition->type() == EntityDefinition::BrushEntity);
                     if (brushEntity) {
-                        if (propertyForKey(AnglesKey) != NULL) {
+                        if (propertyForKey(AnglesKeyId) != NULL) {
                             type = RTEulerAngles;
                             property = AnglesKey;
-                        } else if (propertyForKey(AngleKey) != NULL) {
+                        } else if (propertyForKey(AngleKeyId) != NULL) {
                             type = RTZAngleWithUpDown;
                             property = AngleKey;
                         }
@@ -314,7 +327,7 @@ namespace TrenchBroom {
                         // if the origin of the definition's bounding box is not in its center, don't apply the rotation
                         const Vec3f offset = origin() - center();
                         if (offset.x() == 0.0f && offset.y() == 0.0f) {
-                            if (propertyForKey(AnglesKey) != NULL) {
+                            if (propertyForKey(AnglesKeyId) != NULL) {
                                 type = RTEulerAngles;
                                 property = AnglesKey;
                             } else {
@@ -447,21 +460,28 @@ namespace TrenchBroom {
             m_geometryValid = false;
         }
 
-        void Entity::setMap(Map* map) {
+        void Entity::setMap(Map* map, bool resolveLinkSources) {
             if (m_map == map)
                 return;
             
-            removeAllLinkTargets();
-            removeAllKillTargets();
-            removeAllLinkSources();
-            removeAllKillSources();
+            // an entity that does not belong to a map has no links of its own, but it may already be the target
+            // of entities in the same batch, see Map::addEntities
+            if (m_map != NULL) {
+                removeAllLinkTargets();
+                removeAllKillTargets();
+                removeAllLinkSources();
+                removeAllKillSources();
+            }
             
             m_map = map;
             
             addAllLinkTargets();
             addAllKillTargets();
 
-            const PropertyValue* targetname = propertyForKey(TargetnameKey);
+            if (!resolveLinkSources)
+                return;
+            
+            const PropertyValue* targetname = propertyForKey(TargetnameKeyId);
             if (targetname != NULL && !targetname->empty()) {
                 addAllLinkSources(*targetname);
                 addAllKillSources(*targetname);
@@ -504,6 +524,24 @@ namespace TrenchBroom {
             setProperty(newKey, *value);
         }
         
+        bool Entity::matchesPattern(const String& pattern) const {
+            if (m_map != NULL)
+                return m_map->entityMatchesPattern(*this, pattern);
+            return propertiesContain(pattern);
+        }
+        
+        bool Entity::propertiesContain(const String& pattern) const {
+            const PropertyList& properties = m_propertyStore.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it) {
+                const Property& property = *it;
+                if (Utility::containsString(property.key(), pattern, false) ||
+                    Utility::containsString(property.value(), pattern, false))
+                    return true;
+            }
+            return false;
+        }
+        
         void Entity::removeProperty(const PropertyKey& key) {
             assert(propertyKeyIsMutable(key));
             if (!m_propertyStore.containsProperty(key))
@@ -514,6 +552,12 @@ namespace TrenchBroom {
         
         void Entity::setProperties(const PropertyList& properties, bool replace) {
             if (replace) {
+                if (m_map != NULL) {
+                    const PropertyList& oldProperties = m_propertyStore.properties();
+                    PropertyList::const_iterator it, end;
+                    for (it = oldProperties.begin(), end = oldProperties.end(); it != end; ++it)
+                        m_map->updateEntityProperty(*this, it->key(), NULL, &it->value());
+                }
                 m_propertyStore.clear();
                 setProperty(SpawnFlagsKey, "0");
             }
@@ -586,10 +630,15 @@ namespace TrenchBroom {
                     m_map->updateEntityTargetname(*this, value, oldValue);
             }
             
+            if (m_map != NULL)
+                m_map->updateEntityProperty(*this, key, value, oldValue);
+            
             if (value == NULL)
                 m_propertyStore.removeProperty(key);
             else
                 m_propertyStore.setPropertyValue(key, *value);
+            if (m_map != NULL)
+                m_map->updateEntityPatternMatch(*this);
             invalidateGeometry();
         }
         
@@ -656,6 +705,8 @@ namespace TrenchBroom {
         void Entity::addBrush(Brush& brush) {
             brush.setEntity(this);
             m_brushes.push_back(&brush);
+            if (m_map != NULL)
+                m_map->lineIndex().addBrush(brush);
             invalidateGeometry();
         }
         
@@ -664,6 +715,8 @@ namespace TrenchBroom {
                 Model::Brush* brush = brushes[i];
                 brush->setEntity(this);
                 m_brushes.push_back(brush);
+                if (m_map != NULL)
+                    m_map->lineIndex().addBrush(*brush);
             }
             invalidateGeometry();
         }
@@ -671,6 +724,8 @@ namespace TrenchBroom {
         void Entity::removeBrush(Brush& brush) {
             brush.setEntity(NULL);
             m_brushes.erase(std::remove(m_brushes.begin(), m_brushes.end(), &brush), m_brushes.end());
+            if (m_map != NULL)
+                m_map->lineIndex().removeBrush(brush);
             invalidateGeometry();
         }
 
@@ -60,6 +60,15 @@ namespace TrenchBroom {
             static String const DefKey;
             static String const DefaultDefinition;
             static String const FacePointFormatKey;
+            
+            // interned keys of the properties that are looked up most often
+            static PropertyKeyId const ClassnameKeyId;
+            static PropertyKeyId const OriginKeyId;
+            static PropertyKeyId const AngleKeyId;
+            static PropertyKeyId const AnglesKeyId;
+            static PropertyKeyId const MangleKeyId;
+            static PropertyKeyId const TargetKeyId;
+            static PropertyKeyId const TargetnameKeyId;
 
             inline static bool isNumberedProperty(const String& pattern, const String& key) {
                 if (key.size() < pattern.size())
@@ -88,6 +97,8 @@ namespace TrenchBroom {
             mutable BBoxf m_bounds;
             mutable Vec3f m_center;
             mutable bool m_geometryValid;
+            
+            unsigned int m_patternGeneration;
 
             EntityList m_linkTargets;
             EntityList m_linkSources;
@@ -152,16 +163,44 @@ namespace TrenchBroom {
                 return m_map;
             }
 
-            void setMap(Map* map);
+            /*
+             * Resolves the links of this entity in the given map. If resolveLinkSources is false, only the links
+             * that originate from this entity are resolved; this is used by Map::addEntities, which visits every
+             * entity of a batch.
+             */
+            void setMap(Map* map, bool resolveLinkSources = true);
 
             inline const PropertyList& properties() const {
                 return m_propertyStore.properties();
             }
 
+            inline const PropertyValue* propertyForKey(PropertyKeyId key) const {
+                return m_propertyStore.propertyValue(key);
+            }
+
             inline const PropertyValue* propertyForKey(const PropertyKey& key) const {
                 return m_propertyStore.propertyValue(key);
             }
 
+            /*
+             * Returns whether the key or the value of a property of this entity contains the given pattern, ignoring
+             * case. If the entity belongs to a map, the map's cached result is returned.
+             */
+            bool matchesPattern(const String& pattern) const;
+            bool propertiesContain(const String& pattern) const;
+            
+            /*
+             * The generation of the map's filter pattern that this entity was last found to match, see
+             * Map::entityMatchesPattern.
+             */
+            inline unsigned int patternGeneration() const {
+                return m_patternGeneration;
+            }
+            
+            inline void setPatternGeneration(unsigned int patternGeneration) {
+                m_patternGeneration = patternGeneration;
+            }
+
             static bool propertyIsMutable(const PropertyKey& key);
             static bool propertyKeyIsMutable(const PropertyKey& key);
 
@@ -195,7 +234,7 @@ namespace TrenchBroom {
             }
 
             inline const PropertyValue* classname() const {
-                return propertyForKey(ClassnameKey);
+                return propertyForKey(ClassnameKeyId);
             }
             
             inline const PropertyValue& safeClassname() const {
@@ -210,7 +249,7 @@ namespace TrenchBroom {
             }
 
             inline const Vec3f origin() const {
-                const PropertyValue* value = propertyForKey(OriginKey);
+                const PropertyValue* value = propertyForKey(OriginKeyId);
                 if (value == NULL)
                     return Vec3f::Null;
                 return Vec3f(*value);
@@ -220,12 +259,12 @@ namespace TrenchBroom {
                 if (classname() == NULL)
                     return false;
                 if (Utility::startsWith(*classname(), "light")) {
-                    if (propertyForKey(MangleKey) != NULL)
+                    if (propertyForKey(MangleKeyId) != NULL)
                         return true;
                 } else {
-                    if (propertyForKey(AngleKey) != NULL)
+                    if (propertyForKey(AngleKeyId) != NULL)
                         return true;
-                    if (propertyForKey(AnglesKey) != NULL)
+                    if (propertyForKey(AnglesKeyId) != NULL)
                         return true;
                 }
                 return false;
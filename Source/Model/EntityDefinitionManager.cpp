@@ -19,23 +19,132 @@
 
 #include "EntityDefinitionManager.h"
 
+#include "IO/EntityDefinitionCache.h"
 #include "IO/FileManager.h"
 #include "IO/DefParser.h"
 #include "IO/FgdParser.h"
 #include "Utility/Color.h"
 #include "Utility/Console.h"
+#include "Utility/List.h"
 #include "Utility/Map.h"
+#include "Utility/MessageException.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
+#include "Utility/ProgressIndicator.h"
 #include "Utility/String.h"
 
+#include <wx/utils.h>
+
 #include <algorithm>
 
 namespace TrenchBroom {
     namespace Model {
+        template <class Parser>
+        void EntityDefinitionLoader::parse(Parser& parser, EntityDefinitionMap& definitions) {
+            EntityDefinition* definition = NULL;
+            while ((definition = parser.nextDefinition()) != NULL) {
+                Utility::insertOrReplace(definitions, definition->name(), definition);
+                Utility::atomicExchange(m_position, static_cast<Utility::AtomicValue>(parser.position()));
+            }
+        }
+        
+        void EntityDefinitionLoader::run() {
+            IO::FileManager fileManager;
+            const String parserType = Utility::toLower(fileManager.pathExtension(m_path));
+            
+            IO::EntityDefinitionCache cache(m_cacheDirectory, m_path, m_modificationTime, parserType, m_defaultColor);
+            if (!m_cacheDirectory.empty() && cache.read(m_definitions)) {
+                m_cached = true;
+                return;
+            }
+            
+            IO::MappedFile::Ptr file = fileManager.mapFile(m_path);
+            if (file.get() == NULL)
+                throw Utility::MessageException("Unable to open entity definition file " + m_path);
+            Utility::atomicExchange(m_size, static_cast<Utility::AtomicValue>(file->size()));
+            
+            EntityDefinitionMap definitions;
+            try {
+                if (parserType == "def") {
+                    IO::DefParser parser(file->begin(), file->end(), m_defaultColor);
+                    parse(parser, definitions);
+                } else if (parserType == "fgd") {
+                    IO::FgdParser parser(file->begin(), file->end(), m_defaultColor);
+                    parse(parser, definitions);
+                }
+            } catch (...) {
+                Utility::deleteAll(definitions);
+                throw;
+            }
+            
+            m_definitions.reserve(definitions.size());
+            EntityDefinitionMap::const_iterator it, end;
+            for (it = definitions.begin(), end = definitions.end(); it != end; ++it)
+                m_definitions.push_back(it->second);
+            
+            if (!m_cacheDirectory.empty())
+                cache.write(m_definitions);
+        }
+
+        EntityDefinitionLoader::EntityDefinitionLoader(const String& path, const String& cacheDirectory, const Color& defaultColor) :
+        m_path(path),
+        m_cacheDirectory(cacheDirectory),
+        m_modificationTime(0),
+        m_defaultColor(defaultColor),
+        m_cached(false),
+        m_position(0),
+        m_size(0) {
+            IO::FileManager fileManager;
+            m_modificationTime = fileManager.modificationTime(path);
+            
+            // without a modification time, an outdated cache cannot be detected
+            if (m_modificationTime == 0)
+                m_cacheDirectory.clear();
+        }
+        
+        EntityDefinitionLoader::~EntityDefinitionLoader() {
+            wait();
+            Utility::deleteAll(m_definitions);
+        }
+        
+        int EntityDefinitionLoader::progress() {
+            const Utility::AtomicValue size = Utility::atomicLoad(m_size);
+            if (size == 0)
+                return 0;
+            return static_cast<int>(100 * static_cast<float>(Utility::atomicLoad(m_position)) / size);
+        }
+        
+        EntityDefinitionList EntityDefinitionLoader::releaseDefinitions() {
+            assert(finished());
+            EntityDefinitionList definitions;
+            definitions.swap(m_definitions);
+            return definitions;
+        }
+        
+        EntityDefinitionLoader* EntityDefinitionManager::createLoader(const String& path) const {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const Color& defaultColor = prefs.getColor(Preferences::EntityBoundsColor);
+            
+            IO::FileManager fileManager;
+            String cacheDirectory = fileManager.cacheDirectory();
+            if (!fileManager.exists(cacheDirectory)) {
+                const String parentDirectory = fileManager.deleteLastPathComponent(cacheDirectory);
+                if (!fileManager.exists(parentDirectory))
+                    fileManager.makeDirectory(parentDirectory);
+                if (!fileManager.makeDirectory(cacheDirectory))
+                    cacheDirectory.clear();
+            }
+            
+            return new EntityDefinitionLoader(path, cacheDirectory, defaultColor);
+        }
+        
         EntityDefinitionManager::EntityDefinitionManager(Utility::Console& console) :
-        m_console(console) {}
+        m_console(console),
+        m_loader(NULL) {}
         
         EntityDefinitionManager::~EntityDefinitionManager() {
+            delete m_loader;
+            m_loader = NULL;
             clear();
         }
         
@@ -56,43 +165,56 @@ namespace TrenchBroom {
             return result;
         }
 
-        void EntityDefinitionManager::load(const String& path) {
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            const Color& defaultColor = prefs.getColor(Preferences::EntityBoundsColor);
-            EntityDefinitionMap newDefinitions;
+        void EntityDefinitionManager::prefetch(const String& path) {
+            if (m_loader != NULL) {
+                if (m_loader->path() == path)
+                    return;
+                delete m_loader;
+            }
             
-            IO::FileManager fileManager;
-            IO::MappedFile::Ptr file = fileManager.mapFile(path);
-            if (file.get() != NULL) {
-                try {
-                    const String extension = fileManager.pathExtension(path);
-                    if (Utility::equalsString(extension, "def", false)) {
-                        IO::DefParser parser(file->begin(), file->end(), defaultColor);
-                        
-                        EntityDefinition* definition = NULL;
-                        while ((definition = parser.nextDefinition()) != NULL)
-                            Utility::insertOrReplace(newDefinitions, definition->name(), definition);
-                    } else if (Utility::equalsString(extension, "fgd", false)) {
-                        IO::FgdParser parser(file->begin(), file->end(), defaultColor);
-                        
-                        EntityDefinition* definition = NULL;
-                        while ((definition = parser.nextDefinition()) != NULL)
-                            Utility::insertOrReplace(newDefinitions, definition->name(), definition);
-                    }
-                    
-                    clear();
-                    m_entityDefinitions = newDefinitions;
-                    m_path = path;
-                } catch (IO::ParserException& e) {
-                    Utility::deleteAll(newDefinitions);
-                    m_console.error(e.what());
+            m_loader = createLoader(path);
+            m_loader->start();
+        }
+
+        void EntityDefinitionManager::load(const String& path, Utility::ProgressIndicator* indicator) {
+            TB_PROFILE_ZONE("EntityDefinitionManager::load");
+            prefetch(path);
+            
+            if (indicator != NULL) {
+                indicator->reset(100);
+                while (!m_loader->finished()) {
+                    indicator->update(m_loader->progress());
+                    wxMilliSleep(10);
                 }
+                indicator->update(100);
+            }
+            m_loader->wait();
+            
+            if (m_loader->failed()) {
+                m_console.error(m_loader->error());
             } else {
-                m_console.error("Unable to open entity definition file %s", path.c_str());
+                const EntityDefinitionList definitions = m_loader->releaseDefinitions();
+                
+                clear();
+                // the definitions are sorted by name, so each one is appended at the end of the map
+                EntityDefinitionList::const_iterator it, end;
+                for (it = definitions.begin(), end = definitions.end(); it != end; ++it) {
+                    EntityDefinition* definition = *it;
+                    m_entityDefinitions.insert(m_entityDefinitions.end(), EntityDefinitionMap::value_type(definition->name(), definition));
+                    m_nameIndex.insert(definition->name(), definition);
+                }
+                m_path = path;
+                
+                if (m_loader->cached())
+                    m_console.info("Loaded entity definitions for %s from cache", path.c_str());
             }
+            
+            delete m_loader;
+            m_loader = NULL;
         }
         
         void EntityDefinitionManager::clear() {
+            m_nameIndex.clear();
             Utility::deleteAll(m_entityDefinitions);
         }
 
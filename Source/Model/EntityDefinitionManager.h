@@ -21,18 +21,69 @@
 
 #include "Model/EntityDefinitionTypes.h"
 #include "Model/EntityDefinition.h"
+#include "Utility/Atomic.h"
+#include "Utility/Color.h"
 #include "Utility/String.h"
+#include "Utility/ThreadPool.h"
+#include "Utility/TrigramIndex.h"
 
 #include <map>
 
 namespace TrenchBroom {
     namespace Utility {
         class Console;
+        class ProgressIndicator;
     }
     
     namespace Model {
         class EntityDefinition;
         
+        /*
+         * Loads an entity definition file on a thread of its own. The definitions are read from the definition cache
+         * if it is up to date, otherwise the file is parsed and the cache is rewritten.
+         */
+        class EntityDefinitionLoader : public Utility::BackgroundTask {
+        private:
+            typedef std::map<String, EntityDefinition*> EntityDefinitionMap;
+            
+            String m_path;
+            String m_cacheDirectory;
+            long m_modificationTime;
+            Color m_defaultColor;
+            EntityDefinitionList m_definitions;
+            bool m_cached;
+            
+            volatile Utility::AtomicValue m_position;
+            volatile Utility::AtomicValue m_size;
+            
+            template <class Parser>
+            void parse(Parser& parser, EntityDefinitionMap& definitions);
+        protected:
+            void run();
+        public:
+            EntityDefinitionLoader(const String& path, const String& cacheDirectory, const Color& defaultColor);
+            ~EntityDefinitionLoader();
+            
+            inline const String& path() const {
+                return m_path;
+            }
+            
+            inline bool cached() const {
+                return m_cached;
+            }
+            
+            /*
+             * Returns how much of the file has been parsed, in percent.
+             */
+            int progress();
+            
+            /*
+             * Returns the definitions sorted by name and passes their ownership to the caller. Must not be called
+             * before the task has finished.
+             */
+            EntityDefinitionList releaseDefinitions();
+        };
+        
         class EntityDefinitionManager {
         public:
             enum SortOrder {
@@ -70,16 +121,39 @@ namespace TrenchBroom {
             Utility::Console& m_console;
             String m_path;
             EntityDefinitionMap m_entityDefinitions;
+            Utility::TrigramIndex<EntityDefinition*> m_nameIndex;
+            EntityDefinitionLoader* m_loader;
+            
+            EntityDefinitionLoader* createLoader(const String& path) const;
         public:
             EntityDefinitionManager(Utility::Console& console);
             ~EntityDefinitionManager();
             
             static StringList builtinDefinitionFiles();
             
-            void load(const String& path);
+            /*
+             * Starts loading the given file in the background so that a following call to load for the same file
+             * only has to wait for the remainder.
+             */
+            void prefetch(const String& path);
+            
+            /*
+             * Loads the given file, taking over a prefetched load of the same file if there is one. The progress
+             * indicator, if any, is updated while the file is parsed.
+             */
+            void load(const String& path, Utility::ProgressIndicator* indicator = NULL);
             void clear();
             
             EntityDefinition* definition(const String& name);
+            
+            /*
+             * Appends the definitions whose names contain the given pattern, ignoring case, to the given list. The
+             * appended definitions are ordered by their addresses.
+             */
+            inline void findDefinitions(const String& pattern, EntityDefinitionList& result) const {
+                m_nameIndex.find(pattern, result);
+            }
+            
             EntityDefinitionList definitions(EntityDefinition::Type type, SortOrder order = Name);
             EntityDefinitionGroups groups(EntityDefinition::Type type, SortOrder order = Name);
         };
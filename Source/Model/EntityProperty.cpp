@@ -39,11 +39,15 @@ namespace TrenchBroom {
             if (containsProperty(newKey))
                 return false;
             
+            PropertyKeyId oldKeyId = propertyKeyTable().find(oldKey);
+            if (oldKeyId == NULL)
+                return false;
+            
             PropertyList::iterator it, end;
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
-                if (property.key() == oldKey) {
-                    property.setKey(newKey);
+                if (property.keyId() == oldKeyId) {
+                    property.setKey(internPropertyKey(newKey));
                     assert(!hasDuplicates());
                     return true;
                 }
@@ -53,24 +57,29 @@ namespace TrenchBroom {
         }
 
         void PropertyStore::setPropertyValue(const PropertyKey& key, const PropertyValue& value) {
+            PropertyKeyId keyId = internPropertyKey(key);
             PropertyList::iterator it, end;
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
-                if (property.key() == key) {
+                if (property.keyId() == keyId) {
                     property.setValue(value);
                     return;
                 }
             }
             
-            m_properties.push_back(Property(key, value));
+            m_properties.push_back(Property(keyId, value));
             assert(!hasDuplicates());
         }
         
         bool PropertyStore::removeProperty(const PropertyKey& key) {
+            PropertyKeyId keyId = propertyKeyTable().find(key);
+            if (keyId == NULL)
+                return false;
+            
             PropertyList::iterator it, end;
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
-                if (property.key() == key) {
+                if (property.keyId() == keyId) {
                     m_properties.erase(it);
                     return true;
                 }
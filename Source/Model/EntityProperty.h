@@ -21,6 +21,7 @@
 #define __TrenchBroom__EntityProperty__
 
 #include "Utility/String.h"
+#include "Utility/StringTable.h"
 
 #include <map>
 #include <set>
@@ -34,23 +35,47 @@ namespace TrenchBroom {
         typedef std::set<PropertyKey> PropertyKeySet;
         typedef std::pair<PropertyKeySet::iterator, bool> PropertyKeySetInsertResult;
         typedef std::vector<PropertyValue> PropertyValueList;
+        
+        /*
+         * Property keys are interned, so every distinct key is stored only once and properties are looked up by
+         * comparing the interned pointers instead of the strings.
+         */
+        typedef const PropertyKey* PropertyKeyId;
+        
+        inline Utility::StringTable& propertyKeyTable() {
+            static Utility::StringTable table;
+            return table;
+        }
+        
+        inline PropertyKeyId internPropertyKey(const PropertyKey& key) {
+            return propertyKeyTable().intern(key);
+        }
 
         class Property {
         private:
-            PropertyKey m_key;
+            PropertyKeyId m_key;
             PropertyValue m_value;
         public:
-            Property() {}
+            Property() :
+            m_key(internPropertyKey("")) {}
             
             Property(const PropertyKey& key, const PropertyValue& value) :
+            m_key(internPropertyKey(key)),
+            m_value(value) {}
+            
+            Property(PropertyKeyId key, const PropertyValue& value) :
             m_key(key),
             m_value(value) {}
             
             inline const PropertyKey& key() const {
+                return *m_key;
+            }
+            
+            inline PropertyKeyId keyId() const {
                 return m_key;
             }
             
-            inline void setKey(const PropertyKey& key) {
+            inline void setKey(PropertyKeyId key) {
                 m_key = key;
             }
             
@@ -75,28 +100,40 @@ namespace TrenchBroom {
             
             bool hasDuplicates() const;
         public:
+            inline bool containsProperty(PropertyKeyId key) const {
+                return property(key) != NULL;
+            }
+            
             inline bool containsProperty(const PropertyKey& key) const {
-                PropertyList::const_iterator it, end;
-                for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
-                    const Property& property = *it;
-                    if (property.key() == key)
-                        return true;
-                }
-                
-                return false;
+                return property(key) != NULL;
             }
-
-            inline const Property* property(const PropertyKey& key) const {
+            
+            inline const Property* property(PropertyKeyId key) const {
                 PropertyList::const_iterator it, end;
                 for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                     const Property& property = *it;
-                    if (property.key() == key)
+                    if (property.keyId() == key)
                         return &property;
                 }
                 
                 return NULL;
             }
             
+            inline const Property* property(const PropertyKey& key) const {
+                // a key that was never interned cannot belong to any property
+                PropertyKeyId keyId = propertyKeyTable().find(key);
+                if (keyId == NULL)
+                    return NULL;
+                return property(keyId);
+            }
+            
+            inline const PropertyValue* propertyValue(PropertyKeyId key) const {
+                const Property* prop = property(key);
+                if (prop == NULL)
+                    return NULL;
+                return &prop->value();
+            }
+            
             inline const PropertyValue* propertyValue(const PropertyKey& key) const {
                 const Property* prop = property(key);
                 if (prop == NULL)
@@ -33,6 +33,7 @@ namespace TrenchBroom {
         static const EntityList EmptyEntityList;
         
         typedef std::set<Entity*> EntitySet;
+        static const EntitySet EmptyEntitySet;
         typedef std::pair<EntitySet::iterator, bool> EntitySetInsertResult;
     }
 }
@@ -22,6 +22,7 @@
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
 #include "Model/Texture.h"
+#include "Utility/Atomic.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -98,8 +99,8 @@ namespace TrenchBroom {
         };
         
         void Face::init() {
-            static unsigned int currentId = 1;
-            m_faceId = currentId++;
+            static Utility::AtomicValue currentId = 0;
+            m_faceId = static_cast<unsigned int>(Utility::atomicIncrement(currentId));
             for (size_t i = 0; i < 3; i++)
                 m_points[i] = Vec3f::Null;
             m_xOffset = 0.0f;
@@ -109,6 +110,7 @@ namespace TrenchBroom {
             m_yScale = 1.0f;
             m_brush = NULL;
             m_texture = NULL;
+            m_contentFlags = ContentFlags::None;
             m_filePosition = 0;
             m_selected = false;
             m_texAxesValid = false;
@@ -193,6 +195,16 @@ namespace TrenchBroom {
             m_vertexCacheValid = true;
         }
         
+        Vec2f Face::textureCoordinates(const Vec3f& point) const {
+            if (!m_texAxesValid)
+                validateTexAxes(m_boundary.normal);
+
+            const float width = static_cast<float>(m_texture != NULL ? m_texture->width() : 1);
+            const float height = static_cast<float>(m_texture != NULL ? m_texture->height() : 1);
+            return Vec2f((point.dot(m_scaledTexAxisX) + m_xOffset) / width,
+                         (point.dot(m_scaledTexAxisY) + m_yOffset) / height);
+        }
+
         void Face::compensateTransformation(const Mat4f& transformation) {
             if (!m_texAxesValid)
                 validateTexAxes(m_boundary.normal);
@@ -357,6 +369,7 @@ namespace TrenchBroom {
         m_forceIntegerFacePoints(face.forceIntegerFacePoints()),
         m_textureName(face.textureName()),
         m_texture(face.texture()),
+        m_contentFlags(face.contentFlags()),
         m_xOffset(face.xOffset()),
         m_yOffset(face.yOffset()),
         m_rotation(face.rotation()),
@@ -407,6 +420,7 @@ namespace TrenchBroom {
             m_rotation = faceTemplate.rotation();
             m_xScale = faceTemplate.xScale();
             m_yScale = faceTemplate.yScale();
+            setTextureName(faceTemplate.textureName());
             setTexture(faceTemplate.texture());
             m_texAxesValid = false;
             m_vertexCacheValid = false;
@@ -417,11 +431,17 @@ namespace TrenchBroom {
             if (brush == m_brush)
                 return;
             
-            if (m_brush != NULL && m_selected)
-                m_brush->decSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->decSelectedFaceCount();
+                m_brush->invalidateContentFlags();
+            }
             m_brush = brush;
-            if (m_brush != NULL && m_selected)
-                m_brush->incSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->incSelectedFaceCount();
+                m_brush->invalidateContentFlags();
+            }
         }
         
         void Face::updatePointsFromVertices() {
@@ -478,6 +498,18 @@ namespace TrenchBroom {
             }
         }
 
+        void Face::setPoints(const Vec3f& point1, const Vec3f& point2, const Vec3f& point3) {
+            m_points[0] = point1;
+            m_points[1] = point2;
+            m_points[2] = point3;
+
+            // only used to restore points that were taken from a face before, so they are known to be valid
+            m_boundary.setPoints(m_points[0], m_points[1], m_points[2]);
+
+            m_texAxesValid = false;
+            m_vertexCacheValid = false;
+        }
+
         void Face::correctFacePoints() {
             for (size_t i = 0; i < 3; i++)
                 m_points[i].correct();
@@ -488,6 +520,23 @@ namespace TrenchBroom {
             updatePointsFromBoundary();
         }
 
+        void Face::updateContentFlags() {
+            m_contentFlags = ContentFlags::None;
+            if (Utility::containsString(m_textureName, "clip", false))
+                m_contentFlags |= ContentFlags::Clip;
+            if (Utility::containsString(m_textureName, "skip", false))
+                m_contentFlags |= ContentFlags::Skip;
+            if (Utility::containsString(m_textureName, "hint", false))
+                m_contentFlags |= ContentFlags::Hint;
+            if (!m_textureName.empty() && m_textureName[0] == '*')
+                m_contentFlags |= ContentFlags::Liquid;
+            if (Utility::containsString(m_textureName, "trigger", false))
+                m_contentFlags |= ContentFlags::Trigger;
+            
+            if (m_brush != NULL)
+                m_brush->invalidateContentFlags();
+        }
+        
         void Face::setTexture(Texture* texture) {
             if (texture == m_texture)
                 return;
@@ -496,8 +545,10 @@ namespace TrenchBroom {
                 m_texture->decUsageCount();
             
             m_texture = texture;
-            if (m_texture != NULL)
+            if (m_texture != NULL) {
                 m_textureName = texture->name();
+                updateContentFlags();
+            }
             
             if (m_texture != NULL)
                 m_texture->incUsageCount();
@@ -631,12 +682,18 @@ namespace TrenchBroom {
         }
         
         void Face::transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTexture, const bool invertOrientation) {
+            Vec3f points[3];
+            transformPoints(pointTransform, m_points, 3, points);
+            transform(pointTransform, m_boundary.transformed(pointTransform, vectorTransform), points, lockTexture, invertOrientation);
+        }
+        
+        void Face::transform(const Mat4f& pointTransform, const Planef& boundary, const Vec3f* points, const bool lockTexture, const bool invertOrientation) {
             if (lockTexture)
                 compensateTransformation(pointTransform);
             
-            m_boundary.transform(pointTransform, vectorTransform);
+            m_boundary = boundary;
             for (size_t i = 0; i < 3; i++)
-                m_points[i] = pointTransform * m_points[i];
+                m_points[i] = points[i];
             if (m_forceIntegerFacePoints) {
                 updatePointsFromBoundary();
             } else {
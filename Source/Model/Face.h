@@ -21,6 +21,7 @@
 #define __TrenchBroom__Face__
 
 #include "Model/BrushGeometry.h"
+#include "Model/ContentFlags.h"
 #include "Model/FaceTypes.h"
 #include "Renderer/FaceVertex.h"
 #include "Utility/Allocator.h"
@@ -108,6 +109,7 @@ namespace TrenchBroom {
 
             String m_textureName;
             Texture* m_texture;
+            ContentFlags::Type m_contentFlags;
             float m_xOffset;
             float m_yOffset;
             float m_rotation;
@@ -142,6 +144,7 @@ namespace TrenchBroom {
 
             void projectOntoTexturePlane(Vec3f& xAxis, Vec3f& yAxis);
             void compensateTransformation(const Mat4f& transformation);
+            void updateContentFlags();
         public:
             Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName);
             Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Face& faceTemplate);
@@ -175,6 +178,7 @@ namespace TrenchBroom {
 
             void updatePointsFromVertices();
             void updatePointsFromBoundary();
+            void setPoints(const Vec3f& point1, const Vec3f& point2, const Vec3f& point3);
 
             inline void getPoints(Vec3f& point1, Vec3f& point2, Vec3f& point3) const {
                 point1 = m_points[0];
@@ -221,6 +225,11 @@ namespace TrenchBroom {
 
             inline void setTextureName(const String& textureName) {
                 m_textureName = textureName;
+                updateContentFlags();
+            }
+
+            inline ContentFlags::Type contentFlags() const {
+                return m_contentFlags;
             }
 
             inline Texture* texture() const {
@@ -314,6 +323,11 @@ namespace TrenchBroom {
                 return m_vertexCache;
             }
 
+            /*
+             * Returns the texture coordinates of the given point, which need not be a vertex of this face.
+             */
+            Vec2f textureCoordinates(const Vec3f& point) const;
+
             inline bool selected() const {
                 return m_selected;
             }
@@ -329,6 +343,13 @@ namespace TrenchBroom {
             }
 
             void transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTexture, const bool invertOrientation);
+            
+            /*
+             * Sets the boundary and the points of this face to the given ones, which must have been transformed by the
+             * given point transformation. This lets a brush transform the planes and points of all its faces in one
+             * batch.
+             */
+            void transform(const Mat4f& pointTransform, const Planef& boundary, const Vec3f* points, const bool lockTexture, const bool invertOrientation);
         };
     }
 }
@@ -81,6 +81,21 @@ namespace TrenchBroom {
         class DefaultFilter : public Filter {
         protected:
             const View::ViewOptions& m_viewOptions;
+            
+            inline ContentFlags::Type hiddenContentFlags() const {
+                ContentFlags::Type flags = ContentFlags::None;
+                if (!m_viewOptions.showClipBrushes())
+                    flags |= ContentFlags::Clip;
+                if (!m_viewOptions.showSkipBrushes())
+                    flags |= ContentFlags::Skip;
+                if (!m_viewOptions.showHintBrushes())
+                    flags |= ContentFlags::Hint;
+                if (!m_viewOptions.showLiquidBrushes())
+                    flags |= ContentFlags::Liquid;
+                if (!m_viewOptions.showTriggerBrushes())
+                    flags |= ContentFlags::Trigger;
+                return flags;
+            }
         public:
             DefaultFilter(const View::ViewOptions& viewOptions) :
             m_viewOptions(viewOptions) {}
@@ -93,17 +108,8 @@ namespace TrenchBroom {
                     return false;
 
                 const String& pattern = m_viewOptions.filterPattern();
-                if (!pattern.empty()) {
-                    const Model::PropertyList& properties = entity.properties();
-                    Model::PropertyList::const_iterator it, end;
-                    for (it = properties.begin(), end = properties.end(); it != end; ++it) {
-                        const Model::Property property = *it;
-                        if (Utility::containsString(property.key(), pattern, false) ||
-                            Utility::containsString(property.value(), pattern, false))
-                            return true;
-                    }
-                    return false;
-                }
+                if (!pattern.empty())
+                    return entity.matchesPattern(pattern);
 
                 return true;
             }
@@ -121,53 +127,22 @@ namespace TrenchBroom {
                 if (!m_viewOptions.showBrushes() || brush.hidden())
                     return false;
 
-                const String& pattern = m_viewOptions.filterPattern();
-                if (!pattern.empty() ||
-                    !m_viewOptions.showClipBrushes() || !m_viewOptions.showSkipBrushes() ||
-                    !m_viewOptions.showHintBrushes() || !m_viewOptions.showLiquidBrushes() ||
-                    !m_viewOptions.showTriggerBrushes()) {
-                    
-                    if (!m_viewOptions.showTriggerBrushes()) {
-                        Model::Entity* entity = brush.entity();
-                        if (entity != NULL && Utility::startsWith(entity->safeClassname(), "trigger_"))
-                            return false;
-                    }
-                    
-                    const Model::FaceList& faces = brush.faces();
-                    unsigned int clipCount = 0;
-                    unsigned int skipCount = 0;
-                    unsigned int hintCount = 0;
-                    unsigned int liquidCount = 0;
-                    unsigned int triggerCount = 0;
-                    bool matches = pattern.empty();
-                    for (unsigned int i = 0; i < faces.size(); i++) {
-                        const String& textureName = faces[i]->textureName();
-                        if (!m_viewOptions.showClipBrushes() && Utility::containsString(textureName, "clip", false))
-                            clipCount++;
-                        if (!m_viewOptions.showSkipBrushes() && Utility::containsString(textureName, "skip", false))
-                            skipCount++;
-                        if (!m_viewOptions.showHintBrushes() && Utility::containsString(textureName, "hint", false))
-                            hintCount++;
-                        if (!m_viewOptions.showLiquidBrushes() && textureName[0] == '*')
-                            liquidCount++;
-                        if (!m_viewOptions.showTriggerBrushes() && Utility::containsString(textureName, "trigger", false))
-                            triggerCount++;
-                        if (!matches)
-                            matches = Utility::containsString(textureName, pattern, false);
-                    }
-
-                    if (!m_viewOptions.showClipBrushes() && clipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showSkipBrushes() && skipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showHintBrushes() && hintCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showLiquidBrushes() && liquidCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showTriggerBrushes() && triggerCount == faces.size())
+                if (!m_viewOptions.showTriggerBrushes()) {
+                    Model::Entity* entity = brush.entity();
+                    if (entity != NULL && Utility::startsWith(entity->safeClassname(), "trigger_"))
                         return false;
+                }
+                
+                if ((brush.contentFlags() & hiddenContentFlags()) != 0)
+                    return false;
 
-                    return matches;
+                const String& pattern = m_viewOptions.filterPattern();
+                if (!pattern.empty()) {
+                    const Model::FaceList& faces = brush.faces();
+                    for (unsigned int i = 0; i < faces.size(); i++)
+                        if (Utility::containsString(faces[i]->textureName(), pattern, false))
+                            return true;
+                    return false;
                 }
 
                 return true;
@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LineIndex.h"
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        LineIndex::Hit LineIndex::find(size_t line, IntervalList<Entity>::Cursor& entityCursor, IntervalList<Brush>::Cursor& brushCursor) const {
+            Hit hit;
+            hit.entity = m_entities.find(line, entityCursor);
+            hit.brush = m_brushes.find(line, brushCursor);
+            if (hit.brush != NULL) {
+                const FaceList& faces = hit.brush->faces();
+                FaceList::const_iterator it, end;
+                for (it = faces.begin(), end = faces.end(); it != end && hit.face == NULL; ++it) {
+                    Face* face = *it;
+                    if (face->filePosition() == line)
+                        hit.face = face;
+                }
+            }
+            return hit;
+        }
+
+        void LineIndex::addEntity(Entity& entity) {
+            if (entity.fileLine() > 0)
+                m_entities.insert(entity);
+
+            const BrushList& brushes = entity.brushes();
+            BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                addBrush(**it);
+        }
+
+        void LineIndex::removeEntity(Entity& entity) {
+            if (entity.fileLine() > 0)
+                m_entities.erase(entity);
+
+            const BrushList& brushes = entity.brushes();
+            BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                removeBrush(**it);
+        }
+
+        void LineIndex::addBrush(Brush& brush) {
+            if (brush.fileLine() > 0)
+                m_brushes.insert(brush);
+        }
+
+        void LineIndex::removeBrush(Brush& brush) {
+            if (brush.fileLine() > 0)
+                m_brushes.erase(brush);
+        }
+
+        void LineIndex::clear() {
+            m_entities.clear();
+            m_brushes.clear();
+        }
+
+        LineIndex::Hit LineIndex::find(size_t line) const {
+            IntervalList<Entity>::Cursor entityCursor = 0;
+            IntervalList<Brush>::Cursor brushCursor = 0;
+            return find(line, entityCursor, brushCursor);
+        }
+
+        void LineIndex::find(const std::vector<size_t>& lines, HitList& hits) const {
+            typedef std::pair<size_t, size_t> LineOrder;
+            typedef std::vector<LineOrder> LineOrderList;
+
+            LineOrderList order;
+            order.reserve(lines.size());
+            for (size_t i = 0; i < lines.size(); i++)
+                order.push_back(LineOrder(lines[i], i));
+            std::sort(order.begin(), order.end());
+
+            const size_t offset = hits.size();
+            hits.resize(offset + lines.size());
+
+            IntervalList<Entity>::Cursor entityCursor = 0;
+            IntervalList<Brush>::Cursor brushCursor = 0;
+            LineOrderList::const_iterator it, end;
+            for (it = order.begin(), end = order.end(); it != end; ++it)
+                hits[offset + it->second] = find(it->first, entityCursor, brushCursor);
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__LineIndex__
+#define __TrenchBroom__LineIndex__
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class Entity;
+        class Face;
+
+        /*
+         * Maps the line numbers of the map file to the entities, brushes and faces that occupy them. The entities and
+         * brushes are kept sorted by their first line so that a line is found by a binary search. Objects without a
+         * line number, i.e., objects that were created after the file was loaded or saved, are not indexed. The map
+         * keeps the index in sync when entities and brushes are added or removed, and the map writer rebuilds it when
+         * the file is saved because that changes all line numbers.
+         */
+        class LineIndex {
+        public:
+            struct Hit {
+                Entity* entity;
+                Brush* brush;
+                Face* face;
+
+                Hit() :
+                entity(NULL),
+                brush(NULL),
+                face(NULL) {}
+            };
+
+            typedef std::vector<Hit> HitList;
+        private:
+            /*
+             * The line ranges of the objects sorted by their first lines. The ranges are copied when an object is
+             * added so that the order cannot be broken by changes to the object's file position. Ranges of objects
+             * that were removed before the file was saved and restored afterwards may overlap the other ranges, so
+             * every entry also stores the greatest end of all ranges up to and including it. A search can stop
+             * stepping back as soon as that end does not exceed the line.
+             */
+            template <class T>
+            class IntervalList {
+            private:
+                struct Interval {
+                    size_t first;
+                    size_t end;
+                    size_t maxEnd;
+                    T* object;
+                };
+
+                typedef std::vector<Interval> List;
+
+                struct CompareFirst {
+                    inline bool operator()(const size_t line, const Interval& interval) const {
+                        return line < interval.first;
+                    }
+                };
+
+                List m_intervals;
+
+                void updateMaxEnd(size_t index) {
+                    size_t maxEnd = index > 0 ? m_intervals[index - 1].maxEnd : 0;
+                    for (; index < m_intervals.size(); index++) {
+                        Interval& interval = m_intervals[index];
+                        maxEnd = std::max(maxEnd, interval.end);
+                        interval.maxEnd = maxEnd;
+                    }
+                }
+
+                size_t findBefore(const size_t line, const size_t upperBound) const {
+                    size_t index = upperBound;
+                    while (index > 0 && m_intervals[index - 1].maxEnd > line) {
+                        const Interval& interval = m_intervals[--index];
+                        if (line < interval.end)
+                            return index;
+                    }
+                    return m_intervals.size();
+                }
+            public:
+                typedef size_t Cursor;
+
+                void insert(T& object) {
+                    Interval interval;
+                    interval.first = object.fileLine();
+                    interval.end = interval.first + std::max(object.fileLineCount(), static_cast<size_t>(1));
+                    interval.maxEnd = 0;
+                    interval.object = &object;
+
+                    const typename List::iterator it = std::upper_bound(m_intervals.begin(), m_intervals.end(), interval.first, CompareFirst());
+                    const size_t index = static_cast<size_t>(std::distance(m_intervals.begin(), it));
+                    m_intervals.insert(it, interval);
+                    updateMaxEnd(index);
+                }
+
+                void erase(T& object) {
+                    // the object's range is usually unchanged since it was inserted, so look there first
+                    const size_t line = object.fileLine();
+                    typename List::iterator it = std::upper_bound(m_intervals.begin(), m_intervals.end(), line, CompareFirst());
+                    while (it != m_intervals.begin() && (it - 1)->first == line && (it - 1)->object != &object)
+                        --it;
+                    if (it == m_intervals.begin() || (it - 1)->object != &object) {
+                        for (it = m_intervals.end(); it != m_intervals.begin() && (it - 1)->object != &object; --it);
+                        if (it == m_intervals.begin())
+                            return;
+                    }
+
+                    const size_t index = static_cast<size_t>(std::distance(m_intervals.begin(), it - 1));
+                    m_intervals.erase(it - 1);
+                    updateMaxEnd(index);
+                }
+
+                inline void clear() {
+                    m_intervals.clear();
+                }
+
+                /*
+                 * Returns the object that occupies the given line, starting the binary search at the given cursor
+                 * and moving the cursor past all ranges that start at or before the line. Passing the same cursor
+                 * for ascending lines makes every search cover only the rest of the list.
+                 */
+                T* find(const size_t line, Cursor& cursor) const {
+                    const typename List::const_iterator it = std::upper_bound(m_intervals.begin() + static_cast<typename List::difference_type>(cursor), m_intervals.end(), line, CompareFirst());
+                    cursor = static_cast<size_t>(std::distance(m_intervals.begin(), it));
+                    const size_t index = findBefore(line, cursor);
+                    return index < m_intervals.size() ? m_intervals[index].object : NULL;
+                }
+            };
+
+            IntervalList<Entity> m_entities;
+            IntervalList<Brush> m_brushes;
+
+            Hit find(size_t line, IntervalList<Entity>::Cursor& entityCursor, IntervalList<Brush>::Cursor& brushCursor) const;
+        public:
+            void addEntity(Entity& entity);
+            void removeEntity(Entity& entity);
+            void addBrush(Brush& brush);
+            void removeBrush(Brush& brush);
+            void clear();
+
+            /*
+             * Returns the entity, brush and face that occupy the given line. The face is only set if the line is one
+             * of the face lines of the brush.
+             */
+            Hit find(size_t line) const;
+
+            /*
+             * Looks up all given lines at once, e.g. the lines reported by the compiler tools, and appends the hits to
+             * the given list in the order of the given lines.
+             */
+            void find(const std::vector<size_t>& lines, HitList& hits) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__LineIndex__) */
@@ -104,10 +104,42 @@ namespace TrenchBroom {
                 removeEntityKillTarget(entity, &*it);
         }
 
+        void Map::addEntityProperties(Entity& entity) {
+            const PropertyList& properties = entity.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it) {
+                m_propertyIndex.insert(it->key(), &entity);
+                m_propertyIndex.insert(it->value(), &entity);
+            }
+        }
+        
+        void Map::removeEntityProperties(Entity& entity) {
+            const PropertyList& properties = entity.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it) {
+                m_propertyIndex.remove(it->key(), &entity);
+                m_propertyIndex.remove(it->value(), &entity);
+            }
+        }
+
+        void Map::validateEntitiesMatchingPattern(const String& pattern) const {
+            m_pattern = pattern;
+            m_patternGeneration++;
+            
+            EntityList entities;
+            m_propertyIndex.find(pattern, entities);
+            EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Entity& entity = **it;
+                entity.setPatternGeneration(m_patternGeneration);
+            }
+        }
+
         Map::Map(const BBoxf& worldBounds, bool forceIntegerFacePoints) :
         m_worldBounds(worldBounds),
         m_forceIntegerFacePoints(forceIntegerFacePoints),
-        m_worldspawn(NULL) {}
+        m_worldspawn(NULL),
+        m_patternGeneration(0) {}
 
         Map::~Map() {
             clear();
@@ -131,61 +163,133 @@ namespace TrenchBroom {
         void Map::addEntity(Entity& entity) {
             if (!entity.worldspawn() || worldspawn() == NULL) {
                 m_entities.push_back(&entity);
-                addEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
+                addEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKeyId));
                 addEntityTargets(entity);
                 addEntityKillTargets(entity);
+                addEntityProperties(entity);
+                m_lineIndex.addEntity(entity);
                 entity.setMap(this);
+                updateEntityPatternMatch(entity);
             }
         }
         
+        void Map::addEntities(const EntityList& entities) {
+            if (!m_entities.empty()) {
+                // links between the new and the existing entities must be resolved in both directions
+                EntityList::const_iterator it, end;
+                for (it = entities.begin(), end = entities.end(); it != end; ++it)
+                    addEntity(**it);
+                return;
+            }
+            
+            m_entities.reserve(entities.size());
+            EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Entity& entity = **it;
+                if (!entity.worldspawn() || worldspawn() == NULL) {
+                    m_entities.push_back(&entity);
+                    addEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKeyId));
+                    addEntityTargets(entity);
+                    addEntityKillTargets(entity);
+                    addEntityProperties(entity);
+                    m_lineIndex.addEntity(entity);
+                    updateEntityPatternMatch(entity);
+                }
+            }
+            
+            // all targetnames are known now, so each link is found from its source and no entity has to look for
+            // the entities that link to it
+            for (it = m_entities.begin(), end = m_entities.end(); it != end; ++it) {
+                Entity& entity = **it;
+                entity.setMap(this, false);
+            }
+        }
+
         void Map::removeEntity(Entity& entity) {
             if (entity.worldspawn())
                 m_worldspawn = NULL;
             entity.setMap(NULL);
-            removeEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
+            removeEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKeyId));
             removeEntityTargets(entity);
             removeEntityKillTargets(entity);
+            removeEntityProperties(entity);
+            m_lineIndex.removeEntity(entity);
             Utility::erase(m_entities, &entity);
         }
 
-        EntityList Map::entitiesWithTargetname(const String& targetname) const {
+        const EntitySet& Map::entitiesWithTargetname(const String& targetname) const {
             typedef TargetnameEntityMap::const_iterator MapIt;
             MapIt it = m_entitiesWithTargetname.find(targetname);
             if (it == m_entitiesWithTargetname.end())
-                return EmptyEntityList;
-            return Utility::makeList(it->second);
+                return EmptyEntitySet;
+            return it->second;
         }
         
         void Map::updateEntityTargetname(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityTargetname(entity, oldTargetname);
             addEntityTargetname(entity, newTargetname);
+            m_entitiesWithChangedLinks.insert(&entity);
         }
 
         
-        EntityList Map::entitiesWithTarget(const String& targetname) const {
+        const EntitySet& Map::entitiesWithTarget(const String& targetname) const {
             typedef TargetnameEntityMap::const_iterator MapIt;
             MapIt it = m_entitiesWithTarget.find(targetname);
             if (it == m_entitiesWithTarget.end())
-                return EmptyEntityList;
-            return Utility::makeList(it->second);
+                return EmptyEntitySet;
+            return it->second;
         }
         
         void Map::updateEntityTarget(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityTarget(entity, oldTargetname);
             addEntityTarget(entity, newTargetname);
+            m_entitiesWithChangedLinks.insert(&entity);
         }
         
-        EntityList Map::entitiesWithKillTarget(const String& targetname) const {
+        const EntitySet& Map::entitiesWithKillTarget(const String& targetname) const {
             typedef TargetnameEntityMap::const_iterator MapIt;
             MapIt it = m_entitiesWithKillTarget.find(targetname);
             if (it == m_entitiesWithKillTarget.end())
-                return EmptyEntityList;
-            return Utility::makeList(it->second);
+                return EmptyEntitySet;
+            return it->second;
         }
         
         void Map::updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityKillTarget(entity, oldTargetname);
             addEntityKillTarget(entity, newTargetname);
+            m_entitiesWithChangedLinks.insert(&entity);
+        }
+
+        void Map::takeEntitiesWithChangedLinks(EntitySet& result) {
+            result.clear();
+            result.swap(m_entitiesWithChangedLinks);
+        }
+        
+        void Map::updateEntityProperty(Entity& entity, const String& key, const String* newValue, const String* oldValue) {
+            // the key stays indexed if only the value changes
+            if (oldValue != NULL && newValue == NULL)
+                m_propertyIndex.remove(key, &entity);
+            else if (oldValue == NULL && newValue != NULL)
+                m_propertyIndex.insert(key, &entity);
+            
+            if (oldValue == NULL || newValue == NULL || *oldValue != *newValue) {
+                if (oldValue != NULL)
+                    m_propertyIndex.remove(*oldValue, &entity);
+                if (newValue != NULL)
+                    m_propertyIndex.insert(*newValue, &entity);
+            }
+        }
+        
+        bool Map::entityMatchesPattern(const Entity& entity, const String& pattern) const {
+            if (m_patternGeneration == 0 || pattern != m_pattern)
+                validateEntitiesMatchingPattern(pattern);
+            return entity.patternGeneration() == m_patternGeneration;
+        }
+        
+        void Map::updateEntityPatternMatch(Entity& entity) {
+            // an entity with a stale stamp does not match, so there is nothing to do until a pattern was looked up
+            if (m_patternGeneration > 0)
+                entity.setPatternGeneration(entity.propertiesContain(m_pattern) ? m_patternGeneration : 0);
         }
 
         Entity* Map::worldspawn() {
@@ -202,6 +306,9 @@ namespace TrenchBroom {
             m_entitiesWithTargetname.clear();
             m_entitiesWithTarget.clear();
             m_entitiesWithKillTarget.clear();
+            m_entitiesWithChangedLinks.clear();
+            m_lineIndex.clear();
+            m_propertyIndex.clear();
             Utility::deleteAll(m_entities);
             m_worldspawn = NULL;
         }
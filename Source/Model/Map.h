@@ -21,6 +21,8 @@
 #define __TrenchBroom__Map__
 
 #include "Model/EntityTypes.h"
+#include "Model/LineIndex.h"
+#include "Utility/TrigramIndex.h"
 #include "Utility/VecMath.h"
 
 #include <map>
@@ -41,7 +43,13 @@ namespace TrenchBroom {
             TargetnameEntityMap m_entitiesWithTargetname;
             TargetnameEntityMap m_entitiesWithTarget;
             TargetnameEntityMap m_entitiesWithKillTarget;
+            EntitySet m_entitiesWithChangedLinks;
             Entity* m_worldspawn;
+            LineIndex m_lineIndex;
+            
+            Utility::TrigramIndex<Entity*> m_propertyIndex;
+            mutable String m_pattern;
+            mutable unsigned int m_patternGeneration;
             
             void addEntityTargetname(Entity& entity, const String* targetname);
             void removeEntityTargetname(Entity& entity, const String* targetname);
@@ -55,6 +63,10 @@ namespace TrenchBroom {
             void removeEntityKillTarget(Entity& entity, const String* targetname);
             void addEntityKillTargets(Entity& entity);
             void removeEntityKillTargets(Entity& entity);
+            
+            void addEntityProperties(Entity& entity);
+            void removeEntityProperties(Entity& entity);
+            void validateEntitiesMatchingPattern(const String& pattern) const;
         public:
             Map(const BBoxf& worldBounds, bool forceIntegerFacePoints);
             ~Map();
@@ -70,23 +82,66 @@ namespace TrenchBroom {
             void setForceIntegerFacePoints(bool forceIntegerFacePoints);
             
             void addEntity(Entity& entity);
+            
+            /*
+             * Adds the given entities at once. If the map is empty, as it is when a map file is loaded, the
+             * targetname indices are built for all entities first and every link is then resolved once from its
+             * source.
+             */
+            void addEntities(const EntityList& entities);
             void removeEntity(Entity& entity);
 
-            EntityList entitiesWithTargetname(const String& targetname) const;
+            /*
+             * The returned sets are owned by the map and remain valid until the next change to the respective
+             * index.
+             */
+            const EntitySet& entitiesWithTargetname(const String& targetname) const;
             void updateEntityTargetname(Entity& entity, const String* newTargetname, const String* oldTargetname);
             
-            EntityList entitiesWithTarget(const String& targetname) const;
+            const EntitySet& entitiesWithTarget(const String& targetname) const;
             void updateEntityTarget(Entity& entity, const String* newTargetname, const String* oldTargetname);
             
-            EntityList entitiesWithKillTarget(const String& targetname) const;
+            const EntitySet& entitiesWithKillTarget(const String& targetname) const;
             void updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname);
             
+            /*
+             * Moves the entities whose targets, killtargets or targetname were updated since the last call into the
+             * given set, so that their links can be refreshed without visiting all other entities.
+             */
+            void takeEntitiesWithChangedLinks(EntitySet& result);
+            
+            /*
+             * Returns whether the given entity has a property whose key or value contains the given pattern, ignoring
+             * case. Whenever the pattern changes, the matching entities are looked up in an index of the property
+             * keys and values and stamped with a new pattern generation. An entity matches if its stamp is current.
+             */
+            bool entityMatchesPattern(const Entity& entity, const String& pattern) const;
+            
+            /*
+             * Must be called after the properties of the given entity have changed to update its pattern stamp.
+             */
+            void updateEntityPatternMatch(Entity& entity);
+            
+            /*
+             * Must be called before the property with the given key is changed, i.e., while the old value is still
+             * valid. Either value may be NULL if the property is added or removed.
+             */
+            void updateEntityProperty(Entity& entity, const String& key, const String* newValue, const String* oldValue);
+            
             inline const EntityList& entities() const {
                 return m_entities;
             }
             
             Entity* worldspawn();
             
+            inline LineIndex& lineIndex() {
+                return m_lineIndex;
+            }
+            
+            inline const LineIndex& lineIndex() const {
+                return m_lineIndex;
+            }
+            
             void clear();
         };
     }
@@ -77,8 +77,15 @@ namespace TrenchBroom {
                 
                 View::ProgressIndicatorDialog progressIndicator;
                 loadMap(mappedFile->begin(), mappedFile->end(), progressIndicator);
+                
+                // parse the entity definitions while the textures are loading
+                const String definitionPath = entityDefinitionFilePath();
+                if (!definitionPath.empty())
+                    m_definitionManager->prefetch(definitionPath);
+                
                 loadTextures();
-                loadEntityDefinitionFile();
+                progressIndicator.setText("Loading entity definitions...");
+                loadEntityDefinitionFile(&progressIndicator);
 
                 String title = fileManager.pathComponents(path).back();
                 SetTitle(title);
@@ -110,8 +117,9 @@ namespace TrenchBroom {
         void MapDocument::clear() {
             m_sharedResources->textureRendererManager().invalidate();
             m_editStateManager->clear();
-            m_map->clear();
+            // clearing the octree first waits for a background pick that may still read the entities
             m_octree->clear();
+            m_map->clear();
             m_textureManager->clear();
             m_definitionManager->clear();
             unloadPointFile();
@@ -467,6 +475,10 @@ namespace TrenchBroom {
             return *m_textureManager;
         }
 
+        Octree& MapDocument::octree() const {
+            return *m_octree;
+        }
+
         Picker& MapDocument::picker() const {
             return *m_picker;
         }
@@ -548,7 +560,7 @@ namespace TrenchBroom {
             m_textureLock = textureLock;
         }
 
-        void MapDocument::loadEntityDefinitionFile() {
+        String MapDocument::entityDefinitionFilePath() {
             String definitionFile = "";
             Entity& worldspawnEntity = worldspawn();
             const PropertyValue* defValue = worldspawnEntity.propertyForKey(Entity::DefKey);
@@ -558,29 +570,34 @@ namespace TrenchBroom {
             IO::FileManager fileManager;
             const String resourcePath = fileManager.resourceDirectory();
             const String defsPath = fileManager.appendPathComponent(resourcePath, "Defs");
-            String definitionPath;
             
-            if (Utility::startsWith(definitionFile, "external:")) {
-                definitionPath = definitionFile.substr(9);
-            } else if (Utility::startsWith(definitionFile, "builtin:")) {
-                definitionPath = fileManager.appendPath(defsPath, definitionFile.substr(8));
-            } else if (definitionFile == "") {
-                definitionPath = fileManager.appendPath(defsPath, Entity::DefaultDefinition);
-            } else {
-                console().error("Unable to load entity definition file %s", definitionFile.c_str());
+            if (Utility::startsWith(definitionFile, "external:"))
+                return definitionFile.substr(9);
+            if (Utility::startsWith(definitionFile, "builtin:"))
+                return fileManager.appendPath(defsPath, definitionFile.substr(8));
+            if (definitionFile == "")
+                return fileManager.appendPath(defsPath, Entity::DefaultDefinition);
+            return "";
+        }
+
+        void MapDocument::loadEntityDefinitionFile(Utility::ProgressIndicator* progressIndicator) {
+            const String definitionPath = entityDefinitionFilePath();
+            if (definitionPath.empty()) {
+                const PropertyValue* defValue = worldspawn().propertyForKey(Entity::DefKey);
+                console().error("Unable to load entity definition file %s", defValue != NULL ? defValue->c_str() : "");
                 return;
             }
 
+            m_octree->clear();
+
             const EntityList& entities = m_map->entities();
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Entity& entity = *entities[i];
                 entity.setDefinition(NULL);
             }
-
-            m_octree->clear();
             
             m_definitionManager->clear();
-            m_definitionManager->load(definitionPath);
+            m_definitionManager->load(definitionPath, progressIndicator);
 
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Entity& entity = *entities[i];
@@ -121,6 +121,7 @@ namespace TrenchBroom {
             EntityDefinitionManager& definitionManager() const;
             EditStateManager& editStateManager() const;
             TextureManager& textureManager() const;
+            Octree& octree() const;
             Picker& picker() const;
             Utility::Grid& grid() const;
             
@@ -139,7 +140,8 @@ namespace TrenchBroom {
             bool textureLock() const;
             void setTextureLock(bool textureLock);
 
-            void loadEntityDefinitionFile();
+            String entityDefinitionFilePath();
+            void loadEntityDefinitionFile(Utility::ProgressIndicator* progressIndicator = NULL);
             void loadTextures();
             
             void incModificationCount();
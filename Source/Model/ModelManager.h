@@ -0,0 +1,323 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ModelManager_h
+#define TrenchBroom_ModelManager_h
+
+#include "IO/IOUtils.h"
+#include "Utility/Atomic.h"
+#include "Utility/Console.h"
+#include "Utility/SharedPointer.h"
+#include "Utility/String.h"
+#include "Utility/ThreadPool.h"
+
+#include <cassert>
+#include <exception>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        /*
+         * Loads models of type T on a background thread and keeps the loaded models in a cache that is bounded by
+         * memory size. T must provide a constructor T(name, begin, end), a method memorySize() and a shared pointer
+         * type T::Ptr.
+         *
+         * Models are handed out as shared pointers. A model that is still referenced, e.g. by a model renderer, is
+         * never evicted because evicting it would not free any memory, and a later request for it would load a second
+         * copy. Such models count towards the memory size of the cache, so the bound only limits the models that are
+         * no longer used. All methods must be called from the main thread.
+         */
+        template <class T>
+        class ModelManager {
+        public:
+            typedef enum {
+                ModelLoaded,
+                ModelPending,
+                ModelMissing
+            } ModelState;
+        private:
+            struct Request {
+                String key;
+                String name;
+                IO::MappedFile::Ptr file;
+            };
+
+            struct Result {
+                String key;
+                String name;
+                T* model;
+                String error;
+            };
+
+            typedef std::list<Request> RequestList;
+            typedef std::vector<Result> ResultList;
+
+            struct Queue {
+                Utility::SpinLock lock;
+                RequestList requests;
+                ResultList results;
+                bool running;
+
+                Queue() :
+                running(false) {}
+            };
+
+            class Loader : public Utility::BackgroundTask {
+            private:
+                Queue& m_queue;
+            protected:
+                void run() {
+                    while (true) {
+                        Request request;
+                        {
+                            Utility::SpinLocker locker(m_queue.lock);
+                            if (m_queue.requests.empty()) {
+                                m_queue.running = false;
+                                return;
+                            }
+                            request = m_queue.requests.front();
+                            m_queue.requests.pop_front();
+                        }
+
+                        Result result;
+                        result.key = request.key;
+                        result.name = request.name;
+                        result.model = NULL;
+                        try {
+                            result.model = new T(request.name, request.file->begin(), request.file->end());
+                        } catch (std::exception& e) {
+                            result.error = e.what();
+                        } catch (...) {
+                            result.error = "Unknown error";
+                        }
+                        request.file = IO::MappedFile::Ptr();
+
+                        Utility::SpinLocker locker(m_queue.lock);
+                        m_queue.results.push_back(result);
+                    }
+                }
+            public:
+                Loader(Queue& queue) :
+                m_queue(queue) {}
+
+                ~Loader() {
+                    wait();
+                }
+            };
+
+            typedef std::list<String> KeyList;
+
+            struct CacheEntry {
+                String name;
+                typename T::Ptr model;
+                size_t size;
+                typename KeyList::iterator lruPosition;
+            };
+
+            typedef std::map<String, CacheEntry> Cache;
+            typedef std::set<String> KeySet;
+
+            String m_typeName;
+            size_t m_maxMemory;
+            size_t m_memory;
+            size_t m_generation;
+
+            Cache m_cache;
+            KeyList m_lru;
+            KeySet m_pending;
+            KeySet m_failed;
+
+            Queue m_queue;
+            Loader* m_loader;
+
+            void evict(Utility::Console& console) {
+                // the most recently used model is always kept
+                typename KeyList::iterator lruIt = m_lru.end();
+                while (m_memory > m_maxMemory && lruIt != m_lru.begin() && --lruIt != m_lru.begin()) {
+                    typename Cache::iterator it = m_cache.find(*lruIt);
+                    assert(it != m_cache.end());
+                    if (!it->second.model.unique())
+                        continue;
+
+                    m_memory -= it->second.size;
+                    console.info("Evicted %s '%s' from the model cache (%u KB, model cache holds %u KB)", m_typeName.c_str(), it->second.name.c_str(), static_cast<unsigned int>(it->second.size / 1024), static_cast<unsigned int>(m_memory / 1024));
+                    m_cache.erase(it);
+                    lruIt = m_lru.erase(lruIt);
+                }
+            }
+
+            ModelManager(const ModelManager& other);
+            ModelManager& operator=(const ModelManager& other);
+        public:
+            ModelManager(const String& typeName, size_t maxMemory) :
+            m_typeName(typeName),
+            m_maxMemory(maxMemory),
+            m_memory(0),
+            m_generation(0),
+            m_loader(NULL) {}
+
+            ~ModelManager() {
+                m_queue.lock.lock();
+                m_queue.requests.clear();
+                m_queue.lock.unlock();
+
+                delete m_loader;
+                m_loader = NULL;
+
+                for (size_t i = 0; i < m_queue.results.size(); i++)
+                    delete m_queue.results[i].model;
+                m_queue.results.clear();
+            }
+
+            /*
+             * Returns the model with the given name if it is loaded. Otherwise, the model is queued for loading and
+             * state is set to ModelPending until updatePendingModels picks it up, or to ModelMissing if the model
+             * cannot be found or loaded.
+             */
+            typename T::Ptr model(const String& name, const StringList& paths, Utility::Console& console, ModelState& state) {
+                updatePendingModels(console);
+
+                const String pathList = Utility::join(paths, ",");
+                const String key = pathList + ":" + name;
+
+                typename Cache::iterator it = m_cache.find(key);
+                if (it != m_cache.end()) {
+                    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+                    state = ModelLoaded;
+                    return it->second.model;
+                }
+
+                if (m_pending.count(key) > 0) {
+                    state = ModelPending;
+                    return typename T::Ptr();
+                }
+
+                if (m_failed.count(key) > 0) {
+                    state = ModelMissing;
+                    return typename T::Ptr();
+                }
+
+                console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
+
+                IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
+                if (file.get() == NULL) {
+                    console.warn("Unable to find %s '%s'", m_typeName.c_str(), name.c_str());
+                    m_failed.insert(key);
+                    state = ModelMissing;
+                    return typename T::Ptr();
+                }
+
+                Request request;
+                request.key = key;
+                request.name = name;
+                request.file = file;
+
+                bool startLoader = false;
+                m_queue.lock.lock();
+                m_queue.requests.push_back(request);
+                if (!m_queue.running) {
+                    m_queue.running = true;
+                    startLoader = true;
+                }
+                m_queue.lock.unlock();
+
+                m_pending.insert(key);
+                if (startLoader) {
+                    delete m_loader;
+                    m_loader = new Loader(m_queue);
+                    m_loader->start();
+                }
+
+                state = ModelPending;
+                return typename T::Ptr();
+            }
+
+            /*
+             * Moves the models that have finished loading into the cache. Returns true if any pending model was
+             * finished.
+             */
+            bool updatePendingModels(Utility::Console& console) {
+                if (m_pending.empty())
+                    return false;
+
+                ResultList results;
+                m_queue.lock.lock();
+                results.swap(m_queue.results);
+                m_queue.lock.unlock();
+
+                if (results.empty())
+                    return false;
+
+                for (size_t i = 0; i < results.size(); i++) {
+                    Result& result = results[i];
+                    m_pending.erase(result.key);
+
+                    if (result.model == NULL) {
+                        console.error("Unable to load %s '%s': %s", m_typeName.c_str(), result.name.c_str(), result.error.c_str());
+                        m_failed.insert(result.key);
+                    } else {
+                        m_lru.push_front(result.key);
+
+                        CacheEntry& entry = m_cache[result.key];
+                        entry.name = result.name;
+                        entry.model = typename T::Ptr(result.model);
+                        entry.size = result.model->memorySize();
+                        entry.lruPosition = m_lru.begin();
+                        m_memory += entry.size;
+
+                        console.info("Loaded %s '%s' (%u KB, model cache holds %u KB)", m_typeName.c_str(), result.name.c_str(), static_cast<unsigned int>(entry.size / 1024), static_cast<unsigned int>(m_memory / 1024));
+                    }
+                }
+
+                evict(console);
+                m_generation += results.size();
+                return true;
+            }
+
+            /*
+             * Evicts the least recently used models that are no longer referenced until the cache is within its
+             * bound again. Should be called after the clients have released models.
+             */
+            void evictUnusedModels(Utility::Console& console) {
+                evict(console);
+            }
+
+            inline bool pendingModels() const {
+                return !m_pending.empty();
+            }
+
+            /*
+             * Incremented whenever a pending model is finished, so that several clients can tell whether anything has
+             * happened since they last checked.
+             */
+            inline size_t generation() const {
+                return m_generation;
+            }
+
+            inline size_t memory() const {
+                return m_memory;
+            }
+        };
+    }
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include "Model/Entity.h"
 #include "Model/Map.h"
 #include "Model/MapObject.h"
+#include "Utility/ThreadPool.h"
 
 #include <algorithm>
 #include <cmath>
@@ -171,17 +172,50 @@ namespace TrenchBroom {
             }
         }
         
+        void OctreeNode::intersect(const BBoxf& bounds, MapObjectList& objects) {
+            if (m_bounds.intersects(bounds)) {
+                objects.insert(objects.end(), m_objects.begin(), m_objects.end());
+                for (unsigned int i = 0; i < 8; i++)
+                    if (m_children[i] != NULL)
+                        m_children[i]->intersect(bounds, objects);
+            }
+        }
+        
+        void OctreeNode::above(const Planef& plane, MapObjectList& objects) {
+            // the corner of the node that lies farthest in the direction of the plane normal
+            Vec3f corner;
+            for (size_t i = 0; i < 3; i++)
+                corner[i] = plane.normal[i] > 0.0f ? m_bounds.max[i] : m_bounds.min[i];
+            
+            if (plane.pointStatus(corner) != PointStatus::PSBelow) {
+                objects.insert(objects.end(), m_objects.begin(), m_objects.end());
+                for (unsigned int i = 0; i < 8; i++)
+                    if (m_children[i] != NULL)
+                        m_children[i]->above(plane, objects);
+            }
+        }
+        
         Octree::Octree(Map& map, unsigned int minSize) :
         m_minSize(minSize),
         m_map(map),
-        m_root(new OctreeNode(map.worldBounds(), minSize)) {}
+        m_root(new OctreeNode(map.worldBounds(), minSize)),
+        m_revision(0),
+        m_backgroundReader(NULL) {}
         
         Octree::~Octree() {
+            willChange();
             delete m_root;
             m_root = NULL;
         }
         
+        void Octree::willChange() {
+            if (m_backgroundReader != NULL)
+                m_backgroundReader->wait();
+            m_revision++;
+        }
+        
         void Octree::loadMap() {
+            willChange();
             const EntityList& entities = m_map.entities();
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Entity* entity = entities[i];
@@ -195,16 +229,19 @@ namespace TrenchBroom {
         }
         
         void Octree::clear() {
+            willChange();
             delete m_root;
             m_root = new OctreeNode(m_map.worldBounds(), m_minSize);
         }
         
         void Octree::addObject(MapObject& object) {
+            willChange();
             bool result = m_root->addObject(object);
             assert(result);
         }
 
         void Octree::addObjects(const MapObjectList& objects) {
+            willChange();
             bool result;
             for (unsigned int i = 0; i < objects.size(); i++) {
                 MapObject* object = objects[i];
@@ -214,11 +251,13 @@ namespace TrenchBroom {
         }
         
         void Octree::removeObject(MapObject& object) {
+            willChange();
             bool result = m_root->removeObject(object);
             assert(result);
         }
         
         void Octree::removeObjects(const MapObjectList& objects) {
+            willChange();
             bool result;
             for (unsigned int i = 0; i < objects.size(); i++) {
                 MapObject* object = objects[i];
@@ -236,5 +275,17 @@ namespace TrenchBroom {
             m_root->intersect(ray, result);
             return result;
         }
+        
+        MapObjectList Octree::intersect(const BBoxf& bounds) {
+            MapObjectList result;
+            m_root->intersect(bounds, result);
+            return result;
+        }
+        
+        MapObjectList Octree::above(const Planef& plane) {
+            MapObjectList result;
+            m_root->above(plane, result);
+            return result;
+        }
     }
 }
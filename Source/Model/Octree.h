@@ -29,6 +29,10 @@
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
+    namespace Utility {
+        class BackgroundTask;
+    }
+    
     namespace Model {
         class Map;
         
@@ -58,6 +62,8 @@ namespace TrenchBroom {
             bool empty() const;
             size_t count() const;
             void intersect(const Rayf& ray, MapObjectList& objects);
+            void intersect(const BBoxf& bounds, MapObjectList& objects);
+            void above(const Planef& plane, MapObjectList& objects);
         };
         
         class Octree {
@@ -65,6 +71,10 @@ namespace TrenchBroom {
             unsigned int m_minSize;
             Map& m_map;
             OctreeNode* m_root;
+            unsigned int m_revision;
+            Utility::BackgroundTask* m_backgroundReader;
+            
+            void willChange();
         public:
             Octree(Map& map, unsigned int minSize = 64);
             ~Octree();
@@ -77,8 +87,36 @@ namespace TrenchBroom {
             void removeObjects(const MapObjectList& objects);
             
             size_t count() const;
+            
+            /*
+             * Increases with every change to the octree, so that results computed from it can be checked for being
+             * up to date.
+             */
+            inline unsigned int revision() const {
+                return m_revision;
+            }
+            
+            /*
+             * Registers a task that reads the octree and the objects in it on another thread. Every change waits for
+             * the task to finish first. Pass NULL once the task has finished.
+             */
+            inline void setBackgroundReader(Utility::BackgroundTask* reader) {
+                m_backgroundReader = reader;
+            }
 
             MapObjectList intersect(const Rayf& ray);
+            
+            /*
+             * Returns the objects stored in the nodes that intersect the given bounds. The objects themselves may not
+             * intersect the bounds and must be checked by the caller.
+             */
+            MapObjectList intersect(const BBoxf& bounds);
+            
+            /*
+             * Returns the objects stored in the nodes that reach above the given plane. As above, the objects must be
+             * checked by the caller.
+             */
+            MapObjectList above(const Planef& plane);
         };
     }
 }
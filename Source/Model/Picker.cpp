@@ -21,8 +21,11 @@
 #include "Model/Face.h"
 #include "Model/MapObject.h"
 #include "Model/Octree.h"
+#include "Utility/Profiler.h"
+#include "Utility/ThreadPool.h"
 
 #include <algorithm>
+#include <cassert>
 
 namespace TrenchBroom {
     namespace Model {
@@ -111,9 +114,82 @@ namespace TrenchBroom {
             return hits(HitType::Any, filter);
         }
 
-        Picker::Picker(Octree& octree) : m_octree(octree) {}
+        void PickResult::targets(HitTargetList& result) {
+            if (!m_sorted)
+                sortHits();
+            
+            result.clear();
+            result.reserve(m_hits.size());
+            HitList::const_iterator it, end;
+            for (it = m_hits.begin(), end = m_hits.end(); it != end; ++it)
+                result.push_back((*it)->target());
+        }
 
-        PickResult* Picker::pick(const Rayf& ray) {
+        void PickResult::removeHits(HitType::Type typeMask) {
+            HitList::iterator it = m_hits.begin();
+            for (HitList::iterator hitIt = m_hits.begin(), hitEnd = m_hits.end(); hitIt != hitEnd; ++hitIt) {
+                Hit* hit = *hitIt;
+                if (hit->hasType(typeMask))
+                    delete hit;
+                else
+                    *it++ = hit;
+            }
+            m_hits.erase(it, m_hits.end());
+        }
+
+        class PickTask : public Utility::BackgroundTask {
+        private:
+            Picker& m_picker;
+            Rayf m_ray;
+            unsigned int m_revision;
+            PickResult* m_result;
+        protected:
+            void run() {
+                m_result = m_picker.pickObjects(m_ray);
+            }
+        public:
+            PickTask(Picker& picker, const Rayf& ray, unsigned int revision) :
+            m_picker(picker),
+            m_ray(ray),
+            m_revision(revision),
+            m_result(NULL) {}
+            
+            ~PickTask() {
+                wait();
+                delete m_result;
+                m_result = NULL;
+            }
+            
+            inline const Rayf& ray() const {
+                return m_ray;
+            }
+            
+            inline unsigned int revision() const {
+                return m_revision;
+            }
+            
+            inline PickResult* takeResult() {
+                PickResult* result = m_result;
+                m_result = NULL;
+                return result;
+            }
+        };
+        
+        Picker::Picker(Octree& octree) :
+        m_octree(octree),
+        m_task(NULL),
+        m_listener(NULL) {}
+
+        Picker::~Picker() {
+            if (m_task != NULL) {
+                delete m_task;
+                m_task = NULL;
+                m_octree.setBackgroundReader(NULL);
+            }
+        }
+        
+        PickResult* Picker::pickObjects(const Rayf& ray) {
+            TB_PROFILE_ZONE("Picker::pick");
             PickResult* pickResults = new PickResult();
 
             MapObjectList objects = m_octree.intersect(ray);
@@ -123,5 +199,50 @@ namespace TrenchBroom {
             return pickResults;
         }
 
+        PickResult* Picker::pick(const Rayf& ray) {
+            // some objects compute their bounds lazily, so they must not be picked on two threads at once
+            waitForAsyncPick();
+            return pickObjects(ray);
+        }
+        
+        unsigned int Picker::revision() const {
+            return m_octree.revision();
+        }
+        
+        void Picker::setListener(Utility::BackgroundTaskListener* listener) {
+            waitForAsyncPick();
+            m_listener = listener;
+        }
+        
+        void Picker::pickAsync(const Rayf& ray) {
+            assert(m_task == NULL);
+            m_task = new PickTask(*this, ray, m_octree.revision());
+            m_task->setListener(m_listener);
+            m_octree.setBackgroundReader(m_task);
+            m_task->start();
+        }
+        
+        void Picker::waitForAsyncPick() {
+            if (m_task != NULL)
+                m_task->wait();
+        }
+        
+        bool Picker::asyncPickFinished() const {
+            return m_task != NULL && m_task->finished();
+        }
+        
+        PickResult* Picker::takeAsyncPickResult(Rayf& ray, unsigned int& revision) {
+            assert(m_task != NULL);
+            m_task->wait();
+            m_octree.setBackgroundReader(NULL);
+            
+            ray = m_task->ray();
+            revision = m_task->revision();
+            PickResult* result = m_task->takeResult();
+            
+            delete m_task;
+            m_task = NULL;
+            return result;
+        }
     }
 }
@@ -21,6 +21,7 @@
 #define TrenchBroom_Picker_h
 
 #include "Model/Filter.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/VecMath.h"
 
 using namespace TrenchBroom::VecMath;
@@ -42,6 +43,28 @@ namespace TrenchBroom {
             static const Type Any         = 0xFFFFFFFF;
         }
 
+        /*
+         * Identifies what a hit refers to regardless of where exactly the pick ray met it, so that the hits of two
+         * picks can be compared. Hits whose feedback does not depend on the hit point return the object or the handle
+         * position they refer to, all others return their hit point.
+         */
+        struct HitTarget {
+            HitType::Type type;
+            const void* object;
+            Vec3f position;
+            
+            HitTarget(HitType::Type i_type, const void* i_object, const Vec3f& i_position) :
+            type(i_type),
+            object(i_object),
+            position(i_position) {}
+            
+            inline bool operator== (const HitTarget& other) const {
+                return type == other.type && object == other.object && position == other.position;
+            }
+        };
+        
+        typedef std::vector<HitTarget> HitTargetList;
+        
         class Hit {
         private:
             HitType::Type m_type;
@@ -69,6 +92,10 @@ namespace TrenchBroom {
             }
             
             virtual bool pickable(Filter& filter) const = 0;
+            
+            virtual HitTarget target() const {
+                return HitTarget(m_type, NULL, m_hitPoint);
+            }
         };
         
         class ObjectHit : public Hit {
@@ -81,6 +108,10 @@ namespace TrenchBroom {
             inline MapObject& object() const {
                 return m_object;
             }
+            
+            virtual HitTarget target() const {
+                return HitTarget(type(), &m_object, Vec3f::Null);
+            }
         };
         
         class EntityHit : public ObjectHit {
@@ -107,6 +138,10 @@ namespace TrenchBroom {
             }
 
             bool pickable(Filter& filter) const;
+            
+            HitTarget target() const {
+                return HitTarget(type(), &m_face, Vec3f::Null);
+            }
         };
         
         typedef std::vector<Hit*> HitList;
@@ -131,14 +166,73 @@ namespace TrenchBroom {
             Hit* first(HitType::Type typeMask, bool ignoreOccluders, Filter& filter);
             HitList hits(HitType::Type typeMask, Filter& filter);
             HitList hits(Filter& filter);
+            
+            /*
+             * Returns the targets of all hits ordered by distance, including the unpickable ones.
+             */
+            void targets(HitTargetList& result);
+            
+            /*
+             * Deletes the hits of the given types. The order of the remaining hits is kept.
+             */
+            void removeHits(HitType::Type typeMask);
         };
         
+        class PickTask;
+        
+        /*
+         * Picks the objects in the octree. A pick can also run on a background thread while the caller does something
+         * else; the octree waits for it before it changes, so the objects cannot change while they are picked.
+         */
         class Picker {
         private:
             Octree& m_octree;
+            PickTask* m_task;
+            Utility::BackgroundTaskListener* m_listener;
+            
+            PickResult* pickObjects(const Rayf& ray);
+            friend class PickTask;
         public:
             Picker(Octree& octree);
+            ~Picker();
+            
             PickResult* pick(const Rayf& ray);
+            
+            /*
+             * The revision of the octree, see Octree::revision(). A pick result is up to date as long as the revision
+             * has not changed since the pick.
+             */
+            unsigned int revision() const;
+            
+            /*
+             * Sets the listener that is notified on the picking thread whenever a background pick has finished. Waits
+             * for the running background pick, so the previous listener is not notified anymore when this returns.
+             */
+            void setListener(Utility::BackgroundTaskListener* listener);
+            
+            /*
+             * Starts picking the objects along the given ray on a background thread. The result of the previous
+             * background pick must have been taken.
+             */
+            void pickAsync(const Rayf& ray);
+            
+            /*
+             * Waits until the running background pick has finished without taking its result. Anything that changes
+             * the objects must call this first, because picking reads their geometry.
+             */
+            void waitForAsyncPick();
+            
+            inline bool asyncPickRunning() const {
+                return m_task != NULL;
+            }
+            
+            bool asyncPickFinished() const;
+            
+            /*
+             * Waits for the background pick and returns its result along with the ray and the octree revision it
+             * was computed for. The caller takes ownership of the result.
+             */
+            PickResult* takeAsyncPickResult(Rayf& ray, unsigned int& revision);
         };
     }
 }
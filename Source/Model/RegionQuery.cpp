@@ -0,0 +1,435 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RegionQuery.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometryTypes.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Filter.h"
+#include "Model/Octree.h"
+#include "Utility/Profiler.h"
+#include "Utility/ThreadPool.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Model {
+        namespace {
+            /*
+             * Computes the smallest and the largest distance of the given vertices to each of the four planes in the
+             * given block. The vertices are stored in blocks of four as well.
+             */
+            void planeDistances(const float* planes, const float* vertices, const size_t vertexCount, float* min, float* max) {
+#if defined(TB_SIMD)
+                using namespace VecMath::SIMD;
+                const Float4 nx = load(planes);
+                const Float4 ny = load(planes + 4);
+                const Float4 nz = load(planes + 8);
+                const Float4 d = load(planes + 12);
+                Float4 minDist = splat(std::numeric_limits<float>::max());
+                Float4 maxDist = splat(-std::numeric_limits<float>::max());
+                for (size_t i = 0; i < vertexCount; i++) {
+                    const float* block = vertices + (i / 4) * 12;
+                    const size_t lane = i % 4;
+                    const Float4 dist = sub(add(add(mul(nx, splat(block[lane])),
+                                                    mul(ny, splat(block[lane + 4]))),
+                                                mul(nz, splat(block[lane + 8]))), d);
+                    minDist = VecMath::SIMD::min(minDist, dist);
+                    maxDist = VecMath::SIMD::max(maxDist, dist);
+                }
+                store(min, minDist);
+                store(max, maxDist);
+#else
+                for (size_t j = 0; j < 4; j++) {
+                    min[j] = std::numeric_limits<float>::max();
+                    max[j] = -std::numeric_limits<float>::max();
+                }
+                for (size_t i = 0; i < vertexCount; i++) {
+                    const float* block = vertices + (i / 4) * 12;
+                    const size_t lane = i % 4;
+                    for (size_t j = 0; j < 4; j++) {
+                        const float dist = planes[j] * block[lane] + planes[j + 4] * block[lane + 4] + planes[j + 8] * block[lane + 8] - planes[j + 12];
+                        if (dist < min[j])
+                            min[j] = dist;
+                        if (dist > max[j])
+                            max[j] = dist;
+                    }
+                }
+#endif
+            }
+
+            class RegionTestTask : public Utility::ParallelTask {
+            public:
+                typedef enum {
+                    Touching,
+                    Inside,
+                    Above
+                } Mode;
+            private:
+                Mode m_mode;
+                const ConvexRegion* m_region;
+                Planef m_plane;
+                const EntityList& m_entities;
+                const BrushList& m_brushes;
+                std::vector<char>& m_results;
+
+                /*
+                 * Decides the test from the bounds of the candidate alone if possible, which spares building the
+                 * region of most candidates. Returns 1 or 0 if the test is decided and -1 otherwise.
+                 */
+                inline int testBounds(const BBoxf& bounds) const {
+                    switch (m_mode) {
+                        case Touching:
+                            return m_region->bounds().intersects(bounds) ? -1 : 0;
+                        case Inside:
+                            return m_region->bounds().expanded(Math<float>::PointStatusEpsilon).contains(bounds) ? -1 : 0;
+                        default: {
+                            Vec3f nearest, farthest;
+                            for (size_t i = 0; i < 3; i++) {
+                                nearest[i] = m_plane.normal[i] > 0.0f ? bounds.min[i] : bounds.max[i];
+                                farthest[i] = m_plane.normal[i] > 0.0f ? bounds.max[i] : bounds.min[i];
+                            }
+                            if (m_plane.pointDistance(nearest) >= -Math<float>::PointStatusEpsilon)
+                                return 1;
+                            if (m_plane.pointDistance(farthest) < -Math<float>::PointStatusEpsilon)
+                                return 0;
+                            return -1;
+                        }
+                    }
+                }
+
+                inline bool test(const ConvexRegion& candidate) const {
+                    switch (m_mode) {
+                        case Touching:
+                            return m_region->intersects(candidate);
+                        case Inside:
+                            return m_region->contains(candidate);
+                        default:
+                            return candidate.above(m_plane);
+                    }
+                }
+            public:
+                RegionTestTask(Mode mode, const ConvexRegion* region, const Planef& plane, const EntityList& entities, const BrushList& brushes, std::vector<char>& results) :
+                m_mode(mode),
+                m_region(region),
+                m_plane(plane),
+                m_entities(entities),
+                m_brushes(brushes),
+                m_results(results) {}
+
+                void run(size_t index) {
+                    int result;
+                    if (index < m_entities.size()) {
+                        const Entity& entity = *m_entities[index];
+                        result = testBounds(entity.bounds());
+                        if (result < 0)
+                            result = test(ConvexRegion(entity.bounds())) ? 1 : 0;
+                    } else {
+                        const Brush& brush = *m_brushes[index - m_entities.size()];
+                        result = testBounds(brush.bounds());
+                        if (result < 0)
+                            result = test(ConvexRegion(brush)) ? 1 : 0;
+                    }
+                    m_results[index] = static_cast<char>(result);
+                }
+            };
+
+            void runRegionTest(RegionTestTask::Mode mode, const ConvexRegion* region, const Planef& plane, const EntityList& candidateEntities, const BrushList& candidateBrushes, EntityList& entities, BrushList& brushes) {
+                const size_t count = candidateEntities.size() + candidateBrushes.size();
+                std::vector<char> results(count, 0);
+                RegionTestTask task(mode, region, plane, candidateEntities, candidateBrushes, results);
+                Utility::ThreadPool::pool().parallelFor(count, task, 16);
+
+                for (size_t i = 0; i < candidateEntities.size(); i++)
+                    if (results[i] != 0)
+                        entities.push_back(candidateEntities[i]);
+                for (size_t i = 0; i < candidateBrushes.size(); i++)
+                    if (results[candidateEntities.size() + i] != 0)
+                        brushes.push_back(candidateBrushes[i]);
+            }
+        }
+
+        void ConvexRegion::addPlane(const Planef& plane) {
+            if (m_planeCount % 4 == 0)
+                m_planes.resize(m_planes.size() + 16);
+            float* block = &m_planes[(m_planeCount / 4) * 16];
+            const size_t lane = m_planeCount % 4;
+            block[lane]      = plane.normal.x();
+            block[lane + 4]  = plane.normal.y();
+            block[lane + 8]  = plane.normal.z();
+            block[lane + 12] = plane.distance;
+            m_planeCount++;
+        }
+
+        void ConvexRegion::addVertex(const Vec3f& vertex) {
+            if (m_vertexCount % 4 == 0)
+                m_vertices.resize(m_vertices.size() + 12);
+            float* block = &m_vertices[(m_vertexCount / 4) * 12];
+            const size_t lane = m_vertexCount % 4;
+            block[lane]     = vertex.x();
+            block[lane + 4] = vertex.y();
+            block[lane + 8] = vertex.z();
+            m_vertexCount++;
+        }
+
+        void ConvexRegion::addEdgeDirection(const Vec3f& direction) {
+            const Vec3f normalized = direction.normalized();
+            Vec3f::List::const_iterator it, end;
+            for (it = m_edgeDirections.begin(), end = m_edgeDirections.end(); it != end; ++it) {
+                if (std::abs(it->dot(normalized)) >= 1.0f - Math<float>::AlmostZero)
+                    return;
+            }
+            m_edgeDirections.push_back(normalized);
+        }
+
+        void ConvexRegion::padBlocks() {
+            // repeat the last plane and vertex in the unused lanes of the last blocks, this does not change any of the
+            // minimum or maximum distances
+            if (m_planeCount % 4 != 0) {
+                float* block = &m_planes[(m_planeCount / 4) * 16];
+                const size_t last = (m_planeCount - 1) % 4;
+                for (size_t lane = last + 1; lane < 4; lane++)
+                    for (size_t i = 0; i < 4; i++)
+                        block[lane + 4 * i] = block[last + 4 * i];
+            }
+            if (m_vertexCount % 4 != 0) {
+                float* block = &m_vertices[(m_vertexCount / 4) * 12];
+                const size_t last = (m_vertexCount - 1) % 4;
+                for (size_t lane = last + 1; lane < 4; lane++)
+                    for (size_t i = 0; i < 3; i++)
+                        block[lane + 4 * i] = block[last + 4 * i];
+            }
+        }
+
+        bool ConvexRegion::separates(const ConvexRegion& other) const {
+            float min[4], max[4];
+            for (size_t i = 0; i < m_planeCount; i += 4) {
+                planeDistances(&m_planes[i * 4], &other.m_vertices[0], other.m_vertexCount, min, max);
+                for (size_t j = 0; j < 4; j++)
+                    if (min[j] > Math<float>::PointStatusEpsilon)
+                        return true;
+            }
+            return false;
+        }
+
+        bool ConvexRegion::encloses(const ConvexRegion& other) const {
+            float min[4], max[4];
+            for (size_t i = 0; i < m_planeCount; i += 4) {
+                planeDistances(&m_planes[i * 4], &other.m_vertices[0], other.m_vertexCount, min, max);
+                for (size_t j = 0; j < 4; j++)
+                    if (max[j] > Math<float>::PointStatusEpsilon)
+                        return false;
+            }
+            return true;
+        }
+
+        void ConvexRegion::project(const Vec3f& axis, float& min, float& max) const {
+#if defined(TB_SIMD)
+            using namespace VecMath::SIMD;
+            const Float4 ax = splat(axis.x());
+            const Float4 ay = splat(axis.y());
+            const Float4 az = splat(axis.z());
+            Float4 minDist = splat(std::numeric_limits<float>::max());
+            Float4 maxDist = splat(-std::numeric_limits<float>::max());
+            for (size_t i = 0; i < m_vertexCount; i += 4) {
+                const float* block = &m_vertices[i * 3];
+                const Float4 dist = add(add(mul(load(block), ax),
+                                            mul(load(block + 4), ay)),
+                                        mul(load(block + 8), az));
+                minDist = VecMath::SIMD::min(minDist, dist);
+                maxDist = VecMath::SIMD::max(maxDist, dist);
+            }
+
+            float minLanes[4], maxLanes[4];
+            store(minLanes, minDist);
+            store(maxLanes, maxDist);
+            min = minLanes[0];
+            max = maxLanes[0];
+            for (size_t i = 1; i < 4; i++) {
+                if (minLanes[i] < min)
+                    min = minLanes[i];
+                if (maxLanes[i] > max)
+                    max = maxLanes[i];
+            }
+#else
+            min = std::numeric_limits<float>::max();
+            max = -std::numeric_limits<float>::max();
+            for (size_t i = 0; i < m_vertexCount; i++) {
+                const float dist = vertex(i).dot(axis);
+                if (dist < min)
+                    min = dist;
+                if (dist > max)
+                    max = dist;
+            }
+#endif
+        }
+
+        ConvexRegion::ConvexRegion(const Brush& brush) :
+        m_bounds(brush.bounds()),
+        m_planeCount(0),
+        m_vertexCount(0) {
+            const FaceList& faces = brush.faces();
+            FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                addPlane((*faceIt)->boundary());
+
+            const VertexList& vertices = brush.vertices();
+            VertexList::const_iterator vertexIt, vertexEnd;
+            for (vertexIt = vertices.begin(), vertexEnd = vertices.end(); vertexIt != vertexEnd; ++vertexIt)
+                addVertex((*vertexIt)->position);
+
+            const EdgeList& edges = brush.edges();
+            EdgeList::const_iterator edgeIt, edgeEnd;
+            for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt)
+                addEdgeDirection((*edgeIt)->vector());
+
+            padBlocks();
+        }
+
+        ConvexRegion::ConvexRegion(const BBoxf& bounds) :
+        m_bounds(bounds),
+        m_planeCount(0),
+        m_vertexCount(0) {
+            addPlane(Planef(Vec3f::PosX,  bounds.max.x()));
+            addPlane(Planef(Vec3f::NegX, -bounds.min.x()));
+            addPlane(Planef(Vec3f::PosY,  bounds.max.y()));
+            addPlane(Planef(Vec3f::NegY, -bounds.min.y()));
+            addPlane(Planef(Vec3f::PosZ,  bounds.max.z()));
+            addPlane(Planef(Vec3f::NegZ, -bounds.min.z()));
+
+            for (size_t i = 0; i < 8; i++)
+                addVertex(bounds.vertex(i));
+
+            m_edgeDirections.push_back(Vec3f::PosX);
+            m_edgeDirections.push_back(Vec3f::PosY);
+            m_edgeDirections.push_back(Vec3f::PosZ);
+
+            padBlocks();
+        }
+
+        bool ConvexRegion::intersects(const ConvexRegion& other) const {
+            if (!m_bounds.intersects(other.m_bounds))
+                return false;
+
+            // separating axis theorem
+            // http://www.geometrictools.com/Documentation/MethodOfSeparatingAxes.pdf
+            if (separates(other) || other.separates(*this))
+                return false;
+
+            Vec3f::List::const_iterator myIt, myEnd, theirIt, theirEnd;
+            for (myIt = m_edgeDirections.begin(), myEnd = m_edgeDirections.end(); myIt != myEnd; ++myIt) {
+                for (theirIt = other.m_edgeDirections.begin(), theirEnd = other.m_edgeDirections.end(); theirIt != theirEnd; ++theirIt) {
+                    Vec3f axis = crossed(*myIt, *theirIt);
+                    if (axis.lengthSquared() < Math<float>::AlmostZero)
+                        continue;
+                    axis.normalize();
+
+                    float myMin, myMax, theirMin, theirMax;
+                    project(axis, myMin, myMax);
+                    other.project(axis, theirMin, theirMax);
+                    if (myMax < theirMin - Math<float>::PointStatusEpsilon ||
+                        theirMax < myMin - Math<float>::PointStatusEpsilon)
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool ConvexRegion::contains(const ConvexRegion& other) const {
+            if (!m_bounds.expanded(Math<float>::PointStatusEpsilon).contains(other.m_bounds))
+                return false;
+            return encloses(other);
+        }
+
+        bool ConvexRegion::above(const Planef& plane) const {
+            float min, max;
+            project(plane.normal, min, max);
+            return min >= plane.distance - Math<float>::PointStatusEpsilon;
+        }
+
+        void RegionQuery::candidates(const MapObjectList& objects, const Brush* exclude, EntityList& entities, BrushList& brushes) const {
+            MapObjectList::const_iterator it, end;
+            for (it = objects.begin(), end = objects.end(); it != end; ++it) {
+                MapObject& object = **it;
+                if (object.objectType() == MapObject::EntityObject) {
+                    Entity& entity = static_cast<Entity&>(object);
+                    if (entity.brushes().empty() && m_filter.entitySelectable(entity))
+                        entities.push_back(&entity);
+                } else {
+                    Brush& brush = static_cast<Brush&>(object);
+                    if (&brush != exclude && m_filter.brushSelectable(brush))
+                        brushes.push_back(&brush);
+                }
+            }
+        }
+
+        RegionQuery::RegionQuery(Octree& octree, const Filter& filter) :
+        m_octree(octree),
+        m_filter(filter) {}
+
+        void RegionQuery::touching(const Brush& brush, EntityList& entities, BrushList& brushes) const {
+            TB_PROFILE_ZONE("RegionQuery::touching");
+            EntityList candidateEntities;
+            BrushList candidateBrushes;
+            candidates(m_octree.intersect(brush.bounds()), &brush, candidateEntities, candidateBrushes);
+            const ConvexRegion region(brush);
+            runRegionTest(RegionTestTask::Touching, &region, Planef(), candidateEntities, candidateBrushes, entities, brushes);
+        }
+
+        void RegionQuery::inside(const Brush& brush, EntityList& entities, BrushList& brushes) const {
+            TB_PROFILE_ZONE("RegionQuery::inside");
+            EntityList candidateEntities;
+            BrushList candidateBrushes;
+            candidates(m_octree.intersect(brush.bounds()), &brush, candidateEntities, candidateBrushes);
+            const ConvexRegion region(brush);
+            runRegionTest(RegionTestTask::Inside, &region, Planef(), candidateEntities, candidateBrushes, entities, brushes);
+        }
+
+        void RegionQuery::touching(const BBoxf& bounds, EntityList& entities, BrushList& brushes) const {
+            TB_PROFILE_ZONE("RegionQuery::touching");
+            EntityList candidateEntities;
+            BrushList candidateBrushes;
+            candidates(m_octree.intersect(bounds), NULL, candidateEntities, candidateBrushes);
+            const ConvexRegion region(bounds);
+            runRegionTest(RegionTestTask::Touching, &region, Planef(), candidateEntities, candidateBrushes, entities, brushes);
+        }
+
+        void RegionQuery::inside(const BBoxf& bounds, EntityList& entities, BrushList& brushes) const {
+            TB_PROFILE_ZONE("RegionQuery::inside");
+            EntityList candidateEntities;
+            BrushList candidateBrushes;
+            candidates(m_octree.intersect(bounds), NULL, candidateEntities, candidateBrushes);
+            const ConvexRegion region(bounds);
+            runRegionTest(RegionTestTask::Inside, &region, Planef(), candidateEntities, candidateBrushes, entities, brushes);
+        }
+
+        void RegionQuery::above(const Planef& plane, EntityList& entities, BrushList& brushes) const {
+            TB_PROFILE_ZONE("RegionQuery::above");
+            EntityList candidateEntities;
+            BrushList candidateBrushes;
+            candidates(m_octree.above(plane), NULL, candidateEntities, candidateBrushes);
+            runRegionTest(RegionTestTask::Above, NULL, plane, candidateEntities, candidateBrushes, entities, brushes);
+        }
+    }
+}
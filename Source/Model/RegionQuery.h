@@ -0,0 +1,122 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__RegionQuery__
+#define __TrenchBroom__RegionQuery__
+
+#include "Model/BrushTypes.h"
+#include "Model/EntityTypes.h"
+#include "Model/MapObjectTypes.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class Filter;
+        class Octree;
+
+        /*
+         * A convex polyhedron prepared for separating axis tests. The planes and vertices are stored in blocks of four
+         * (all x coordinates of a block first, then all y coordinates and so on) so that four of them can be tested at
+         * once, and parallel edges are merged because they yield the same separating axes.
+         */
+        class ConvexRegion {
+        private:
+            BBoxf m_bounds;
+            std::vector<float> m_planes;
+            std::vector<float> m_vertices;
+            size_t m_planeCount;
+            size_t m_vertexCount;
+            Vec3f::List m_edgeDirections;
+
+            void addPlane(const Planef& plane);
+            void addVertex(const Vec3f& vertex);
+            void addEdgeDirection(const Vec3f& direction);
+            void padBlocks();
+
+            inline const Vec3f vertex(const size_t index) const {
+                const float* block = &m_vertices[(index / 4) * 12];
+                const size_t lane = index % 4;
+                return Vec3f(block[lane], block[lane + 4], block[lane + 8]);
+            }
+
+            /*
+             * Returns true if all vertices of the given region lie above one of the planes of this region.
+             */
+            bool separates(const ConvexRegion& other) const;
+
+            /*
+             * Returns true if no vertex of the given region lies above any of the planes of this region.
+             */
+            bool encloses(const ConvexRegion& other) const;
+            void project(const Vec3f& axis, float& min, float& max) const;
+        public:
+            ConvexRegion(const Brush& brush);
+            ConvexRegion(const BBoxf& bounds);
+
+            inline const BBoxf& bounds() const {
+                return m_bounds;
+            }
+
+            bool intersects(const ConvexRegion& other) const;
+            bool contains(const ConvexRegion& other) const;
+            bool above(const Planef& plane) const;
+        };
+
+        /*
+         * Finds the selectable objects in a region of the map. The octree yields the candidates whose nodes touch the
+         * region, and the exact tests run on all processors afterwards. Entities are only returned if they do not
+         * contain brushes, the brushes of brush entities are returned individually. All queries append their results
+         * to the given lists.
+         */
+        class RegionQuery {
+        private:
+            Octree& m_octree;
+            const Filter& m_filter;
+
+            void candidates(const MapObjectList& objects, const Brush* exclude, EntityList& entities, BrushList& brushes) const;
+        public:
+            RegionQuery(Octree& octree, const Filter& filter);
+
+            /*
+             * Returns the objects that intersect or touch the given brush, excluding the brush itself.
+             */
+            void touching(const Brush& brush, EntityList& entities, BrushList& brushes) const;
+
+            /*
+             * Returns the objects that lie completely inside of the given brush, excluding the brush itself.
+             */
+            void inside(const Brush& brush, EntityList& entities, BrushList& brushes) const;
+
+            void touching(const BBoxf& bounds, EntityList& entities, BrushList& brushes) const;
+            void inside(const BBoxf& bounds, EntityList& entities, BrushList& brushes) const;
+
+            /*
+             * Returns the objects that lie completely above the given plane, i.e., on the side its normal points to.
+             */
+            void above(const Planef& plane, EntityList& entities, BrushList& brushes) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__RegionQuery__) */
@@ -21,6 +21,7 @@
 #define __TrenchBroom__Texture__
 
 #include <GL/glew.h>
+#include "Utility/Atomic.h"
 #include "Utility/String.h"
 
 namespace TrenchBroom {
@@ -37,7 +38,7 @@ namespace TrenchBroom {
             IdType m_uniqueId;
             unsigned int m_width;
             unsigned int m_height;
-            unsigned int m_usageCount;
+            volatile Utility::AtomicValue m_usageCount;
             bool m_overridden;
         public:
             Texture(TextureCollection& collection, const String& name, unsigned int width, unsigned int height) :
@@ -72,15 +73,16 @@ namespace TrenchBroom {
             }
             
             inline unsigned int usageCount() const {
-                return m_usageCount;
+                return static_cast<unsigned int>(m_usageCount);
             }
             
+            // faces are created and destroyed on worker threads, too
             inline void incUsageCount() {
-                m_usageCount++;
+                Utility::atomicIncrement(m_usageCount);
             }
             
             inline void decUsageCount() {
-                m_usageCount--;
+                Utility::atomicDecrement(m_usageCount);
             }
             
             inline bool overridden() const {
@@ -21,6 +21,7 @@
 
 #include "Renderer/Palette.h"
 #include "Utility/List.h"
+#include "Utility/Profiler.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -49,6 +50,7 @@ namespace TrenchBroom {
         TextureCollection::TextureCollection(const String& name, const String& path) throw (IO::IOException) :
         m_name(name),
         m_path(path) {
+            TB_PROFILE_ZONE("TextureCollection::TextureCollection");
             IO::Mip::List mips;
             try {
                 IO::Wad wad(m_path);
@@ -118,6 +120,18 @@ namespace TrenchBroom {
             std::sort(m_texturesByName.begin(), m_texturesByName.end(), CompareTexturesByName());
         }
 
+        void TextureManager::indexTextures(TextureCollection& collection) {
+            const TextureList& textures = collection.textures();
+            for (size_t i = 0; i < textures.size(); i++)
+                m_nameIndex.insert(textures[i]->name(), textures[i]);
+        }
+        
+        void TextureManager::unindexTextures(TextureCollection& collection) {
+            const TextureList& textures = collection.textures();
+            for (size_t i = 0; i < textures.size(); i++)
+                m_nameIndex.remove(textures[i]->name(), textures[i]);
+        }
+
         TextureManager::~TextureManager() {
             clear();
         }
@@ -129,6 +143,7 @@ namespace TrenchBroom {
             std::advance(insertPos, index);
             m_collections.insert(insertPos, collection);
 
+            indexTextures(*collection);
             reloadTextures();
         }
 
@@ -140,6 +155,7 @@ namespace TrenchBroom {
             std::advance(removePos, index);
             m_collections.erase(removePos);
 
+            unindexTextures(*collection);
             reloadTextures();
             return collection;
         }
@@ -162,6 +178,7 @@ namespace TrenchBroom {
             m_texturesByName.clear();
             m_texturesByUsage.clear();
             m_collectionMap.clear();
+            m_nameIndex.clear();
             Utility::deleteAll(m_collections);
         }
     }
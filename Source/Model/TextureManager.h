@@ -25,6 +25,7 @@
 #include "Model/TextureTypes.h"
 #include "Utility/Color.h"
 #include "Utility/String.h"
+#include "Utility/TrigramIndex.h"
 
 #include <algorithm>
 #include <map>
@@ -117,7 +118,11 @@ namespace TrenchBroom {
             TextureMap m_texturesCaseInsensitive;
             TextureList m_texturesByName;
             mutable TextureList m_texturesByUsage;
+            Utility::TrigramIndex<Texture*> m_nameIndex;
+            
             void reloadTextures();
+            void indexTextures(TextureCollection& collection);
+            void unindexTextures(TextureCollection& collection);
         public:
             ~TextureManager();
             
@@ -147,6 +152,14 @@ namespace TrenchBroom {
                 return it->second;
             }
             
+            /*
+             * Appends the textures of all collections whose names contain the given pattern, ignoring case, to the
+             * given list. Overridden textures are included. The appended textures are ordered by their addresses.
+             */
+            inline void findTextures(const String& pattern, TextureList& result) const {
+                m_nameIndex.find(pattern, result);
+            }
+            
             inline String wadProperty() const {
                 StringStream str;
                 for (size_t i = 0; i < m_collections.size(); i++) {
@@ -33,7 +33,7 @@
 
 namespace TrenchBroom {
     namespace Renderer {
-        AliasModelRenderer::AliasModelRenderer(const Model::Alias& alias, unsigned int frameIndex, unsigned int skinIndex, Vbo& vbo, const Palette& palette) :
+        AliasModelRenderer::AliasModelRenderer(Model::Alias::Ptr alias, unsigned int frameIndex, unsigned int skinIndex, Vbo& vbo, const Palette& palette) :
         m_alias(alias),
         m_frameIndex(frameIndex),
         m_skinIndex(skinIndex),
@@ -51,13 +51,13 @@ namespace TrenchBroom {
 
         void AliasModelRenderer::render(ShaderProgram& shaderProgram) {
             if (m_vertexArray == NULL) {
-                assert(m_skinIndex < m_alias.skins().size());
-                assert(m_frameIndex < m_alias.frames().size());
+                assert(m_skinIndex < m_alias->skins().size());
+                assert(m_frameIndex < m_alias->frames().size());
                 
-                Model::AliasSkin& skin = *m_alias.skins()[m_skinIndex];
+                Model::AliasSkin& skin = *m_alias->skins()[m_skinIndex];
                 m_texture = TextureRendererPtr(new TextureRenderer(skin, 0, m_palette));
 
-                Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
+                Model::AliasSingleFrame& frame = m_alias->frame(m_frameIndex);
                 const Model::AliasFrameTriangleList& triangles = frame.triangles();
                 unsigned int vertexCount = static_cast<unsigned int>(3 * triangles.size());
                 
@@ -86,29 +86,26 @@ namespace TrenchBroom {
         }
 
         const Vec3f& AliasModelRenderer::center() const {
-            return m_alias.frame(m_frameIndex).center();
+            return m_alias->frame(m_frameIndex).center();
         }
 
         const BBoxf& AliasModelRenderer::bounds() const {
-            return m_alias.frame(m_frameIndex).bounds();
+            return m_alias->frame(m_frameIndex).bounds();
         }
 
         BBoxf AliasModelRenderer::boundsAfterTransformation(const Mat4f& transformation) const {
-            Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
+            Model::AliasSingleFrame& frame = m_alias->frame(m_frameIndex);
             const Model::AliasFrameTriangleList& triangles = frame.triangles();
 
-            BBoxf bounds;
-            bounds.min = bounds.max = transformation * (*triangles[0])[0].position();
-            
-            for (unsigned int i = 1; i < triangles.size(); i++) {
+            Vec3f::List positions;
+            positions.reserve(3 * triangles.size());
+            for (unsigned int i = 0; i < triangles.size(); i++) {
                 Model::AliasFrameTriangle& triangle = *triangles[i];
-                for (unsigned int j = 0; j < 3; j++) {
-                    Model::AliasFrameVertex& vertex = triangle[j];
-                    bounds.mergeWith(transformation * vertex.position());
-                }
+                for (unsigned int j = 0; j < 3; j++)
+                    positions.push_back(triangle[j].position());
             }
             
-            return bounds;
+            return transformedBounds(transformation, &positions[0], positions.size());
         }
     }
 }
@@ -20,13 +20,13 @@
 #ifndef TrenchBroom_AliasModelRenderer_h
 #define TrenchBroom_AliasModelRenderer_h
 
+#include "Model/Alias.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/TextureRendererTypes.h"
 #include "Renderer/VertexArray.h"
 
 namespace TrenchBroom {
     namespace Model {
-        class Alias;
         class Entity;
     }
 
@@ -39,7 +39,7 @@ namespace TrenchBroom {
 
         class AliasModelRenderer : public EntityModelRenderer {
         private:
-            const Model::Alias& m_alias;
+            Model::Alias::Ptr m_alias;
             unsigned int m_frameIndex;
             unsigned int m_skinIndex;
 
@@ -49,7 +49,7 @@ namespace TrenchBroom {
             Vbo& m_vbo;
             VertexArray* m_vertexArray;
         public:
-            AliasModelRenderer(const Model::Alias& alias, unsigned int frameIndex, unsigned int skinIndex, Vbo& vbo, const Palette& palette);
+            AliasModelRenderer(Model::Alias::Ptr alias, unsigned int frameIndex, unsigned int skinIndex, Vbo& vbo, const Palette& palette);
             ~AliasModelRenderer();
 
             void render(ShaderProgram& shaderProgram);
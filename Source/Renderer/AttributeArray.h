@@ -236,6 +236,13 @@ namespace TrenchBroom {
                 m_block = vbo.allocBlock(m_vertexCapacity * (m_vertexSize + m_padBy));
             }
 
+            inline size_t attributeOffset(size_t vertexIndex, size_t attributeIndex) const {
+                size_t offset = vertexIndex * (m_vertexSize + m_padBy);
+                for (size_t i = 0; i < attributeIndex; i++)
+                    offset += m_attributes[i].sizeInBytes();
+                return offset;
+            }
+            
             inline void attributesAdded(size_t count = 1) {
                 assert(count <= 1 || m_padBy == 0);
                 if (count > 1) {
@@ -341,6 +348,10 @@ namespace TrenchBroom {
                 return m_vertexCount;
             }
             
+            inline size_t vertexCapacity() const {
+                return m_vertexCapacity;
+            }
+            
             inline void addAttribute(float value) {
                 assert(m_vertexCount < m_vertexCapacity);
                 assert(m_attributes[m_specIndex].valueType() == GL_FLOAT);
@@ -477,6 +488,57 @@ namespace TrenchBroom {
                 attributesAdded(static_cast<size_t>(cachedVertices.size()));
             }
             
+            /*
+             * Copies vertices whose memory layout matches the attributes of this array, e.g. a class that holds one
+             * member per attribute.
+             */
+            template <typename T>
+            inline void addInterleavedVertices(const std::vector<T>& vertices) {
+                assert(sizeof(T) == m_vertexSize);
+                assert(m_padBy == 0);
+                assert(m_specIndex == 0);
+                assert(m_vertexCount + vertices.size() <= m_vertexCapacity);
+                if (vertices.empty())
+                    return;
+                
+                m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(&vertices.front()), m_writeOffset, vertices.size() * sizeof(T));
+                m_vertexCount += vertices.size();
+            }
+            
+            /*
+             * Overwrites an attribute of a vertex that has already been written. The VBO
+             * must be mapped.
+             */
+            inline void setAttribute(size_t vertexIndex, size_t attributeIndex, float value) {
+                assert(vertexIndex < m_vertexCount);
+                assert(attributeIndex < m_attributes.size());
+                assert(m_attributes[attributeIndex].valueType() == GL_FLOAT);
+                assert(m_attributes[attributeIndex].size() == 1);
+                
+                m_block->writeFloat(value, attributeOffset(vertexIndex, attributeIndex));
+            }
+            
+            inline void setAttribute(size_t vertexIndex, size_t attributeIndex, const Vec3f& value) {
+                assert(vertexIndex < m_vertexCount);
+                assert(attributeIndex < m_attributes.size());
+                assert(m_attributes[attributeIndex].valueType() == GL_FLOAT);
+                assert(m_attributes[attributeIndex].size() == 3);
+                
+                m_block->writeVec(value, attributeOffset(vertexIndex, attributeIndex));
+            }
+            
+            /*
+             * Drops all vertices from the given index on. Vertices that are added afterwards follow the remaining
+             * ones.
+             */
+            inline void truncate(size_t vertexCount) {
+                assert(vertexCount <= m_vertexCount);
+                assert(m_specIndex == 0);
+                
+                m_vertexCount = vertexCount;
+                m_writeOffset = vertexCount * (m_vertexSize + m_padBy);
+            }
+            
             inline void bindAttributes(const ShaderProgram& program) {
                 for (size_t i = 0; i < m_attributes.size(); i++) {
                     Attribute& attribute = m_attributes[i];
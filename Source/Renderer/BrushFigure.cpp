@@ -29,6 +29,8 @@
 #include "Renderer/TexturedPolygonSorter.h"
 #include "Renderer/Vbo.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Renderer {
         BrushFigure::BrushFigure(TextureRendererManager& textureRendererManager) :
@@ -58,9 +60,8 @@ namespace TrenchBroom {
                 delete m_faceRenderer;
                 m_faceRenderer = NULL;
 
-                if (!m_brushes.empty()) {
-                    typedef TexturedPolygonSorter<Model::Texture, Model::Face*> FaceSorter;
-                    FaceSorter faceSorter;
+                if (!m_brushes.empty() || !m_polygons.empty()) {
+                    FaceRenderer::Sorter faceSorter;
                     
                     Model::BrushList::const_iterator brushIt, brushEnd;
                     Model::FaceList::const_iterator faceIt, faceEnd;
@@ -73,7 +74,36 @@ namespace TrenchBroom {
                         }
                     }
                     
-                    m_faceRenderer = new FaceRenderer(vbo, m_textureRendererManager, faceSorter, m_faceColor);
+                    // triangulate the split polygons like the faces triangulate their vertices
+                    size_t polygonCount = 0;
+                    Model::SplitPolygonsList::const_iterator polygonsIt, polygonsEnd;
+                    for (polygonsIt = m_polygons.begin(), polygonsEnd = m_polygons.end(); polygonsIt != polygonsEnd; ++polygonsIt)
+                        polygonCount += (*polygonsIt)->polygons.size();
+                    
+                    std::vector<FaceVertex::List> triangles(polygonCount);
+                    FaceRenderer::TriangleSorter triangleSorter;
+                    size_t index = 0;
+                    for (polygonsIt = m_polygons.begin(), polygonsEnd = m_polygons.end(); polygonsIt != polygonsEnd; ++polygonsIt) {
+                        const Model::SplitPolygons& polygons = **polygonsIt;
+                        for (size_t i = 0; i < polygons.polygons.size(); i++) {
+                            const Model::SplitPolygons::Polygon& polygon = polygons.polygons[i];
+                            const Model::Face& face = *polygon.face;
+                            const Vec3f& normal = polygon.cap ? polygons.capNormal : face.boundary().normal;
+                            const size_t begin = polygons.begin(i);
+                            const size_t vertexCount = polygon.end - begin;
+                            
+                            FaceVertex::List& vertices = triangles[index++];
+                            vertices.reserve(3 * (vertexCount - 2));
+                            for (size_t j = begin + 1; j < polygon.end - 1; j++) {
+                                vertices.push_back(FaceVertex(polygons.vertices[begin], normal, face.textureCoordinates(polygons.vertices[begin])));
+                                vertices.push_back(FaceVertex(polygons.vertices[j], normal, face.textureCoordinates(polygons.vertices[j])));
+                                vertices.push_back(FaceVertex(polygons.vertices[j + 1], normal, face.textureCoordinates(polygons.vertices[j + 1])));
+                            }
+                            triangleSorter.addPolygon(face.texture(), &vertices, vertexCount);
+                        }
+                    }
+                    
+                    m_faceRenderer = new FaceRenderer(vbo, m_textureRendererManager, faceSorter, triangleSorter, m_faceColor);
                 }
                 m_faceRendererValid = true;
             }
@@ -94,11 +124,11 @@ namespace TrenchBroom {
                 delete m_edgeRenderer;
                 m_edgeRenderer = NULL;
                 
-                if (!m_brushes.empty()) {
+                if (!m_brushes.empty() || !m_polygons.empty()) {
                     if (m_edgeMode == EMDefault)
-                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, Model::EmptyFaceList, m_edgeColor);
+                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, m_polygons, m_edgeColor);
                     else
-                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, Model::EmptyFaceList);
+                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, m_polygons);
                 }
                 m_edgeRendererValid = true;
             }
@@ -20,6 +20,7 @@
 #ifndef __TrenchBroom__BrushFigure__
 #define __TrenchBroom__BrushFigure__
 
+#include "Model/BrushGeometryTypes.h"
 #include "Model/BrushTypes.h"
 #include "Renderer/Figure.h"
 #include "Utility/Color.h"
@@ -44,6 +45,7 @@ namespace TrenchBroom {
         private:
             TextureRendererManager& m_textureRendererManager;
             Model::BrushList m_brushes;
+            Model::SplitPolygonsList m_polygons;
             FaceRenderer* m_faceRenderer;
             EdgeRenderer* m_edgeRenderer;
             Color m_faceColor;
@@ -62,12 +64,25 @@ namespace TrenchBroom {
 
             inline void setBrushes(const Model::BrushList& brushes) {
                 m_brushes = brushes;
+                m_polygons.clear();
+                m_edgeRendererValid = false;
+                m_faceRendererValid = false;
+            }
+            
+            /*
+             * Renders the given brushes and the parts of brushes that were split by a plane. The polygons are not
+             * copied and must stay unchanged until they are replaced.
+             */
+            inline void setBrushes(const Model::BrushList& brushes, const Model::SplitPolygonsList& polygons) {
+                m_brushes = brushes;
+                m_polygons = polygons;
                 m_edgeRendererValid = false;
                 m_faceRendererValid = false;
             }
             
             inline void setBrush(Model::Brush& brush) {
                 m_brushes.clear();
+                m_polygons.clear();
                 m_brushes.push_back(&brush);
                 m_edgeRendererValid = false;
                 m_faceRendererValid = false;
@@ -23,124 +23,87 @@
 #include "Model/Entity.h"
 #include "Renderer/MapRenderer.h"
 #include "Renderer/RenderContext.h"
+#include "Renderer/IndexedVertexArray.h"
 #include "Renderer/Shader/Shader.h"
-#include "Renderer/TexturedPolygonSorter.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/Vbo.h"
-#include "Renderer/VertexArray.h"
+#include "Utility/List.h"
 
 namespace TrenchBroom {
     namespace Renderer {
-        void BspModelRenderer::buildVertexArrays() {
-            typedef TexturedPolygonSorter<const Model::BspTexture, Model::BspFace*> FaceSorter;
-            typedef FaceSorter::PolygonCollection FaceCollection;
-            typedef FaceSorter::PolygonCollectionMap FaceCollectionMap;
-            
-            Model::BspModel& model = *m_bsp.models()[0];
-            FaceSorter faceSorter;
-            
+        void BspModelRenderer::buildVertexArray() {
+            const Model::BspModel& model = *m_bsp->models()[0];
+            const Model::BspVertexList& vertices = model.vertices();
             const Model::BspFaceList& faces = model.faces();
-            for (unsigned int i = 0; i < faces.size(); i++) {
-                Model::BspFace* face = faces[i];
-                const Model::BspTexture& texture = face->texture();
-                TextureRenderer* textureRenderer = NULL;
-                
-                TextureCache::iterator textureIt = m_textures.find(&texture);
-                if (textureIt == m_textures.end()) {
-                    textureRenderer = new TextureRenderer(texture, m_palette);
-                    m_textures[&texture] = textureRenderer;
-                }
-                
-                faceSorter.addPolygon(&texture, face, face->vertices().size());
+            const Model::BspTextureList& textures = m_bsp->textures();
+            m_textures.resize(textures.size(), NULL);
+
+            // the faces are sorted by texture, so every texture covers one range of faces
+            for (size_t i = 0; i < faces.size(); i++) {
+                const Model::BspFace& face = faces[i];
+                TextureRenderer*& texture = m_textures[face.textureIndex];
+                if (texture == NULL)
+                    texture = new TextureRenderer(*textures[face.textureIndex], m_palette);
+                if (m_textureRanges.empty() || m_textureRanges.back().texture != texture)
+                    m_textureRanges.push_back(TextureRange(texture, i));
+                m_textureRanges.back().faceCount++;
             }
             
-            const FaceCollectionMap& faceCollectionMap = faceSorter.collections();
-            FaceCollectionMap::const_iterator it, end;
-            Vec2f texCoords;
-            
+            m_vertexArray = new IndexedVertexArray(m_vbo, GL_TRIANGLE_FAN, vertices.size(),
+                                                   Attribute::position3f(),
+                                                   Attribute::texCoord02f(), 0);
             m_vbo.map();
-            for (it = faceCollectionMap.begin(), end = faceCollectionMap.end(); it != end; ++it) {
-                const Model::BspTexture* texture = it->first;
-                Renderer::TextureRenderer* textureRenderer = m_textures[texture];
-                const FaceCollection& faceCollection = it->second;
-                const Model::BspFaceList& collectedFaces = faceCollection.polygons();
-                unsigned int vertexCount = static_cast<unsigned int>(3 * faceCollection.vertexCount() - 6 * collectedFaces.size());
-                
-                VertexArray* vertexArray = new VertexArray(m_vbo, GL_TRIANGLES, vertexCount,
-                                                           Attribute::position3f(),
-                                                           Attribute::texCoord02f());
-                
-                for (unsigned int i = 0; i < collectedFaces.size(); i++) {
-                    Model::BspFace* face = collectedFaces[i];
-                    const Vec3f::List& vertices = face->vertices();
-                    for (unsigned int j = 1; j < vertices.size() - 1; j++) {
-                        face->textureCoordinates(vertices[0], texCoords);
-                        vertexArray->addAttribute(vertices[0]);
-                        vertexArray->addAttribute(texCoords);
-                        
-                        face->textureCoordinates(vertices[j], texCoords);
-                        vertexArray->addAttribute(vertices[j]);
-                        vertexArray->addAttribute(texCoords);
-                        
-                        face->textureCoordinates(vertices[j + 1], texCoords);
-                        vertexArray->addAttribute(vertices[j + 1]);
-                        vertexArray->addAttribute(texCoords);
-                    }
-                }
-                
-                m_vertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
-            }
+            m_vertexArray->addInterleavedVertices(vertices);
             m_vbo.unmap();
+            
+            for (size_t i = 0; i < faces.size(); i++)
+                m_vertexArray->addPrimitive(faces[i].vertexIndex, faces[i].vertexCount);
         }
         
-        BspModelRenderer::BspModelRenderer(const Model::Bsp& bsp, Vbo& vbo, const Palette& palette) :
+        BspModelRenderer::BspModelRenderer(Model::Bsp::Ptr bsp, Vbo& vbo, const Palette& palette) :
         m_bsp(bsp),
         m_palette(palette),
-        m_vbo(vbo) {}
+        m_vbo(vbo),
+        m_vertexArray(NULL) {}
         
         BspModelRenderer::~BspModelRenderer() {
-            TextureCache::iterator it, end;
-            for (it = m_textures.begin(), end = m_textures.end(); it != end; ++it)
-                delete it->second;
-            m_textures.clear();
+            delete m_vertexArray;
+            m_vertexArray = NULL;
+            Utility::deleteAll(m_textures);
         }
 
         void BspModelRenderer::render(ShaderProgram& shaderProgram) {
-            if (m_vertexArrays.empty())
-                buildVertexArrays();
+            if (m_vertexArray == NULL)
+                buildVertexArray();
             
             glActiveTexture(GL_TEXTURE0);
-            for (unsigned int i = 0; i < m_vertexArrays.size(); i++) {
-                TextureVertexArray& textureVertexArray = m_vertexArrays[i];
-                textureVertexArray.texture->activate();
+            for (size_t i = 0; i < m_textureRanges.size(); i++) {
+                const TextureRange& range = m_textureRanges[i];
+                range.texture->activate();
                 shaderProgram.setUniformVariable("Texture", 0);
-                textureVertexArray.vertexArray->render();
-                textureVertexArray.texture->deactivate();
+                m_vertexArray->render(range.firstFace, range.faceCount);
+                range.texture->deactivate();
             }
         }
         
         const Vec3f& BspModelRenderer::center() const {
-            return m_bsp.models()[0]->center();
+            return m_bsp->models()[0]->center();
         }
         
         const BBoxf& BspModelRenderer::bounds() const {
-            return m_bsp.models()[0]->bounds();
+            return m_bsp->models()[0]->bounds();
         }
 
         BBoxf BspModelRenderer::boundsAfterTransformation(const Mat4f& transformation) const {
-            Model::BspModel& model = *m_bsp.models()[0];
-            const Model::BspFaceList& faces = model.faces();
-
-            BBoxf bounds;
-            bounds.min = bounds.max = transformation * faces[0]->vertices()[0];
-            
-            for (unsigned int i = 0; i < faces.size(); i++) {
-                Model::BspFace* face = faces[i];
-                const Vec3f::List& vertices = face->vertices();
-                for (unsigned int j = 0; j < vertices.size(); j++)
-                    bounds.mergeWith(transformation * vertices[j]);
-            }
+            const Model::BspModel& model = *m_bsp->models()[0];
+            const Model::BspVertexList& vertices = model.vertices();
+            if (vertices.empty())
+                return model.bounds();
             
+            BBoxf bounds;
+            bounds.min = bounds.max = transformation * vertices[0].position;
+            for (size_t i = 1; i < vertices.size(); i++)
+                bounds.mergeWith(transformation * vertices[i].position);
             return bounds;
         }
     }
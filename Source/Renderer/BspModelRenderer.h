@@ -21,20 +21,18 @@
 #define TrenchBroom_BspModelRenderer_h
 
 #include <GL/glew.h>
+#include "Model/Bsp.h"
 #include "Renderer/EntityModelRenderer.h"
-#include "Renderer/TextureVertexArray.h"
 
-#include <map>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Model {
-        class Bsp;
-        class BspTexture;
         class Entity;
     }
 
     namespace Renderer {
+        class IndexedVertexArray;
         class Palette;
         class ShaderProgram;
         class TextureRenderer;
@@ -43,19 +41,33 @@ namespace TrenchBroom {
 
         class BspModelRenderer : public EntityModelRenderer {
         private:
-            typedef std::map<const Model::BspTexture*, TextureRenderer*> TextureCache;
+            struct TextureRange {
+                typedef std::vector<TextureRange> List;
+                
+                TextureRenderer* texture;
+                size_t firstFace;
+                size_t faceCount;
+                
+                TextureRange(TextureRenderer* i_texture, size_t i_firstFace) :
+                texture(i_texture),
+                firstFace(i_firstFace),
+                faceCount(0) {}
+            };
+            
+            typedef std::vector<TextureRenderer*> TextureList;
 
-            const Model::Bsp& m_bsp;
+            Model::Bsp::Ptr m_bsp;
 
             const Palette& m_palette;
-            TextureCache m_textures;
+            TextureList m_textures;
 
             Vbo& m_vbo;
-            TextureVertexArrayList m_vertexArrays;
+            IndexedVertexArray* m_vertexArray;
+            TextureRange::List m_textureRanges;
             
-            void buildVertexArrays();
+            void buildVertexArray();
         public:
-            BspModelRenderer(const Model::Bsp& bsp, Vbo& vbo, const Palette& palette);
+            BspModelRenderer(Model::Bsp::Ptr bsp, Vbo& vbo, const Palette& palette);
             ~BspModelRenderer();
             
             void render(ShaderProgram& shaderProgram);
@@ -31,7 +31,15 @@
 
 namespace TrenchBroom {
     namespace Renderer {
-        unsigned int EdgeRenderer::vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces) {
+        namespace {
+            inline const Color& brushColor(const Model::Brush& brush, const Color& defaultColor) {
+                const Model::Entity* entity = brush.entity();
+                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
+                return (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
+            }
+        }
+        
+        unsigned int EdgeRenderer::vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces, const Model::SplitPolygonsList& polygons) {
             Model::BrushList::const_iterator brushIt, brushEnd;
             Model::FaceList::const_iterator faceIt, faceEnd;
             unsigned int vertexCount = 0;
@@ -46,11 +54,15 @@ namespace TrenchBroom {
                 vertexCount += face.edges().size();
             }
             
+            Model::SplitPolygonsList::const_iterator polygonsIt, polygonsEnd;
+            for (polygonsIt = polygons.begin(), polygonsEnd = polygons.end(); polygonsIt != polygonsEnd; ++polygonsIt)
+                vertexCount += static_cast<unsigned int>((*polygonsIt)->vertices.size());
+            
             return 2 * vertexCount;
         }
         
-        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) {
-            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces),
+        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Model::SplitPolygonsList& polygons) {
+            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces, polygons),
                                             Attribute::position3f());
 
             Model::BrushList::const_iterator brushIt, brushEnd;
@@ -76,19 +88,30 @@ namespace TrenchBroom {
                     m_vertexArray->addAttribute(edge.end->position);
                 }
             }
+            
+            Model::SplitPolygonsList::const_iterator polygonsIt, polygonsEnd;
+            for (polygonsIt = polygons.begin(), polygonsEnd = polygons.end(); polygonsIt != polygonsEnd; ++polygonsIt) {
+                const Model::SplitPolygons& splitPolygons = **polygonsIt;
+                for (size_t i = 0; i < splitPolygons.polygons.size(); i++) {
+                    const size_t begin = splitPolygons.begin(i);
+                    const size_t end = splitPolygons.polygons[i].end;
+                    for (size_t j = begin; j < end; j++) {
+                        m_vertexArray->addAttribute(splitPolygons.vertices[j]);
+                        m_vertexArray->addAttribute(splitPolygons.vertices[j + 1 < end ? j + 1 : begin]);
+                    }
+                }
+            }
         }
         
-        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) {
-            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces),
+        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Model::SplitPolygonsList& polygons, const Color& defaultColor) {
+            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces, polygons),
                                             Attribute::position3f(),
                                             Attribute::color4f());
 
             Model::BrushList::const_iterator brushIt, brushEnd;
             for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
                 const Model::Brush& brush = **brushIt;
-                const Model::Entity* entity = brush.entity();
-                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
-                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
+                const Color& color = brushColor(brush, defaultColor);
                 
                 const Model::EdgeList& edges = brush.edges();
                 Model::EdgeList::const_iterator edgeIt, edgeEnd;
@@ -104,10 +127,7 @@ namespace TrenchBroom {
             Model::FaceList::const_iterator faceIt, faceEnd;
             for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                 const Model::Face& face = **faceIt;
-                const Model::Brush* brush = face.brush();
-                const Model::Entity* entity = brush->entity();
-                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
-                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
+                const Color& color = brushColor(*face.brush(), defaultColor);
                 
                 const Model::EdgeList& edges = face.edges();
                 Model::EdgeList::const_iterator edgeIt, edgeEnd;
@@ -119,16 +139,45 @@ namespace TrenchBroom {
                     m_vertexArray->addAttribute(color);
                 }
             }
+            
+            Model::SplitPolygonsList::const_iterator polygonsIt, polygonsEnd;
+            for (polygonsIt = polygons.begin(), polygonsEnd = polygons.end(); polygonsIt != polygonsEnd; ++polygonsIt) {
+                const Model::SplitPolygons& splitPolygons = **polygonsIt;
+                if (splitPolygons.empty())
+                    continue;
+                
+                const Color& color = brushColor(*splitPolygons.polygons.front().face->brush(), defaultColor);
+                for (size_t i = 0; i < splitPolygons.polygons.size(); i++) {
+                    const size_t begin = splitPolygons.begin(i);
+                    const size_t end = splitPolygons.polygons[i].end;
+                    for (size_t j = begin; j < end; j++) {
+                        m_vertexArray->addAttribute(splitPolygons.vertices[j]);
+                        m_vertexArray->addAttribute(color);
+                        m_vertexArray->addAttribute(splitPolygons.vertices[j + 1 < end ? j + 1 : begin]);
+                        m_vertexArray->addAttribute(color);
+                    }
+                }
+            }
         }
 
         EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) :
         m_vertexArray(NULL) {
-            writeEdgeData(vbo, brushes, faces);
+            writeEdgeData(vbo, brushes, faces, Model::EmptySplitPolygonsList);
         }
         
         EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) :
         m_vertexArray(NULL) {
-            writeEdgeData(vbo, brushes, faces, defaultColor);
+            writeEdgeData(vbo, brushes, faces, Model::EmptySplitPolygonsList, defaultColor);
+        }
+        
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::SplitPolygonsList& polygons) :
+        m_vertexArray(NULL) {
+            writeEdgeData(vbo, brushes, Model::EmptyFaceList, polygons);
+        }
+        
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::SplitPolygonsList& polygons, const Color& defaultColor) :
+        m_vertexArray(NULL) {
+            writeEdgeData(vbo, brushes, Model::EmptyFaceList, polygons, defaultColor);
         }
 
         EdgeRenderer::~EdgeRenderer() {
@@ -20,6 +20,7 @@
 #ifndef __TrenchBroom__EdgeRenderer__
 #define __TrenchBroom__EdgeRenderer__
 
+#include "Model/BrushGeometryTypes.h"
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
 #include "Utility/Color.h"
@@ -34,12 +35,19 @@ namespace TrenchBroom {
         protected:
             VertexArray* m_vertexArray;
             
-            unsigned int vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces);
-            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
-            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            unsigned int vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces, const Model::SplitPolygonsList& polygons);
+            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Model::SplitPolygonsList& polygons);
+            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Model::SplitPolygonsList& polygons, const Color& defaultColor);
         public:
             EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
             EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            
+            /*
+             * Also renders the outlines of the given split polygons. Edges that are shared by two polygons are
+             * rendered twice.
+             */
+            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::SplitPolygonsList& polygons);
+            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::SplitPolygonsList& polygons, const Color& defaultColor);
             ~EdgeRenderer();
 
             void render(RenderContext& context);
@@ -20,6 +20,8 @@
 #ifndef TrenchBroom_EntityDecorator_h
 #define TrenchBroom_EntityDecorator_h
 
+#include "Model/EntityTypes.h"
+
 #include <vector>
 
 namespace TrenchBroom {
@@ -45,6 +47,23 @@ namespace TrenchBroom {
             virtual ~EntityDecorator() {}
 
             virtual void invalidate() = 0;
+            
+            /*
+             * Called if only the selection state of some objects has changed. Decorators that can
+             * refresh their selection state cheaply should override this.
+             */
+            virtual void invalidateSelection() {
+                invalidate();
+            }
+            
+            /*
+             * Called if properties of some entities have changed. The given entities are the ones whose links or
+             * position may have changed.
+             */
+            virtual void invalidateEntityProperties(const Model::EntitySet& entities) {
+                invalidate();
+            }
+            
             virtual void render(Vbo& vbo, RenderContext& context) = 0;
         };
     }
@@ -39,22 +39,15 @@ using namespace TrenchBroom::VecMath;
 namespace TrenchBroom {
     namespace Renderer {
         void EntityLinkDecorator::clear() {
-            delete m_selectedLinkArray;
-            m_selectedLinkArray = NULL;
-            delete m_unselectedLinkArray;
-            m_unselectedLinkArray = NULL;
-            delete m_selectedKillLinkArray;
-            m_selectedKillLinkArray = NULL;
-            delete m_unselectedKillLinkArray;
-            m_unselectedKillLinkArray = NULL;
+            m_links.clear();
+            m_killLinks.clear();
+            delete m_linkArray;
+            m_linkArray = NULL;
+            delete m_killLinkArray;
+            m_killLinkArray = NULL;
         }
         
-        void EntityLinkDecorator::makeLink(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const {
-            vertices.push_back(source.center());
-            vertices.push_back(target.center());
-        }
-
-        void EntityLinkDecorator::buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities, Vec3f::List& selectedLinks, Vec3f::List& unselectedLinks, Vec3f::List& selectedKillLinks, Vec3f::List& unselectedKillLinks) const {
+        void EntityLinkDecorator::buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities) {
             if (context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayLocal && depth > 1)
                 return;
 
@@ -71,45 +64,201 @@ namespace TrenchBroom {
             for (entityIt = linkTargets.begin(), entityEnd = linkTargets.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& target = **entityIt;
                 if (entityVisible && context.filter().entityVisible(target) &&
-                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected()))
-                    makeLink(target, entity, entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected() ? selectedLinks : unselectedLinks);
+                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || EntityLink::linkSelected(entity, target)))
+                    m_links.push_back(EntityLink(entity, target));
                 if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth == 0)
-                    buildLinks(context, target, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                    buildLinks(context, target, depth + 1, visitedEntities);
             }
             
             const Model::EntityList& linkSources = entity.linkSources();
             for (entityIt = linkSources.begin(), entityEnd = linkSources.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& source = **entityIt;
                 if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth <= 1)
-                    buildLinks(context, source, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                    buildLinks(context, source, depth + 1, visitedEntities);
             }
             
             const Model::EntityList& killTargets = entity.killTargets();
             for (entityIt = killTargets.begin(), entityEnd = killTargets.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& target = **entityIt;
                 if (entityVisible && context.filter().entityVisible(target) &&
-                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected()))
-                    makeLink(target, entity, entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected() ? selectedKillLinks : unselectedKillLinks);
+                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || EntityLink::linkSelected(entity, target)))
+                    m_killLinks.push_back(EntityLink(entity, target));
                 if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth == 0)
-                    buildLinks(context, target, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                    buildLinks(context, target, depth + 1, visitedEntities);
             }
             
             const Model::EntityList& killSources = entity.killSources();
             for (entityIt = killSources.begin(), entityEnd = killSources.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& source = **entityIt;
                 if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth <= 1)
-                    buildLinks(context, source, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                    buildLinks(context, source, depth + 1, visitedEntities);
+            }
+        }
+        
+        void EntityLinkDecorator::buildAllLinks(RenderContext& context) {
+            // every entity contributes its outgoing edges exactly once, so there is no need to walk the graph
+            const Model::EntityList& entities = document().map().entities();
+            Model::EntityList::const_iterator it, end, entityIt, entityEnd;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Model::Entity& entity = **it;
+                if (!context.filter().entityVisible(entity))
+                    continue;
+                
+                const Model::EntityList& linkTargets = entity.linkTargets();
+                for (entityIt = linkTargets.begin(), entityEnd = linkTargets.end(); entityIt != entityEnd; ++entityIt) {
+                    Model::Entity& target = **entityIt;
+                    if (context.filter().entityVisible(target))
+                        m_links.push_back(EntityLink(entity, target));
+                }
+
+                const Model::EntityList& killTargets = entity.killTargets();
+                for (entityIt = killTargets.begin(), entityEnd = killTargets.end(); entityIt != entityEnd; ++entityIt) {
+                    Model::Entity& target = **entityIt;
+                    if (context.filter().entityVisible(target))
+                        m_killLinks.push_back(EntityLink(entity, target));
+                }
+            }
+        }
+        
+        VertexArray* EntityLinkDecorator::makeLinkArray(Vbo& vbo, const EntityLink::List& links) const {
+            if (links.empty())
+                return NULL;
+            
+            // link i occupies vertices 2i and 2i+1, the texture coordinate holds its selection state; the spare
+            // capacity takes the links that are added when entities change
+            VertexArray* linkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(2 * (links.size() + links.size() / 4 + 16)),
+                                                     Attribute::position3f(),
+                                                     Attribute(1, GL_FLOAT, Attribute::TexCoord0), 0);
+            EntityLink::List::const_iterator it, end;
+            for (it = links.begin(), end = links.end(); it != end; ++it) {
+                const EntityLink& link = *it;
+                const float selected = link.selected ? 1.0f : 0.0f;
+                linkArray->addAttribute(link.target->center());
+                linkArray->addAttribute(selected);
+                linkArray->addAttribute(link.source->center());
+                linkArray->addAttribute(selected);
+            }
+            return linkArray;
+        }
+        
+        void EntityLinkDecorator::writeLink(VertexArray& linkArray, size_t index, const EntityLink& link) const {
+            const float selected = link.selected ? 1.0f : 0.0f;
+            linkArray.setAttribute(2 * index, 0, link.target->center());
+            linkArray.setAttribute(2 * index, 1, selected);
+            linkArray.setAttribute(2 * index + 1, 0, link.source->center());
+            linkArray.setAttribute(2 * index + 1, 1, selected);
+        }
+        
+        void EntityLinkDecorator::updateLinkArray(EntityLink::List& links, VertexArray& linkArray) const {
+            for (size_t i = 0; i < links.size(); i++) {
+                EntityLink& link = links[i];
+                const bool selected = EntityLink::linkSelected(*link.source, *link.target);
+                if (selected != link.selected) {
+                    link.selected = selected;
+                    linkArray.setAttribute(2 * i, 1, selected ? 1.0f : 0.0f);
+                    linkArray.setAttribute(2 * i + 1, 1, selected ? 1.0f : 0.0f);
+                }
+            }
+        }
+
+        void EntityLinkDecorator::removeChangedLinks(EntityLink::List& links, VertexArray* linkArray) const {
+            // the last link fills the gap, so only its slot has to be rewritten
+            size_t i = 0;
+            while (i < links.size()) {
+                const EntityLink& link = links[i];
+                if (m_changedEntities.count(link.source) > 0 || m_changedEntities.count(link.target) > 0) {
+                    links[i] = links.back();
+                    links.pop_back();
+                    if (i < links.size())
+                        writeLink(*linkArray, i, links[i]);
+                } else {
+                    i++;
+                }
+            }
+            
+            if (linkArray != NULL)
+                linkArray->truncate(2 * links.size());
+        }
+        
+        void EntityLinkDecorator::addLinks(Vbo& vbo, const EntityLink::List& newLinks, EntityLink::List& links, VertexArray*& linkArray) const {
+            if (newLinks.empty())
+                return;
+            
+            links.insert(links.end(), newLinks.begin(), newLinks.end());
+            if (linkArray == NULL || linkArray->vertexCapacity() < 2 * links.size()) {
+                delete linkArray;
+                linkArray = makeLinkArray(vbo, links);
+                return;
+            }
+            
+            EntityLink::List::const_iterator it, end;
+            for (it = newLinks.begin(), end = newLinks.end(); it != end; ++it) {
+                const EntityLink& link = *it;
+                const float selected = link.selected ? 1.0f : 0.0f;
+                linkArray->addAttribute(link.target->center());
+                linkArray->addAttribute(selected);
+                linkArray->addAttribute(link.source->center());
+                linkArray->addAttribute(selected);
+            }
+        }
+        
+        void EntityLinkDecorator::updateChangedLinks(Vbo& vbo, RenderContext& context) {
+            SetVboState mapVbo(vbo, Vbo::VboMapped);
+            removeChangedLinks(m_links, m_linkArray);
+            removeChangedLinks(m_killLinks, m_killLinkArray);
+            
+            // a link between two changed entities is added with its source
+            EntityLink::List newLinks;
+            EntityLink::List newKillLinks;
+            Model::EntitySet::const_iterator it, end;
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (it = m_changedEntities.begin(), end = m_changedEntities.end(); it != end; ++it) {
+                Model::Entity& entity = **it;
+                if (entity.map() == NULL || !context.filter().entityVisible(entity))
+                    continue;
+                
+                const Model::EntityList& linkTargets = entity.linkTargets();
+                for (entityIt = linkTargets.begin(), entityEnd = linkTargets.end(); entityIt != entityEnd; ++entityIt) {
+                    Model::Entity& target = **entityIt;
+                    if (context.filter().entityVisible(target))
+                        newLinks.push_back(EntityLink(entity, target));
+                }
+                
+                const Model::EntityList& linkSources = entity.linkSources();
+                for (entityIt = linkSources.begin(), entityEnd = linkSources.end(); entityIt != entityEnd; ++entityIt) {
+                    Model::Entity& source = **entityIt;
+                    if (m_changedEntities.count(&source) == 0 && context.filter().entityVisible(source))
+                        newLinks.push_back(EntityLink(source, entity));
+                }
+                
+                const Model::EntityList& killTargets = entity.killTargets();
+                for (entityIt = killTargets.begin(), entityEnd = killTargets.end(); entityIt != entityEnd; ++entityIt) {
+                    Model::Entity& target = **entityIt;
+                    if (context.filter().entityVisible(target))
+                        newKillLinks.push_back(EntityLink(entity, target));
+                }
+                
+                const Model::EntityList& killSources = entity.killSources();
+                for (entityIt = killSources.begin(), entityEnd = killSources.end(); entityIt != entityEnd; ++entityIt) {
+                    Model::Entity& source = **entityIt;
+                    if (m_changedEntities.count(&source) == 0 && context.filter().entityVisible(source))
+                        newKillLinks.push_back(EntityLink(source, entity));
+                }
             }
+            
+            addLinks(vbo, newLinks, m_links, m_linkArray);
+            addLinks(vbo, newKillLinks, m_killLinks, m_killLinkArray);
+            m_changedEntities.clear();
         }
 
         EntityLinkDecorator::EntityLinkDecorator(const Model::MapDocument& document, const Color& color) :
         EntityDecorator(document),
         m_color(color),
-        m_selectedLinkArray(NULL),
-        m_unselectedLinkArray(NULL),
-        m_selectedKillLinkArray(NULL),
-        m_unselectedKillLinkArray(NULL),
-        m_valid(false) {}
+        m_linkArray(NULL),
+        m_killLinkArray(NULL),
+        m_linkDisplayMode(View::ViewOptions::LinkDisplayNone),
+        m_valid(false),
+        m_selectionValid(false) {}
 
         EntityLinkDecorator::~EntityLinkDecorator() {
             clear();
@@ -121,44 +270,44 @@ namespace TrenchBroom {
 
             SetVboState activateVbo(vbo, Vbo::VboActive);
             
-            if (!m_valid) {
+            if (!m_valid || m_linkDisplayMode != context.viewOptions().linkDisplayMode()) {
                 clear();
                 
-                Vec3f::List selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks;
-                Model::EntitySet visitedEntities;
-
-                const Model::EntityList& entities = context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayAll ? document().map().entities() : document().editStateManager().allSelectedEntities();
-                Model::EntityList::const_iterator it, end;
-                for (it = entities.begin(), end = entities.end(); it != end; ++it) {
-                    Model::Entity& entity = **it;
-                    buildLinks(context, entity, 0, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                m_linkDisplayMode = context.viewOptions().linkDisplayMode();
+                if (m_linkDisplayMode == View::ViewOptions::LinkDisplayAll) {
+                    buildAllLinks(context);
+                } else {
+                    Model::EntitySet visitedEntities;
+                    const Model::EntityList& entities = document().editStateManager().allSelectedEntities();
+                    Model::EntityList::const_iterator it, end;
+                    for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                        Model::Entity& entity = **it;
+                        buildLinks(context, entity, 0, visitedEntities);
+                    }
                 }
                 
                 SetVboState mapVbo(vbo, Vbo::VboMapped);
-                if (!selectedLinks.empty()) {
-                    m_selectedLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(selectedLinks.size()), Attribute::position3f(), 0);
-                    m_selectedLinkArray->addAttributes(selectedLinks);
-                }
+                m_linkArray = makeLinkArray(vbo, m_links);
+                m_killLinkArray = makeLinkArray(vbo, m_killLinks);
                 
-                if (!unselectedLinks.empty()) {
-                    m_unselectedLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(unselectedLinks.size()), Attribute::position3f(), 0);
-                    m_unselectedLinkArray->addAttributes(unselectedLinks);
-                }
-
-                if (!selectedKillLinks.empty()) {
-                    m_selectedKillLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(selectedKillLinks.size()), Attribute::position3f(), 0);
-                    m_selectedKillLinkArray->addAttributes(selectedKillLinks);
-                }
-                
-                if (!unselectedKillLinks.empty()) {
-                    m_unselectedKillLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(unselectedKillLinks.size()), Attribute::position3f(), 0);
-                    m_unselectedKillLinkArray->addAttributes(unselectedKillLinks);
-                }
-
                 m_valid = true;
+                m_selectionValid = true;
+                m_changedEntities.clear();
+            } else {
+                if (!m_changedEntities.empty())
+                    updateChangedLinks(vbo, context);
+                if (!m_selectionValid) {
+                    SetVboState mapVbo(vbo, Vbo::VboMapped);
+                    if (m_linkArray != NULL)
+                        updateLinkArray(m_links, *m_linkArray);
+                    if (m_killLinkArray != NULL)
+                        updateLinkArray(m_killLinks, *m_killLinkArray);
+                    
+                    m_selectionValid = true;
+                }
             }
 
-            if (m_selectedLinkArray == NULL && m_unselectedLinkArray == NULL)
+            if (m_linkArray == NULL && m_killLinkArray == NULL)
                 return;
 
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
@@ -172,46 +321,30 @@ namespace TrenchBroom {
             glDepthMask(GL_FALSE);
             glDisable(GL_DEPTH_TEST);
 
-            if (m_unselectedLinkArray != NULL) {
+            if (m_linkArray != NULL) {
                 shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityLinkColor));
-                m_unselectedLinkArray->render();
+                shader.setUniformVariable("SelectedColor", prefs.getColor(Preferences::OccludedSelectedEntityLinkColor));
+                m_linkArray->render();
             }
             
-            if (m_selectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityLinkColor));
-                m_selectedLinkArray->render();
-            }
-            
-            if (m_unselectedKillLinkArray != NULL) {
+            if (m_killLinkArray != NULL) {
                 shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityKillLinkColor));
-                m_unselectedKillLinkArray->render();
-            }
-            
-            if (m_selectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityKillLinkColor));
-                m_selectedKillLinkArray->render();
+                shader.setUniformVariable("SelectedColor", prefs.getColor(Preferences::OccludedSelectedEntityKillLinkColor));
+                m_killLinkArray->render();
             }
             
             glEnable(GL_DEPTH_TEST);
 
-            if (m_unselectedLinkArray != NULL) {
+            if (m_linkArray != NULL) {
                 shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityLinkColor));
-                m_unselectedLinkArray->render();
-            }
-
-            if (m_selectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityLinkColor));
-                m_selectedLinkArray->render();
+                shader.setUniformVariable("SelectedColor", prefs.getColor(Preferences::SelectedEntityLinkColor));
+                m_linkArray->render();
             }
             
-            if (m_unselectedKillLinkArray != NULL) {
+            if (m_killLinkArray != NULL) {
                 shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityKillLinkColor));
-                m_unselectedKillLinkArray->render();
-            }
-            
-            if (m_selectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityKillLinkColor));
-                m_selectedKillLinkArray->render();
+                shader.setUniformVariable("SelectedColor", prefs.getColor(Preferences::SelectedEntityKillLinkColor));
+                m_killLinkArray->render();
             }
 
             glDepthMask(GL_TRUE);
@@ -26,6 +26,8 @@
 #include "Utility/Color.h"
 #include "View/ViewOptions.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class MapDocument;
@@ -36,22 +38,72 @@ namespace TrenchBroom {
         
         class EntityLinkDecorator : public EntityDecorator {
         private:
+            class EntityLink {
+            public:
+                Model::Entity* source;
+                Model::Entity* target;
+                bool selected;
+
+                EntityLink(Model::Entity& i_source, Model::Entity& i_target) :
+                source(&i_source),
+                target(&i_target),
+                selected(linkSelected(i_source, i_target)) {}
+
+                static inline bool linkSelected(const Model::Entity& source, const Model::Entity& target) {
+                    return source.selected() || source.partiallySelected() || target.selected() || target.partiallySelected();
+                }
+
+                typedef std::vector<EntityLink> List;
+            };
+
             Color m_color;
-            VertexArray* m_selectedLinkArray;
-            VertexArray* m_unselectedLinkArray;
-            VertexArray* m_selectedKillLinkArray;
-            VertexArray* m_unselectedKillLinkArray;
+            EntityLink::List m_links;
+            EntityLink::List m_killLinks;
+            VertexArray* m_linkArray;
+            VertexArray* m_killLinkArray;
+            View::ViewOptions::LinkDisplayMode m_linkDisplayMode;
             bool m_valid;
+            bool m_selectionValid;
+            Model::EntitySet m_changedEntities;
             
             void clear();
-            void makeLink(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const;
-            void buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities, Vec3f::List& selectedLinks, Vec3f::List& unselectedLinks, Vec3f::List& selectedKillLinks, Vec3f::List& unselectedKillLinks) const;
+            void buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities);
+            void buildAllLinks(RenderContext& context);
+            VertexArray* makeLinkArray(Vbo& vbo, const EntityLink::List& links) const;
+            void writeLink(VertexArray& linkArray, size_t index, const EntityLink& link) const;
+            void updateLinkArray(EntityLink::List& links, VertexArray& linkArray) const;
+            void removeChangedLinks(EntityLink::List& links, VertexArray* linkArray) const;
+            void addLinks(Vbo& vbo, const EntityLink::List& newLinks, EntityLink::List& links, VertexArray*& linkArray) const;
+            void updateChangedLinks(Vbo& vbo, RenderContext& context);
         public:
             EntityLinkDecorator(const Model::MapDocument& document, const Color& color);
             ~EntityLinkDecorator();
             
             inline void invalidate() {
                 m_valid = false;
+                m_changedEntities.clear();
+            }
+            
+            /*
+             * Only the selection state of the linked entities has changed. If all links are shown,
+             * the affected links are recolored in place, otherwise the links are rebuilt.
+             */
+            inline void invalidateSelection() {
+                if (m_linkDisplayMode == View::ViewOptions::LinkDisplayAll)
+                    m_selectionValid = false;
+                else
+                    m_valid = false;
+            }
+
+            /*
+             * If all links are shown, only the links of the given entities are replaced, otherwise the links are
+             * rebuilt.
+             */
+            inline void invalidateEntityProperties(const Model::EntitySet& entities) {
+                if (m_valid && m_linkDisplayMode == View::ViewOptions::LinkDisplayAll)
+                    m_changedEntities.insert(entities.begin(), entities.end());
+                else
+                    invalidate();
             }
 
             void render(Vbo& vbo, RenderContext& context);
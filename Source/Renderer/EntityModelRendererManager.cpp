@@ -71,18 +71,25 @@ namespace TrenchBroom {
                 unsigned int frameIndex = modelDefinition.frameIndex();
 
                 Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
-                const Model::Alias* alias = aliasManager.alias(modelName, searchPaths, m_console);
+                Model::AliasManager::ModelState state;
+                Model::Alias::Ptr alias = aliasManager.alias(modelName, searchPaths, m_console, state);
+                if (state == Model::AliasManager::ModelPending)
+                    return NULL;
 
-                if (alias != NULL && skinIndex < alias->skins().size() && frameIndex < alias->frames().size()) {
-                    Renderer::EntityModelRenderer* renderer = new AliasModelRenderer(*alias, frameIndex, skinIndex, *m_vbo, *m_palette);
+                if (alias.get() != NULL && skinIndex < alias->skins().size() && frameIndex < alias->frames().size()) {
+                    Renderer::EntityModelRenderer* renderer = new AliasModelRenderer(alias, frameIndex, skinIndex, *m_vbo, *m_palette);
                     m_modelRenderers[key] = renderer;
                     return renderer;
                 }
             } else if (ext == "bsp") {
                 Model::BspManager& bspManager = *Model::BspManager::sharedManager;
-                const Model::Bsp* bsp = bspManager.bsp(modelName, searchPaths, m_console);
-                if (bsp != NULL) {
-                    Renderer::EntityModelRenderer* renderer = new BspModelRenderer(*bsp, *m_vbo, *m_palette);
+                Model::BspManager::ModelState state;
+                Model::Bsp::Ptr bsp = bspManager.bsp(modelName, searchPaths, m_console, state);
+                if (state == Model::BspManager::ModelPending)
+                    return NULL;
+
+                if (bsp.get() != NULL) {
+                    Renderer::EntityModelRenderer* renderer = new BspModelRenderer(bsp, *m_vbo, *m_palette);
                     m_modelRenderers[key] = renderer;
                     return renderer;
                 }
@@ -97,12 +104,13 @@ namespace TrenchBroom {
         EntityModelRendererManager::EntityModelRendererManager(Utility::Console& console) :
         m_palette(NULL),
         m_console(console),
-        m_valid(true) {
+        m_valid(true),
+        m_generation(0) {
             m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
         }
 
         EntityModelRendererManager::~EntityModelRendererManager() {
-            clear();
+            Utility::deleteAll(m_modelRenderers);
             delete m_vbo;
             m_vbo = NULL;
         }
@@ -128,12 +136,35 @@ namespace TrenchBroom {
         void EntityModelRendererManager::clear() {
             clearMismatches();
             Utility::deleteAll(m_modelRenderers);
+
+            // models that were only kept alive by the deleted renderers can be evicted now
+            if (Model::AliasManager::sharedManager != NULL)
+                Model::AliasManager::sharedManager->evictUnusedModels(m_console);
+            if (Model::BspManager::sharedManager != NULL)
+                Model::BspManager::sharedManager->evictUnusedModels(m_console);
         }
         
         void EntityModelRendererManager::clearMismatches() {
             m_mismatches.clear();
         }
 
+        bool EntityModelRendererManager::updatePendingModels() {
+            Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
+            Model::BspManager& bspManager = *Model::BspManager::sharedManager;
+            aliasManager.updatePendingModels(m_console);
+            bspManager.updatePendingModels(m_console);
+
+            const size_t generation = aliasManager.generation() + bspManager.generation();
+            if (generation == m_generation)
+                return false;
+            m_generation = generation;
+            return true;
+        }
+
+        bool EntityModelRendererManager::pendingModels() const {
+            return Model::AliasManager::sharedManager->pendingModels() || Model::BspManager::sharedManager->pendingModels();
+        }
+
         void EntityModelRendererManager::setPalette(const Palette& palette) {
             if (&palette == m_palette)
                 return;
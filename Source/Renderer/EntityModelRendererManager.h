@@ -54,6 +54,7 @@ namespace TrenchBroom {
             EntityModelRendererCache m_modelRenderers;
             MismatchCache m_mismatches;
             bool m_valid;
+            size_t m_generation;
 
             const String modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
             EntityModelRenderer* modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
@@ -70,6 +71,14 @@ namespace TrenchBroom {
             void clear();
             void clearMismatches();
             
+            /*
+             * Models are loaded in the background, and modelRenderer returns NULL while an entity's model is still
+             * pending. Returns true if any model has finished loading since the last call, in which case the callers
+             * must ask for their model renderers again.
+             */
+            bool updatePendingModels();
+            bool pendingModels() const;
+            
             void setPalette(const Palette& palette);
             
             void activate();
@@ -255,6 +255,7 @@ namespace TrenchBroom {
             assert(font != NULL);
             
             m_classnameRenderer = new EntityClassnameRenderer(*font);
+            m_classnameRenderer->setRejectOverlaps(true);
         }
 
         EntityRenderer::~EntityRenderer() {
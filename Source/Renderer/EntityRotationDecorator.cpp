@@ -83,8 +83,9 @@ namespace TrenchBroom {
                     const float angle = angleFrom(rotZ, onPlane, direction);
                     
                     const Mat4f matrix = translationMatrix(center) * rotationMatrix(angle, -direction) * rotationMatrix(entity.rotation()) * translationMatrix(16.0f * Vec3f::PosX);
-                    for (size_t i = 0; i < 3; i++)
-                        vertices.push_back(matrix * triangle[i]);
+                    const size_t offset = vertices.size();
+                    vertices.resize(offset + 3);
+                    transformPoints(matrix, triangle, 3, &vertices[offset]);
                 }
             }
             
@@ -36,28 +36,41 @@ namespace TrenchBroom {
     namespace Renderer {
         String FaceRenderer::AlphaBlendedTextures[] = {"clip", "hint", "skip", "hintskip", "trigger"};
 
-        void FaceRenderer::writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter) {
-            const FaceCollectionMap& faceCollectionMap = faceSorter.collections();
-            if (faceCollectionMap.empty())
+        namespace {
+            inline const FaceVertex::List& triangles(const Model::Face* face) {
+                return face->cachedVertices();
+            }
+            
+            inline const FaceVertex::List& triangles(const FaceVertex::List* triangles) {
+                return *triangles;
+            }
+        }
+        
+        template <class PolygonSorter>
+        void FaceRenderer::writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const PolygonSorter& polygonSorter) {
+            typedef typename PolygonSorter::PolygonCollection PolygonCollection;
+            typedef typename PolygonSorter::PolygonCollectionMap PolygonCollectionMap;
+            typedef typename PolygonSorter::PolygonList PolygonList;
+            
+            const PolygonCollectionMap& polygonCollectionMap = polygonSorter.collections();
+            if (polygonCollectionMap.empty())
                 return;
             
-            FaceCollectionMap::const_iterator it, end;
-            for (it = faceCollectionMap.begin(), end = faceCollectionMap.end(); it != end; ++it) {
+            typename PolygonCollectionMap::const_iterator it, end;
+            for (it = polygonCollectionMap.begin(), end = polygonCollectionMap.end(); it != end; ++it) {
                 Model::Texture* texture = it->first;
                 TextureRenderer* textureRenderer = texture != NULL ? &textureRendererManager.renderer(texture) : NULL;
-                const FaceCollection& faceCollection = it->second;
-                const Model::FaceList& faces = faceCollection.polygons();
-                const size_t vertexCount = 3 * faceCollection.vertexCount() - 6 * faces.size();
+                const PolygonCollection& polygonCollection = it->second;
+                const PolygonList& polygons = polygonCollection.polygons();
+                const size_t vertexCount = 3 * polygonCollection.vertexCount() - 6 * polygons.size();
                 VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
                                                            Attribute::position3f(),
                                                            Attribute::normal3f(),
                                                            Attribute::texCoord02f(),
                                                            0);
                 
-                for (size_t i = 0; i < faces.size(); i++) {
-                    Model::Face* face = faces[i];
-                    vertexArray->addAttributes(face->cachedVertices());
-                }
+                for (size_t i = 0; i < polygons.size(); i++)
+                    vertexArray->addAttributes(triangles(polygons[i]));
                 
                 if (texture != NULL && alphaBlend(texture->name()))
                     m_transparentVertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
@@ -137,6 +150,12 @@ namespace TrenchBroom {
             writeFaceData(vbo, textureRendererManager, faceSorter);
         }
         
+        FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const TriangleSorter& triangleSorter, const Color& faceColor) :
+        m_faceColor(faceColor) {
+            writeFaceData(vbo, textureRendererManager, faceSorter);
+            writeFaceData(vbo, textureRendererManager, triangleSorter);
+        }
+        
         void FaceRenderer::render(RenderContext& context, bool grayScale) {
             render(context, grayScale, NULL);
         }
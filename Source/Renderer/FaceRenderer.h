@@ -20,6 +20,7 @@
 #ifndef __TrenchBroom__FaceRenderer__
 #define __TrenchBroom__FaceRenderer__
 
+#include "Renderer/FaceVertex.h"
 #include "Renderer/TexturedPolygonSorter.h"
 #include "Renderer/TextureVertexArray.h"
 #include "Utility/Color.h"
@@ -38,9 +39,13 @@ namespace TrenchBroom {
         class FaceRenderer {
         public:
             typedef TexturedPolygonSorter<Model::Texture, Model::Face*> Sorter;
+            
+            /*
+             * Sorts polygons that are not faces of a brush, given as triangles. Every polygon must be added with its
+             * number of vertices, not with the number of triangle vertices.
+             */
+            typedef TexturedPolygonSorter<Model::Texture, const FaceVertex::List*> TriangleSorter;
         protected:
-            typedef Sorter::PolygonCollection FaceCollection;
-            typedef Sorter::PolygonCollectionMap FaceCollectionMap;
 
             Color m_faceColor;
             TextureVertexArrayList m_vertexArrays;
@@ -59,13 +64,15 @@ namespace TrenchBroom {
                 return false;
             }
             
-            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
+            template <class PolygonSorter>
+            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const PolygonSorter& polygonSorter);
             void render(RenderContext& context, bool grayScale, const Color* tintColor);
             void renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture);
             void renderTransparentFaces(ShaderProgram& shader, const bool applyTexture);
             void renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture);
         public:
             FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor);
+            FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const TriangleSorter& triangleSorter, const Color& faceColor);
             
             void render(RenderContext& context, bool grayScale);
             void render(RenderContext& context, bool grayScale, const Color& tintColor);
@@ -27,6 +27,7 @@
 #include "Renderer/Shader/Shader.h"
 #include "Utility/String.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -85,6 +86,17 @@ namespace TrenchBroom {
                 
             }
 
+            /*
+             * Adds a primitive made of vertices that have already been written, e.g. by addInterleavedVertices.
+             */
+            inline void addPrimitive(size_t firstVertex, size_t vertexCount) {
+                assert(firstVertex + vertexCount <= m_vertexCount);
+                m_primIndices.push_back(static_cast<GLint>(firstVertex));
+                m_primVertexCounts.push_back(static_cast<GLsizei>(vertexCount));
+                m_primCount++;
+                m_currentPrimIndex = std::max(m_currentPrimIndex, firstVertex + vertexCount);
+            }
+            
             inline void render() {
                 if (m_primCount == 0)
                     return;
@@ -99,6 +111,16 @@ namespace TrenchBroom {
                 glMultiDrawArrays(m_primType, indexArray, countArray, static_cast<GLint>(m_primCount));
                 cleanup();
             }
+            
+            inline void render(size_t firstPrimitive, size_t primitiveCount) {
+                assert(firstPrimitive + primitiveCount <= m_primCount);
+                if (primitiveCount == 0)
+                    return;
+                
+                setup();
+                glMultiDrawArrays(m_primType, &m_primIndices[firstPrimitive], &m_primVertexCounts[firstPrimitive], static_cast<GLint>(primitiveCount));
+                cleanup();
+            }
         };
     }
 }
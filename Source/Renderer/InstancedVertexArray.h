@@ -21,9 +21,11 @@
 #define TrenchBroom_InstancedVertexArray_h
 
 #include "Renderer/AttributeArray.h"
+#include "Utility/InstanceBuffer.h"
 #include "Utility/List.h"
 #include "Utility/String.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -41,6 +43,14 @@ namespace TrenchBroom {
             GLint m_textureSize;
         protected:
             virtual GLint createTexture(GLuint textureId) = 0;
+            
+            /*
+             Called whenever the texture is bound again. Returns the new size of the texture if it had to be
+             recreated.
+             */
+            virtual GLint updateTexture(GLuint textureId, GLint textureSize) {
+                return textureSize;
+            }
         public:
             InstanceAttributes(const String& name) :
             m_name(name),
@@ -77,6 +87,7 @@ namespace TrenchBroom {
                     m_textureSize = createTexture(m_textureId);
                 } else {
                     glBindTexture(GL_TEXTURE_2D, m_textureId);
+                    m_textureSize = updateTexture(m_textureId, m_textureSize);
                 }
             }
             
@@ -116,6 +127,74 @@ namespace TrenchBroom {
             m_vertices(vertices) {}
         };
         
+        /*
+         Instance attributes that mirror an instance buffer. The texture is only created once, afterwards only the
+         slots that changed in the buffer are uploaded again, and the texture grows with the buffer.
+         */
+        class InstanceAttributesBuffer : public InstanceAttributes {
+        private:
+            Utility::InstanceBuffer& m_buffer;
+            
+            inline void upload(const GLint textureSize, const size_t begin, const size_t end) {
+                const size_t size = static_cast<size_t>(textureSize);
+                const Vec4f::List& instances = m_buffer.instances();
+                
+                // upload the partial first and last rows separately and all rows in between at once
+                size_t index = begin;
+                while (index < end) {
+                    const size_t row = index / size;
+                    const size_t column = index % size;
+                    size_t count;
+                    GLsizei width, height;
+                    if (column > 0 || end - index < size) {
+                        count = std::min(size - column, end - index);
+                        width = static_cast<GLsizei>(count);
+                        height = 1;
+                    } else {
+                        count = (end - index) / size * size;
+                        width = textureSize;
+                        height = static_cast<GLsizei>(count / size);
+                    }
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(column), static_cast<GLint>(row), width, height, GL_RGBA, GL_FLOAT, reinterpret_cast<const GLvoid*>(&instances[index]));
+                    index += count;
+                }
+            }
+        protected:
+            GLint createTexture(GLuint textureId) {
+                size_t size = 1;
+                while (size * size < m_buffer.size())
+                    size *= 2;
+                
+                // requires GL_ARB_texture_float, see http://www.opengl.org/wiki/Floating_point_and_mipmapping_and_filtering
+                GLint textureSize = static_cast<GLint>(size);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, textureSize, textureSize, 0, GL_RGBA, GL_FLOAT, NULL);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                
+                upload(textureSize, 0, m_buffer.size());
+                m_buffer.clean();
+                
+                return textureSize;
+            }
+            
+            GLint updateTexture(GLuint textureId, GLint textureSize) {
+                if (m_buffer.size() > static_cast<size_t>(textureSize * textureSize))
+                    return createTexture(textureId);
+                
+                if (m_buffer.dirty()) {
+                    upload(textureSize, m_buffer.dirtyBegin(), m_buffer.dirtyEnd());
+                    m_buffer.clean();
+                }
+                return textureSize;
+            }
+        public:
+            InstanceAttributesBuffer(const String& name, Utility::InstanceBuffer& buffer) :
+            InstanceAttributes(name),
+            m_buffer(buffer) {}
+        };
+        
         // requires ARB_draw_instanced and ARB_texture_float
         class InstancedVertexArray : public RenderArray {
         protected:
@@ -156,6 +235,19 @@ namespace TrenchBroom {
                 m_instanceAttributes.push_back(new InstanceAttributesVec4f(name, values));
             }
             
+            /*
+             Adds instance attributes that follow the given buffer. The instance count must be updated whenever the
+             size of the buffer changes.
+             */
+            inline void addAttributeArray(const String& name, Utility::InstanceBuffer& buffer) {
+                assert(buffer.size() == m_instanceCount);
+                m_instanceAttributes.push_back(new InstanceAttributesBuffer(name, buffer));
+            }
+            
+            inline void setInstanceCount(const unsigned int instanceCount) {
+                m_instanceCount = instanceCount;
+            }
+            
             inline void render(ShaderProgram& program) {
                 bindAttributes(program);
                 setup();
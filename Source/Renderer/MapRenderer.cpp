@@ -54,6 +54,7 @@
 #include "Utility/Grid.h"
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -67,6 +68,7 @@ namespace TrenchBroom {
         static const int EntityBoundsVertexSize = ColorSize + VertexSize;
 
         void MapRenderer::rebuildGeometryData(RenderContext& context) {
+            TB_PROFILE_ZONE("MapRenderer::rebuildGeometryData");
             if (!m_geometryDataValid) {
                 delete m_faceRenderer;
                 m_faceRenderer = NULL;
@@ -216,6 +218,22 @@ namespace TrenchBroom {
                 decorator.invalidate();
             }
         }
+        
+        void MapRenderer::invalidateDecoratorProperties(const Model::EntitySet& entities) {
+            EntityDecorator::List::const_iterator decoratorIt, decoratorEnd;
+            for (decoratorIt = m_entityDecorators.begin(), decoratorEnd = m_entityDecorators.end(); decoratorIt != decoratorEnd; ++decoratorIt) {
+                EntityDecorator& decorator = **decoratorIt;
+                decorator.invalidateEntityProperties(entities);
+            }
+        }
+        
+        void MapRenderer::invalidateDecoratorSelection() {
+            EntityDecorator::List::const_iterator decoratorIt, decoratorEnd;
+            for (decoratorIt = m_entityDecorators.begin(), decoratorEnd = m_entityDecorators.end(); decoratorIt != decoratorEnd; ++decoratorIt) {
+                EntityDecorator& decorator = **decoratorIt;
+                decorator.invalidateSelection();
+            }
+        }
 
         void MapRenderer::renderFaces(RenderContext& context) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
@@ -282,7 +300,7 @@ namespace TrenchBroom {
                 changeSet.brushStateChangedTo(Model::EditState::Default) ||
                 changeSet.faceSelectionChanged()) {
                 m_geometryDataValid = false;
-                invalidateDecorators();
+                invalidateDecoratorSelection();
             }
             
             if (changeSet.brushStateChangedFrom(Model::EditState::Selected) ||
@@ -489,6 +507,10 @@ namespace TrenchBroom {
         }
 
         void MapRenderer::update(const Controller::Command& command) {
+            // the entities are taken after every command so that none of them can be deleted in the meantime
+            Model::EntitySet entitiesWithChangedLinks;
+            m_document.map().takeEntitiesWithChangedLinks(entitiesWithChangedLinks);
+            
             switch (command.type()) {
                 case Controller::Command::LoadMap: {
                     clear();
@@ -502,7 +524,7 @@ namespace TrenchBroom {
                 case Controller::Command::ChangeEditState: {
                     const Controller::ChangeEditStateCommand& changeEditStateCommand = static_cast<const Controller::ChangeEditStateCommand&>(command);
                     changeEditState(changeEditStateCommand.changeSet());
-                    invalidateDecorators();
+                    invalidateDecoratorSelection();
                     break;
                 }
                 case Controller::Command::ViewFilterChange: {
@@ -529,7 +551,18 @@ namespace TrenchBroom {
                     if (entityPropertyCommand.isEntityAffected(m_document.worldspawn()) &&
                         entityPropertyCommand.isPropertyAffected(Model::Entity::WadKey))
                             invalidateBrushes();
-                    invalidateEntities();
+                    m_entityRenderer->invalidateBounds();
+                    m_selectedEntityRenderer->invalidateBounds();
+                    m_lockedEntityRenderer->invalidateBounds();
+                    
+                    // the links of an entity move with its origin and with its bounds, which depend on its class
+                    if (entityPropertyCommand.isPropertyAffected(Model::Entity::OriginKey) ||
+                        entityPropertyCommand.isPropertyAffected(Model::Entity::ClassnameKey)) {
+                        const Model::EntityList& entities = entityPropertyCommand.entities();
+                        entitiesWithChangedLinks.insert(entities.begin(), entities.end());
+                    }
+                    invalidateDecoratorProperties(entitiesWithChangedLinks);
+                    entitiesWithChangedLinks.clear();
                     invalidateSelectedEntityModelRendererCache();
                     break;
                 }
@@ -571,6 +604,9 @@ namespace TrenchBroom {
                 default:
                     break;
             }
+            
+            if (!entitiesWithChangedLinks.empty())
+                invalidateDecorators();
         }
 
         void MapRenderer::setPointTrace(const Vec3f::List& points) {
@@ -587,6 +623,7 @@ namespace TrenchBroom {
         void MapRenderer::render(RenderContext& context) {
             if (m_rendering)
                 return;
+            TB_PROFILE_ZONE("MapRenderer::render");
             m_rendering = true;
             
             validate(context);
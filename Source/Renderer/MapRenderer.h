@@ -119,6 +119,8 @@ namespace TrenchBroom {
             void invalidateEntityModelRendererCache();
             void invalidateSelectedEntityModelRendererCache();
             void invalidateDecorators();
+            void invalidateDecoratorSelection();
+            void invalidateDecoratorProperties(const Model::EntitySet& entities);
             void clear();
 
             // prevent copying
@@ -108,24 +108,31 @@ namespace TrenchBroom {
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
         }
 
+        OffscreenRenderer& OffscreenRenderer::readBuffers() {
+            if (!m_multisample || m_samples == 0)
+                return *this;
+            
+            if (m_readBuffers == NULL)
+                m_readBuffers = new OffscreenRenderer(false);
+
+            m_readBuffers->setDimensions(m_width, m_height);
+            m_readBuffers->preRender();
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+            glBlitFramebuffer(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
+                              0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+            m_readBuffers->postRender();
+            return *m_readBuffers;
+        }
+
         wxImage* OffscreenRenderer::getImage() {
             assert(m_valid);
 
-            if (m_multisample && m_samples > 0) {
-                if (m_readBuffers == NULL)
-                    m_readBuffers = new OffscreenRenderer(false);
-
-                m_readBuffers->setDimensions(m_width, m_height);
-                m_readBuffers->preRender();
-
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
-                glBlitFramebuffer(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
-                                  0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
-                                  GL_COLOR_BUFFER_BIT, GL_LINEAR);
-
-                m_readBuffers->postRender();
-                return m_readBuffers->getImage();
-            }
+            OffscreenRenderer& readBuffers = this->readBuffers();
+            if (&readBuffers != this)
+                return readBuffers.getImage();
 
             glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, m_framebufferId);
 
@@ -164,5 +171,24 @@ namespace TrenchBroom {
 
             return new wxImage(static_cast<int>(m_width), static_cast<int>(m_height), imageData, alphaData);
         }
+
+        void OffscreenRenderer::getPixels(unsigned char* rgbaData) {
+            assert(m_valid);
+            
+            OffscreenRenderer& readBuffers = this->readBuffers();
+            if (&readBuffers != this) {
+                readBuffers.getPixels(rgbaData);
+                return;
+            }
+            
+            glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, m_framebufferId);
+            
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+            glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+            
+            glReadPixels(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height), GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<GLvoid*>(rgbaData));
+        }
     }
 }
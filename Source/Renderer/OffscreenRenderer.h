@@ -44,6 +44,12 @@ namespace TrenchBroom {
             GLint m_samples;
 
             OffscreenRenderer* m_readBuffers;
+            
+            /*
+             * Returns the renderer whose buffers can be read, i.e., this renderer or, if it is multisampled, the
+             * renderer into which its buffers were resolved.
+             */
+            OffscreenRenderer& readBuffers();
         public:
             OffscreenRenderer(bool multisample, GLint samples = 0);
             ~OffscreenRenderer();
@@ -60,6 +66,12 @@ namespace TrenchBroom {
             void postRender();
 
             wxImage* getImage();
+            
+            /*
+             * Reads the rendered image into the given buffer, which must hold four bytes per pixel. The rows are
+             * stored bottom up as OpenGL expects them for a texture.
+             */
+            void getPixels(unsigned char* rgbaData);
         };
     }
 }
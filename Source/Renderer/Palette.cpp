@@ -50,6 +50,15 @@ namespace TrenchBroom {
             std::swap(m_size, other.m_size);
         }
 
+        unsigned int Palette::checksum() const {
+            unsigned int checksum = 2166136261u;
+            for (size_t i = 0; i < m_size; i++) {
+                checksum ^= m_data[i];
+                checksum *= 16777619u;
+            }
+            return checksum;
+        }
+
         Palette::~Palette() {
             delete[] m_data;
         }
@@ -38,6 +38,11 @@ namespace TrenchBroom {
             
             void operator= (Palette other);
             
+            /*
+             * Returns a checksum of the colors so that caches can tell which palette their images were made with.
+             */
+            unsigned int checksum() const;
+            
             inline void indexedToRgb(const unsigned char* indexedImage, unsigned char* rgbImage, size_t pixelCount, Color& averageColor) const {
                 double avg[3];
                 avg[0] = avg[1] = avg[2] = 0;
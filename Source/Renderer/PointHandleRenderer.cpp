@@ -29,6 +29,7 @@
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
+#include "Utility/InstanceBuffer.h"
 #include "Utility/Preferences.h"
 
 #include <cassert>
@@ -48,14 +49,14 @@ namespace TrenchBroom {
             return false;
         }
 
-        PointHandleRenderer* PointHandleRenderer::create(float radius, unsigned int iterations, float scalingFactor, float maximumDistance) {
+        PointHandleRenderer* PointHandleRenderer::create(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances) {
             if (instancingSupported())
-               return new InstancedPointHandleRenderer(radius, iterations, scalingFactor, maximumDistance);
-            return new DefaultPointHandleRenderer(radius, iterations, scalingFactor, maximumDistance);
+               return new InstancedPointHandleRenderer(radius, iterations, scalingFactor, maximumDistance, instances);
+            return new DefaultPointHandleRenderer(radius, iterations, scalingFactor, maximumDistance, instances);
         }
 
-        DefaultPointHandleRenderer::DefaultPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance) :
-        PointHandleRenderer(radius, iterations, scalingFactor, maximumDistance),
+        DefaultPointHandleRenderer::DefaultPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances) :
+        PointHandleRenderer(radius, iterations, scalingFactor, maximumDistance, instances),
         m_vertexArray(NULL) {}
         
         DefaultPointHandleRenderer::~DefaultPointHandleRenderer() {
@@ -64,8 +65,7 @@ namespace TrenchBroom {
         }
         
         void DefaultPointHandleRenderer::render(Vbo& vbo, RenderContext& context) {
-            const Vec4f::List& positionList = positions();
-            if (positionList.empty())
+            if (m_instances.empty())
                 return;
 
             SetVboState activateVbo(vbo, Vbo::VboActive);
@@ -85,22 +85,36 @@ namespace TrenchBroom {
                 }
             }
             
+            const Vec3f& cameraPosition = context.camera().position();
+            const float maxDistance2 = maximumDistance() * maximumDistance();
+            
             Renderer::ActivateShader shader(context.shaderManager(), Renderer::Shaders::PointHandleShader);
-            shader.setUniformVariable("Color", color());
-            shader.setUniformVariable("CameraPosition", context.camera().position());
+            shader.setUniformVariable("CameraPosition", cameraPosition);
             shader.setUniformVariable("ScalingFactor", scalingFactor());
             shader.setUniformVariable("MaximumDistance", maximumDistance());
             
-            Vec4f::List::const_iterator pIt, pEnd;
-            for (pIt = positionList.begin(), pEnd = positionList.end(); pIt != pEnd; ++pIt) {
-                const Vec4f& position = *pIt;
-                shader.setUniformVariable("Position", position);
-                m_vertexArray->render();
+            // render the unselected handles first and then the selected ones so that the color is only set twice
+            const Vec4f::List& instances = m_instances.instances();
+            for (unsigned int pass = renderUnselected() ? 0 : 1; pass < 2; pass++) {
+                const bool selected = pass == 1;
+                shader.setUniformVariable("Color", selected ? selectedColor() : color());
+                
+                Vec4f::List::const_iterator pIt, pEnd;
+                for (pIt = instances.begin(), pEnd = instances.end(); pIt != pEnd; ++pIt) {
+                    const Vec4f& instance = *pIt;
+                    if ((instance.w() > 0.5f) != selected)
+                        continue;
+                    // the shader would discard it anyway
+                    if (instance.xyz().squaredDistanceTo(cameraPosition) > maxDistance2)
+                        continue;
+                    shader.setUniformVariable("Position", Vec4f(instance.xyz(), 0.0f));
+                    m_vertexArray->render();
+                }
             }
         }
 
-        InstancedPointHandleRenderer::InstancedPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance) :
-        PointHandleRenderer(radius, iterations, scalingFactor, maximumDistance),
+        InstancedPointHandleRenderer::InstancedPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances) :
+        PointHandleRenderer(radius, iterations, scalingFactor, maximumDistance, instances),
         m_vertexArray(NULL) {}
         
         InstancedPointHandleRenderer::~InstancedPointHandleRenderer() {
@@ -109,40 +123,38 @@ namespace TrenchBroom {
         }
 
         void InstancedPointHandleRenderer::render(Vbo& vbo, RenderContext& context) {
+            if (m_instances.empty())
+                return;
+            
             SetVboState activateVbo(vbo, Vbo::VboActive);
             
-            if (!valid()) {
-                delete m_vertexArray;
-                m_vertexArray = NULL;
+            // the vertex array keeps the instance texture, which only uploads the instances that changed
+            unsigned int instanceCount = static_cast<unsigned int>(m_instances.size());
+            if (m_vertexArray == NULL) {
+                Vec3f::List vertices = sphere();
                 
-                const Vec4f::List& positionList = positions();
+                unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+                m_vertexArray = new InstancedVertexArray(vbo, GL_TRIANGLES, vertexCount, instanceCount,
+                                                         Attribute::position3f());
                 
-                if (!positionList.empty()) {
-                    Vec3f::List vertices = sphere();
-                    
-                    unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
-                    unsigned int instanceCount = static_cast<unsigned int>(positionList.size());
-                    m_vertexArray = new InstancedVertexArray(vbo, GL_TRIANGLES, vertexCount, instanceCount,
-                                                             Attribute::position3f());
-                    
-                    SetVboState mapVbo(vbo, Vbo::VboMapped);
-                    Vec3f::List::iterator it, end;
-                    for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
-                        m_vertexArray->addAttribute(*it);
-                    
-                    m_vertexArray->addAttributeArray("position", positionList);
-                }
-                validate();
+                SetVboState mapVbo(vbo, Vbo::VboMapped);
+                Vec3f::List::iterator it, end;
+                for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
+                    m_vertexArray->addAttribute(*it);
+                
+                m_vertexArray->addAttributeArray("position", m_instances);
+            } else {
+                m_vertexArray->setInstanceCount(instanceCount);
             }
             
-            if (m_vertexArray != NULL) {
-                Renderer::ActivateShader shader(context.shaderManager(), Renderer::Shaders::InstancedPointHandleShader);
-                shader.setUniformVariable("Color", color());
-                shader.setUniformVariable("CameraPosition", context.camera().position());
-                shader.setUniformVariable("ScalingFactor", scalingFactor());
-                shader.setUniformVariable("MaximumDistance", maximumDistance());
-                m_vertexArray->render(shader.currentShader());
-            }
+            Renderer::ActivateShader shader(context.shaderManager(), Renderer::Shaders::InstancedPointHandleShader);
+            shader.setUniformVariable("Color", color());
+            shader.setUniformVariable("SelectedColor", selectedColor());
+            shader.setUniformVariable("RenderUnselected", renderUnselected());
+            shader.setUniformVariable("CameraPosition", context.camera().position());
+            shader.setUniformVariable("ScalingFactor", scalingFactor());
+            shader.setUniformVariable("MaximumDistance", maximumDistance());
+            m_vertexArray->render(shader.currentShader());
         }
     }
 }
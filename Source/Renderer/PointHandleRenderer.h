@@ -26,12 +26,20 @@
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
+    namespace Utility {
+        class InstanceBuffer;
+    }
+    
     namespace Renderer {
         class InstancedVertexArray;
         class RenderContext;
         class Vbo;
         class VertexArray;
         
+        /*
+         Renders a sphere at the position of every instance in an instance buffer. Selected instances are rendered in
+         the selected color, unselected ones in the normal color unless they are hidden.
+         */
         class PointHandleRenderer {
         private:
             float m_radius;
@@ -40,9 +48,11 @@ namespace TrenchBroom {
             float m_maximumDistance;
 
             Color m_color;
-            Vec4f::List m_positions;
-            bool m_valid;
+            Color m_selectedColor;
+            bool m_renderUnselected;
         protected:
+            Utility::InstanceBuffer& m_instances;
+            
             Vec3f::List sphere() const;
             
             inline float scalingFactor() const {
@@ -53,47 +63,40 @@ namespace TrenchBroom {
                 return m_maximumDistance;
             }
             
-            inline const Vec4f::List& positions() const {
-                return m_positions;
+            inline const Color& color() const {
+                return m_color;
             }
             
-            inline bool valid() const {
-                return m_valid;
-            }
-
-            inline void validate() {
-                m_valid = true;
+            inline const Color& selectedColor() const {
+                return m_selectedColor;
             }
             
-            inline const Color& color() const {
-                return m_color;
+            inline bool renderUnselected() const {
+                return m_renderUnselected;
             }
         public:
-            PointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance) :
+            PointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances) :
             m_radius(radius),
             m_iterations(iterations),
             m_scalingFactor(scalingFactor),
             m_maximumDistance(maximumDistance),
-            m_valid(false) {}
+            m_renderUnselected(true),
+            m_instances(instances) {}
             
             virtual ~PointHandleRenderer() {}
             
             static bool instancingSupported();
-            static PointHandleRenderer* create(float radius, unsigned int iterations, float scalingFactor, float maximumDistance);
+            static PointHandleRenderer* create(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances);
             
-            inline void add(const Vec3f& position) {
-                m_positions.push_back(Vec4f(position, 0.0f));
-                m_valid = false;
+            inline void setColor(const Color& color, const Color& selectedColor) {
+                m_color = color;
+                m_selectedColor = selectedColor;
             }
             
-            inline void clear() {
-                m_valid &= m_positions.empty();
-                m_positions.clear();
+            inline void setRenderUnselected(const bool renderUnselected) {
+                m_renderUnselected = renderUnselected;
             }
             
-            inline void setColor(const Color& color) {
-                m_color = color;
-            }
             virtual void render(Vbo& vbo, RenderContext& context) = 0;
         };
         
@@ -101,7 +104,7 @@ namespace TrenchBroom {
         protected:
             VertexArray* m_vertexArray;
         public:
-            DefaultPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance);
+            DefaultPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances);
             ~DefaultPointHandleRenderer();
             
             void render(Vbo& vbo, RenderContext& context);
@@ -111,7 +114,7 @@ namespace TrenchBroom {
         protected:
             InstancedVertexArray* m_vertexArray;
         public:
-            InstancedPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance);
+            InstancedPointHandleRenderer(float radius, unsigned int iterations, float scalingFactor, float maximumDistance, Utility::InstanceBuffer& instances);
             ~InstancedPointHandleRenderer();
 
             void render(Vbo& vbo, RenderContext& context);
@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <cassert>
 #include <map>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
@@ -135,30 +136,97 @@ namespace TrenchBroom {
                 };
 
             protected:
-                class TextEntry {
+                /*
+                 The geometry of a string, shared by all entries that show it. It is built once when the string is
+                 added. The text and the background are relative to the lower left corner of the string and are
+                 written into the vertex arrays of a frame together with the offset of each entry.
+                 */
+                class StringGeometry {
                 private:
                     Vec2f::List m_vertices;
+                    Vec2f::List m_rectVertices;
                     Vec2f m_size;
-                    TextAnchor::Ptr m_textAnchor;
+                    size_t m_useCount;
                 public:
-                    TextEntry(const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr textAnchor) :
+                    StringGeometry(const Vec2f::List& vertices, const Vec2f& size, const float hInset, const float vInset) :
                     m_vertices(vertices),
                     m_size(size),
-                    m_textAnchor(textAnchor) {}
-                    
-                    inline const Vec2f::List& vertices() const {
-                        return m_vertices;
-                    }
+                    m_useCount(0) {
+                        m_rectVertices.reserve(3 * 16); // 16 triangles (for a rounded rect with 3 triangles per corner: 3 * 4 + 4 = 16)
+                        roundedRect(m_size.x() + 2.0f * hInset, m_size.y() + 2.0f * vInset, 3.0f, 3, m_rectVertices);
 
-                    inline void update(const Vec2f::List& vertices, const Vec2f& size) {
-                        m_vertices = vertices;
-                        m_size = size;
+                        const Vec2f center = m_size / 2.0f;
+                        for (size_t i = 0; i < m_rectVertices.size(); i++)
+                            m_rectVertices[i] += center;
                     }
 
                     inline const Vec2f& size() const {
                         return m_size;
                     }
 
+                    inline void retain() {
+                        m_useCount++;
+                    }
+
+                    inline bool release() {
+                        assert(m_useCount > 0);
+                        return --m_useCount == 0;
+                    }
+
+                    inline size_t textVertexCount() const {
+                        return m_vertices.size() / 2;
+                    }
+
+                    inline size_t rectVertexCount() const {
+                        return m_rectVertices.size();
+                    }
+
+                    // the VBO must be mapped
+                    inline void writeText(VertexArray& array, const Vec3f& offset) const {
+                        for (size_t i = 0; i < m_vertices.size() / 2; i++) {
+                            const Vec2f& vertex = m_vertices[2 * i];
+                            const Vec2f& texCoords = m_vertices[2 * i + 1];
+                            array.addAttribute(Vec3f(vertex.x() + offset.x(), vertex.y() + offset.y(), -offset.z()));
+                            array.addAttribute(texCoords);
+                        }
+                    }
+
+                    // the VBO must be mapped
+                    inline void writeBackground(VertexArray& array, const Vec3f& offset) const {
+                        for (size_t i = 0; i < m_rectVertices.size(); i++) {
+                            const Vec2f& vertex = m_rectVertices[i];
+                            array.addAttribute(Vec3f(vertex.x() + offset.x(), vertex.y() + offset.y(), -offset.z()));
+                        }
+                    }
+                };
+
+                typedef std::map<String, StringGeometry*> StringCache;
+
+                class TextEntry {
+                private:
+                    typename StringCache::iterator m_string;
+                    TextAnchor::Ptr m_textAnchor;
+                public:
+                    TextEntry(typename StringCache::iterator string, TextAnchor::Ptr textAnchor) :
+                    m_string(string),
+                    m_textAnchor(textAnchor) {}
+
+                    inline typename StringCache::iterator stringIterator() const {
+                        return m_string;
+                    }
+
+                    inline const String& string() const {
+                        return m_string->first;
+                    }
+
+                    inline StringGeometry& geometry() const {
+                        return *m_string->second;
+                    }
+
+                    inline const TextAnchor::Ptr& textAnchorPtr() const {
+                        return m_textAnchor;
+                    }
+
                     inline const TextAnchor& textAnchor() const {
                         return *m_textAnchor.get();
                     }
@@ -166,47 +234,130 @@ namespace TrenchBroom {
 
                 typedef std::map<Key, TextEntry, Comparator> TextMap;
                 typedef std::pair<Key, TextEntry> TextMapItem;
-                typedef std::vector<TextEntry> EntryList;
+
+                class VisibleEntry {
+                public:
+                    StringGeometry* geometry;
+                    Vec3f offset;
+                    float left, bottom, right, top;
+
+                    VisibleEntry(StringGeometry& i_geometry, const Vec3f& i_offset, const float hInset, const float vInset) :
+                    geometry(&i_geometry),
+                    offset(i_offset),
+                    left(i_offset.x() - hInset),
+                    bottom(i_offset.y() - vInset),
+                    right(i_offset.x() + i_geometry.size().x() + hInset),
+                    top(i_offset.y() + i_geometry.size().y() + vInset) {}
+
+                    inline bool overlaps(const VisibleEntry& other) const {
+                        return left < other.right && other.left < right && bottom < other.top && other.bottom < top;
+                    }
+
+                    inline bool operator<(const VisibleEntry& other) const {
+                        return offset.z() < other.offset.z();
+                    }
+                };
+
+                typedef std::vector<VisibleEntry> VisibleEntryList;
+
+                static const float OverlapCellSize;
 
                 TexturedFont& m_font;
                 float m_fadeDistance;
                 float m_hInset;
                 float m_vInset;
+                bool m_rejectOverlaps;
 
                 TextMap m_entries;
+                StringCache m_strings;
                 Vbo* m_vbo;
 
-                inline void addString(Key key, const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr anchor) {
-                    removeString(key);
-                    m_entries.insert(TextMapItem(key, TextEntry(vertices, size, anchor)));
+                inline void releaseString(typename StringCache::iterator string) {
+                    if (string->second->release()) {
+                        delete string->second;
+                        m_strings.erase(string);
+                    }
+                }
+
+                /*
+                 Removes the entries that overlap an entry closer to the camera. The accepted entries are registered
+                 in a screen space grid so that every entry is only tested against its neighbours.
+                 */
+                void rejectOverlaps(const Camera::Viewport& viewport, VisibleEntryList& entries) const {
+                    std::sort(entries.begin(), entries.end());
+
+                    const int columns = static_cast<int>(viewport.width / OverlapCellSize) + 1;
+                    const int rows = static_cast<int>(viewport.height / OverlapCellSize) + 1;
+                    std::vector<std::vector<size_t> > cells(static_cast<size_t>(columns * rows));
+
+                    size_t accepted = 0;
+                    for (size_t i = 0; i < entries.size(); i++) {
+                        const VisibleEntry& entry = entries[i];
+                        const int minX = std::max(0, static_cast<int>((entry.left - viewport.x) / OverlapCellSize));
+                        const int maxX = std::min(columns - 1, static_cast<int>((entry.right - viewport.x) / OverlapCellSize));
+                        const int minY = std::max(0, static_cast<int>((entry.bottom - viewport.y) / OverlapCellSize));
+                        const int maxY = std::min(rows - 1, static_cast<int>((entry.top - viewport.y) / OverlapCellSize));
+
+                        bool overlaps = false;
+                        for (int y = minY; y <= maxY && !overlaps; y++) {
+                            for (int x = minX; x <= maxX && !overlaps; x++) {
+                                const std::vector<size_t>& cell = cells[static_cast<size_t>(y * columns + x)];
+                                for (size_t j = 0; j < cell.size() && !overlaps; j++)
+                                    overlaps = entry.overlaps(entries[cell[j]]);
+                            }
+                        }
+
+                        if (!overlaps) {
+                            entries[accepted] = entry;
+                            for (int y = minY; y <= maxY; y++)
+                                for (int x = minX; x <= maxX; x++)
+                                    cells[static_cast<size_t>(y * columns + x)].push_back(accepted);
+                            accepted++;
+                        }
+                    }
+                    entries.resize(accepted, entries.front());
                 }
 
-                EntryList visibleEntries(RenderContext& context, const TextRendererFilter& filter) {
-                    float cutoff = (m_fadeDistance + 100) * (m_fadeDistance + 100);
-                    EntryList result;
+                /*
+                 Returns the entries that are not filtered, within the fade distance, in front of the camera and inside
+                 of the viewport, together with their offsets in screen space.
+                 */
+                void visibleEntries(RenderContext& context, const TextRendererFilter& filter, VisibleEntryList& result) {
+                    const Camera& camera = context.camera();
+                    const Camera::Viewport& viewport = camera.viewport();
+                    const float cutoff = (m_fadeDistance + 100) * (m_fadeDistance + 100);
 
                     typename TextMap::iterator it, end;
                     for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
-                        Key key = it->first;
-                        if (filter.stringVisible(context, key)) {
-                            const TextEntry& entry = it->second;
-                            const TextAnchor& anchor = entry.textAnchor();
-                            const Vec3f position = anchor.position();
-
-                            float dist2 = context.camera().squaredDistanceTo(position);
-                            if (dist2 <= cutoff)
-                                result.push_back(entry);
-                        }
+                        const TextEntry& entry = it->second;
+                        const TextAnchor& anchor = entry.textAnchor();
+                        const Vec3f position = anchor.position();
+                        if (camera.squaredDistanceTo(position) > cutoff)
+                            continue;
+                        if ((position - camera.position()).dot(camera.direction()) <= 0.0f)
+                            continue;
+                        if (!filter.stringVisible(context, it->first))
+                            continue;
+
+                        StringGeometry& geometry = entry.geometry();
+                        const VisibleEntry visibleEntry(geometry, anchor.offset(camera, geometry.size()), m_hInset, m_vInset);
+                        if (visibleEntry.right < viewport.x || visibleEntry.left > viewport.x + viewport.width ||
+                            visibleEntry.top < viewport.y || visibleEntry.bottom > viewport.y + viewport.height)
+                            continue;
+                        result.push_back(visibleEntry);
                     }
 
-                    return result;
+                    if (m_rejectOverlaps && result.size() > 1)
+                        rejectOverlaps(viewport, result);
                 }
+
             public:
                 TextRenderer(TexturedFont& font) :
                 m_font(font),
                 m_fadeDistance(100.0f),
                 m_hInset(4.0f),
                 m_vInset(4.0f),
+                m_rejectOverlaps(false),
                 m_vbo(NULL) {}
 
                 ~TextRenderer() {
@@ -216,32 +367,40 @@ namespace TrenchBroom {
                 }
 
                 inline void addString(Key key, const String& string, TextAnchor::Ptr anchor) {
-                    const Vec2f::List vertices = m_font.quads(string, true);
-                    const Vec2f size = m_font.measure(string);
-                    addString(key, vertices, size, anchor);
+                    removeString(key);
+
+                    typename StringCache::iterator stringIt = m_strings.find(string);
+                    if (stringIt == m_strings.end()) {
+                        StringGeometry* geometry = new StringGeometry(m_font.quads(string, true), m_font.measure(string).rounded(), m_hInset, m_vInset);
+                        stringIt = m_strings.insert(typename StringCache::value_type(string, geometry)).first;
+                    }
+                    stringIt->second->retain();
+                    m_entries.insert(TextMapItem(key, TextEntry(stringIt, anchor)));
                 }
 
                 inline void removeString(Key key)  {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
+                        typename StringCache::iterator stringIt = it->second.stringIterator();
                         m_entries.erase(it);
+                        releaseString(stringIt);
                     }
                 }
 
                 inline void updateString(Key key, const String& string) {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
-                        TextEntry& entry = it->second;
-                        entry.setVertices(m_font.quads(string, true));
+                        const TextAnchor::Ptr anchor = it->second.textAnchorPtr();
+                        addString(key, string, anchor);
                     }
                 }
 
                 inline void transferString(Key key, TextRenderer& destination)  {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
-                        TextEntry& entry = it->second;
-                        destination.addString(key, entry.vertices(), entry.textAnchor());
-                        m_entries.erase(it);
+                        const TextEntry& entry = it->second;
+                        destination.addString(key, entry.string(), entry.textAnchorPtr());
+                        removeString(key);
                     }
                 }
 
@@ -251,17 +410,30 @@ namespace TrenchBroom {
 
                 inline void clear()  {
                     m_entries.clear();
+
+                    typename StringCache::iterator it, end;
+                    for (it = m_strings.begin(), end = m_strings.end(); it != end; ++it)
+                        delete it->second;
+                    m_strings.clear();
                 }
 
                 inline void setFadeDistance(float fadeDistance)  {
                     m_fadeDistance = fadeDistance;
                 }
 
+                /*
+                 Hides the entries that overlap an entry that is closer to the camera.
+                 */
+                inline void setRejectOverlaps(bool rejectOverlaps) {
+                    m_rejectOverlaps = rejectOverlaps;
+                }
+
                 void render(RenderContext& context, const TextRendererFilter& filter, ShaderProgram& textProgram, const Color& textColor, ShaderProgram& backgroundProgram, const Color& backgroundColor) {
                     if (m_entries.empty())
                         return;
 
-                    EntryList entries = visibleEntries(context, filter);
+                    VisibleEntryList entries;
+                    visibleEntries(context, filter, entries);
                     if (entries.empty())
                         return;
 
@@ -269,42 +441,25 @@ namespace TrenchBroom {
                         m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
 
                     size_t textVertexCount = 0;
+                    size_t rectVertexCount = 0;
                     for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
-                        textVertexCount += entry.vertices().size() / 2;
+                        const StringGeometry& geometry = *entries[i].geometry;
+                        textVertexCount += geometry.textVertexCount();
+                        rectVertexCount += geometry.rectVertexCount();
                     }
 
+                    // all entries are drawn with one call for the backgrounds and one for the text
                     VertexArray textArray(*m_vbo, GL_QUADS, static_cast<unsigned int>(textVertexCount),
                                           Attribute::position3f(),
                                           Attribute::texCoord02f());
-
-                    size_t rectVertexCount = 3 * 16 * entries.size(); // 16 triangles (for a rounded rect with 3 triangles per corner: 3 * 4 + 4 = 16)
                     VertexArray rectArray(*m_vbo, GL_TRIANGLES, static_cast<unsigned int>(rectVertexCount),
                                           Attribute::position3f());
 
                     SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
                     for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
-                        const Vec2f& size = entry.size().rounded();
-                        const TextAnchor& anchor = entry.textAnchor();
-                        const Vec3f offset = anchor.offset(context.camera(), size);
-
-                        const Vec2f::List& textVertices = entry.vertices();
-                        for (size_t j = 0; j < textVertices.size() / 2; j++) {
-                            const Vec2f& vertex = textVertices[2 * j];
-                            const Vec2f& texCoords = textVertices[2 * j + 1];
-
-                            textArray.addAttribute(Vec3f(vertex.x() + offset.x(), vertex.y() + offset.y(), -offset.z()));
-                            textArray.addAttribute(texCoords);
-                        }
-
-                        Vec2f::List rectVertices;
-                        rectVertices.reserve(3 * 16);
-                        roundedRect(size.x() + 2.0f * m_hInset, size.y() + 2.0f * m_vInset, 3.0f, 3, rectVertices);
-                        for (size_t j = 0; j < rectVertices.size(); j++) {
-                            const Vec2f& vertex = rectVertices[j];
-                            rectArray.addAttribute(Vec3f(vertex.x() + offset.x() + size.x() / 2.0f, vertex.y() + offset.y() + size.y() / 2.0f, -offset.z()));
-                        }
+                        const VisibleEntry& entry = entries[i];
+                        entry.geometry->writeText(textArray, entry.offset);
+                        entry.geometry->writeBackground(rectArray, entry.offset);
                     }
 
                     const Camera::Viewport& viewport = context.camera().viewport();
@@ -339,6 +494,9 @@ namespace TrenchBroom {
                     glDepthMask(GL_TRUE);
                 }
             };
+
+            template <typename Key, typename Comparator>
+            const float TextRenderer<Key, Comparator>::OverlapCellSize = 64.0f;
         }
     }
 }
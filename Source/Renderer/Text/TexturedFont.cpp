@@ -98,8 +98,18 @@ namespace TrenchBroom {
             }
 
             Vec2f::List TexturedFont::quads(const String& string, bool clockwise, const Vec2f& offset) {
-                Vec2f::List result;
+                size_t glyphCount = 0;
+                for (size_t i = 0; i < string.length(); i++) {
+                    const char c = string[i];
+                    if (c != '\n' && glyphChar(c) != ' ')
+                        glyphCount++;
+                }
 
+                Vec2f::List result(8 * glyphCount);
+                if (glyphCount == 0)
+                    return result;
+                
+                Vec2f* vertices = &result.front();
                 int x = static_cast<int>(Math<float>::round(offset.x()));
                 int y = static_cast<int>(Math<float>::round(offset.y()));
                 for (size_t i = 0; i < string.length(); i++) {
@@ -110,12 +120,10 @@ namespace TrenchBroom {
                         continue;
                     }
                     
-                    if (c < m_minChar || c > m_maxChar)
-                        c = ' '; // space
-
+                    c = glyphChar(c);
                     const Char& glyph = m_chars[static_cast<size_t>(c - m_minChar)];
                     if (c != ' ')
-                        glyph.append(result, x, y, m_textureLength, clockwise);
+                        vertices = glyph.append(vertices, x, y, m_textureLength, clockwise);
 
                     x += glyph.a;
                 }
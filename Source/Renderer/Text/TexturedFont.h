@@ -48,26 +48,36 @@ namespace TrenchBroom {
                     h(i_h),
                     a(i_a) {}
 
-                    inline void append(Vec2f::List& vertices, int xOffset, int yOffset, int textureLength, bool clockwise) const {
+                    // writes the eight vertices and texture coordinates of this glyph's quad to the given buffer
+                    inline Vec2f* append(Vec2f* vertices, int xOffset, int yOffset, int textureLength, bool clockwise) const {
+                        const float length = static_cast<float>(textureLength);
+                        const Vec2f bottomLeft(static_cast<float>(xOffset), static_cast<float>(yOffset));
+                        const Vec2f topLeft(static_cast<float>(xOffset), static_cast<float>(yOffset + h));
+                        const Vec2f topRight(static_cast<float>(xOffset + w), static_cast<float>(yOffset + h));
+                        const Vec2f bottomRight(static_cast<float>(xOffset + w), static_cast<float>(yOffset));
+                        const Vec2f texBottomLeft(static_cast<float>(x) / length, static_cast<float>(y + h) / length);
+                        const Vec2f texTopLeft(static_cast<float>(x) / length, static_cast<float>(y) / length);
+                        const Vec2f texTopRight(static_cast<float>(x + w) / length, static_cast<float>(y) / length);
+                        const Vec2f texBottomRight(static_cast<float>(x + w) / length, static_cast<float>(y + h) / length);
+                        
+                        *vertices++ = bottomLeft;
+                        *vertices++ = texBottomLeft;
                         if (clockwise) {
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset), static_cast<float>(yOffset)));
-                            vertices.push_back(Vec2f(static_cast<float>(x), static_cast<float>(y + h)) / static_cast<float>(textureLength));
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset), static_cast<float>(yOffset + h)));
-                            vertices.push_back(Vec2f(static_cast<float>(x), static_cast<float>(y)) / static_cast<float>(textureLength));
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset + w), static_cast<float>(yOffset + h)));
-                            vertices.push_back(Vec2f(static_cast<float>(x + w), static_cast<float>(y)) / static_cast<float>(textureLength));
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset + w), static_cast<float>(yOffset)));
-                            vertices.push_back(Vec2f(static_cast<float>(x + w), static_cast<float>(y + h)) / static_cast<float>(textureLength));
+                            *vertices++ = topLeft;
+                            *vertices++ = texTopLeft;
+                            *vertices++ = topRight;
+                            *vertices++ = texTopRight;
+                            *vertices++ = bottomRight;
+                            *vertices++ = texBottomRight;
                         } else {
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset), static_cast<float>(yOffset)));
-                            vertices.push_back(Vec2f(static_cast<float>(x), static_cast<float>(y + h)) / static_cast<float>(textureLength));
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset + w), static_cast<float>(yOffset)));
-                            vertices.push_back(Vec2f(static_cast<float>(x + w), static_cast<float>(y + h)) / static_cast<float>(textureLength));
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset + w), static_cast<float>(yOffset + h)));
-                            vertices.push_back(Vec2f(static_cast<float>(x + w), static_cast<float>(y)) / static_cast<float>(textureLength));
-                            vertices.push_back(Vec2f(static_cast<float>(xOffset), static_cast<float>(yOffset + h)));
-                            vertices.push_back(Vec2f(static_cast<float>(x), static_cast<float>(y)) / static_cast<float>(textureLength));
+                            *vertices++ = bottomRight;
+                            *vertices++ = texBottomRight;
+                            *vertices++ = topRight;
+                            *vertices++ = texTopRight;
+                            *vertices++ = topLeft;
+                            *vertices++ = texTopLeft;
                         }
+                        return vertices;
                     }
 
                     inline float sMin(size_t textureWidth) const {
@@ -97,6 +107,12 @@ namespace TrenchBroom {
                 GLuint m_textureId;
                 int m_textureLength;
                 TextureBitmap* m_bitmap;
+
+                inline char glyphChar(char c) const {
+                    if (c < m_minChar || c > m_maxChar)
+                        return ' ';
+                    return c;
+                }
             public:
                 TexturedFont(FT_Face face, const unsigned char minChar = ' ', const unsigned char maxChar = '~');
                 ~TexturedFont();
@@ -30,6 +30,7 @@ namespace TrenchBroom {
             m_width = width;
             m_height = height;
             m_textureBuffer = NULL;
+            m_format = GL_RGB;
 			m_textureId = 0;
         }
         
@@ -43,6 +44,11 @@ namespace TrenchBroom {
             init(rgbImage, width, height);
         }
         
+        TextureRenderer::TextureRenderer(unsigned char* image, GLenum format, unsigned int width, unsigned int height) {
+            init(image, width, height);
+            m_format = format;
+        }
+        
         TextureRenderer::TextureRenderer(const Model::AliasSkin& skin, unsigned int skinIndex, const Palette& palette) {
             init(skin.width(), skin.height());
             m_textureBuffer = new unsigned char[m_width * m_height * 3];
@@ -78,7 +84,7 @@ namespace TrenchBroom {
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, GL_RGB, GL_UNSIGNED_BYTE, m_textureBuffer);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, m_format, GL_UNSIGNED_BYTE, m_textureBuffer);
                     delete [] m_textureBuffer;
                     m_textureBuffer = NULL;
                 }
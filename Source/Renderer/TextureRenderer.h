@@ -42,6 +42,7 @@ namespace TrenchBroom {
             unsigned int m_width;
             unsigned int m_height;
             unsigned char* m_textureBuffer;
+            GLenum m_format;
             Color m_averageColor;
             
             void init(unsigned int width, unsigned int height);
@@ -52,6 +53,11 @@ namespace TrenchBroom {
             void operator= (const TextureRenderer& other);
         public:
             TextureRenderer(unsigned char* rgbImage, const Color& averageColor, unsigned int width, unsigned int height);
+            
+            /*
+             * Takes ownership of the given image, whose pixels are stored in the given format, e.g., GL_RGBA.
+             */
+            TextureRenderer(unsigned char* image, GLenum format, unsigned int width, unsigned int height);
             TextureRenderer(const Model::AliasSkin& skin, unsigned int skinIndex, const Palette& palette);
             TextureRenderer(const Model::BspTexture& texture, const Palette& palette);
             TextureRenderer();
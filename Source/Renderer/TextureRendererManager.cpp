@@ -29,31 +29,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
-        TextureRendererCollection::TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette) {
-            typedef std::pair<TextureRendererMap::iterator, bool> InsertResult;
-
-            Color averageColor;
-            Model::TextureCollection::LoaderPtr loader = textureCollection.loader();
-
-            const Model::TextureList& textures = textureCollection.textures();
-            for (unsigned int i = 0; i < textures.size(); i++) {
-                Model::Texture& texture = *textures[i];
-                unsigned char* textureImage = loader->load(texture, palette, averageColor);
-                if (textureImage != NULL) {
-                    TextureRenderer* textureRenderer = new TextureRenderer(textureImage, averageColor, texture.width(), texture.height());
-                    InsertResult result = m_textures.insert(TextureRendererEntry(&texture, textureRenderer));
-                    assert(result.second);
-                }
-            }
-        }
+        TextureRendererCollection::TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette) :
+        m_loader(textureCollection.loader()),
+        m_palette(palette) {}
         
-        TextureRenderer* TextureRendererCollection::renderer(Model::Texture& texture) const {
-            TextureRendererMap::const_iterator it = m_textures.find(&texture);
-            if (it == m_textures.end())
-                return NULL;
-            return it->second;
-        }
-
         TextureRendererCollection::~TextureRendererCollection() {
             TextureRendererMap::iterator it, end;
             for (it = m_textures.begin(), end = m_textures.end(); it != end; ++it)
@@ -61,15 +40,54 @@ namespace TrenchBroom {
             m_textures.clear();
         }
 
+        TextureRenderer* TextureRendererCollection::renderer(Model::Texture& texture) {
+            TextureRendererMap::iterator it = m_textures.lower_bound(&texture);
+            if (it != m_textures.end() && it->first == &texture)
+                return it->second;
+
+            // textures that cannot be loaded are remembered, too, so that the wad file is only read once
+            Color averageColor;
+            TextureRenderer* textureRenderer = NULL;
+            unsigned char* textureImage = m_loader->load(texture, m_palette, averageColor);
+            if (textureImage != NULL)
+                textureRenderer = new TextureRenderer(textureImage, averageColor, texture.width(), texture.height());
+            m_textures.insert(it, TextureRendererEntry(&texture, textureRenderer));
+            return textureRenderer;
+        }
+
+        void TextureRendererCollection::release(Model::Texture& texture) {
+            TextureRendererMap::iterator it = m_textures.find(&texture);
+            if (it == m_textures.end())
+                return;
+            delete it->second;
+            m_textures.erase(it);
+        }
+
+        TextureRendererCollection* TextureRendererManager::rendererCollection(Model::TextureCollection& collection) {
+            TextureRendererCollectionMap::iterator it = m_textureCollections.find(&collection);
+            if (it != m_textureCollections.end())
+                return it->second;
+            
+            TextureRendererCollection* rendererCollection = new TextureRendererCollection(collection, *m_palette);
+            m_textureCollections[&collection] = rendererCollection;
+            return rendererCollection;
+        }
+        
         void TextureRendererManager::clear() {
             Utility::deleteAll(m_textureCollections);
+            m_thumbnails.clear();
+            m_thumbnailMap.clear();
+            m_thumbnailTexels = 0;
         }
 
         TextureRendererManager::TextureRendererManager(Model::TextureManager& textureManager) :
         m_textureManager(textureManager),
         m_dummyTexture(new TextureRenderer()),
         m_palette(NULL),
-        m_valid(true) {}
+        m_valid(true),
+        m_thumbnailTexels(0),
+        m_thumbnailBudget(16 * 1024 * 1024),
+        m_thumbnailFrame(0) {}
         
         TextureRendererManager::~TextureRendererManager() {
             clear();
@@ -88,24 +106,49 @@ namespace TrenchBroom {
             if (texture == NULL)
                 return *m_dummyTexture;
             
-            Model::TextureCollection& collection = texture->collection();
-            TextureRendererCollection* rendererCollection = NULL;
-            TextureRendererCollectionMap::iterator it = m_textureCollections.find(&collection);
-            if (it == m_textureCollections.end()) {
-                rendererCollection = new TextureRendererCollection(collection, *m_palette);
-                m_textureCollections[&collection] = rendererCollection;
-            } else {
-                rendererCollection = it->second;
-            }
-
-            if (rendererCollection == NULL)
-                return *m_dummyTexture;
-            
+            TextureRendererCollection* rendererCollection = this->rendererCollection(texture->collection());
             TextureRenderer* textureRenderer = rendererCollection->renderer(*texture);
             if (textureRenderer == NULL)
                 return *m_dummyTexture;
 
             return *textureRenderer;
         }
+
+        TextureRenderer& TextureRendererManager::thumbnail(Model::Texture* texture) {
+            TextureRenderer& textureRenderer = renderer(texture);
+            if (texture == NULL || &textureRenderer == m_dummyTexture)
+                return textureRenderer;
+            
+            Thumbnail thumbnail;
+            thumbnail.texture = texture;
+            thumbnail.frame = m_thumbnailFrame;
+            
+            ThumbnailMap::iterator it = m_thumbnailMap.find(texture);
+            if (it != m_thumbnailMap.end()) {
+                m_thumbnails.erase(it->second);
+            } else {
+                m_thumbnailTexels += texture->width() * texture->height();
+                it = m_thumbnailMap.insert(ThumbnailMap::value_type(texture, m_thumbnails.end())).first;
+            }
+            
+            m_thumbnails.push_front(thumbnail);
+            it->second = m_thumbnails.begin();
+            return textureRenderer;
+        }
+        
+        void TextureRendererManager::evictThumbnails() {
+            // the thumbnails may refer to textures that were deleted since the manager was invalidated
+            while (m_valid && m_thumbnailTexels > m_thumbnailBudget && !m_thumbnails.empty() && m_thumbnails.back().frame != m_thumbnailFrame) {
+                Model::Texture* texture = m_thumbnails.back().texture;
+                m_thumbnails.pop_back();
+                m_thumbnailMap.erase(texture);
+                m_thumbnailTexels -= texture->width() * texture->height();
+                
+                // the face renderers keep pointers to the renderers of the textures in use
+                if (texture->usageCount() == 0)
+                    rendererCollection(texture->collection())->release(*texture);
+            }
+            m_thumbnailFrame++;
+        }
     }
 }
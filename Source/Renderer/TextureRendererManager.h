@@ -21,7 +21,9 @@
 #define __TrenchBroom__TextureRendererManager__
 
 #include "Model/Texture.h"
+#include "Model/TextureManager.h"
 
+#include <list>
 #include <map>
 
 namespace TrenchBroom {
@@ -35,17 +37,29 @@ namespace TrenchBroom {
         class Palette;
         class TextureRenderer;
         
+        /*
+         * Loads the images of a texture collection on demand. The image of a texture is only read from the wad file
+         * when its renderer is requested for the first time.
+         */
         class TextureRendererCollection {
         protected:
             typedef std::map<Model::Texture*, TextureRenderer*> TextureRendererMap;
             typedef std::pair<Model::Texture*, TextureRenderer*> TextureRendererEntry;
             
+            Model::TextureCollection::LoaderPtr m_loader;
+            const Palette& m_palette;
             TextureRendererMap m_textures;
         public:
             TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette);
             ~TextureRendererCollection();
             
-            TextureRenderer* renderer(Model::Texture& texture) const;
+            TextureRenderer* renderer(Model::Texture& texture);
+            
+            /*
+             * Deletes the renderer of the given texture and its GL texture. The image is loaded again when the
+             * renderer is requested the next time.
+             */
+            void release(Model::Texture& texture);
         };
         
         class TextureRendererManager {
@@ -59,6 +73,25 @@ namespace TrenchBroom {
             TextureRendererCollectionMap m_textureCollections;
             bool m_valid;
 
+            /*
+             * The textures that were requested as thumbnails, most recently used first. Every thumbnail remembers
+             * the frame in which it was used last so that the thumbnails of the current frame are never evicted.
+             */
+            struct Thumbnail {
+                Model::Texture* texture;
+                size_t frame;
+            };
+            
+            typedef std::list<Thumbnail> ThumbnailList;
+            typedef std::map<Model::Texture*, ThumbnailList::iterator> ThumbnailMap;
+            
+            ThumbnailList m_thumbnails;
+            ThumbnailMap m_thumbnailMap;
+            size_t m_thumbnailTexels;
+            size_t m_thumbnailBudget;
+            size_t m_thumbnailFrame;
+            
+            TextureRendererCollection* rendererCollection(Model::TextureCollection& collection);
             void clear();
         public:
             TextureRendererManager(Model::TextureManager& textureManager);
@@ -73,6 +106,22 @@ namespace TrenchBroom {
             
             TextureRenderer& renderer(Model::Texture* texture);
             
+            /*
+             * Returns the renderer of the given texture for display in a browser and marks it as used in the current
+             * frame. Call evictThumbnails once the frame is done.
+             */
+            TextureRenderer& thumbnail(Model::Texture* texture);
+            
+            /*
+             * Releases the least recently used thumbnails until their texels fit into the budget again. Thumbnails
+             * of the current frame and textures that are used in the map are never released.
+             */
+            void evictThumbnails();
+            
+            inline void setThumbnailBudget(size_t thumbnailBudget) {
+                m_thumbnailBudget = thumbnailBudget;
+            }
+            
             inline void invalidate() {
                 m_valid = false;
             }
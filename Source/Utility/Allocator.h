@@ -20,6 +20,8 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include "Utility/Atomic.h"
+
 #include <cassert>
 #include <iostream>
 #include <limits>
@@ -31,6 +33,17 @@
 
 namespace TrenchBroom {
     namespace Utility {
+#ifdef TB_COUNT_POOL_ALLOCATIONS
+        /*
+         * Counts the blocks that all allocators have handed out. Only the benchmark target defines
+         * TB_COUNT_POOL_ALLOCATIONS, so that the editor does not pay for the atomic increment.
+         */
+        inline volatile AtomicValue& poolAllocationCount() {
+            static volatile AtomicValue count = 0;
+            return count;
+        }
+#endif
+
         template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
         class Allocator {
         private:
@@ -113,10 +126,20 @@ namespace TrenchBroom {
                 static ChunkList chunks;
                 return chunks;
             }
+            
+            // brushes are built and transformed on worker threads, see Utility::ThreadPool
+            static inline SpinLock& lock() {
+                static SpinLock l;
+                return l;
+            }
         public:
 #ifdef _ENABLE_ALLOCATOR
             inline void* operator new(size_t size) {
                 assert(size == sizeof(T));
+#ifdef TB_COUNT_POOL_ALLOCATIONS
+                atomicIncrement(poolAllocationCount());
+#endif
+                SpinLocker locker(lock());
 
                 if (!pool().empty()) {
                     T* t = pool().top();
@@ -149,6 +172,7 @@ namespace TrenchBroom {
 
             inline void operator delete(void* block) {
                 T* t = reinterpret_cast<T*>(block);
+                SpinLocker locker(lock());
 
                 size_t poolSize = PoolSize;
                 if (poolSize > 0 && pool().size() < poolSize) {
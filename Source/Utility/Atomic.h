@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Atomic_h
+#define TrenchBroom_Atomic_h
+
+#if defined _WIN32
+#include <intrin.h>
+#pragma intrinsic(_InterlockedIncrement, _InterlockedDecrement, _InterlockedExchange, _InterlockedCompareExchange)
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        typedef long AtomicValue;
+        
+        /*
+         * Returns the incremented value.
+         */
+        inline AtomicValue atomicIncrement(volatile AtomicValue& value) {
+#if defined _WIN32
+            return _InterlockedIncrement(&value);
+#else
+            return __sync_add_and_fetch(&value, 1);
+#endif
+        }
+        
+        /*
+         * Returns the decremented value.
+         */
+        inline AtomicValue atomicDecrement(volatile AtomicValue& value) {
+#if defined _WIN32
+            return _InterlockedDecrement(&value);
+#else
+            return __sync_sub_and_fetch(&value, 1);
+#endif
+        }
+
+        /*
+         * Returns the previous value.
+         */
+        inline AtomicValue atomicExchange(volatile AtomicValue& value, AtomicValue newValue) {
+#if defined _WIN32
+            return _InterlockedExchange(&value, newValue);
+#else
+            return __sync_lock_test_and_set(&value, newValue);
+#endif
+        }
+        
+        inline AtomicValue atomicLoad(volatile AtomicValue& value) {
+#if defined _WIN32
+            return _InterlockedCompareExchange(&value, 0, 0);
+#else
+            return __sync_add_and_fetch(&value, 0);
+#endif
+        }
+
+        /*
+         * A minimal lock for very short critical sections such as the free lists of the pooled allocators. Don't use
+         * it to guard anything that may block.
+         */
+        class SpinLock {
+        private:
+            volatile AtomicValue m_locked;
+            
+            SpinLock(const SpinLock& other);
+            SpinLock& operator=(const SpinLock& other);
+        public:
+            SpinLock() :
+            m_locked(0) {}
+            
+            inline void lock() {
+                while (atomicExchange(m_locked, 1) != 0) {
+                    while (m_locked != 0);
+                }
+            }
+            
+            inline void unlock() {
+                atomicExchange(m_locked, 0);
+            }
+        };
+        
+        class SpinLocker {
+        private:
+            SpinLock& m_lock;
+        public:
+            SpinLocker(SpinLock& lock) :
+            m_lock(lock) {
+                m_lock.lock();
+            }
+            
+            ~SpinLocker() {
+                m_lock.unlock();
+            }
+        };
+    }
+}
+
+#endif
@@ -336,16 +336,10 @@ namespace TrenchBroom {
             }
             
             const BBox<T> transformed(const Mat4f& transformation) const {
-                BBox<T> result;
-                result.min = result.max = transformation * vertex(false, false, false);
-                mergeWith(transformation * vertex(false, false, true ));
-                mergeWith(transformation * vertex(false, true , false));
-                mergeWith(transformation * vertex(false, true , true ));
-                mergeWith(transformation * vertex(true , false, false));
-                mergeWith(transformation * vertex(true , false, true ));
-                mergeWith(transformation * vertex(true , true , false));
-                mergeWith(transformation * vertex(true , true , true ));
-                return result;
+                Vec<T,3> corners[8];
+                for (size_t i = 0; i < 8; i++)
+                    corners[i] = vertex(i);
+                return transformedBounds(transformation, corners, 8);
             }
             
             inline BBox<T>& flip(const Axis::Type axis) {
@@ -399,6 +393,40 @@ namespace TrenchBroom {
         };
         
         typedef BBox<float> BBoxf;
+        
+        // Bounds of the given points after transforming them, count must not be zero
+        template <typename T>
+        inline const BBox<T> transformedBounds(const Mat<T,4,4>& transformation, const Vec<T,3>* points, const size_t count) {
+            assert(count > 0);
+            BBox<T> result;
+            result.min = result.max = transformation * points[0];
+            for (size_t i = 1; i < count; i++)
+                result.mergeWith(transformation * points[i]);
+            return result;
+        }
+        
+#if defined(TB_SIMD)
+        template <>
+        inline const BBoxf transformedBounds<float>(const Mat4f& transformation, const Vec3f* points, const size_t count) {
+            assert(count > 0);
+            SIMD::Float4 columns[4];
+            SIMD::loadColumns(transformation, columns);
+            
+            SIMD::Float4 min = SIMD::transformPoint(columns, points[0].v);
+            SIMD::Float4 max = min;
+            for (size_t i = 1; i < count; i++) {
+                // same argument order as std::min / std::max in BBox::mergeWith
+                const SIMD::Float4 point = SIMD::transformPoint(columns, points[i].v);
+                min = SIMD::min(point, min);
+                max = SIMD::max(point, max);
+            }
+            
+            BBoxf result;
+            SIMD::store3(result.min.v, min);
+            SIMD::store3(result.max.v, max);
+            return result;
+        }
+#endif
     }
 }
 
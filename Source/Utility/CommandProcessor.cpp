@@ -19,6 +19,8 @@
 
 #include "CommandProcessor.h"
 
+#include "Utility/Profiler.h"
+
 #include <algorithm>
 #include <cassert>
 
@@ -51,6 +53,7 @@ void CompoundCommand::clear() {
 }
 
 bool CompoundCommand::Do() {
+    TB_PROFILE_ZONE("CompoundCommand::Do");
     CommandList::iterator it, end;
     for (it = m_commands.begin(), end = m_commands.end(); it != end; ++it) {
         wxCommand* command = *it;
@@ -61,6 +64,7 @@ bool CompoundCommand::Do() {
 }
 
 bool CompoundCommand::Undo() {
+    TB_PROFILE_ZONE("CompoundCommand::Undo");
     CommandList::reverse_iterator it, end;
     for (it = m_commands.rbegin(), end = m_commands.rend(); it != end; ++it) {
         wxCommand* command = *it;
@@ -74,6 +78,16 @@ CommandProcessor::CommandProcessor(int maxCommandLevel) :
 wxCommandProcessor(maxCommandLevel),
 m_block(NULL) {}
 
+bool CommandProcessor::DoCommand(wxCommand& command) {
+    TB_PROFILE_ZONE("CommandProcessor::DoCommand");
+    return wxCommandProcessor::DoCommand(command);
+}
+
+bool CommandProcessor::UndoCommand(wxCommand& command) {
+    TB_PROFILE_ZONE("CommandProcessor::UndoCommand");
+    return wxCommandProcessor::UndoCommand(command);
+}
+
 void CommandProcessor::BeginGroup(wxCommandProcessor* wxCommandProc, const wxString& name) {
     CommandProcessor* commandProc = static_cast<CommandProcessor*>(wxCommandProc);
     commandProc->BeginGroup(name);
@@ -49,6 +49,9 @@ protected:
 
     GroupStack m_groupStack;
     wxCommand* m_block;
+
+    bool DoCommand(wxCommand& command);
+    bool UndoCommand(wxCommand& command);
 public:
     CommandProcessor(int maxCommandLevel = -1);
 
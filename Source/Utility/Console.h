@@ -22,10 +22,10 @@
 
 #include "Utility/String.h"
 
-#include <wx/textctrl.h>
-
 #include <vector>
 
+class wxTextCtrl;
+
 namespace TrenchBroom {
     namespace Utility {
         class Console {
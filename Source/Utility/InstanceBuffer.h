@@ -0,0 +1,148 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_InstanceBuffer_h
+#define TrenchBroom_InstanceBuffer_h
+
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Utility {
+        /*
+         The instances of a handle renderer, kept in a dense array that can be updated incrementally. Every instance is
+         identified by its position and stores its selection state in the w component. Removing an instance moves the
+         last instance into its slot so that the array never has gaps. The buffer records the range of slots that
+         changed since it was last cleaned, so a renderer only needs to upload that range.
+         */
+        class InstanceBuffer {
+        private:
+            typedef std::map<Vec3f, size_t, Vec3f::LexicographicOrder> IndexMap;
+            
+            Vec4f::List m_instances;
+            IndexMap m_indices;
+            size_t m_dirtyBegin;
+            size_t m_dirtyEnd;
+            
+            inline void touch(const size_t index) {
+                m_dirtyBegin = std::min(m_dirtyBegin, index);
+                m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+            }
+        public:
+            InstanceBuffer() :
+            m_dirtyBegin(0),
+            m_dirtyEnd(0) {}
+            
+            inline const Vec4f::List& instances() const {
+                return m_instances;
+            }
+            
+            inline size_t size() const {
+                return m_instances.size();
+            }
+            
+            inline bool empty() const {
+                return m_instances.empty();
+            }
+            
+            inline bool contains(const Vec3f& position) const {
+                return m_indices.find(position) != m_indices.end();
+            }
+            
+            inline bool selected(const Vec3f& position) const {
+                IndexMap::const_iterator it = m_indices.find(position);
+                return it != m_indices.end() && m_instances[it->second].w() > 0.5f;
+            }
+            
+            inline bool add(const Vec3f& position, const bool selected = false) {
+                const size_t index = m_instances.size();
+                if (!m_indices.insert(IndexMap::value_type(position, index)).second)
+                    return false;
+                m_instances.push_back(Vec4f(position, selected ? 1.0f : 0.0f));
+                touch(index);
+                return true;
+            }
+            
+            inline bool remove(const Vec3f& position) {
+                IndexMap::iterator it = m_indices.find(position);
+                if (it == m_indices.end())
+                    return false;
+                
+                const size_t index = it->second;
+                const size_t last = m_instances.size() - 1;
+                m_indices.erase(it);
+                if (index < last) {
+                    m_instances[index] = m_instances[last];
+                    m_indices[m_instances[index].xyz()] = index;
+                    touch(index);
+                }
+                m_instances.pop_back();
+                return true;
+            }
+            
+            inline bool setSelected(const Vec3f& position, const bool selected) {
+                IndexMap::const_iterator it = m_indices.find(position);
+                if (it == m_indices.end())
+                    return false;
+                
+                Vec4f& instance = m_instances[it->second];
+                const float state = selected ? 1.0f : 0.0f;
+                if (instance[3] != state) {
+                    instance[3] = state;
+                    touch(it->second);
+                }
+                return true;
+            }
+            
+            inline void clear() {
+                m_instances.clear();
+                m_indices.clear();
+                m_dirtyBegin = m_dirtyEnd = 0;
+            }
+            
+            /*
+             The slots in [dirtyBegin(), dirtyEnd()) changed since the buffer was last cleaned. Slots that were removed
+             from the end of the array are not included, the renderer learns about them from the size.
+             */
+            inline bool dirty() const {
+                return dirtyBegin() < dirtyEnd();
+            }
+            
+            inline size_t dirtyBegin() const {
+                return m_dirtyBegin;
+            }
+            
+            inline size_t dirtyEnd() const {
+                return std::min(m_dirtyEnd, m_instances.size());
+            }
+            
+            inline void clean() {
+                m_dirtyBegin = m_instances.size();
+                m_dirtyEnd = 0;
+            }
+        };
+    }
+}
+
+#endif
@@ -183,7 +183,7 @@ namespace TrenchBroom {
                 typename Vec<T,C>::List result;
                 result.reserve(right.size());
 
-                typename Vec<T,C>::List::const_iteartor it, end;
+                typename Vec<T,C>::List::const_iterator it, end;
                 for (it = right.begin(), end = right.end(); it != end; ++it)
                     result.push_back(*this * *it);
                 return result;
@@ -196,7 +196,7 @@ namespace TrenchBroom {
                 typename Vec<T,C-1>::List::const_iterator it, end;
                 for (it = right.begin(), end = right.end(); it != end; ++it)
                     result.push_back(*this * *it);
-                    return result;
+                return result;
             }
 
             // indexed access, returns one column
@@ -320,6 +320,20 @@ namespace TrenchBroom {
             return left;
         }
     
+        // Batch transformation of points, the result may alias the input
+        template <typename T>
+        inline void transformPoints(const Mat<T,4,4>& transformation, const Vec<T,3>* points, const size_t count, Vec<T,3>* result) {
+            for (size_t i = 0; i < count; i++)
+                result[i] = transformation * points[i];
+        }
+        
+        template <typename T>
+        inline std::vector<Vec<T,3> >& transformPoints(const Mat<T,4,4>& transformation, std::vector<Vec<T,3> >& points) {
+            if (!points.empty())
+                transformPoints(transformation, &points[0], points.size(), &points[0]);
+            return points;
+        }
+        
         template <typename T, size_t S>
         inline Mat<T,S,S>& transposeMatrix(Mat<T,S,S>& mat) {
             for (size_t c = 0; c < S; c++)
@@ -642,6 +656,82 @@ namespace TrenchBroom {
         typedef Mat<double,2,2> Mat2d;
         typedef Mat<double,3,3> Mat3d;
         typedef Mat<double,4,4> Mat4d;
+
+#if defined(TB_SIMD)
+        /*
+         The kernels below keep the operation order of the scalar templates, including the addition to the
+         initial null vector, so that they produce bit identical results.
+         */
+        namespace SIMD {
+            inline void loadColumns(const Mat4f& mat, Float4 columns[4]) {
+                for (size_t c = 0; c < 4; c++)
+                    columns[c] = load(mat[c].v);
+            }
+            
+            inline Float4 transformVector(const Float4 columns[4], const float* vec) {
+                Float4 result = splat(0.0f);
+                for (size_t i = 0; i < 4; i++)
+                    result = add(result, mul(columns[i], splat(vec[i])));
+                return result;
+            }
+            
+            inline Float4 transformPoint(const Float4 columns[4], const float* point) {
+                Float4 result = splat(0.0f);
+                for (size_t i = 0; i < 3; i++)
+                    result = add(result, mul(columns[i], splat(point[i])));
+                result = add(result, columns[3]);
+                return div(result, splatW(result));
+            }
+        }
+        
+        template <>
+        inline const Mat4f Mat4f::operator* (const Mat4f& right) const {
+            SIMD::Float4 columns[4];
+            SIMD::loadColumns(*this, columns);
+            
+            Mat4f result;
+            for (size_t c = 0; c < 4; c++)
+                SIMD::store(result[c].v, SIMD::transformVector(columns, right[c].v));
+            return result;
+        }
+        
+        template <>
+        inline const Vec4f Mat4f::operator* (const Vec4f& right) const {
+            SIMD::Float4 columns[4];
+            SIMD::loadColumns(*this, columns);
+            
+            Vec4f result;
+            SIMD::store(result.v, SIMD::transformVector(columns, right.v));
+            return result;
+        }
+        
+        template <>
+        inline const Vec3f Mat4f::operator* (const Vec3f& right) const {
+            SIMD::Float4 columns[4];
+            SIMD::loadColumns(*this, columns);
+
+            Vec3f result;
+            SIMD::store3(result.v, SIMD::transformPoint(columns, right.v));
+            return result;
+        }
+        
+        template <>
+        inline void transformPoints<float>(const Mat4f& transformation, const Vec3f* points, const size_t count, Vec3f* result) {
+            SIMD::Float4 columns[4];
+            SIMD::loadColumns(transformation, columns);
+            
+            for (size_t i = 0; i < count; i++)
+                SIMD::store3(result[i].v, SIMD::transformPoint(columns, points[i].v));
+        }
+
+        template <>
+        inline const Vec3f::List Mat4f::operator* (const Vec3f::List& right) const {
+            Vec3f::List result(right.size());
+            if (!right.empty())
+                transformPoints(*this, &right[0], right.size(), &result[0]);
+            return result;
+        }
+#endif
     }
 }
 
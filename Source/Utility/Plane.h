@@ -21,6 +21,7 @@
 #define TrenchBroom_Plane_h
 
 #include "Utility/Line.h"
+#include "Utility/Mat.h"
 #include "Utility/Quat.h"
 #include "Utility/Ray.h"
 #include "Utility/Vec.h"
@@ -170,6 +171,40 @@ namespace TrenchBroom {
                     
         typedef Plane<float> Planef;
         typedef Plane<double> Planed;
+        
+        // Batch transformation of planes, the result may alias the input
+        template <typename T>
+        inline void transformPlanes(const Mat4f& pointTransform, const Mat4f& vectorTransform, const Plane<T>* planes, const size_t count, Plane<T>* result) {
+            for (size_t i = 0; i < count; i++)
+                result[i] = planes[i].transformed(pointTransform, vectorTransform);
+        }
+        
+        template <typename T>
+        inline std::vector<Plane<T> >& transformPlanes(const Mat4f& pointTransform, const Mat4f& vectorTransform, std::vector<Plane<T> >& planes) {
+            if (!planes.empty())
+                transformPlanes(pointTransform, vectorTransform, &planes[0], planes.size(), &planes[0]);
+            return planes;
+        }
+        
+#if defined(TB_SIMD)
+        template <>
+        inline void transformPlanes<float>(const Mat4f& pointTransform, const Mat4f& vectorTransform, const Planef* planes, const size_t count, Planef* result) {
+            SIMD::Float4 pointColumns[4];
+            SIMD::Float4 vectorColumns[4];
+            SIMD::loadColumns(pointTransform, pointColumns);
+            SIMD::loadColumns(vectorTransform, vectorColumns);
+            
+            for (size_t i = 0; i < count; i++) {
+                const Vec3f oldAnchor = planes[i].anchor();
+                Vec3f normal, anchor;
+                SIMD::store3(normal.v, SIMD::transformPoint(vectorColumns, planes[i].normal.v));
+                SIMD::store3(anchor.v, SIMD::transformPoint(pointColumns, oldAnchor.v));
+                normal.normalize();
+                result[i].normal = normal;
+                result[i].distance = anchor.dot(normal);
+            }
+        }
+#endif
     }
 }
 
@@ -0,0 +1,199 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_PointGrid_h
+#define TrenchBroom_PointGrid_h
+
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Utility {
+        /*
+         A sparse uniform grid of points. Queries return the points of all cells that overlap the query region, so
+         their cost depends on the size of the region and not on the number of points in the grid. Every point
+         must only be added once.
+         */
+        class PointGrid {
+        private:
+            struct Cell {
+                int x;
+                int y;
+                int z;
+                
+                Cell(const int i_x, const int i_y, const int i_z) :
+                x(i_x),
+                y(i_y),
+                z(i_z) {}
+                
+                inline bool operator<(const Cell& other) const {
+                    if (x != other.x)
+                        return x < other.x;
+                    if (y != other.y)
+                        return y < other.y;
+                    return z < other.z;
+                }
+            };
+            
+            typedef std::map<Cell, Vec3f::List> CellMap;
+            typedef std::set<Cell> CellSet;
+            
+            float m_cellSize;
+            CellMap m_cells;
+            size_t m_count;
+            
+            inline int cellCoord(const float f) const {
+                return static_cast<int>(std::floor(f / m_cellSize));
+            }
+            
+            inline Cell cell(const Vec3f& point) const {
+                return Cell(cellCoord(point.x()), cellCoord(point.y()), cellCoord(point.z()));
+            }
+            
+            inline void collect(const Cell& cell, const Vec3f::List& points, CellSet& visited, Vec3f::List& result) const {
+                if (visited.insert(cell).second)
+                    result.insert(result.end(), points.begin(), points.end());
+            }
+            
+            void collect(const BBoxf& bounds, CellSet& visited, Vec3f::List& result) const {
+                const Cell min = cell(bounds.min);
+                const Cell max = cell(bounds.max);
+                
+                const double cellCount = (static_cast<double>(max.x - min.x) + 1.0) * (static_cast<double>(max.y - min.y) + 1.0) * (static_cast<double>(max.z - min.z) + 1.0);
+                if (cellCount > static_cast<double>(m_cells.size())) {
+                    // fewer occupied cells than cells in the bounds, so check the occupied cells instead
+                    CellMap::const_iterator it, end;
+                    for (it = m_cells.begin(), end = m_cells.end(); it != end; ++it) {
+                        const Cell& current = it->first;
+                        if (current.x >= min.x && current.x <= max.x &&
+                            current.y >= min.y && current.y <= max.y &&
+                            current.z >= min.z && current.z <= max.z)
+                            collect(current, it->second, visited, result);
+                    }
+                } else {
+                    for (int x = min.x; x <= max.x; x++) {
+                        for (int y = min.y; y <= max.y; y++) {
+                            for (int z = min.z; z <= max.z; z++) {
+                                const Cell current(x, y, z);
+                                CellMap::const_iterator it = m_cells.find(current);
+                                if (it != m_cells.end())
+                                    collect(current, it->second, visited, result);
+                            }
+                        }
+                    }
+                }
+            }
+        public:
+            PointGrid(const float cellSize) :
+            m_cellSize(cellSize),
+            m_count(0) {
+                assert(m_cellSize > 0.0f);
+            }
+            
+            inline size_t size() const {
+                return m_count;
+            }
+            
+            inline bool empty() const {
+                return m_count == 0;
+            }
+            
+            inline void add(const Vec3f& point) {
+                m_cells[cell(point)].push_back(point);
+                m_count++;
+            }
+            
+            inline bool remove(const Vec3f& point) {
+                CellMap::iterator cellIt = m_cells.find(cell(point));
+                if (cellIt == m_cells.end())
+                    return false;
+                
+                Vec3f::List& points = cellIt->second;
+                Vec3f::List::iterator pointIt = std::find(points.begin(), points.end(), point);
+                if (pointIt == points.end())
+                    return false;
+                
+                *pointIt = points.back();
+                points.pop_back();
+                if (points.empty())
+                    m_cells.erase(cellIt);
+                m_count--;
+                return true;
+            }
+            
+            inline void clear() {
+                m_cells.clear();
+                m_count = 0;
+            }
+            
+            /*
+             Finds every point within the given distance of the given center.
+             */
+            void findInSphere(const Vec3f& center, const float radius, Vec3f::List& result) const {
+                CellSet visited;
+                Vec3f::List candidates;
+                collect(BBoxf(center, radius), visited, candidates);
+                
+                const float radius2 = radius * radius;
+                Vec3f::List::const_iterator it, end;
+                for (it = candidates.begin(), end = candidates.end(); it != end; ++it)
+                    if (it->squaredDistanceTo(center) <= radius2)
+                        result.push_back(*it);
+            }
+            
+            /*
+             Finds the candidates for picking handles whose radius grows with their distance to the ray origin, as in
+             Ray::intersectWithSphere(position, radius, scalingFactor, maxDistance), where radiusFactor is the product of
+             the radius and the scaling factor. The result may contain points that the ray misses, but every point
+             that it hits is contained.
+             */
+            void findInCone(const Rayf& ray, const float radiusFactor, const float maxDistance, Vec3f::List& result) const {
+                CellSet visited;
+                if (radiusFactor >= 1.0f) {
+                    collect(BBoxf(ray.origin, maxDistance), visited, result);
+                    return;
+                }
+                
+                // a point hit by the ray is at most this factor times its distance along the ray away from the ray
+                const float spread = radiusFactor / std::sqrt(1.0f - radiusFactor * radiusFactor);
+                for (float start = 0.0f; start < maxDistance; start += m_cellSize) {
+                    const float end = std::min(start + m_cellSize, maxDistance);
+                    const float radius = spread * end;
+                    
+                    BBoxf bounds;
+                    bounds.min = bounds.max = ray.pointAtDistance(start);
+                    bounds.mergeWith(ray.pointAtDistance(end));
+                    bounds.min -= Vec3f(radius, radius, radius);
+                    bounds.max += Vec3f(radius, radius, radius);
+                    collect(bounds, visited, result);
+                }
+            }
+        };
+    }
+}
+
+#endif
@@ -158,6 +158,11 @@ namespace TrenchBroom {
         const int               RendererInstancingModeForceOn       = 1;
         const int               RendererInstancingModeForceOff      = 2;
 
+        const Preference<int>   ProfilerMode = Preference<int>(                                 "Debug/Profiler mode",                                          0);
+        const int               ProfilerModeOff                     = 0;
+        const int               ProfilerModeRecord                  = 1;
+        const int               ProfilerModeConsole                 = 2;
+
         const Preference<KeyboardShortcut>  CameraMoveForward = Preference<KeyboardShortcut>(   "Controls/Camera/Move Forward",     KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'W', KeyboardShortcut::SCAny, "Move Camera Forward"));
         const Preference<KeyboardShortcut>  CameraMoveBackward = Preference<KeyboardShortcut>(  "Controls/Camera/Move Backward",    KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'S', KeyboardShortcut::SCAny, "Move Camera Backward"));
         const Preference<KeyboardShortcut>  CameraMoveLeft = Preference<KeyboardShortcut>(      "Controls/Camera/Move Left",        KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'A', KeyboardShortcut::SCAny, "Move Camera Left"));
@@ -300,6 +305,7 @@ namespace TrenchBroom {
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectAll, WXK_CONTROL, 'A', KeyboardShortcut::SCAny, "Select All"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectSiblings, WXK_CONTROL, WXK_ALT, 'A', KeyboardShortcut::SCAny, "Select Siblings"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectTouching, WXK_CONTROL, 'T', KeyboardShortcut::SCAny, "Select Touching"));
+            editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectInside, WXK_CONTROL, 'E', KeyboardShortcut::SCAny, "Select Inside"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectByFilePosition, KeyboardShortcut::SCAny, "Select by Line Number"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectNone, WXK_CONTROL, WXK_SHIFT, 'A', KeyboardShortcut::SCAny, "Select None"));
             editMenu->addSeparator();
@@ -382,6 +388,10 @@ namespace TrenchBroom {
             objectActionMenu.addSeparator();
             MenuItem::Ptr snapVerticesItem = objectActionMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSnapVertices, KeyboardShortcut::SCObjects | KeyboardShortcut::SCVertexTool, "Snap Vertices"));
             objectActionMenu.addSeparator();
+            objectActionMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSubtractBrushes, KeyboardShortcut::SCObjects, "Subtract Brushes"));
+            objectActionMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditMergeBrushes, KeyboardShortcut::SCObjects, "Merge Brushes"));
+            objectActionMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditHollowBrushes, KeyboardShortcut::SCObjects, "Hollow Brushes"));
+            objectActionMenu.addSeparator();
 #ifdef __linux__ // tab is not allowed as a menu accelerator on GTK
             MenuItem::Ptr toggleAxisItem = objectActionMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditToggleAxisRestriction, 'X', KeyboardShortcut::SCObjects | KeyboardShortcut::SCVertexTool, "Toggle Movement Axis"));
 #else
@@ -362,6 +362,10 @@ namespace TrenchBroom {
         extern const int                RendererInstancingModeAutodetect;
         extern const int                RendererInstancingModeForceOn;
         extern const int                RendererInstancingModeForceOff;
+        extern const Preference<int>    ProfilerMode;
+        extern const int                ProfilerModeOff;
+        extern const int                ProfilerModeRecord;
+        extern const int                ProfilerModeConsole;
 
         extern const Preference<KeyboardShortcut>   CameraMoveForward;
         extern const Preference<KeyboardShortcut>   CameraMoveBackward;
@@ -0,0 +1,264 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+#if defined _WIN32
+#include <windows.h>
+#elif defined __APPLE__
+#include <mach/mach_time.h>
+#include <pthread.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        namespace {
+            // set once the profiler is destroyed, threads that exit later must not touch it anymore
+            volatile bool profilerDestroyed = false;
+            
+#if defined _WIN32
+            VOID WINAPI releaseThreadBuffer(PVOID buffer) {
+#else
+            void releaseThreadBuffer(void* buffer) {
+#endif
+                if (buffer != NULL && !profilerDestroyed)
+                    Profiler::instance().releaseThreadBuffer(static_cast<ProfilerBuffer*>(buffer));
+            }
+            
+            class ThreadBufferKey {
+            private:
+#if defined _WIN32
+                DWORD m_key;
+#else
+                pthread_key_t m_key;
+#endif
+            public:
+                ThreadBufferKey() {
+                    // fiber local storage is used on Windows because, unlike thread local storage, it calls a
+                    // destructor when a thread exits
+#if defined _WIN32
+                    m_key = FlsAlloc(releaseThreadBuffer);
+#else
+                    pthread_key_create(&m_key, releaseThreadBuffer);
+#endif
+                }
+                
+                inline ProfilerBuffer* get() const {
+#if defined _WIN32
+                    return static_cast<ProfilerBuffer*>(FlsGetValue(m_key));
+#else
+                    return static_cast<ProfilerBuffer*>(pthread_getspecific(m_key));
+#endif
+                }
+                
+                inline void set(ProfilerBuffer* buffer) {
+#if defined _WIN32
+                    FlsSetValue(m_key, buffer);
+#else
+                    pthread_setspecific(m_key, buffer);
+#endif
+                }
+            };
+            
+            ThreadBufferKey threadBufferKey;
+            
+            class ZoneTime {
+            public:
+                ProfilerTime time;
+                size_t count;
+                size_t firstIndex;
+                
+                ZoneTime() :
+                time(0),
+                count(0),
+                firstIndex(0) {}
+            };
+            
+            struct CompareFirstIndex {
+                inline bool operator()(const std::pair<const char*, ZoneTime>& lhs, const std::pair<const char*, ZoneTime>& rhs) const {
+                    return lhs.second.firstIndex < rhs.second.firstIndex;
+                }
+            };
+            
+            struct CompareBegin {
+                inline bool operator()(const ProfilerEvent& lhs, const ProfilerEvent& rhs) const {
+                    return lhs.begin < rhs.begin;
+                }
+            };
+        }
+        
+        void ProfilerBuffer::events(ProfilerTime since, std::vector<ProfilerEvent>& result) const {
+            const size_t count = static_cast<size_t>(atomicLoad(const_cast<volatile AtomicValue&>(m_count)));
+            const size_t first = count > Capacity ? count - Capacity : 0;
+            for (size_t i = first; i < count; i++) {
+                const ProfilerEvent& event = m_events[i % Capacity];
+                if (event.begin >= since)
+                    result.push_back(event);
+            }
+        }
+        
+        Profiler::Profiler() :
+        m_nextThreadId(0),
+        m_enabled(0),
+        m_startTime(now()),
+        m_frameStartTime(m_startTime) {}
+        
+        Profiler::~Profiler() {
+            profilerDestroyed = true;
+            
+            SpinLocker locker(m_lock);
+            BufferList::iterator it, end;
+            for (it = m_buffers.begin(), end = m_buffers.end(); it != end; ++it)
+                delete *it;
+            m_buffers.clear();
+        }
+        
+        Profiler& Profiler::instance() {
+            static Profiler profiler;
+            return profiler;
+        }
+        
+        ProfilerTime Profiler::now() {
+#if defined _WIN32
+            static LARGE_INTEGER frequency = { 0 };
+            if (frequency.QuadPart == 0)
+                QueryPerformanceFrequency(&frequency);
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+            return static_cast<ProfilerTime>(counter.QuadPart) * 1000000000 / static_cast<ProfilerTime>(frequency.QuadPart);
+#elif defined __APPLE__
+            static mach_timebase_info_data_t timebase = { 0, 0 };
+            if (timebase.denom == 0)
+                mach_timebase_info(&timebase);
+            return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+            timespec time;
+            clock_gettime(CLOCK_MONOTONIC, &time);
+            return static_cast<ProfilerTime>(time.tv_sec) * 1000000000 + static_cast<ProfilerTime>(time.tv_nsec);
+#endif
+        }
+        
+        ProfilerBuffer& Profiler::threadBuffer() {
+            ProfilerBuffer* buffer = threadBufferKey.get();
+            if (buffer == NULL) {
+                SpinLocker locker(m_lock);
+                buffer = new ProfilerBuffer(m_nextThreadId++);
+                m_buffers.push_back(buffer);
+                threadBufferKey.set(buffer);
+            }
+            return *buffer;
+        }
+        
+        void Profiler::releaseThreadBuffer(ProfilerBuffer* buffer) {
+            std::vector<ProfilerEvent> events;
+            buffer->events(0, events);
+            
+            SpinLocker locker(m_lock);
+            m_retiredEvents.insert(m_retiredEvents.end(), events.begin(), events.end());
+            if (m_retiredEvents.size() > ProfilerBuffer::Capacity)
+                m_retiredEvents.erase(m_retiredEvents.begin(), m_retiredEvents.end() - ProfilerBuffer::Capacity);
+            
+            BufferList::iterator it = std::find(m_buffers.begin(), m_buffers.end(), buffer);
+            if (it != m_buffers.end())
+                m_buffers.erase(it);
+            delete buffer;
+        }
+        
+        void Profiler::beginFrame() {
+            m_frameStartTime = now();
+        }
+        
+        String Profiler::frameSummary() {
+            const ProfilerTime frameTime = now() - m_frameStartTime;
+            
+            std::vector<ProfilerEvent> events;
+            threadBuffer().events(m_frameStartTime, events);
+            
+            typedef std::map<const char*, ZoneTime> ZoneTimeMap;
+            ZoneTimeMap zoneTimes;
+            for (size_t i = 0; i < events.size(); i++) {
+                const ProfilerEvent& event = events[i];
+                ZoneTime& zoneTime = zoneTimes[event.name];
+                if (zoneTime.count == 0)
+                    zoneTime.firstIndex = i;
+                zoneTime.time += event.end - event.begin;
+                zoneTime.count++;
+            }
+            
+            // list the zones in the order in which they first finished
+            std::vector<std::pair<const char*, ZoneTime> > sortedZoneTimes(zoneTimes.begin(), zoneTimes.end());
+            std::sort(sortedZoneTimes.begin(), sortedZoneTimes.end(), CompareFirstIndex());
+            
+            StringStream summary;
+            summary.setf(std::ios::fixed);
+            summary.precision(2);
+            summary << "Frame " << static_cast<double>(frameTime) / 1000000.0 << " ms";
+            for (size_t i = 0; i < sortedZoneTimes.size(); i++) {
+                const char* name = sortedZoneTimes[i].first;
+                const ZoneTime& zoneTime = sortedZoneTimes[i].second;
+                summary << (i == 0 ? ": " : ", ") << name << " " << static_cast<double>(zoneTime.time) / 1000000.0 << " ms";
+                if (zoneTime.count > 1)
+                    summary << " (" << zoneTime.count << "x)";
+            }
+            return summary.str();
+        }
+        
+        void Profiler::writeChromeTrace(std::ostream& stream) {
+            std::vector<ProfilerEvent> events;
+            {
+                // the buffers of exiting threads are deleted under the lock
+                SpinLocker locker(m_lock);
+                BufferList::const_iterator it, end;
+                for (it = m_buffers.begin(), end = m_buffers.end(); it != end; ++it) {
+                    const ProfilerBuffer& buffer = **it;
+                    buffer.events(m_startTime, events);
+                }
+                
+                std::vector<ProfilerEvent>::const_iterator eventIt, eventEnd;
+                for (eventIt = m_retiredEvents.begin(), eventEnd = m_retiredEvents.end(); eventIt != eventEnd; ++eventIt)
+                    if (eventIt->begin >= m_startTime)
+                        events.push_back(*eventIt);
+            }
+            std::sort(events.begin(), events.end(), CompareBegin());
+            
+            stream << "{\"traceEvents\":[\n";
+            for (size_t i = 0; i < events.size(); i++) {
+                const ProfilerEvent& event = events[i];
+                const ProfilerTime begin = event.begin - m_startTime;
+                const ProfilerTime duration = event.end - event.begin;
+                
+                if (i > 0)
+                    stream << ",\n";
+                
+                // Chrome expects microseconds
+                stream << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId;
+                stream << ",\"ts\":" << begin / 1000 << "." << (begin % 1000) / 100;
+                stream << ",\"dur\":" << duration / 1000 << "." << (duration % 1000) / 100 << "}";
+            }
+            stream << "\n]}\n";
+        }
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__Profiler__
+#define __TrenchBroom__Profiler__
+
+#include "Utility/Atomic.h"
+#include "Utility/String.h"
+
+#include <ostream>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        typedef uint64_t ProfilerTime;
+        
+        class ProfilerEvent {
+        public:
+            const char* name;
+            ProfilerTime begin;
+            ProfilerTime end;
+            unsigned int depth;
+            unsigned int threadId;
+        };
+        
+        /*
+         * Holds the most recent events recorded by one thread. Only the owning thread writes to the buffer, so it needs
+         * no lock; the event count is published atomically after each event has been written. When the buffer is full,
+         * the oldest events are overwritten.
+         */
+        class ProfilerBuffer {
+        public:
+            static const size_t Capacity = 1 << 15;
+        private:
+            std::vector<ProfilerEvent> m_events;
+            volatile AtomicValue m_count;
+            unsigned int m_threadId;
+            unsigned int m_depth;
+        public:
+            ProfilerBuffer(unsigned int threadId) :
+            m_events(Capacity),
+            m_count(0),
+            m_threadId(threadId),
+            m_depth(0) {}
+            
+            inline unsigned int threadId() const {
+                return m_threadId;
+            }
+            
+            inline unsigned int enter() {
+                return m_depth++;
+            }
+            
+            inline void leave(const char* name, ProfilerTime begin, ProfilerTime end, unsigned int depth) {
+                m_depth--;
+                
+                const AtomicValue count = m_count;
+                ProfilerEvent& event = m_events[static_cast<size_t>(count) % Capacity];
+                event.name = name;
+                event.begin = begin;
+                event.end = end;
+                event.depth = depth;
+                event.threadId = m_threadId;
+                atomicIncrement(m_count);
+            }
+            
+            /*
+             * Appends the events that began at or after the given time to the given list, oldest first.
+             */
+            void events(ProfilerTime since, std::vector<ProfilerEvent>& result) const;
+        };
+        
+        /*
+         * Records named zones on every thread that enters one. Recording is off until enabled, and a disabled zone
+         * costs no more than reading a flag. When a thread exits, the most recent events of its buffer are kept and
+         * the buffer is deleted.
+         */
+        class Profiler {
+        private:
+            typedef std::vector<ProfilerBuffer*> BufferList;
+            
+            SpinLock m_lock;
+            BufferList m_buffers;
+            std::vector<ProfilerEvent> m_retiredEvents;
+            unsigned int m_nextThreadId;
+            volatile AtomicValue m_enabled;
+            ProfilerTime m_startTime;
+            ProfilerTime m_frameStartTime;
+            
+            Profiler();
+            ~Profiler();
+        public:
+            static Profiler& instance();
+            
+            /*
+             * Returns a monotonic time stamp in nanoseconds.
+             */
+            static ProfilerTime now();
+            
+            inline bool enabled() {
+                return m_enabled != 0;
+            }
+            
+            inline void setEnabled(bool enabled) {
+                atomicExchange(m_enabled, enabled ? 1 : 0);
+            }
+            
+            /*
+             * Returns the buffer of the calling thread and creates it if necessary.
+             */
+            ProfilerBuffer& threadBuffer();
+            
+            /*
+             * Called on a thread that exits. Merges the events of its buffer into the retired events, of which at most
+             * ProfilerBuffer::Capacity are kept, and deletes the buffer.
+             */
+            void releaseThreadBuffer(ProfilerBuffer* buffer);
+            
+            void beginFrame();
+            
+            /*
+             * Returns a one line summary of the zones that the calling thread has recorded since the last call to
+             * beginFrame, with the total time and the number of calls per zone.
+             */
+            String frameSummary();
+            
+            /*
+             * Writes every recorded event in the Chrome trace event format, which can be loaded in chrome://tracing.
+             */
+            void writeChromeTrace(std::ostream& stream);
+        };
+        
+        class ProfilerZone {
+        private:
+            const char* m_name;
+            ProfilerBuffer* m_buffer;
+            ProfilerTime m_begin;
+            unsigned int m_depth;
+        public:
+            ProfilerZone(const char* name) :
+            m_name(name),
+            m_buffer(NULL) {
+                Profiler& profiler = Profiler::instance();
+                if (profiler.enabled()) {
+                    m_buffer = &profiler.threadBuffer();
+                    m_depth = m_buffer->enter();
+                    m_begin = Profiler::now();
+                }
+            }
+            
+            ~ProfilerZone() {
+                if (m_buffer != NULL)
+                    m_buffer->leave(m_name, m_begin, Profiler::now(), m_depth);
+            }
+        };
+    }
+}
+
+#define TB_PROFILE_ZONE_NAME(line) profilerZone##line
+#define TB_PROFILE_ZONE_LINE(name, line) TrenchBroom::Utility::ProfilerZone TB_PROFILE_ZONE_NAME(line)(name)
+#define TB_PROFILE_ZONE(name) TB_PROFILE_ZONE_LINE(name, __LINE__)
+
+#endif /* defined(__TrenchBroom__Profiler__) */
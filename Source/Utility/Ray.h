@@ -36,6 +36,14 @@ namespace TrenchBroom {
 
             Ray(const Vec<T,3>& i_origin, const Vec<T,3>& i_direction) : origin(i_origin), direction(i_direction) {}
 
+            inline bool operator== (const Ray<T>& right) const {
+                return origin == right.origin && direction == right.direction;
+            }
+
+            inline bool operator!= (const Ray<T>& right) const {
+                return !(*this == right);
+            }
+
             inline const Vec<T,3> pointAtDistance(const T distance) const {
                 return origin + direction * distance;
             }
@@ -0,0 +1,172 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_SIMD_h
+#define TrenchBroom_SIMD_h
+
+#if !defined(TB_NO_SIMD)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TB_SIMD_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define TB_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(TB_SIMD_SSE) || defined(TB_SIMD_NEON)
+#define TB_SIMD
+#endif
+
+#if defined(TB_SIMD)
+
+namespace TrenchBroom {
+    namespace VecMath {
+        /*
+         Thin wrapper around four packed floats so that the kernels in Vec.h, Mat.h and BBox.h can be written
+         once for SSE and NEON. All operations work lane by lane, so the kernels produce exactly the same
+         results as the scalar templates as long as they perform the operations in the same order.
+         */
+        namespace SIMD {
+#if defined(TB_SIMD_SSE)
+            typedef __m128 Float4;
+
+            inline Float4 load(const float* values) {
+                return _mm_loadu_ps(values);
+            }
+            
+            inline Float4 load3(const float* values, const float w) {
+                return _mm_set_ps(w, values[2], values[1], values[0]);
+            }
+            
+            inline void store(float* values, const Float4 f) {
+                _mm_storeu_ps(values, f);
+            }
+            
+            inline Float4 splat(const float f) {
+                return _mm_set1_ps(f);
+            }
+            
+            inline Float4 splatW(const Float4 f) {
+                return _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+            
+            inline Float4 negate(const Float4 f) {
+                return _mm_xor_ps(f, _mm_set1_ps(-0.0f));
+            }
+            
+            inline Float4 add(const Float4 l, const Float4 r) {
+                return _mm_add_ps(l, r);
+            }
+            
+            inline Float4 sub(const Float4 l, const Float4 r) {
+                return _mm_sub_ps(l, r);
+            }
+            
+            inline Float4 mul(const Float4 l, const Float4 r) {
+                return _mm_mul_ps(l, r);
+            }
+            
+            inline Float4 div(const Float4 l, const Float4 r) {
+                return _mm_div_ps(l, r);
+            }
+            
+            inline Float4 min(const Float4 l, const Float4 r) {
+                return _mm_min_ps(l, r);
+            }
+            
+            inline Float4 max(const Float4 l, const Float4 r) {
+                return _mm_max_ps(l, r);
+            }
+#elif defined(TB_SIMD_NEON)
+            typedef float32x4_t Float4;
+            
+            inline Float4 load(const float* values) {
+                return vld1q_f32(values);
+            }
+            
+            inline Float4 load3(const float* values, const float w) {
+                const float buffer[4] = { values[0], values[1], values[2], w };
+                return vld1q_f32(buffer);
+            }
+            
+            inline void store(float* values, const Float4 f) {
+                vst1q_f32(values, f);
+            }
+            
+            inline Float4 splat(const float f) {
+                return vdupq_n_f32(f);
+            }
+            
+            inline Float4 splatW(const Float4 f) {
+                return vdupq_n_f32(vgetq_lane_f32(f, 3));
+            }
+            
+            inline Float4 negate(const Float4 f) {
+                return vnegq_f32(f);
+            }
+            
+            inline Float4 add(const Float4 l, const Float4 r) {
+                return vaddq_f32(l, r);
+            }
+            
+            inline Float4 sub(const Float4 l, const Float4 r) {
+                return vsubq_f32(l, r);
+            }
+            
+            inline Float4 mul(const Float4 l, const Float4 r) {
+                return vmulq_f32(l, r);
+            }
+            
+            inline Float4 div(const Float4 l, const Float4 r) {
+#if defined(__aarch64__)
+                return vdivq_f32(l, r);
+#else
+                // ARMv7 NEON has no exact division, only a reciprocal estimate
+                float lb[4], rb[4];
+                vst1q_f32(lb, l);
+                vst1q_f32(rb, r);
+                for (unsigned int i = 0; i < 4; i++)
+                    lb[i] /= rb[i];
+                return vld1q_f32(lb);
+#endif
+            }
+            
+            inline Float4 min(const Float4 l, const Float4 r) {
+                return vminq_f32(l, r);
+            }
+            
+            inline Float4 max(const Float4 l, const Float4 r) {
+                return vmaxq_f32(l, r);
+            }
+#endif
+            inline void store3(float* values, const Float4 f) {
+                float buffer[4];
+                store(buffer, f);
+                values[0] = buffer[0];
+                values[1] = buffer[1];
+                values[2] = buffer[2];
+            }
+        }
+    }
+}
+
+#endif
+
+#endif
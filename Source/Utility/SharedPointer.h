@@ -22,6 +22,14 @@
 
 #if defined _WIN32
 #include <memory>
+#elif __cplusplus >= 201103L
+// libc++ has no TR1 headers, so map the TR1 name onto the C++11 pointer
+#include <memory>
+namespace std {
+    namespace tr1 {
+        using std::shared_ptr;
+    }
+}
 #else
 #include <tr1/memory>
 #endif
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_StringTable_h
+#define TrenchBroom_StringTable_h
+
+#include "Utility/Atomic.h"
+#include "Utility/String.h"
+
+#include <set>
+
+namespace TrenchBroom {
+    namespace Utility {
+        /*
+         * Stores every distinct string only once. Interned strings are never removed, so the returned pointers remain
+         * valid for the lifetime of the table, and two strings interned in the same table are equal if and only if
+         * their pointers are equal. The table may be used from several threads at once.
+         */
+        class StringTable {
+        private:
+            typedef std::set<String> StringSet;
+            
+            StringSet m_strings;
+            mutable SpinLock m_lock;
+            
+            StringTable(const StringTable& other);
+            StringTable& operator=(const StringTable& other);
+        public:
+            StringTable() {}
+            
+            inline const String* intern(const String& str) {
+                SpinLocker locker(m_lock);
+                return &*m_strings.insert(str).first;
+            }
+            
+            /*
+             * Returns the interned copy of the given string or NULL if the string was never interned.
+             */
+            inline const String* find(const String& str) const {
+                SpinLocker locker(m_lock);
+                StringSet::const_iterator it = m_strings.find(str);
+                if (it == m_strings.end())
+                    return NULL;
+                return &*it;
+            }
+            
+            inline size_t size() const {
+                SpinLocker locker(m_lock);
+                return m_strings.size();
+            }
+        };
+    }
+}
+
+#endif
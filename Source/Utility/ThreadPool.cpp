@@ -0,0 +1,411 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.h"
+
+#include "Utility/MessageException.h"
+#include "Utility/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+
+#if defined _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        namespace {
+            class Mutex {
+            private:
+#if defined _WIN32
+                CRITICAL_SECTION m_section;
+#else
+                pthread_mutex_t m_mutex;
+#endif
+                friend class Condition;
+            public:
+                Mutex() {
+#if defined _WIN32
+                    InitializeCriticalSection(&m_section);
+#else
+                    pthread_mutex_init(&m_mutex, NULL);
+#endif
+                }
+                
+                ~Mutex() {
+#if defined _WIN32
+                    DeleteCriticalSection(&m_section);
+#else
+                    pthread_mutex_destroy(&m_mutex);
+#endif
+                }
+                
+                inline void lock() {
+#if defined _WIN32
+                    EnterCriticalSection(&m_section);
+#else
+                    pthread_mutex_lock(&m_mutex);
+#endif
+                }
+                
+                inline void unlock() {
+#if defined _WIN32
+                    LeaveCriticalSection(&m_section);
+#else
+                    pthread_mutex_unlock(&m_mutex);
+#endif
+                }
+            };
+            
+            class Condition {
+            private:
+#if defined _WIN32
+                CONDITION_VARIABLE m_condition;
+#else
+                pthread_cond_t m_condition;
+#endif
+            public:
+                Condition() {
+#if defined _WIN32
+                    InitializeConditionVariable(&m_condition);
+#else
+                    pthread_cond_init(&m_condition, NULL);
+#endif
+                }
+                
+                ~Condition() {
+#if !defined _WIN32
+                    pthread_cond_destroy(&m_condition);
+#endif
+                }
+                
+                inline void wait(Mutex& mutex) {
+#if defined _WIN32
+                    SleepConditionVariableCS(&m_condition, &mutex.m_section, INFINITE);
+#else
+                    pthread_cond_wait(&m_condition, &mutex.m_mutex);
+#endif
+                }
+                
+                inline void broadcast() {
+#if defined _WIN32
+                    WakeAllConditionVariable(&m_condition);
+#else
+                    pthread_cond_broadcast(&m_condition);
+#endif
+                }
+            };
+            
+            inline size_t processorCount() {
+#if defined _WIN32
+                SYSTEM_INFO info;
+                GetSystemInfo(&info);
+                return static_cast<size_t>(info.dwNumberOfProcessors);
+#else
+                const long count = sysconf(_SC_NPROCESSORS_ONLN);
+                return count > 0 ? static_cast<size_t>(count) : 1;
+#endif
+            }
+            
+#if defined _WIN32
+            struct ThreadStart {
+                void* (*function)(void*);
+                void* argument;
+            };
+            
+            unsigned __stdcall runThread(void* start) {
+                ThreadStart* threadStart = reinterpret_cast<ThreadStart*>(start);
+                threadStart->function(threadStart->argument);
+                delete threadStart;
+                return 0;
+            }
+#endif
+            
+            inline bool startThread(void* (*function)(void*), void* argument) {
+#if defined _WIN32
+                ThreadStart* start = new ThreadStart();
+                start->function = function;
+                start->argument = argument;
+                uintptr_t handle = _beginthreadex(NULL, 0, &runThread, start, 0, NULL);
+                if (handle == 0) {
+                    delete start;
+                    return false;
+                }
+                CloseHandle(reinterpret_cast<HANDLE>(handle));
+                return true;
+#else
+                pthread_t thread;
+                if (pthread_create(&thread, NULL, function, argument) != 0)
+                    return false;
+                pthread_detach(thread);
+                return true;
+#endif
+            }
+        }
+        
+        struct ThreadPool::State {
+            Mutex mutex;
+            Condition workAvailable;
+            Condition workDone;
+            
+            ParallelTask* task;
+            size_t count;
+            size_t next;
+            size_t done;
+            size_t batchSize;
+            bool busy;
+            
+            bool failed;
+            String error;
+            
+            State() :
+            task(NULL),
+            count(0),
+            next(0),
+            done(0),
+            batchSize(1),
+            busy(false),
+            failed(false) {}
+        };
+        
+        ThreadPool::ThreadPool() :
+        m_state(new State()),
+        m_threadCount(0) {
+            const size_t workerCount = processorCount() - 1;
+            for (size_t i = 0; i < workerCount; i++) {
+                if (startThread(&ThreadPool::workerMain, this))
+                    m_threadCount++;
+            }
+        }
+        
+        void* ThreadPool::workerMain(void* pool) {
+            ThreadPool* threadPool = reinterpret_cast<ThreadPool*>(pool);
+            threadPool->m_state->mutex.lock();
+            threadPool->work(false);
+            threadPool->m_state->mutex.unlock();
+            return NULL;
+        }
+        
+        void ThreadPool::runBatch(ParallelTask& task, size_t begin, size_t end, bool& failed, String& error) {
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    task.run(i);
+                } catch (std::exception& e) {
+                    if (!failed) {
+                        failed = true;
+                        error = e.what();
+                    }
+                } catch (...) {
+                    if (!failed) {
+                        failed = true;
+                        error = "Unknown exception in parallel task";
+                    }
+                }
+            }
+        }
+        
+        void ThreadPool::work(bool caller) {
+            // the mutex is locked when this is called and when it returns
+            State& state = *m_state;
+            while (true) {
+                if (caller) {
+                    if (state.next >= state.count)
+                        return;
+                } else {
+                    while (state.task == NULL || state.next >= state.count)
+                        state.workAvailable.wait(state.mutex);
+                }
+                
+                ParallelTask* task = state.task;
+                const size_t begin = state.next;
+                const size_t end = std::min(begin + state.batchSize, state.count);
+                state.next = end;
+                state.mutex.unlock();
+                
+                bool failed = false;
+                String error;
+                runBatch(*task, begin, end, failed, error);
+                
+                state.mutex.lock();
+                if (failed && !state.failed) {
+                    state.failed = true;
+                    state.error = error;
+                }
+                state.done += end - begin;
+                if (state.done == state.count)
+                    state.workDone.broadcast();
+            }
+        }
+        
+        struct BackgroundTask::State {
+            mutable Mutex mutex;
+            Condition finishedCondition;
+            BackgroundTaskListener* listener;
+            bool started;
+            bool finished;
+            bool failed;
+            String error;
+            
+            State() :
+            listener(NULL),
+            started(false),
+            finished(false),
+            failed(false) {}
+        };
+        
+        void* BackgroundTask::taskMain(void* task) {
+            reinterpret_cast<BackgroundTask*>(task)->execute();
+            return NULL;
+        }
+        
+        void BackgroundTask::execute() {
+            bool failed = false;
+            String error;
+            try {
+                run();
+            } catch (std::exception& e) {
+                failed = true;
+                error = e.what();
+            } catch (...) {
+                failed = true;
+                error = "Unknown exception in background task";
+            }
+            
+            m_state->mutex.lock();
+            m_state->failed = failed;
+            m_state->error = error;
+            m_state->finished = true;
+            // notify while the mutex is held, otherwise the task could be deleted by a waiting thread in the meantime
+            if (m_state->listener != NULL)
+                m_state->listener->backgroundTaskFinished();
+            m_state->finishedCondition.broadcast();
+            m_state->mutex.unlock();
+        }
+        
+        BackgroundTask::BackgroundTask() :
+        m_state(new State()) {}
+        
+        BackgroundTask::~BackgroundTask() {
+            wait();
+            delete m_state;
+            m_state = NULL;
+        }
+        
+        void BackgroundTask::setListener(BackgroundTaskListener* listener) {
+            assert(!m_state->started);
+            m_state->listener = listener;
+        }
+        
+        void BackgroundTask::start() {
+            assert(!m_state->started);
+            m_state->started = true;
+            if (!startThread(&BackgroundTask::taskMain, this))
+                execute();
+        }
+        
+        bool BackgroundTask::finished() const {
+            m_state->mutex.lock();
+            const bool finished = m_state->finished;
+            m_state->mutex.unlock();
+            return finished;
+        }
+        
+        void BackgroundTask::wait() {
+            if (!m_state->started)
+                return;
+            m_state->mutex.lock();
+            while (!m_state->finished)
+                m_state->finishedCondition.wait(m_state->mutex);
+            m_state->mutex.unlock();
+        }
+        
+        bool BackgroundTask::failed() const {
+            return m_state->failed;
+        }
+        
+        const String& BackgroundTask::error() const {
+            return m_state->error;
+        }
+        
+        ThreadPool& ThreadPool::pool() {
+            // intentionally never destroyed, the workers live as long as the process does
+            static ThreadPool* pool = new ThreadPool();
+            return *pool;
+        }
+        
+        void ThreadPool::parallelFor(size_t count, ParallelTask& task, size_t minBatchSize) {
+            if (count == 0)
+                return;
+            
+            const size_t batchSize = std::max(std::max(minBatchSize, static_cast<size_t>(1)), count / (concurrency() * 4));
+            bool serial = m_threadCount == 0 || count < 2 * batchSize;
+            
+            State& state = *m_state;
+            if (!serial) {
+                state.mutex.lock();
+                if (state.busy) {
+                    serial = true;
+                } else {
+                    state.busy = true;
+                    state.task = &task;
+                    state.count = count;
+                    state.next = 0;
+                    state.done = 0;
+                    state.batchSize = batchSize;
+                    state.failed = false;
+                    state.error.clear();
+                    state.workAvailable.broadcast();
+                }
+                if (serial)
+                    state.mutex.unlock();
+            }
+            
+            if (serial) {
+                bool failed = false;
+                String error;
+                runBatch(task, 0, count, failed, error);
+                if (failed)
+                    throw MessageException(error);
+                return;
+            }
+            
+            work(true);
+            while (state.done < state.count)
+                state.workDone.wait(state.mutex);
+            
+            const bool failed = state.failed;
+            const String error = state.error;
+            state.task = NULL;
+            state.count = 0;
+            state.next = 0;
+            state.done = 0;
+            state.busy = false;
+            state.mutex.unlock();
+            
+            if (failed)
+                throw MessageException(error);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ThreadPool__
+#define __TrenchBroom__ThreadPool__
+
+#include "Utility/String.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class ParallelTask {
+        public:
+            virtual ~ParallelTask() {}
+            
+            /*
+             * Called concurrently for every index in [0, count). Implementations must only touch state that belongs to
+             * the given index, or synchronize access to shared state themselves.
+             */
+            virtual void run(size_t index) = 0;
+        };
+        
+        /*
+         * A fixed set of worker threads (one less than the number of processors, the calling thread does its share of
+         * the work, too) that executes parallel loops. The pool does not depend on wxWidgets so that the model code can
+         * use it, too.
+         */
+        class ThreadPool {
+        private:
+            struct State;
+            State* m_state;
+            size_t m_threadCount;
+            
+            ThreadPool();
+            ThreadPool(const ThreadPool& other);
+            ThreadPool& operator=(const ThreadPool& other);
+            
+            static void* workerMain(void* pool);
+            static void runBatch(ParallelTask& task, size_t begin, size_t end, bool& failed, String& error);
+            void work(bool caller);
+        public:
+            static ThreadPool& pool();
+            
+            /*
+             * The number of threads that execute a parallel loop, including the calling thread.
+             */
+            inline size_t concurrency() const {
+                return m_threadCount + 1;
+            }
+            
+            /*
+             * Runs the given task for every index in [0, count) and returns when all indices have been processed. Small
+             * loops (less than two batches) and loops that are started from within another parallel loop run serially
+             * on the calling thread. If the task throws, the remaining indices are still processed, and the message of
+             * the first exception is rethrown as a MessageException afterwards, regardless of whether the loop ran
+             * serially or not.
+             */
+            void parallelFor(size_t count, ParallelTask& task, size_t minBatchSize = 1);
+        };
+        
+        /*
+         * Is notified when a background task has finished. The notification is sent on the thread of the task, so
+         * implementations must not do more than hand it over to another thread, e.g. by posting an event.
+         */
+        class BackgroundTaskListener {
+        public:
+            virtual ~BackgroundTaskListener() {}
+            virtual void backgroundTaskFinished() = 0;
+        };
+        
+        /*
+         * A unit of work that runs on a thread of its own while the thread that started it does something else.
+         * Exceptions thrown by run() are caught and can be queried after the task has finished. Subclasses must call
+         * wait() in their destructor if the task may still be running at that point.
+         */
+        class BackgroundTask {
+        private:
+            struct State;
+            State* m_state;
+            
+            BackgroundTask(const BackgroundTask& other);
+            BackgroundTask& operator=(const BackgroundTask& other);
+            
+            static void* taskMain(void* task);
+            void execute();
+        protected:
+            virtual void run() = 0;
+        public:
+            BackgroundTask();
+            virtual ~BackgroundTask();
+            
+            /*
+             * Sets the listener that is notified when the task has finished. Must be called before the task is started.
+             */
+            void setListener(BackgroundTaskListener* listener);
+            
+            /*
+             * Starts the task. If no thread can be created, the task runs on the calling thread before this returns.
+             */
+            void start();
+            bool finished() const;
+            void wait();
+            
+            bool failed() const;
+            const String& error() const;
+        };
+        
+        template <typename T, class Function>
+        class ParallelForEachTask : public ParallelTask {
+        private:
+            const std::vector<T>& m_elements;
+            const Function& m_function;
+        public:
+            ParallelForEachTask(const std::vector<T>& elements, const Function& function) :
+            m_elements(elements),
+            m_function(function) {}
+            
+            void run(size_t index) {
+                m_function(m_elements[index]);
+            }
+        };
+        
+        /*
+         * Calls the const function object for every element of the given vector, see ThreadPool::parallelFor.
+         */
+        template <typename T, class Function>
+        inline void parallelForEach(const std::vector<T>& elements, const Function& function, size_t minBatchSize = 1) {
+            ParallelForEachTask<T, Function> task(elements, function);
+            ThreadPool::pool().parallelFor(elements.size(), task, minBatchSize);
+        }
+    }
+}
+
+#endif /* defined(__TrenchBroom__ThreadPool__) */
@@ -0,0 +1,232 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TrigramIndex_h
+#define TrenchBroom_TrigramIndex_h
+
+#include "Utility/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        /*
+         Finds the values whose strings contain a pattern, ignoring case. Every distinct string is folded to lower case
+         and stored once together with the values it was added for. The values of a string are kept in a map that
+         counts how often each value was added, so that strings which are shared by many values, such as common
+         property keys, can be updated in logarithmic time. For every trigram, i.e., every substring of three
+         characters, the index keeps the sorted ids of the strings that contain it. A pattern of at least three
+         characters is then only compared with the strings that contain all of its trigrams. Shorter patterns are
+         compared with every distinct string.
+         */
+        template <typename T>
+        class TrigramIndex {
+        public:
+            typedef std::vector<T> ValueList;
+        private:
+            typedef unsigned int Trigram;
+            typedef std::vector<Trigram> TrigramList;
+            typedef std::vector<size_t> IdList;
+            typedef std::map<Trigram, IdList> TrigramMap;
+            typedef std::map<String, size_t> IdMap;
+            typedef std::map<T, size_t> ValueCountMap;
+            
+            struct Entry {
+                String string;
+                ValueCountMap values;
+            };
+            
+            typedef std::vector<Entry> EntryList;
+            
+            struct CompareSize {
+                inline bool operator()(const IdList* left, const IdList* right) const {
+                    return left->size() < right->size();
+                }
+            };
+            
+            EntryList m_entries;
+            IdList m_freeIds;
+            IdMap m_ids;
+            TrigramMap m_trigrams;
+            
+            static void trigrams(const String& string, TrigramList& result) {
+                for (size_t i = 0; i + 2 < string.size(); i++) {
+                    const Trigram trigram = (static_cast<Trigram>(static_cast<unsigned char>(string[i])) << 16) |
+                                            (static_cast<Trigram>(static_cast<unsigned char>(string[i + 1])) << 8) |
+                                             static_cast<Trigram>(static_cast<unsigned char>(string[i + 2]));
+                    result.push_back(trigram);
+                }
+                std::sort(result.begin(), result.end());
+                result.erase(std::unique(result.begin(), result.end()), result.end());
+            }
+            
+            void addTrigrams(const size_t id, const String& string) {
+                TrigramList trigrams;
+                this->trigrams(string, trigrams);
+                
+                TrigramList::const_iterator it, end;
+                for (it = trigrams.begin(), end = trigrams.end(); it != end; ++it) {
+                    IdList& ids = m_trigrams[*it];
+                    ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+                }
+            }
+            
+            void removeTrigrams(const size_t id, const String& string) {
+                TrigramList trigrams;
+                this->trigrams(string, trigrams);
+                
+                TrigramList::const_iterator it, end;
+                for (it = trigrams.begin(), end = trigrams.end(); it != end; ++it) {
+                    typename TrigramMap::iterator trigramIt = m_trigrams.find(*it);
+                    assert(trigramIt != m_trigrams.end());
+                    IdList& ids = trigramIt->second;
+                    IdList::iterator idIt = std::lower_bound(ids.begin(), ids.end(), id);
+                    assert(idIt != ids.end() && *idIt == id);
+                    ids.erase(idIt);
+                    if (ids.empty())
+                        m_trigrams.erase(trigramIt);
+                }
+            }
+            
+            inline void appendValues(const Entry& entry, const String& pattern, ValueList& result) const {
+                if (!entry.values.empty() && entry.string.find(pattern) != String::npos) {
+                    typename ValueCountMap::const_iterator it, end;
+                    for (it = entry.values.begin(), end = entry.values.end(); it != end; ++it)
+                        result.push_back(it->first);
+                }
+            }
+        public:
+            /*
+             Adds the given value for the given string. A value can be added for many strings, and it can be added for
+             the same string more than once, in which case it must be removed as often.
+             */
+            void insert(const String& string, T value) {
+                const String folded = toLower(string);
+                typename IdMap::iterator it = m_ids.lower_bound(folded);
+                if (it == m_ids.end() || it->first != folded) {
+                    size_t id;
+                    if (!m_freeIds.empty()) {
+                        id = m_freeIds.back();
+                        m_freeIds.pop_back();
+                    } else {
+                        id = m_entries.size();
+                        m_entries.push_back(Entry());
+                    }
+                    
+                    m_entries[id].string = folded;
+                    addTrigrams(id, folded);
+                    it = m_ids.insert(it, typename IdMap::value_type(folded, id));
+                }
+                
+                m_entries[it->second].values[value]++;
+            }
+            
+            void remove(const String& string, T value) {
+                const String folded = toLower(string);
+                typename IdMap::iterator it = m_ids.find(folded);
+                if (it == m_ids.end())
+                    return;
+                
+                const size_t id = it->second;
+                ValueCountMap& values = m_entries[id].values;
+                typename ValueCountMap::iterator valueIt = values.find(value);
+                if (valueIt == values.end())
+                    return;
+                
+                if (--valueIt->second == 0)
+                    values.erase(valueIt);
+                
+                if (values.empty()) {
+                    removeTrigrams(id, folded);
+                    m_entries[id].string.clear();
+                    m_freeIds.push_back(id);
+                    m_ids.erase(it);
+                }
+            }
+            
+            void clear() {
+                m_entries.clear();
+                m_freeIds.clear();
+                m_ids.clear();
+                m_trigrams.clear();
+            }
+            
+            /*
+             Returns the number of distinct strings in this index.
+             */
+            inline size_t size() const {
+                return m_ids.size();
+            }
+            
+            inline bool empty() const {
+                return m_ids.empty();
+            }
+            
+            /*
+             Appends the values of all strings that contain the given pattern, ignoring case, to the given list. The
+             appended values are sorted and a value that was added for several matching strings is appended only once.
+             */
+            void find(const String& pattern, ValueList& result) const {
+                const String folded = toLower(pattern);
+                const size_t first = result.size();
+                
+                if (folded.size() < 3) {
+                    typename EntryList::const_iterator it, end;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+                        appendValues(*it, folded, result);
+                } else {
+                    TrigramList trigrams;
+                    this->trigrams(folded, trigrams);
+                    
+                    std::vector<const IdList*> idLists;
+                    TrigramList::const_iterator it, end;
+                    for (it = trigrams.begin(), end = trigrams.end(); it != end; ++it) {
+                        typename TrigramMap::const_iterator trigramIt = m_trigrams.find(*it);
+                        if (trigramIt == m_trigrams.end())
+                            return;
+                        idLists.push_back(&trigramIt->second);
+                    }
+                    
+                    // intersecting the shortest lists first keeps the intermediate results small
+                    std::sort(idLists.begin(), idLists.end(), CompareSize());
+                    IdList candidates = *idLists.front();
+                    for (size_t i = 1; i < idLists.size() && !candidates.empty(); i++) {
+                        IdList intersection;
+                        std::set_intersection(candidates.begin(), candidates.end(), idLists[i]->begin(), idLists[i]->end(), std::back_inserter(intersection));
+                        candidates.swap(intersection);
+                    }
+                    
+                    // the trigrams may occur in a different order in the candidates
+                    IdList::const_iterator idIt, idEnd;
+                    for (idIt = candidates.begin(), idEnd = candidates.end(); idIt != idEnd; ++idIt)
+                        appendValues(m_entries[*idIt], folded, result);
+                }
+                
+                std::sort(result.begin() + static_cast<typename ValueList::difference_type>(first), result.end());
+                result.erase(std::unique(result.begin() + static_cast<typename ValueList::difference_type>(first), result.end()), result.end());
+            }
+        };
+    }
+}
+
+#endif
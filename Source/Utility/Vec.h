@@ -20,8 +20,8 @@
 #ifndef TrenchBroom_Vec_h
 #define TrenchBroom_Vec_h
 
-#include "Utility/Allocator.h"
 #include "Utility/Math.h"
+#include "Utility/SIMD.h"
 #include "Utility/String.h"
 
 #include <algorithm>
@@ -36,7 +36,7 @@
 namespace TrenchBroom {
     namespace VecMath {
         template <typename T, size_t S>
-        class Vec : public Utility::Allocator<Vec<T,S> > {
+        class Vec {
         private:
             class SelectionHeapCmp {
             private:
@@ -549,6 +549,68 @@ namespace TrenchBroom {
         typedef Vec<double,3> Vec3d;
         typedef Vec<double,4> Vec4d;
                     
+#if defined(TB_SIMD)
+        // four component float vectors fit exactly into one SIMD register
+        template <>
+        inline const Vec<float,4> Vec<float,4>::operator- () const {
+            Vec<float,4> result;
+            SIMD::store(result.v, SIMD::negate(SIMD::load(v)));
+            return result;
+        }
+        
+        template <>
+        inline const Vec<float,4> Vec<float,4>::operator+ (const Vec<float,4>& right) const {
+            Vec<float,4> result;
+            SIMD::store(result.v, SIMD::add(SIMD::load(v), SIMD::load(right.v)));
+            return result;
+        }
+        
+        template <>
+        inline const Vec<float,4> Vec<float,4>::operator- (const Vec<float,4>& right) const {
+            Vec<float,4> result;
+            SIMD::store(result.v, SIMD::sub(SIMD::load(v), SIMD::load(right.v)));
+            return result;
+        }
+        
+        template <>
+        inline const Vec<float,4> Vec<float,4>::operator* (const float right) const {
+            Vec<float,4> result;
+            SIMD::store(result.v, SIMD::mul(SIMD::load(v), SIMD::splat(right)));
+            return result;
+        }
+        
+        template <>
+        inline const Vec<float,4> Vec<float,4>::operator/ (const float right) const {
+            Vec<float,4> result;
+            SIMD::store(result.v, SIMD::div(SIMD::load(v), SIMD::splat(right)));
+            return result;
+        }
+        
+        template <>
+        inline Vec<float,4>& Vec<float,4>::operator+= (const Vec<float,4>& right) {
+            SIMD::store(v, SIMD::add(SIMD::load(v), SIMD::load(right.v)));
+            return *this;
+        }
+        
+        template <>
+        inline Vec<float,4>& Vec<float,4>::operator-= (const Vec<float,4>& right) {
+            SIMD::store(v, SIMD::sub(SIMD::load(v), SIMD::load(right.v)));
+            return *this;
+        }
+        
+        template <>
+        inline Vec<float,4>& Vec<float,4>::operator*= (const float right) {
+            SIMD::store(v, SIMD::mul(SIMD::load(v), SIMD::splat(right)));
+            return *this;
+        }
+        
+        template <>
+        inline Vec<float,4>& Vec<float,4>::operator/= (const float right) {
+            SIMD::store(v, SIMD::div(SIMD::load(v), SIMD::splat(right)));
+            return *this;
+        }
+#endif
+        
         template <typename T, size_t S>
         inline Vec<T,S> operator*(const T left, const Vec<T,S>& right) {
             return Vec<T,S>(right) * left;
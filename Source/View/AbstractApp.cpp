@@ -22,6 +22,7 @@
 #include <wx/aboutdlg.h>
 #include <wx/config.h>
 #include <wx/docview.h>
+#include <wx/filedlg.h>
 #include <wx/generic/helpext.h>
 #include <wx/fs_mem.h>
 
@@ -31,6 +32,7 @@
 #include "Model/Bsp.h"
 #include "Model/MapDocument.h"
 #include "Utility/DocManager.h"
+#include "Utility/Profiler.h"
 #include "View/AboutDialog.h"
 #include "View/CommandIds.h"
 #include "View/EditorFrame.h"
@@ -38,6 +40,8 @@
 #include "View/KeyboardShortcut.h"
 #include "View/PreferencesFrame.h"
 
+#include <fstream>
+
 BEGIN_EVENT_TABLE(AbstractApp, wxApp)
 EVT_MENU(wxID_NEW, AbstractApp::OnFileNew)
 EVT_MENU(wxID_OPEN, AbstractApp::OnFileOpen)
@@ -47,6 +51,7 @@ EVT_MENU(wxID_CLOSE, AbstractApp::OnFileClose)
 EVT_MENU(wxID_PREFERENCES, AbstractApp::OnOpenPreferences)
 EVT_MENU(wxID_ABOUT, AbstractApp::OnOpenAbout)
 EVT_MENU(TrenchBroom::View::CommandIds::Menu::HelpShowHelp, AbstractApp::OnHelpShowHelp)
+EVT_MENU(TrenchBroom::View::CommandIds::Menu::HelpExportProfile, AbstractApp::OnHelpExportProfile)
 
 EVT_UPDATE_UI(wxID_NEW, AbstractApp::OnUpdateMenuItem)
 EVT_UPDATE_UI(wxID_OPEN, AbstractApp::OnUpdateMenuItem)
@@ -169,6 +174,8 @@ wxMenu* AbstractApp::CreateHelpMenu(const TrenchBroom::Preferences::MultiMenuSel
 
     wxMenu* helpMenu = new wxMenu();
     helpMenu->Append(HelpShowHelp, wxT("TrenchBroom Help"));
+    helpMenu->AppendSeparator();
+    helpMenu->Append(HelpExportProfile, wxT("Export Profile..."));
     helpMenu->SetEventHandler(eventHandler);
     return helpMenu;
 }
@@ -247,6 +254,9 @@ bool AbstractApp::OnInit() {
     m_helpController = new wxExtHelpController();
     m_helpController->Initialize(helpPath);
 
+    TrenchBroom::Preferences::PreferenceManager& prefs = TrenchBroom::Preferences::PreferenceManager::preferences();
+    TrenchBroom::Utility::Profiler::instance().setEnabled(prefs.getInt(TrenchBroom::Preferences::ProfilerMode) != TrenchBroom::Preferences::ProfilerModeOff);
+
     return true;
 }
 
@@ -318,10 +328,25 @@ void AbstractApp::OnHelpShowHelp(wxCommandEvent& event) {
     m_helpController->DisplaySection(01);
 }
 
+void AbstractApp::OnHelpExportProfile(wxCommandEvent& event) {
+    wxFileDialog saveDialog(NULL, wxT("Export Profile"), wxEmptyString, wxT("TrenchBroom.trace.json"), wxT("*.json"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (saveDialog.ShowModal() != wxID_OK)
+        return;
+
+    std::ofstream stream(saveDialog.GetPath().ToStdString().c_str());
+    if (!stream.is_open()) {
+        wxLogError(wxT("Unable to write profile to %s"), saveDialog.GetPath());
+        return;
+    }
+    TrenchBroom::Utility::Profiler::instance().writeChromeTrace(stream);
+}
+
 void AbstractApp::OnUpdateMenuItem(wxUpdateUIEvent& event) {
     if (event.GetId() == wxID_ABOUT ||
         event.GetId() == TrenchBroom::View::CommandIds::Menu::HelpShowHelp)
         event.Enable(true);
+    else if (event.GetId() == TrenchBroom::View::CommandIds::Menu::HelpExportProfile)
+        event.Enable(TrenchBroom::Utility::Profiler::instance().enabled());
     else if (event.GetId() == wxID_PREFERENCES ||
              event.GetId() == wxID_NEW ||
              event.GetId() == wxID_OPEN ||
@@ -90,6 +90,7 @@ public:
     virtual void OnFileSaveAs(wxCommandEvent& event);
     virtual void OnFileClose(wxCommandEvent& event);
     virtual void OnHelpShowHelp(wxCommandEvent& event);
+    virtual void OnHelpExportProfile(wxCommandEvent& event);
 
     void OnUpdateMenuItem(wxUpdateUIEvent& event);
     
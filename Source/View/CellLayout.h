@@ -88,7 +88,7 @@ namespace TrenchBroom {
             }
 
             inline bool intersectsY(float y, float height) const {
-                return bottom() >= y || top() <= y + height;
+                return bottom() >= y && top() <= y + height;
             }
         };
 
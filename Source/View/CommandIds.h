@@ -126,6 +126,11 @@ namespace TrenchBroom {
                 static const int EditFaceActions                    = Lowest + 100;
                 static const int EditPrintFilePositions             = Lowest + 101;
                 static const int EditToggleAxisRestriction          = Lowest + 102;
+                static const int EditSubtractBrushes                = Lowest + 103;
+                static const int EditMergeBrushes                   = Lowest + 104;
+                static const int EditHollowBrushes                  = Lowest + 105;
+                static const int HelpExportProfile                  = Lowest + 106;
+                static const int EditSelectInside                   = Lowest + 107;
                 static const int Highest                            = Lowest + 199;
             }
             
@@ -175,6 +180,7 @@ namespace TrenchBroom {
                 static const int EnableAltMoveCheckBoxId            = Lowest +  13;
                 static const int MoveCameraInCursorDirCheckBoxId    = Lowest +  14;
                 static const int TextureBrowserIconSideChoiceId     = Lowest +  15;
+                static const int ProfilerModeChoiceId               = Lowest +  16;
                 static const int Highest                            = Lowest +  99;
             }
 
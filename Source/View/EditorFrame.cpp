@@ -27,10 +27,14 @@
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/MapDocument.h"
+#include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/MapRenderer.h"
+#include "Renderer/SharedResources.h"
 #include "Utility/Console.h"
 #include "Utility/List.h"
 #include "View/CommandIds.h"
 #include "View/EditorView.h"
+#include "View/EntityInspector.h"
 #include "View/Inspector.h"
 #include "View/MapGLCanvas.h"
 #include "View/NavBar.h"
@@ -54,15 +58,26 @@
 namespace TrenchBroom {
     namespace View {
         const wxEventType EditorFrame::EVT_SET_FOCUS = wxNewEventType();
+        const wxEventType EditorFrame::EVT_ASYNC_PICK_FINISHED = wxNewEventType();
 
         IMPLEMENT_DYNAMIC_CLASS(EditorFrame, wxFrame)
 
         BEGIN_EVENT_TABLE(EditorFrame, wxFrame)
 		EVT_CLOSE(EditorFrame::OnClose)
         EVT_COMMAND(wxID_ANY, EVT_SET_FOCUS, EditorFrame::OnChangeFocus)
+        EVT_COMMAND(wxID_ANY, EVT_ASYNC_PICK_FINISHED, EditorFrame::OnAsyncPickFinished)
+        EVT_TIMER(wxID_ANY, EditorFrame::OnPendingModelsTimer)
         EVT_IDLE(EditorFrame::OnIdle)
 		END_EVENT_TABLE()
 
+        EditorFrame::AsyncPickListener::AsyncPickListener(wxEvtHandler& handler) :
+        m_handler(handler) {}
+
+        void EditorFrame::AsyncPickListener::backgroundTaskFinished() {
+            // QueueEvent is safe to call from other threads
+            m_handler.QueueEvent(new wxCommandEvent(EVT_ASYNC_PICK_FINISHED));
+        }
+
         EditorFrame::MenuSelector::MenuSelector(DocumentViewHolder& documentViewHolder) :
         m_documentViewHolder(documentViewHolder) {}
 
@@ -151,7 +166,9 @@ namespace TrenchBroom {
         m_navBar(NULL),
         m_mapCanvas(NULL),
         m_logView(NULL),
-        m_focusMapCanvasOnIdle(2) {}
+        m_focusMapCanvasOnIdle(2),
+        m_asyncPickListener(*this),
+        m_pendingModelsTimer(this) {}
 
         EditorFrame::EditorFrame(Model::MapDocument& document, EditorView& view) :
         wxFrame(NULL, wxID_ANY, wxT("")),
@@ -161,7 +178,9 @@ namespace TrenchBroom {
         m_navBar(NULL),
         m_mapCanvas(NULL),
         m_logView(NULL),
-        m_focusMapCanvasOnIdle(2) {
+        m_focusMapCanvasOnIdle(2),
+        m_asyncPickListener(*this),
+        m_pendingModelsTimer(this) {
             Create(document, view);
         }
 
@@ -192,6 +211,8 @@ namespace TrenchBroom {
                 Center();
             }
             Raise();
+            
+            document.picker().setListener(&m_asyncPickListener);
         }
 
         void EditorFrame::update(const Controller::Command& command) {
@@ -255,6 +276,9 @@ namespace TrenchBroom {
             TrenchBroomApp* app = static_cast<TrenchBroomApp*>(wxTheApp);
             app->DetachFileHistoryMenu(oldMenuBar);
 
+            if (m_documentViewHolder.valid())
+                m_documentViewHolder.document().picker().setListener(NULL);
+            m_pendingModelsTimer.Stop();
             m_documentViewHolder.invalidate();
         }
 
@@ -266,6 +290,29 @@ namespace TrenchBroom {
             }
         }
 
+        void EditorFrame::OnAsyncPickFinished(wxCommandEvent& event) {
+            // the hits under the mouse are picked in the background while the mouse moves
+            if (m_documentViewHolder.valid())
+                m_documentViewHolder.view().inputController().updateAsyncPick();
+        }
+
+        void EditorFrame::OnPendingModelsTimer(wxTimerEvent& event) {
+            if (!m_documentViewHolder.valid()) {
+                m_pendingModelsTimer.Stop();
+                return;
+            }
+            
+            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+            if (modelRendererManager.updatePendingModels()) {
+                m_documentViewHolder.view().renderer().invalidateEntityModelRendererCache();
+                m_mapCanvas->requestRedraw();
+                if (!modelRendererManager.pendingModels())
+                    m_inspector->entityInspector().updateEntityBrowser();
+            }
+            if (!modelRendererManager.pendingModels())
+                m_pendingModelsTimer.Stop();
+        }
+
         void EditorFrame::OnIdle(wxIdleEvent& event) {
             if (m_focusMapCanvasOnIdle > 0) {
                 m_mapCanvas->SetFocus();
@@ -275,6 +322,13 @@ namespace TrenchBroom {
                 m_focusMapCanvasOnIdle--;
             }
 
+            // entity models are loaded in the background, the timer checks for them until all of them have arrived
+            if (m_documentViewHolder.valid() && !m_pendingModelsTimer.IsRunning()) {
+                const Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+                if (modelRendererManager.pendingModels())
+                    m_pendingModelsTimer.Start(20);
+            }
+
             // FIXME: Workaround for a bug in Ubuntu GTK where menus are not updated
             // This will be fixed in wxWidgets 2.9.5: http://trac.wxwidgets.org/ticket/14302
             // Unfortunately right now this leads to a crash after the "Navigate Up" item is invoked.
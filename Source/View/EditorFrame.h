@@ -21,8 +21,10 @@
 #define __TrenchBroom__EditorFrame__
 
 #include <wx/frame.h>
+#include <wx/timer.h>
 
 #include "Utility/Preferences.h"
+#include "Utility/ThreadPool.h"
 #include "View/DocumentViewHolder.h"
 
 class wxDocManager;
@@ -52,9 +54,21 @@ namespace TrenchBroom {
         class EditorFrame : public wxFrame {
         public:
             static const wxEventType EVT_SET_FOCUS;
+            static const wxEventType EVT_ASYNC_PICK_FINISHED;
         private:
             DECLARE_DYNAMIC_CLASS(EditorFrame)
         protected:
+            /*
+             * Posts an EVT_ASYNC_PICK_FINISHED event to the frame from the picking thread.
+             */
+            class AsyncPickListener : public Utility::BackgroundTaskListener {
+            private:
+                wxEvtHandler& m_handler;
+            public:
+                AsyncPickListener(wxEvtHandler& handler);
+                void backgroundTaskFinished();
+            };
+
             class MenuSelector : public Preferences::MultiMenuSelector {
             private:
                 DocumentViewHolder& m_documentViewHolder;
@@ -70,6 +84,8 @@ namespace TrenchBroom {
             MapGLCanvas* m_mapCanvas;
             wxTextCtrl* m_logView;
             unsigned int m_focusMapCanvasOnIdle;
+            AsyncPickListener m_asyncPickListener;
+            wxTimer m_pendingModelsTimer;
 
             void CreateGui();
         public:
@@ -96,6 +112,8 @@ namespace TrenchBroom {
             void disableProcessing();
 
             void OnChangeFocus(wxCommandEvent& event);
+            void OnAsyncPickFinished(wxCommandEvent& event);
+            void OnPendingModelsTimer(wxTimerEvent& event);
             void OnIdle(wxIdleEvent& event);
             void OnClose(wxCloseEvent& event);
 
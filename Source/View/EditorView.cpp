@@ -45,10 +45,12 @@
 #include "Model/EntityDefinitionManager.h"
 #include "Model/Face.h"
 #include "Model/Filter.h"
+#include "Model/LineIndex.h"
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
 #include "Model/MapObject.h"
 #include "Model/PointFile.h"
+#include "Model/RegionQuery.h"
 #include "Model/TextureManager.h"
 #include "Renderer/Camera.h"
 #include "Renderer/EntityModelRendererManager.h"
@@ -74,6 +76,7 @@
 
 #include <wx/clipbrd.h>
 #include <wx/dataobj.h>
+#include <wx/textctrl.h>
 #include <wx/tokenzr.h>
 
 namespace TrenchBroom {
@@ -104,6 +107,7 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::EditSelectAll, EditorView::OnEditSelectAll)
         EVT_MENU(CommandIds::Menu::EditSelectSiblings, EditorView::OnEditSelectSiblings)
         EVT_MENU(CommandIds::Menu::EditSelectTouching, EditorView::OnEditSelectTouching)
+        EVT_MENU(CommandIds::Menu::EditSelectInside, EditorView::OnEditSelectInside)
         EVT_MENU(CommandIds::Menu::EditSelectByFilePosition, EditorView::OnEditSelectByFilePosition)
         EVT_MENU(CommandIds::Menu::EditSelectNone, EditorView::OnEditSelectNone)
 
@@ -162,6 +166,10 @@ namespace TrenchBroom {
 
         EVT_MENU(CommandIds::Menu::EditToggleAxisRestriction, EditorView::OnEditToggleAxisRestriction)
 
+        EVT_MENU(CommandIds::Menu::EditSubtractBrushes, EditorView::OnEditSubtractBrushes)
+        EVT_MENU(CommandIds::Menu::EditMergeBrushes, EditorView::OnEditMergeBrushes)
+        EVT_MENU(CommandIds::Menu::EditHollowBrushes, EditorView::OnEditHollowBrushes)
+
         EVT_MENU(CommandIds::Menu::EditPrintFilePositions, EditorView::OnEditPrintFilePositions)
 
         EVT_MENU(CommandIds::Menu::EditMoveVerticesForward, EditorView::OnEditMoveVerticesForward)
@@ -692,7 +700,7 @@ namespace TrenchBroom {
             }
 
             EditorFrame* frame = static_cast<EditorFrame*>(GetFrame());
-            frame->mapCanvas().Refresh();
+            frame->mapCanvas().requestRedraw();
         }
 
         void EditorView::OnChangeFilename() {
@@ -1018,7 +1026,7 @@ namespace TrenchBroom {
             }
         }
 
-        void EditorView::OnEditSelectTouching(wxCommandEvent& event) {
+        void EditorView::selectRegion(bool inside) {
             Model::EditStateManager& editStateManager = mapDocument().editStateManager();
             assert(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes &&
                    editStateManager.selectedBrushes().size() == 1);
@@ -1027,22 +1035,11 @@ namespace TrenchBroom {
             Model::EntityList selectEntities;
             Model::BrushList selectBrushes;
 
-            const Model::EntityList& allEntities = mapDocument().map().entities();
-            Model::EntityList::const_iterator entityIt, entityEnd;
-            for (entityIt = allEntities.begin(), entityEnd = allEntities.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& entity = **entityIt;
-                const Model::BrushList& entityBrushes = entity.brushes();
-                if (!entityBrushes.empty()) {
-                    Model::BrushList::const_iterator brushIt, brushEnd;
-                    for (brushIt = entityBrushes.begin(), brushEnd = entityBrushes.end(); brushIt != brushEnd; ++brushIt) {
-                        Model::Brush* brush = *brushIt;
-                        if (brush != selectionBrush && selectionBrush->intersectsBrush(*brush) && m_filter->brushSelectable(*brush))
-                            selectBrushes.push_back(brush);
-                    }
-                } else if (selectionBrush->intersectsEntity(entity) && m_filter->entitySelectable(entity)) {
-                    selectEntities.push_back(&entity);
-                }
-            }
+            Model::RegionQuery query(mapDocument().octree(), *m_filter);
+            if (inside)
+                query.inside(*selectionBrush, selectEntities, selectBrushes);
+            else
+                query.touching(*selectionBrush, selectEntities, selectBrushes);
 
             Controller::ChangeEditStateCommand* select;
             if (!selectEntities.empty() || !selectBrushes.empty()) {
@@ -1053,51 +1050,47 @@ namespace TrenchBroom {
 
             Controller::RemoveObjectsCommand* remove = Controller::RemoveObjectsCommand::removeBrush(mapDocument(), *selectionBrush);
 
-            CommandProcessor::BeginGroup(mapDocument().GetCommandProcessor(), wxT("Select Touching"));
+            CommandProcessor::BeginGroup(mapDocument().GetCommandProcessor(), inside ? wxT("Select Inside") : wxT("Select Touching"));
             submit(select);
             submit(remove);
             CommandProcessor::EndGroup(mapDocument().GetCommandProcessor());
         }
 
+        void EditorView::OnEditSelectTouching(wxCommandEvent& event) {
+            selectRegion(false);
+        }
+
+        void EditorView::OnEditSelectInside(wxCommandEvent& event) {
+            selectRegion(true);
+        }
+
         void EditorView::OnEditSelectByFilePosition(wxCommandEvent& event) {
             wxString string = wxGetTextFromUser(wxT("Enter a comma- or space separated list of line numbers."), wxT("Select by Line Numbers"), wxT(""), GetFrame());
             if (string.empty())
                 return;
 
-            const Model::EntityList& entities = mapDocument().map().entities();
-            Model::EntitySet selectEntities;
-            Model::BrushSet selectBrushes;
-
+            std::vector<size_t> lines;
             wxStringTokenizer tokenizer(string, ", ");
             while (tokenizer.HasMoreTokens()) {
                 wxString token = tokenizer.NextToken();
                 unsigned long position;
-                if (token.ToULong(&position)) {
-                    Model::Entity* selectEntity = NULL;
-                    Model::Brush* selectBrush = NULL;
-
-                    Model::EntityList::const_iterator entityIt, entityEnd;
-                    for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd && selectEntity == NULL; ++entityIt) {
-                        Model::Entity& entity = **entityIt;
-                        if (entity.occupiesFileLine(position)) {
-                            if (entity.brushes().empty())
-                                selectEntity = &entity;
-
-                            const Model::BrushList& brushes = entity.brushes();
-                            Model::BrushList::const_iterator brushIt, brushEnd;
-                            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd && selectBrush == NULL; ++brushIt) {
-                                Model::Brush& brush = **brushIt;
-                                if (brush.occupiesFileLine(position))
-                                    selectBrush = &brush;
-                            }
-                        }
-                    }
+                if (token.ToULong(&position))
+                    lines.push_back(static_cast<size_t>(position));
+            }
 
-                    if (selectBrush != NULL)
-                        selectBrushes.insert(selectBrush);
-                    else if (selectEntity != NULL)
-                        selectEntities.insert(selectEntity);
-                }
+            Model::LineIndex::HitList hits;
+            mapDocument().map().lineIndex().find(lines, hits);
+
+            Model::EntitySet selectEntities;
+            Model::BrushSet selectBrushes;
+
+            Model::LineIndex::HitList::const_iterator it, end;
+            for (it = hits.begin(), end = hits.end(); it != end; ++it) {
+                const Model::LineIndex::Hit& hit = *it;
+                if (hit.brush != NULL)
+                    selectBrushes.insert(hit.brush);
+                else if (hit.entity != NULL && hit.entity->brushes().empty())
+                    selectEntities.insert(hit.entity);
             }
 
             if (!selectEntities.empty() || !selectBrushes.empty()) {
@@ -1457,6 +1450,21 @@ namespace TrenchBroom {
             inputController().toggleAxisRestriction();
         }
 
+        void EditorView::OnEditSubtractBrushes(wxCommandEvent& event) {
+            if (!Controller::subtractBrushes(mapDocument()))
+                mapDocument().console().info("The selected brushes do not intersect any other brushes");
+        }
+
+        void EditorView::OnEditMergeBrushes(wxCommandEvent& event) {
+            if (!Controller::mergeBrushes(mapDocument()))
+                mapDocument().console().info("The selected brushes cannot be merged into convex brushes");
+        }
+
+        void EditorView::OnEditHollowBrushes(wxCommandEvent& event) {
+            if (!Controller::hollowBrushes(mapDocument()))
+                mapDocument().console().info("The selected brushes are too thin to be hollowed with the current grid size");
+        }
+
         void EditorView::OnEditPrintFilePositions(wxCommandEvent& event) {
             Model::EditStateManager& editStateManager = mapDocument().editStateManager();
             const Model::EntityList entities = editStateManager.allSelectedEntities();
@@ -1757,6 +1765,7 @@ namespace TrenchBroom {
                     event.Enable(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes);
                     break;
                 case CommandIds::Menu::EditSelectTouching:
+                case CommandIds::Menu::EditSelectInside:
                     event.Enable(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes &&
                                  editStateManager.selectedBrushes().size() == 1);
                     break;
@@ -1874,6 +1883,13 @@ namespace TrenchBroom {
                 case CommandIds::Menu::EditCorrectVertices:
                     event.Enable(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes);
                     break;
+                case CommandIds::Menu::EditSubtractBrushes:
+                case CommandIds::Menu::EditHollowBrushes:
+                    event.Enable(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes);
+                    break;
+                case CommandIds::Menu::EditMergeBrushes:
+                    event.Enable(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes && editStateManager.selectedBrushes().size() > 1);
+                    break;
                 case CommandIds::Menu::EditToggleAxisRestriction:
                     event.Enable(true);
                     break;
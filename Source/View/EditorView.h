@@ -88,6 +88,7 @@ namespace TrenchBroom {
             void flipObjects(bool horizontally);
             void moveVertices(Direction direction, bool snapToGrid);
             void removeObjects(const wxString& actionName);
+            void selectRegion(bool inside);
             
             Vec3f centerCameraOnObjectsPosition(const Model::EntityList& entities, const Model::BrushList& brushes);
         public:
@@ -140,6 +141,7 @@ namespace TrenchBroom {
             void OnEditSelectAll(wxCommandEvent& event);
             void OnEditSelectSiblings(wxCommandEvent& event);
             void OnEditSelectTouching(wxCommandEvent& event);
+            void OnEditSelectInside(wxCommandEvent& event);
             void OnEditSelectByFilePosition(wxCommandEvent& event);
             void OnEditSelectNone(wxCommandEvent& event);
             
@@ -197,6 +199,9 @@ namespace TrenchBroom {
 
             void OnEditSnapVertices(wxCommandEvent& event);
             void OnEditToggleAxisRestriction(wxCommandEvent& event);
+            void OnEditSubtractBrushes(wxCommandEvent& event);
+            void OnEditMergeBrushes(wxCommandEvent& event);
+            void OnEditHollowBrushes(wxCommandEvent& event);
             
             void OnEditPrintFilePositions(wxCommandEvent& event);
 
@@ -20,12 +20,15 @@
 #include "EntityBrowserCanvas.h"
 
 #include "IO/FileManager.h"
+#include "IO/IOUtils.h"
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/Palette.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/SharedResources.h"
+#include "Renderer/TextureRenderer.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/Shader.h"
@@ -33,15 +36,39 @@
 #include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/Text/FontManager.h"
 #include "Renderer/Text/TexturedFont.h"
+#include "Utility/Map.h"
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 namespace TrenchBroom {
     namespace View {
-        void EntityBrowserCanvas::addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Renderer::Text::FontDescriptor& font) {
-            if ((!m_hideUnused || definition->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(definition->name(), m_filterText, false))) {
+        String EntityBrowserCanvas::thumbnailDirectory() {
+            IO::FileManager fileManager;
+            const String cacheDirectory = fileManager.cacheDirectory();
+            if (cacheDirectory.empty())
+                return "";
+
+            const String directory = fileManager.appendPathComponent(cacheDirectory, "Thumbnails");
+            if (!fileManager.exists(directory)) {
+                if (!fileManager.exists(cacheDirectory)) {
+                    const String parentDirectory = fileManager.deleteLastPathComponent(cacheDirectory);
+                    if (!fileManager.exists(parentDirectory))
+                        fileManager.makeDirectory(parentDirectory);
+                    if (!fileManager.makeDirectory(cacheDirectory))
+                        return "";
+                }
+                if (!fileManager.makeDirectory(directory))
+                    return "";
+            }
+            return directory;
+        }
+
+        void EntityBrowserCanvas::addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Model::EntityDefinitionList& matches, const Renderer::Text::FontDescriptor& font) {
+            if ((!m_hideUnused || definition->usageCount() > 0) && (m_filterText.empty() || std::binary_search(matches.begin(), matches.end(), definition))) {
                 Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
                 const float maxCellWidth = layout.maxCellWidth();
                 const Renderer::Text::FontDescriptor actualFont = fontManager.selectFontSize(font, definition->name(), maxCellWidth, 5);
@@ -104,6 +131,80 @@ namespace TrenchBroom {
             renderer.render(entityModelProgram);
         }
 
+        void EntityBrowserCanvas::renderOffscreen(const Layout::Group::Row::Cell& cell, unsigned int width, unsigned int height, const Mat4f& projection, float brightness) {
+            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+
+            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
+            Renderer::ShaderProgram& boundsProgram = shaderManager.shaderProgram(Renderer::Shaders::EdgeShader);
+            Renderer::ShaderProgram& entityModelProgram = shaderManager.shaderProgram(Renderer::Shaders::EntityModelShader);
+
+            m_offscreenRenderer.setDimensions(width, height);
+            m_offscreenRenderer.preRender(); // Scampie's Vista machine crashes here
+
+            const Mat4f view = viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f));
+            Renderer::Transformation transformation(projection, view);
+
+            glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glEnable(GL_DEPTH_TEST);
+
+            Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
+            if (modelRenderer == NULL) {
+                boundsProgram.activate();
+                Model::PointEntityDefinition* definition = cell.item().entityDefinition;
+                renderEntityBounds(transformation, boundsProgram, *definition, cell.item().bounds, Vec3f::Null, cell.scale());
+                boundsProgram.deactivate();
+            } else {
+                modelRendererManager.activate();
+                entityModelProgram.activate();
+                entityModelProgram.setUniformVariable("ApplyTinting", false);
+                entityModelProgram.setUniformVariable("Brightness", brightness);
+                renderEntityModel(transformation, entityModelProgram, *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
+                entityModelProgram.deactivate();
+                modelRendererManager.deactivate();
+            }
+        }
+
+        Renderer::TextureRenderer* EntityBrowserCanvas::thumbnail(const Layout::Group::Row::Cell& cell) {
+            const Model::ModelDefinition* modelDefinition = cell.item().entityDefinition->model();
+            assert(modelDefinition != NULL);
+
+            const LayoutBounds& bounds = cell.itemBounds();
+            const unsigned int width = std::max(static_cast<unsigned int>(bounds.width()), 1u);
+            const unsigned int height = std::max(static_cast<unsigned int>(bounds.height()), 1u);
+
+            const StringList& searchPaths = m_documentViewHolder.document().searchPaths();
+            const String key = IO::EntityThumbnailCache::key(searchPaths, modelDefinition->name(), modelDefinition->skinIndex(), modelDefinition->frameIndex(), width, height);
+
+            ThumbnailMap::iterator it = m_thumbnails.lower_bound(key);
+            if (it != m_thumbnails.end() && it->first == key)
+                return it->second;
+
+            // the model file and the palette are only checked when the thumbnail is not in memory yet
+            const long modificationTime = IO::gameFileModificationTime(modelDefinition->name(), searchPaths);
+            const unsigned int paletteChecksum = m_documentViewHolder.document().sharedResources().palette().checksum();
+
+            unsigned char* pixels = new unsigned char[width * height * 4];
+            if (!m_thumbnailCache.read(key, modificationTime, paletteChecksum, width, height, pixels)) {
+                // the brightness is applied when the thumbnail is drawn, so that it need not be part of the key
+                GLint viewport[4];
+                glGetIntegerv(GL_VIEWPORT, viewport);
+
+                const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, 0.0f, static_cast<float>(height), static_cast<float>(width), 0.0f);
+                renderOffscreen(cell, width, height, projection, 1.0f);
+                m_offscreenRenderer.getPixels(pixels);
+                m_offscreenRenderer.postRender();
+
+                glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+                m_thumbnailCache.write(key, modificationTime, paletteChecksum, width, height, pixels);
+            }
+
+            Renderer::TextureRenderer* textureRenderer = new Renderer::TextureRenderer(pixels, GL_RGBA, width, height);
+            m_thumbnails.insert(it, ThumbnailMap::value_type(key, textureRenderer));
+            return textureRenderer;
+        }
+
         void EntityBrowserCanvas::doInitLayout(Layout& layout) {
             layout.setOuterMargin(5.0f);
             layout.setGroupMargin(5.0f);
@@ -125,6 +226,10 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor font(fontName, static_cast<unsigned int>(fontSize));
             IO::FileManager fileManager;
 
+            Model::EntityDefinitionList matches;
+            if (!m_filterText.empty())
+                definitionManager.findDefinitions(m_filterText, matches);
+
             if (m_group) {
                 Model::EntityDefinitionManager::EntityDefinitionGroups groups = definitionManager.groups(Model::EntityDefinition::PointEntity, m_sortOrder);
                 Model::EntityDefinitionManager::EntityDefinitionGroups::const_iterator groupIt, groupEnd;
@@ -138,17 +243,18 @@ namespace TrenchBroom {
                     Model::EntityDefinitionList::const_iterator defIt, defEnd;
                     for (defIt = definitions.begin(), defEnd = definitions.end(); defIt != defEnd; ++defIt) {
                         Model::PointEntityDefinition* definition = static_cast<Model::PointEntityDefinition*>(*defIt);
-                        addEntityToLayout(layout, definition, font);
+                        addEntityToLayout(layout, definition, matches, font);
                     }
                 }
             } else {
                 const Model::EntityDefinitionList& definitions = definitionManager.definitions(Model::EntityDefinition::PointEntity, m_sortOrder);
                 for (unsigned int i = 0; i < definitions.size(); i++)
-                    addEntityToLayout(layout, static_cast<Model::PointEntityDefinition*>(definitions[i]), font);
+                    addEntityToLayout(layout, static_cast<Model::PointEntityDefinition*>(definitions[i]), matches, font);
             }
         }
 
         void EntityBrowserCanvas::doClear() {
+            Utility::deleteAll(m_thumbnails);
         }
 
         void EntityBrowserCanvas::doRender(Layout& layout, float y, float height) {
@@ -162,8 +268,6 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor defaultDescriptor(prefs.getString(Preferences::RendererFontName),
                                                              static_cast<unsigned int>(prefs.getInt(Preferences::TextureBrowserFontSize)));
 
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
-
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             glEnable(GL_DEPTH_TEST);
@@ -243,13 +347,36 @@ namespace TrenchBroom {
                 }
             }
 
-            { // render models
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
+            // missing thumbnails are rendered offscreen before the model thumbnails are drawn
+            typedef std::vector<Renderer::TextureRenderer*> ThumbnailList;
+            ThumbnailList thumbnails;
+            for (unsigned int i = 0; i < layout.size(); i++) {
+                const Layout::Group& group = layout[i];
+                if (group.intersectsY(y, height)) {
+                    for (unsigned int j = 0; j < group.size(); j++) {
+                        const Layout::Group::Row& row = group[j];
+                        if (row.intersectsY(y, height)) {
+                            for (unsigned int k = 0; k < row.size(); k++) {
+                                const Layout::Group::Row::Cell& cell = row[k];
+                                if (cell.item().modelRenderer != NULL)
+                                    thumbnails.push_back(thumbnail(cell));
+                            }
+                        }
+                    }
+                }
+            }
+
+            glDisable(GL_DEPTH_TEST);
+            transformation = Renderer::Transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
+
+            { // render model thumbnails
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
                 shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
                 shader.setUniformVariable("GrayScale", false);
+                shader.setUniformVariable("Texture", 0);
 
-                modelRendererManager.activate();
+                ThumbnailList::const_iterator thumbnailIt = thumbnails.begin();
                 for (unsigned int i = 0; i < layout.size(); i++) {
                     const Layout::Group& group = layout[i];
                     if (group.intersectsY(y, height)) {
@@ -258,25 +385,29 @@ namespace TrenchBroom {
                             if (row.intersectsY(y, height)) {
                                 for (unsigned int k = 0; k < row.size(); k++) {
                                     const Layout::Group::Row::Cell& cell = row[k];
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer != NULL)
-                                        renderEntityModel(transformation,
-                                                          shader.currentShader(),
-                                                          *modelRenderer,
-                                                          cell.item().bounds,
-                                                          Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                          cell.scale());
+                                    if (cell.item().modelRenderer != NULL) {
+                                        // the rows of the thumbnails are stored bottom up
+                                        Renderer::TextureRenderer* textureRenderer = *thumbnailIt++;
+                                        textureRenderer->activate();
+                                        glBegin(GL_QUADS);
+                                        glTexCoord2f(0.0f, 0.0f);
+                                        glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
+                                        glTexCoord2f(0.0f, 1.0f);
+                                        glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
+                                        glTexCoord2f(1.0f, 1.0f);
+                                        glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
+                                        glTexCoord2f(1.0f, 0.0f);
+                                        glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
+                                        glEnd();
+                                        textureRenderer->deactivate();
+                                    }
                                 }
                             }
                         }
                     }
                 }
-                modelRendererManager.deactivate();
             }
 
-            glDisable(GL_DEPTH_TEST);
-            transformation = Renderer::Transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
-
             if (visibleGroupCount > 0) { // render group title background
                 unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
                 Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
@@ -341,49 +472,8 @@ namespace TrenchBroom {
             unsigned int height = static_cast<unsigned int>(bounds.height());
 
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
-
-            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
-            Renderer::ShaderProgram& boundsProgram = shaderManager.shaderProgram(Renderer::Shaders::EdgeShader);
-            Renderer::ShaderProgram& entityModelProgram = shaderManager.shaderProgram(Renderer::Shaders::EntityModelShader);
-
-            m_offscreenRenderer.setDimensions(width, height);
-            m_offscreenRenderer.preRender(); // Scampie's Vista machine crashes here
-
-            const float viewLeft      = 0.0f;
-            const float viewTop       = 0.0f;
-            const float viewRight     = bounds.width();
-            const float viewBottom    = bounds.height();
-
-            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
-            const Mat4f view = viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f));
-            Renderer::Transformation transformation(projection, view);
-
-            glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
-            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glEnable(GL_DEPTH_TEST);
-
-            Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-            if (modelRenderer == NULL) {
-                boundsProgram.activate();
-                Model::PointEntityDefinition* definition = cell.item().entityDefinition;
-                renderEntityBounds(transformation, boundsProgram, *definition, cell.item().bounds, Vec3f::Null, cell.scale());
-                boundsProgram.deactivate();
-            } else {
-                modelRendererManager.activate();
-                entityModelProgram.activate();
-                entityModelProgram.setUniformVariable("ApplyTinting", false);
-                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                renderEntityModel(transformation, entityModelProgram, *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
-                entityModelProgram.deactivate();
-                modelRendererManager.deactivate();
-            }
-
-            glPixelStorei(GL_PACK_ALIGNMENT, 1);
-            glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-            glPixelStorei(GL_PACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, 0.0f, 0.0f, bounds.width(), bounds.height());
+            renderOffscreen(cell, width, height, projection, prefs.getFloat(Preferences::RendererBrightness));
 
             wxImage* image = m_offscreenRenderer.getImage();
             m_offscreenRenderer.postRender();
@@ -399,6 +489,7 @@ namespace TrenchBroom {
         CellLayoutGLCanvas(parent, windowId, documentViewHolder.document().sharedResources().attribs(), documentViewHolder.document().sharedResources().sharedContext(), scrollBar),
         m_documentViewHolder(documentViewHolder),
         m_offscreenRenderer(m_documentViewHolder.document().sharedResources().multisample(), m_documentViewHolder.document().sharedResources().samples()),
+        m_thumbnailCache(thumbnailDirectory()),
         m_vbo(NULL),
         m_group(false),
         m_hideUnused(false),
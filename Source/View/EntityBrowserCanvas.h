@@ -20,6 +20,7 @@
 #ifndef __TrenchBroom__EntityBrowserCanvas__
 #define __TrenchBroom__EntityBrowserCanvas__
 
+#include "IO/EntityThumbnailCache.h"
 #include "Model/EntityDefinitionManager.h"
 #include "Renderer/OffscreenRenderer.h"
 #include "Renderer/Shader/Shader.h"
@@ -27,6 +28,8 @@
 #include "Utility/VecMath.h"
 #include "View/CellLayoutGLCanvas.h"
 
+#include <map>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -37,6 +40,7 @@ namespace TrenchBroom {
     namespace Renderer {
         class EntityModelRenderer;
         class ShaderProgram;
+        class TextureRenderer;
         class Vbo;
     }
 
@@ -61,8 +65,12 @@ namespace TrenchBroom {
 
         class EntityBrowserCanvas : public CellLayoutGLCanvas<EntityCellData, EntityGroupData> {
         protected:
+            typedef std::map<String, Renderer::TextureRenderer*> ThumbnailMap;
+            
             DocumentViewHolder& m_documentViewHolder;
             Renderer::OffscreenRenderer m_offscreenRenderer;
+            IO::EntityThumbnailCache m_thumbnailCache;
+            ThumbnailMap m_thumbnails;
             Renderer::Vbo* m_vbo;
             Quatf m_rotation;
 
@@ -71,9 +79,22 @@ namespace TrenchBroom {
             Model::EntityDefinitionManager::SortOrder m_sortOrder;
             String m_filterText;
 
-            void addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Renderer::Text::FontDescriptor& font);
+            /*
+             * Returns the directory below the cache directory where the thumbnails are stored and creates it if
+             * necessary. Returns an empty string if the directory cannot be created.
+             */
+            static String thumbnailDirectory();
+            
+            void addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Model::EntityDefinitionList& matches, const Renderer::Text::FontDescriptor& font);
             void renderEntityBounds(Renderer::Transformation& transformation, Renderer::ShaderProgram& boundsProgram, const Model::PointEntityDefinition& definition, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
             void renderEntityModel(Renderer::Transformation& transformation, Renderer::ShaderProgram& entityModelProgram, Renderer::EntityModelRenderer& renderer, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
+            void renderOffscreen(const Layout::Group::Row::Cell& cell, unsigned int width, unsigned int height, const Mat4f& projection, float brightness);
+            
+            /*
+             * Returns the thumbnail of the model of the given cell. Thumbnails are rendered once at the size of the
+             * cell and then cached in memory and on disk.
+             */
+            Renderer::TextureRenderer* thumbnail(const Layout::Group::Row::Cell& cell);
 
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
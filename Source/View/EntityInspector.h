@@ -64,11 +64,11 @@ namespace TrenchBroom {
             void updateSmartEditor(int row);
             void updateProperties();
             void updateSmartEditor();
-            void updateEntityBrowser();
         public:
             EntityInspector(wxWindow* parent, DocumentViewHolder& documentViewHolder);
             ~EntityInspector();
-            
+
+            void updateEntityBrowser();
             void update(const Controller::Command& command);
             void cameraChanged(const Renderer::Camera& camera);
 
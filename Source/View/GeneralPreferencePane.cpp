@@ -31,6 +31,7 @@
 #include "TrenchBroomApp.h"
 #include "Controller/PreferenceChangeEvent.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/String.h"
 #include "View/CommandIds.h"
 #include "View/LayoutConstants.h"
@@ -49,6 +50,7 @@ namespace TrenchBroom {
         EVT_CHOICE(CommandIds::GeneralPreferencePane::GridModeChoiceId, GeneralPreferencePane::OnGridModeChoice)
         EVT_CHOICE(CommandIds::GeneralPreferencePane::InstancingModeModeChoiceId, GeneralPreferencePane::OnInstancingModeChoice)
         EVT_CHOICE(CommandIds::GeneralPreferencePane::TextureBrowserIconSideChoiceId, GeneralPreferencePane::OnTextureBrowserIconSizeChoice)
+        EVT_CHOICE(CommandIds::GeneralPreferencePane::ProfilerModeChoiceId, GeneralPreferencePane::OnProfilerModeChoice)
 
         EVT_COMMAND_SCROLL(CommandIds::GeneralPreferencePane::LookSpeedSliderId, GeneralPreferencePane::OnMouseSliderChanged)
         EVT_CHECKBOX(CommandIds::GeneralPreferencePane::InvertLookXAxisCheckBoxId, GeneralPreferencePane::OnInvertAxisChanged)
@@ -97,6 +99,12 @@ namespace TrenchBroom {
             else
                 m_textureBrowserIconSizeChoice->SetSelection(2);
 
+            int profilerMode = prefs.getInt(Preferences::ProfilerMode);
+            if (profilerMode == Preferences::ProfilerModeRecord || profilerMode == Preferences::ProfilerModeConsole)
+                m_profilerModeChoice->SetSelection(profilerMode);
+            else
+                m_profilerModeChoice->SetSelection(Preferences::ProfilerModeOff);
+
             m_lookSpeedSlider->SetValue(static_cast<int>(prefs.getFloat(Preferences::CameraLookSpeed) * m_lookSpeedSlider->GetMax()));
             m_invertLookXAxisCheckBox->SetValue(prefs.getBool(Preferences::CameraLookInvertX));
             m_invertLookYAxisCheckBox->SetValue(prefs.getBool(Preferences::CameraLookInvertY));
@@ -172,6 +180,16 @@ namespace TrenchBroom {
             textureBrowserIconSizeSizer->AddSpacer(LayoutConstants::ControlHorizontalMargin);
             textureBrowserIconSizeSizer->Add(m_textureBrowserIconSizeChoice, 0, wxALIGN_CENTER_VERTICAL);
 
+            wxStaticText* profilerModeFakeLabel = new wxStaticText(viewBox, wxID_ANY, wxT(""));
+            wxStaticText* profilerModeLabel = new wxStaticText(viewBox, wxID_ANY, wxT("Profiling"));
+            wxString profilerModes[3] = {"Off", "Record", "Record and log frames"};
+            m_profilerModeChoice = new wxChoice(viewBox, CommandIds::GeneralPreferencePane::ProfilerModeChoiceId, wxDefaultPosition, wxDefaultSize, 3, profilerModes);
+
+            wxSizer* profilerModeSizer = new wxBoxSizer(wxHORIZONTAL);
+            profilerModeSizer->Add(profilerModeLabel, 0, wxALIGN_CENTER_VERTICAL);
+            profilerModeSizer->AddSpacer(LayoutConstants::ControlHorizontalMargin);
+            profilerModeSizer->Add(m_profilerModeChoice, 0, wxALIGN_CENTER_VERTICAL);
+
             wxFlexGridSizer* innerSizer = new wxFlexGridSizer(2, LayoutConstants::ControlHorizontalMargin, LayoutConstants::ControlVerticalMargin);
             innerSizer->AddGrowableCol(1);
             innerSizer->Add(brightnessLabel);
@@ -184,6 +202,8 @@ namespace TrenchBroom {
             innerSizer->Add(instancingModeSizer);
             innerSizer->Add(textureBrowserFakeLabel);
             innerSizer->Add(textureBrowserIconSizeSizer);
+            innerSizer->Add(profilerModeFakeLabel);
+            innerSizer->Add(profilerModeSizer);
             innerSizer->SetItemMinSize(brightnessLabel, GeneralPreferencePaneLayout::MinimumLabelWidth, brightnessLabel->GetSize().y);
 
             wxSizer* outerSizer = new wxBoxSizer(wxVERTICAL);
@@ -374,6 +394,18 @@ namespace TrenchBroom {
             static_cast<TrenchBroomApp*>(wxTheApp)->UpdateAllViews(NULL, &preferenceChangeEvent);
         }
 
+        void GeneralPreferencePane::OnProfilerModeChoice(wxCommandEvent& event) {
+            int mode = m_profilerModeChoice->GetSelection();
+            assert(mode >= 0 && mode <= 2);
+
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            prefs.setInt(Preferences::ProfilerMode, mode);
+            Utility::Profiler::instance().setEnabled(mode != Preferences::ProfilerModeOff);
+
+            Controller::PreferenceChangeEvent preferenceChangeEvent(Preferences::ProfilerMode);
+            static_cast<TrenchBroomApp*>(wxTheApp)->UpdateAllViews(NULL, &preferenceChangeEvent);
+        }
+
         void GeneralPreferencePane::OnMouseSliderChanged(wxScrollEvent& event) {
             wxSlider* sender = static_cast<wxSlider*>(event.GetEventObject());
             float value = sender->GetValue() / 100.0f;
@@ -41,6 +41,7 @@ namespace TrenchBroom {
             wxChoice* m_gridModeChoice;
             wxChoice* m_textureBrowserIconSizeChoice;
             wxChoice* m_instancingModeChoice;
+            wxChoice* m_profilerModeChoice;
             wxSlider* m_lookSpeedSlider;
             wxCheckBox* m_invertLookXAxisCheckBox;
             wxCheckBox* m_invertLookYAxisCheckBox;
@@ -66,6 +67,7 @@ namespace TrenchBroom {
             void OnGridModeChoice(wxCommandEvent& event);
             void OnInstancingModeChoice(wxCommandEvent& event);
             void OnTextureBrowserIconSizeChoice(wxCommandEvent& event);
+            void OnProfilerModeChoice(wxCommandEvent& event);
             void OnMouseSliderChanged(wxScrollEvent& event);
             void OnInvertAxisChanged(wxCommandEvent& event);
             void OnEnableAltMoveChanged(wxCommandEvent& event);
@@ -33,14 +33,17 @@
 #include "Model/Filter.h"
 #include "Utility/Console.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/VecMath.h"
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 #include "View/DragAndDrop.h"
 
+#include <wx/display.h>
 #include <wx/settings.h>
 #include <wx/wx.h>
 
+#include <algorithm>
 #include <cassert>
 
 using namespace TrenchBroom::VecMath;
@@ -63,6 +66,7 @@ namespace TrenchBroom {
         EVT_MOTION(MapGLCanvas::OnMouseMove)
         EVT_MOUSEWHEEL(MapGLCanvas::OnMouseWheel)
         EVT_MOUSE_CAPTURE_LOST(MapGLCanvas::OnMouseCaptureLost)
+        EVT_TIMER(wxID_ANY, MapGLCanvas::OnRedrawTimer)
         END_EVENT_TABLE()
 
         wxDragResult MapGLCanvasDropTarget::OnEnter(wxCoord x, wxCoord y, wxDragResult def) {
@@ -134,14 +138,28 @@ namespace TrenchBroom {
         m_inputController(new Controller::InputController(documentViewHolder)),
         m_overlayRenderer(NULL),
         m_hasFocus(false),
-        m_ignoreNextClick(false) {
+        m_ignoreNextClick(false),
+        m_redrawTimer(new wxTimer(this)),
+        m_frameInterval(1000 / 60),
+        m_redrawPending(false) {
             SetDropTarget(new MapGLCanvasDropTarget(*m_inputController));
+
+            const int displayIndex = wxDisplay::GetFromWindow(parent);
+            if (displayIndex != wxNOT_FOUND) {
+                const int refreshRate = wxDisplay(static_cast<unsigned int>(displayIndex)).GetCurrentMode().GetRefresh();
+                if (refreshRate > 0)
+                    m_frameInterval = 1000 / refreshRate;
+            }
         }
 
         MapGLCanvas::~MapGLCanvas() {
 			if (GetCapture() == this)
 				ReleaseMouse();
 
+            m_redrawTimer->Stop();
+            delete m_redrawTimer;
+            m_redrawTimer = NULL;
+
             delete m_inputController;
             m_inputController = NULL;
             delete m_overlayRenderer;
@@ -164,12 +182,39 @@ namespace TrenchBroom {
             return true;
         }
 
+        void MapGLCanvas::requestRedraw() {
+            if (m_redrawPending || m_redrawTimer->IsRunning())
+                return;
+
+            // the stop watch may still follow the system clock, so it could jump in either direction
+            const long elapsed = std::max(0L, m_frameWatch.Time());
+            if (elapsed >= m_frameInterval) {
+                m_redrawPending = true;
+                Refresh();
+            } else {
+                m_redrawTimer->Start(m_frameInterval - static_cast<int>(elapsed), wxTIMER_ONE_SHOT);
+            }
+        }
+
         void MapGLCanvas::OnPaint(wxPaintEvent& event) {
+            m_frameWatch.Start();
+            m_redrawPending = false;
+
             if (!m_documentViewHolder.valid() || !IsShownOnScreen())
                 return;
 
             EditorView& view = m_documentViewHolder.view();
 
+            // a frame spans everything that happened since the previous paint, including the input that caused this one
+            Utility::Profiler& profiler = Utility::Profiler::instance();
+            if (profiler.enabled()) {
+                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+                if (prefs.getInt(Preferences::ProfilerMode) == Preferences::ProfilerModeConsole)
+                    view.console().info(profiler.frameSummary());
+                profiler.beginFrame();
+            }
+            TB_PROFILE_ZONE("MapGLCanvas::OnPaint");
+
             wxPaintDC(this);
 			if (SetCurrent(*m_glContext)) {
                 glEnable(GL_MULTISAMPLE);
@@ -406,5 +451,10 @@ namespace TrenchBroom {
         void MapGLCanvas::OnMouseCaptureLost(wxMouseCaptureLostEvent& event) {
             m_inputController->endDrag();
         }
+
+        void MapGLCanvas::OnRedrawTimer(wxTimerEvent& event) {
+            m_redrawPending = true;
+            Refresh();
+        }
     }
 }
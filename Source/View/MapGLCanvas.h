@@ -26,6 +26,7 @@
 #include <GL/glew.h>
 #include <wx/dnd.h>
 #include <wx/glcanvas.h>
+#include <wx/stopwatch.h>
 #include <wx/timer.h>
 
 namespace TrenchBroom {
@@ -77,6 +78,11 @@ namespace TrenchBroom {
             
             bool m_hasFocus;
             bool m_ignoreNextClick;
+            
+            wxTimer* m_redrawTimer;
+            wxStopWatch m_frameWatch;
+            int m_frameInterval;
+            bool m_redrawPending;
 
             bool handleModifierKey(int keyCode, bool down);
         public:
@@ -93,6 +99,13 @@ namespace TrenchBroom {
             
             bool setHasFocus(bool hasFocus, bool dontIgnoreNextClick = false);
             
+            /*
+             * Schedules a repaint of the canvas. All requests until the next paint are merged into one, and the
+             * canvas is not painted more often than the display refreshes; a request that comes too early is
+             * deferred until the current frame has passed.
+             */
+            void requestRedraw();
+            
             void OnPaint(wxPaintEvent& event);
             void OnKeyDown(wxKeyEvent& event);
             void OnKeyUp(wxKeyEvent& event);
@@ -108,6 +121,7 @@ namespace TrenchBroom {
             void OnMouseMove(wxMouseEvent& event);
             void OnMouseWheel(wxMouseEvent& event);
             void OnMouseCaptureLost(wxMouseCaptureLostEvent& event);
+            void OnRedrawTimer(wxTimerEvent& event);
 
             DECLARE_EVENT_TABLE()
         };
@@ -19,7 +19,6 @@
 
 #include "TextureBrowserCanvas.h"
 
-#include "IO/FileManager.h"
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/SharedResources.h"
@@ -40,30 +39,119 @@
 #include "View/EditorView.h"
 #include "View/TextureSelectedCommand.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace View {
-        void TextureBrowserCanvas::addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font) {
-            if ((!m_hideUnused || texture->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(texture->name(), m_filterText, false))) {
-                Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
-                const float maxCellWidth = layout.maxCellWidth();
-                const Renderer::Text::FontDescriptor actualFont = fontManager.selectFontSize(font, texture->name(), maxCellWidth, 5);
-                const Vec2f actualSize = fontManager.font(actualFont)->measure(texture->name());
-
-                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-                const float scaleFactor = prefs.getFloat(Preferences::TextureBrowserIconSize);
-                const unsigned int scaledTextureWidth = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->width())));
-                const unsigned int scaledTextureHeight = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->height())));
+        /*
+         * Orders textures like the texture browser lists them, i.e., by their collections first if they are grouped.
+         */
+        class CompareTexturesForLayout {
+        public:
+            typedef std::map<Model::TextureCollection*, size_t> CollectionIndexMap;
+        private:
+            const CollectionIndexMap* m_collectionIndices;
+            Model::TextureSortOrder::Type m_sortOrder;
+        public:
+            CompareTexturesForLayout(const CollectionIndexMap* collectionIndices, Model::TextureSortOrder::Type sortOrder) :
+            m_collectionIndices(collectionIndices),
+            m_sortOrder(sortOrder) {}
+
+            inline bool operator() (const Model::Texture* left, const Model::Texture* right) const {
+                if (m_collectionIndices != NULL && &left->collection() != &right->collection()) {
+                    CollectionIndexMap::const_iterator leftIt = m_collectionIndices->find(&left->collection());
+                    CollectionIndexMap::const_iterator rightIt = m_collectionIndices->find(&right->collection());
+                    assert(leftIt != m_collectionIndices->end() && rightIt != m_collectionIndices->end());
+                    return leftIt->second < rightIt->second;
+                }
+                if (m_sortOrder == Model::TextureSortOrder::Name)
+                    return Model::CompareTexturesByName()(left, right);
+                return Model::CompareTexturesByUsage()(left, right);
+            }
+        };
 
-                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
-                Renderer::TextureRenderer& textureRenderer = textureRendererManager.renderer(texture);
-                layout.addItem(TextureCellData(texture, &textureRenderer, actualFont), scaledTextureWidth, scaledTextureHeight, actualSize.x(), font.size() + 2.0f);
+        bool TextureBrowserCanvas::matchesFilter(Model::Texture* texture) const {
+            return (!m_hideUnused || texture->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(texture->name(), m_filterText, false));
+        }
+
+        void TextureBrowserCanvas::filterTextures() {
+            const bool narrowFilter = m_narrowFilter && !m_filteredTextures.empty();
+            m_narrowFilter = false;
+
+            if (narrowFilter) {
+                // every texture that matches the extended filter text also matched the previous one
+                Model::TextureList::iterator it = m_filteredTextures.begin();
+                Model::TextureList::iterator end = m_filteredTextures.end();
+                Model::TextureList::iterator out = it;
+                for (; it != end; ++it)
+                    if (matchesFilter(*it))
+                        *out++ = *it;
+                m_filteredTextures.erase(out, end);
+                return;
+            }
+
+            // the textures may have changed since the last reload, so the titles must be measured again
+            m_filteredTextures.clear();
+            m_titles.clear();
+
+            Model::TextureManager& textureManager = m_documentViewHolder.document().textureManager();
+            if (!m_filterText.empty()) {
+                // only the textures whose names contain the filter text are brought into the order of the layout
+                Model::TextureList textures;
+                textureManager.findTextures(m_filterText, textures);
+
+                CompareTexturesForLayout::CollectionIndexMap collectionIndices;
+                if (m_group) {
+                    const Model::TextureCollectionList& collections = textureManager.collections();
+                    for (size_t i = 0; i < collections.size(); i++)
+                        collectionIndices[collections[i]] = i;
+                }
+
+                // without groups, only the textures that are not overridden are shown
+                for (size_t i = 0; i < textures.size(); i++)
+                    if ((m_group || !textures[i]->overridden()) && matchesFilter(textures[i]))
+                        m_filteredTextures.push_back(textures[i]);
+                std::sort(m_filteredTextures.begin(), m_filteredTextures.end(), CompareTexturesForLayout(m_group ? &collectionIndices : NULL, m_sortOrder));
+            } else if (m_group) {
+                const Model::TextureCollectionList& collections = textureManager.collections();
+                for (size_t i = 0; i < collections.size(); i++) {
+                    Model::TextureList textures = collections[i]->textures(m_sortOrder);
+                    for (size_t j = 0; j < textures.size(); j++)
+                        if (matchesFilter(textures[j]))
+                            m_filteredTextures.push_back(textures[j]);
+                }
+            } else {
+                Model::TextureList textures = textureManager.textures(m_sortOrder);
+                for (size_t i = 0; i < textures.size(); i++)
+                    if (matchesFilter(textures[i]))
+                        m_filteredTextures.push_back(textures[i]);
             }
         }
 
+        const TextureTitle& TextureBrowserCanvas::title(Model::Texture* texture, const Renderer::Text::FontDescriptor& font, float maxWidth) {
+            TextureTitleMap::iterator it = m_titles.lower_bound(texture);
+            if (it != m_titles.end() && it->first == texture)
+                return it->second;
+
+            Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
+            const Renderer::Text::FontDescriptor actualFont = fontManager.selectFontSize(font, texture->name(), maxWidth, 5);
+            const Vec2f actualSize = fontManager.font(actualFont)->measure(texture->name());
+            return m_titles.insert(it, TextureTitleMap::value_type(texture, TextureTitle(actualFont, actualSize.x())))->second;
+        }
+
+        void TextureBrowserCanvas::addTextureToLayout(Layout& layout, Model::Texture* texture, float titleHeight) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const float scaleFactor = prefs.getFloat(Preferences::TextureBrowserIconSize);
+            const unsigned int scaledTextureWidth = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->width())));
+            const unsigned int scaledTextureHeight = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->height())));
+
+            // the cells have a fixed width, so the titles are not needed for the layout and are measured when rendered
+            layout.addItem(TextureCellData(texture), scaledTextureWidth, scaledTextureHeight, 0.0f, titleHeight);
+        }
+
         void TextureBrowserCanvas::doInitLayout(Layout& layout) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             const float scaleFactor = prefs.getFloat(Preferences::TextureBrowserIconSize);
@@ -80,35 +168,32 @@ namespace TrenchBroom {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             Model::TextureManager& textureManager = m_documentViewHolder.document().textureManager();
 
-            String fontName = prefs.getString(Preferences::RendererFontName);
             int fontSize = prefs.getInt(Preferences::TextureBrowserFontSize);
-
             assert(fontSize >= 0);
-            Renderer::Text::FontDescriptor font(fontName, static_cast<unsigned int>(fontSize));
-            IO::FileManager fileManager;
+            const float titleHeight = fontSize + 2.0f;
+
+            filterTextures();
 
             if (m_group) {
+                // the filtered textures are ordered by their collections
+                size_t index = 0;
                 const Model::TextureCollectionList& collections = textureManager.collections();
                 for (size_t i = 0; i < collections.size(); i++) {
                     Model::TextureCollection* collection = collections[i];
-                    if (m_group) {
-                        String name = fileManager.pathComponents(collection->name()).back();
-                        layout.addGroup(collection, fontSize + 2.0f);
-                    }
-
-                    Model::TextureList textures = collection->textures(m_sortOrder);
-                    for (size_t j = 0; j < textures.size(); j++)
-                        addTextureToLayout(layout, textures[j], font);
+                    layout.addGroup(collection, titleHeight);
+                    while (index < m_filteredTextures.size() && &m_filteredTextures[index]->collection() == collection)
+                        addTextureToLayout(layout, m_filteredTextures[index++], titleHeight);
                 }
             } else {
                 layout.addGroup(NULL, 0.0f);
-                Model::TextureList textures = textureManager.textures(m_sortOrder);
-                for (size_t i = 0; i < textures.size(); i++)
-                    addTextureToLayout(layout, textures[i], font);
+                for (size_t i = 0; i < m_filteredTextures.size(); i++)
+                    addTextureToLayout(layout, m_filteredTextures[i], titleHeight);
             }
         }
 
         void TextureBrowserCanvas::doClear() {
+            m_filteredTextures.clear();
+            m_titles.clear();
         }
 
         void TextureBrowserCanvas::doRender(Layout& layout, float y, float height) {
@@ -163,12 +248,15 @@ namespace TrenchBroom {
                                 visibleItemCount++;
 
                                 const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
+                                const TextureTitle& title = this->title(cell.item().texture, defaultDescriptor, layout.maxCellWidth());
+                                const LayoutBounds& cellBounds = cell.cellBounds();
+                                const LayoutBounds& titleBounds = cell.titleBounds();
+                                const float titleWidth = std::min(title.width, layout.maxCellWidth());
+                                const Vec2f offset(cellBounds.left() + (cellBounds.width() - titleWidth) / 2.0f + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
 
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
+                                Renderer::Text::TexturedFont* font = fontManager.font(title.fontDescriptor);
                                 Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
+                                Vec2f::List& vertices = stringVertices[title.fontDescriptor];
                                 vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
                             }
                         }
@@ -220,20 +308,30 @@ namespace TrenchBroom {
             }
 
             { // render textures
+                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
                 shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+
+                // the textures of the rows within half a page of the visible rect are loaded ahead of scrolling
+                const float prefetchY = y - height / 2.0f;
+                const float prefetchHeight = 2.0f * height;
                 for (unsigned int i = 0; i < layout.size(); i++) {
                     const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
+                    if (group.intersectsY(prefetchY, prefetchHeight)) {
                         for (unsigned int j = 0; j < group.size(); j++) {
                             const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
+                            if (row.intersectsY(prefetchY, prefetchHeight)) {
+                                const bool visible = row.intersectsY(y, height);
                                 for (unsigned int k = 0; k < row.size(); k++) {
                                     const Layout::Group::Row::Cell& cell = row[k];
+                                    Renderer::TextureRenderer& textureRenderer = textureRendererManager.thumbnail(cell.item().texture);
+                                    if (!visible)
+                                        continue;
+
                                     shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
                                     shader.setUniformVariable("Texture", 0);
-                                    cell.item().textureRenderer->activate();
+                                    textureRenderer.activate();
                                     glBegin(GL_QUADS);
                                     glTexCoord2f(0.0f, 0.0f);
                                     glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
@@ -244,12 +342,13 @@ namespace TrenchBroom {
                                     glTexCoord2f(1.0f, 0.0f);
                                     glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
                                     glEnd();
-                                    cell.item().textureRenderer->deactivate();
+                                    textureRenderer.deactivate();
                                 }
                             }
                         }
                     }
                 }
+                textureRendererManager.evictThumbnails();
             }
 
             if (visibleGroupCount > 0) { // render group title background
@@ -336,7 +435,8 @@ namespace TrenchBroom {
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::TextureSortOrder::Name),
-        m_vbo() {}
+        m_vbo(),
+        m_narrowFilter(false) {}
 
         TextureBrowserCanvas::~TextureBrowserCanvas() {
             clear();
@@ -23,6 +23,8 @@
 #include "Model/TextureManager.h"
 #include "View/CellLayoutGLCanvas.h"
 
+#include <map>
+
 namespace TrenchBroom {
     namespace Model {
         class Texture;
@@ -53,13 +55,22 @@ namespace TrenchBroom {
         class TextureCellData {
         public:
             Model::Texture* texture;
-            Renderer::TextureRenderer* textureRenderer;
+            
+            TextureCellData(Model::Texture* i_texture) :
+            texture(i_texture) {}
+        };
+        
+        /*
+         * The font and width of a texture name. Titles are only measured once their cells become visible.
+         */
+        class TextureTitle {
+        public:
             Renderer::Text::FontDescriptor fontDescriptor;
+            float width;
             
-            TextureCellData(Model::Texture* i_texture, Renderer::TextureRenderer* i_textureRenderer, const Renderer::Text::FontDescriptor& i_fontDescriptor) :
-            texture(i_texture),
-            textureRenderer(i_textureRenderer),
-            fontDescriptor(i_fontDescriptor) {}
+            TextureTitle(const Renderer::Text::FontDescriptor& i_fontDescriptor, float i_width) :
+            fontDescriptor(i_fontDescriptor),
+            width(i_width) {}
         };
         
         class TextureBrowserCanvas : public CellLayoutGLCanvas<TextureCellData, TextureGroupData> {
@@ -73,7 +84,20 @@ namespace TrenchBroom {
             String m_filterText;
             Renderer::Vbo* m_vbo;
             
-            void addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font);
+            /*
+             * The textures that passed the filter in the last reload, in layout order. If the filter text is only
+             * extended, the next reload narrows this list instead of filtering all textures again.
+             */
+            Model::TextureList m_filteredTextures;
+            bool m_narrowFilter;
+            
+            typedef std::map<Model::Texture*, TextureTitle> TextureTitleMap;
+            TextureTitleMap m_titles;
+            
+            bool matchesFilter(Model::Texture* texture) const;
+            void filterTextures();
+            const TextureTitle& title(Model::Texture* texture, const Renderer::Text::FontDescriptor& font, float maxWidth);
+            void addTextureToLayout(Layout& layout, Model::Texture* texture, float titleHeight);
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
             virtual void doClear();
@@ -111,6 +135,7 @@ namespace TrenchBroom {
             inline void setFilterText(const String& filterText) {
                 if (filterText == m_filterText)
                     return;
+                m_narrowFilter = Utility::containsString(filterText, m_filterText, false);
                 m_filterText = filterText;
                 reload();
                 Refresh();
@@ -0,0 +1,233 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EntityThumbnailCacheTest_h
+#define TrenchBroom_EntityThumbnailCacheTest_h
+
+#include "TestSuite.h"
+#include "IO/EntityThumbnailCache.h"
+#include "Utility/String.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        class EntityThumbnailCacheTest : public TestSuite<EntityThumbnailCacheTest> {
+        private:
+            StringList m_searchPaths;
+            String m_directory;
+            
+            void fillPixels(unsigned char* pixels, size_t size, unsigned char seed) {
+                for (size_t i = 0; i < size; i++)
+                    pixels[i] = static_cast<unsigned char>(seed + i);
+            }
+            
+            String readFile(const String& path) {
+                std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+                return String(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+            }
+            
+            void writeFile(const String& path, const String& contents) {
+                std::ofstream stream(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&EntityThumbnailCacheTest::testKey);
+                registerTestCase(&EntityThumbnailCacheTest::testReadWrite);
+                registerTestCase(&EntityThumbnailCacheTest::testKeyMismatch);
+                registerTestCase(&EntityThumbnailCacheTest::testSizeMismatch);
+                registerTestCase(&EntityThumbnailCacheTest::testStaleThumbnail);
+                registerTestCase(&EntityThumbnailCacheTest::testTruncatedFile);
+                registerTestCase(&EntityThumbnailCacheTest::testNoDirectory);
+            }
+            
+            void setup() {
+                m_searchPaths.clear();
+                m_searchPaths.push_back("/quake/id1");
+                m_searchPaths.push_back("/quake/mod");
+                
+                // every test case writes into a fresh temporary directory so that nothing is left in the working directory
+                const char* tempDirectory = std::getenv("TMPDIR");
+                String directoryTemplate = String(tempDirectory != NULL && tempDirectory[0] != 0 ? tempDirectory : "/tmp") + "/TrenchBroomTest.XXXXXX";
+                std::vector<char> buffer(directoryTemplate.begin(), directoryTemplate.end());
+                buffer.push_back(0);
+                const char* directory = mkdtemp(&buffer.front());
+                assert(directory != NULL);
+                m_directory = &buffer.front();
+            }
+            
+            void teardown() {
+                DIR* directory = opendir(m_directory.c_str());
+                if (directory != NULL) {
+                    struct dirent* entry;
+                    while ((entry = readdir(directory)) != NULL) {
+                        const String name = entry->d_name;
+                        if (name != "." && name != "..")
+                            std::remove((m_directory + "/" + name).c_str());
+                    }
+                    closedir(directory);
+                }
+                rmdir(m_directory.c_str());
+            }
+        public:
+            void testKey() {
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/Player.mdl", 0, 1, 64, 48);
+                assert(key == EntityThumbnailCache::key(m_searchPaths, "PROGS/player.mdl", 0, 1, 64, 48));
+                assert(key != EntityThumbnailCache::key(m_searchPaths, "progs/player.mdl", 1, 1, 64, 48));
+                assert(key != EntityThumbnailCache::key(m_searchPaths, "progs/player.mdl", 0, 0, 64, 48));
+                assert(key != EntityThumbnailCache::key(m_searchPaths, "progs/player.mdl", 0, 1, 48, 64));
+                assert(key != EntityThumbnailCache::key(StringList(), "progs/player.mdl", 0, 1, 64, 48));
+            }
+            
+            void testReadWrite() {
+                EntityThumbnailCache cache(m_directory);
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 0, 0, 3, 2);
+                
+                unsigned char pixels[3 * 2 * 4];
+                fillPixels(pixels, sizeof(pixels), 7);
+                cache.write(key, 1000, 7, 3, 2, pixels);
+                
+                unsigned char result[3 * 2 * 4];
+                std::memset(result, 0, sizeof(result));
+                assert(cache.read(key, 1000, 7, 3, 2, result));
+                assert(std::memcmp(pixels, result, sizeof(pixels)) == 0);
+                
+                std::remove(cache.cachePath(key).c_str());
+                assert(!cache.read(key, 1000, 7, 3, 2, result));
+            }
+            
+            void testKeyMismatch() {
+                EntityThumbnailCache cache(m_directory);
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 0, 0, 2, 2);
+                const String otherKey = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 1, 0, 2, 2);
+                
+                // simulate a hash collision by moving the file to where the other key's thumbnail would be stored
+                unsigned char pixels[2 * 2 * 4];
+                fillPixels(pixels, sizeof(pixels), 3);
+                cache.write(key, 1000, 7, 2, 2, pixels);
+                std::remove(cache.cachePath(otherKey).c_str());
+                std::rename(cache.cachePath(key).c_str(), cache.cachePath(otherKey).c_str());
+                
+                unsigned char result[2 * 2 * 4];
+                std::memset(result, 0, sizeof(result));
+                assert(!cache.read(otherKey, 1000, 7, 2, 2, result));
+                for (size_t i = 0; i < sizeof(result); i++)
+                    assert(result[i] == 0);
+                
+                std::remove(cache.cachePath(otherKey).c_str());
+            }
+            
+            void testSizeMismatch() {
+                EntityThumbnailCache cache(m_directory);
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 0, 0, 2, 2);
+                
+                unsigned char pixels[2 * 2 * 4];
+                fillPixels(pixels, sizeof(pixels), 11);
+                cache.write(key, 1000, 7, 2, 2, pixels);
+                
+                unsigned char result[2 * 3 * 4];
+                std::memset(result, 0, sizeof(result));
+                assert(!cache.read(key, 1000, 7, 2, 3, result));
+                assert(!cache.read(key, 1000, 7, 3, 2, result));
+                for (size_t i = 0; i < sizeof(result); i++)
+                    assert(result[i] == 0);
+                
+                std::remove(cache.cachePath(key).c_str());
+            }
+            
+            void testStaleThumbnail() {
+                EntityThumbnailCache cache(m_directory);
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 0, 0, 2, 2);
+                
+                unsigned char pixels[2 * 2 * 4];
+                fillPixels(pixels, sizeof(pixels), 13);
+                cache.write(key, 1000, 7, 2, 2, pixels);
+                
+                unsigned char result[2 * 2 * 4];
+                std::memset(result, 0, sizeof(result));
+                assert(!cache.read(key, 1001, 7, 2, 2, result));
+                assert(!cache.read(key, 1000, 8, 2, 2, result));
+                for (size_t i = 0; i < sizeof(result); i++)
+                    assert(result[i] == 0);
+                
+                // a thumbnail rendered from the changed model replaces the stale one
+                cache.write(key, 1001, 7, 2, 2, pixels);
+                assert(cache.read(key, 1001, 7, 2, 2, result));
+                assert(!cache.read(key, 1000, 7, 2, 2, result));
+            }
+            
+            void testTruncatedFile() {
+                EntityThumbnailCache cache(m_directory);
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 0, 0, 2, 2);
+                
+                unsigned char pixels[2 * 2 * 4];
+                fillPixels(pixels, sizeof(pixels), 5);
+                cache.write(key, 1000, 7, 2, 2, pixels);
+                
+                const String path = cache.cachePath(key);
+                const String contents = readFile(path);
+                assert(contents.size() > sizeof(pixels));
+                
+                unsigned char result[2 * 2 * 4];
+                std::memset(result, 0, sizeof(result));
+                
+                // missing pixels
+                writeFile(path, contents.substr(0, contents.size() - 1));
+                assert(!cache.read(key, 1000, 7, 2, 2, result));
+                
+                // missing size and pixels
+                writeFile(path, contents.substr(0, contents.size() - sizeof(pixels) - 6));
+                assert(!cache.read(key, 1000, 7, 2, 2, result));
+                
+                // incomplete header
+                writeFile(path, contents.substr(0, 6));
+                assert(!cache.read(key, 1000, 7, 2, 2, result));
+                
+                for (size_t i = 0; i < sizeof(result); i++)
+                    assert(result[i] == 0);
+                
+                std::remove(path.c_str());
+            }
+            
+            void testNoDirectory() {
+                EntityThumbnailCache cache("");
+                const String key = EntityThumbnailCache::key(m_searchPaths, "progs/armor.mdl", 0, 0, 1, 1);
+                
+                unsigned char pixels[4] = { 1, 2, 3, 4 };
+                cache.write(key, 1000, 7, 1, 1, pixels);
+                assert(!cache.read(key, 1000, 7, 1, 1, pixels));
+                
+                std::ifstream stream(cache.cachePath(key).c_str());
+                assert(!stream.is_open());
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushCSGTest_h
+#define TrenchBroom_BrushCSGTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/BrushCSG.h"
+#include "Utility/List.h"
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushCSGTest : public TestSuite<BrushCSGTest> {
+        private:
+            BBoxf m_worldBounds;
+            
+            Brush* createBrush(const Vec3f& min, const Vec3f& max) {
+                return new Brush(m_worldBounds, true, BBoxf(min, max), NULL);
+            }
+            
+            // all operands are boxes, and so are the results, so the volume follows from the bounds
+            float volume(const BrushList& brushes) {
+                float volume = 0.0f;
+                BrushList::const_iterator it, end;
+                for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                    const Vec3f size = (*it)->bounds().size();
+                    volume += size.x() * size.y() * size.z();
+                }
+                return volume;
+            }
+            
+            bool contains(const BBoxf& outer, const BBoxf& inner) {
+                for (size_t i = 0; i < 3; i++)
+                    if (inner.min[i] < outer.min[i] - Math<float>::AlmostZero || inner.max[i] > outer.max[i] + Math<float>::AlmostZero)
+                        return false;
+                return true;
+            }
+            
+            bool overlaps(const BBoxf& bounds1, const BBoxf& bounds2) {
+                for (size_t i = 0; i < 3; i++)
+                    if (std::min(bounds1.max[i], bounds2.max[i]) - std::max(bounds1.min[i], bounds2.min[i]) <= Math<float>::AlmostZero)
+                        return false;
+                return true;
+            }
+            
+            bool equals(const BBoxf& bounds, const Vec3f& min, const Vec3f& max) {
+                return bounds.min.equals(min) && bounds.max.equals(max);
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BrushCSGTest::testSubtract);
+                registerTestCase(&BrushCSGTest::testSubtractCovered);
+                registerTestCase(&BrushCSGTest::testSubtractMissed);
+                registerTestCase(&BrushCSGTest::testMerge);
+                registerTestCase(&BrushCSGTest::testMergeNonConvex);
+                registerTestCase(&BrushCSGTest::testMergeChain);
+                registerTestCase(&BrushCSGTest::testHollow);
+                registerTestCase(&BrushCSGTest::testHollowTooThin);
+            }
+            
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f));
+            }
+        public:
+            void testSubtract() {
+                BrushCSG csg(m_worldBounds, true);
+                Brush* minuend = createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f));
+                Brush* subtrahend = createBrush(Vec3f(16.0f, 16.0f, 16.0f), Vec3f(48.0f, 48.0f, 80.0f));
+                
+                BrushList subtrahends;
+                subtrahends.push_back(subtrahend);
+                BrushList result;
+                assert(csg.subtract(*minuend, subtrahends, result));
+                
+                // the subtrahend sticks out of the top, so there is no fragment above it
+                assert(result.size() == 5);
+                assert(Math<float>::eq(volume(result), 64.0f * 64.0f * 64.0f - 32.0f * 32.0f * 48.0f));
+                
+                BBoxf fragmentBounds = result.front()->bounds();
+                for (size_t i = 0; i < result.size(); i++) {
+                    assert(contains(minuend->bounds(), result[i]->bounds()));
+                    assert(!overlaps(subtrahend->bounds(), result[i]->bounds()));
+                    fragmentBounds.mergeWith(result[i]->bounds());
+                }
+                assert(equals(fragmentBounds, minuend->bounds().min, minuend->bounds().max));
+                
+                Utility::deleteAll(result);
+                delete subtrahend;
+                delete minuend;
+            }
+            
+            void testSubtractCovered() {
+                BrushCSG csg(m_worldBounds, true);
+                Brush* minuend = createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(32.0f, 32.0f, 32.0f));
+                Brush* subtrahend = createBrush(Vec3f(-16.0f, -16.0f, -16.0f), Vec3f(48.0f, 48.0f, 48.0f));
+                
+                BrushList subtrahends;
+                subtrahends.push_back(subtrahend);
+                BrushList result;
+                assert(csg.subtract(*minuend, subtrahends, result));
+                assert(result.empty());
+                
+                delete subtrahend;
+                delete minuend;
+            }
+            
+            void testSubtractMissed() {
+                BrushCSG csg(m_worldBounds, true);
+                Brush* minuend = createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f));
+                const FaceList faces = minuend->faces();
+                
+                BrushList subtrahends;
+                subtrahends.push_back(createBrush(Vec3f(128.0f, 0.0f, 0.0f), Vec3f(192.0f, 64.0f, 64.0f)));
+                // only touches the minuend
+                subtrahends.push_back(createBrush(Vec3f(64.0f, 0.0f, 0.0f), Vec3f(128.0f, 64.0f, 64.0f)));
+                
+                BrushList result;
+                assert(!csg.subtract(*minuend, subtrahends, result));
+                assert(result.empty());
+                assert(minuend->faces() == faces);
+                assert(equals(minuend->bounds(), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)));
+                
+                Utility::deleteAll(subtrahends);
+                delete minuend;
+            }
+            
+            void testMerge() {
+                BrushCSG csg(m_worldBounds, true);
+                Brush* brush1 = createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f));
+                Brush* brush2 = createBrush(Vec3f(64.0f, 0.0f, 0.0f), Vec3f(128.0f, 64.0f, 64.0f));
+                Brush* brush3 = createBrush(Vec3f(0.0f, 0.0f, 256.0f), Vec3f(64.0f, 64.0f, 320.0f));
+                const FaceList faces3 = brush3->faces();
+                
+                BrushList brushes;
+                brushes.push_back(brush1);
+                brushes.push_back(brush2);
+                brushes.push_back(brush3);
+                
+                BrushList removed;
+                BrushList result;
+                assert(csg.merge(brushes, removed, result));
+                assert(result.size() == 1);
+                assert(equals(result.front()->bounds(), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(128.0f, 64.0f, 64.0f)));
+                assert(result.front()->faces().size() == 6);
+                
+                // the brush that is not adjacent to the others is left alone
+                assert(removed.size() == 2);
+                assert(std::find(removed.begin(), removed.end(), brush1) != removed.end());
+                assert(std::find(removed.begin(), removed.end(), brush2) != removed.end());
+                assert(brush3->faces() == faces3);
+                
+                Utility::deleteAll(result);
+                Utility::deleteAll(brushes);
+            }
+            
+            void testMergeNonConvex() {
+                BrushCSG csg(m_worldBounds, true);
+                BrushList brushes;
+                brushes.push_back(createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)));
+                brushes.push_back(createBrush(Vec3f(64.0f, 0.0f, 0.0f), Vec3f(128.0f, 32.0f, 64.0f)));
+                
+                BrushList removed;
+                BrushList result;
+                assert(!csg.merge(brushes, removed, result));
+                assert(removed.empty());
+                assert(result.empty());
+                
+                Utility::deleteAll(brushes);
+            }
+            
+            void testMergeChain() {
+                BrushCSG csg(m_worldBounds, true);
+                BrushList brushes;
+                brushes.push_back(createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)));
+                brushes.push_back(createBrush(Vec3f(128.0f, 0.0f, 0.0f), Vec3f(192.0f, 64.0f, 64.0f)));
+                brushes.push_back(createBrush(Vec3f(64.0f, 0.0f, 0.0f), Vec3f(128.0f, 64.0f, 64.0f)));
+                
+                // the last brush bridges the first two, and the brush merged from it is merged again
+                BrushList removed;
+                BrushList result;
+                assert(csg.merge(brushes, removed, result));
+                assert(removed.size() == 3);
+                assert(result.size() == 1);
+                assert(equals(result.front()->bounds(), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(192.0f, 64.0f, 64.0f)));
+                assert(result.front()->faces().size() == 6);
+                
+                Utility::deleteAll(result);
+                Utility::deleteAll(brushes);
+            }
+            
+            void testHollow() {
+                BrushCSG csg(m_worldBounds, true);
+                Brush* brush = createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(128.0f, 128.0f, 64.0f));
+                const float thickness = 16.0f;
+                
+                BrushList result;
+                assert(csg.hollow(*brush, thickness, result));
+                assert(result.size() == 6);
+                assert(Math<float>::eq(volume(result), 128.0f * 128.0f * 64.0f - 96.0f * 96.0f * 32.0f));
+                
+                // every wall is as thick as requested
+                for (size_t i = 0; i < result.size(); i++) {
+                    const BBoxf& bounds = result[i]->bounds();
+                    const Vec3f size = bounds.size();
+                    assert(contains(brush->bounds(), bounds));
+                    assert(Math<float>::eq(size.x(), thickness) || Math<float>::eq(size.y(), thickness) || Math<float>::eq(size.z(), thickness));
+                }
+                
+                Utility::deleteAll(result);
+                delete brush;
+            }
+            
+            void testHollowTooThin() {
+                BrushCSG csg(m_worldBounds, true);
+                Brush* brush = createBrush(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(128.0f, 128.0f, 24.0f));
+                
+                BrushList result;
+                assert(!csg.hollow(*brush, 16.0f, result));
+                assert(result.empty());
+                
+                delete brush;
+            }
+        };
+    }
+}
+
+#endif
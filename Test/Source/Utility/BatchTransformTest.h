@@ -0,0 +1,266 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BatchTransformTest_h
+#define TrenchBroom_BatchTransformTest_h
+
+#include "TestSuite.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <functional>
+
+namespace TrenchBroom {
+    namespace VecMath {
+        /*
+         Checks the vectorized Vec4f / Mat4f specializations and the batch kernels against the scalar templates.
+         The scalar reference implementations below are copies of the generic template code, so the results
+         must match exactly and not just within some epsilon.
+         */
+        class BatchTransformTest : public TestSuite<BatchTransformTest> {
+        private:
+            unsigned int m_seed;
+            
+            inline float nextFloat() {
+                m_seed = m_seed * 1103515245u + 12345u;
+                return static_cast<float>((m_seed >> 8) % 200000) / 100.0f - 1000.0f;
+            }
+            
+            inline Vec3f nextVec3f() {
+                const float x = nextFloat();
+                const float y = nextFloat();
+                const float z = nextFloat();
+                return Vec3f(x, y, z);
+            }
+            
+            inline Mat4f nextTransformation() {
+                const Vec3f axis = nextVec3f().normalized();
+                const float angle = nextFloat() / 100.0f;
+                const Vec3f factors = nextVec3f() / 100.0f;
+                return translationMatrix(nextVec3f()) * rotationMatrix(angle, axis) * scalingMatrix(factors);
+            }
+            
+            static const Mat4f scalarMultiply(const Mat4f& left, const Mat4f& right) {
+                Mat4f result(Mat4f::Null);
+                for (size_t c = 0; c < 4; c++)
+                    for (size_t r = 0; r < 4; r++)
+                        for (size_t i = 0; i < 4; i++)
+                            result[c][r] += left[i][r] * right[c][i];
+                return result;
+            }
+            
+            static const Vec4f scalarMultiply(const Mat4f& left, const Vec4f& right) {
+                Vec4f result;
+                for (size_t r = 0; r < 4; r++)
+                    for (size_t i = 0; i < 4; i++)
+                        result[r] += left[i][r] * right[i];
+                return result;
+            }
+            
+            static const Vec3f scalarMultiply(const Mat4f& left, const Vec3f& right) {
+                Vec4f result;
+                const Vec4f right4(right, 1.0f);
+                for (size_t r = 0; r < 4; r++)
+                    for (size_t i = 0; i < 4; i++)
+                        result[r] += left[i][r] * right4[i];
+                return Vec3f(result[0] / result[3],
+                             result[1] / result[3],
+                             result[2] / result[3]);
+            }
+            
+            static const Planef scalarTransform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const Planef& plane) {
+                Vec3f normal = scalarMultiply(vectorTransform, plane.normal);
+                normal.normalize();
+                return Planef(normal, scalarMultiply(pointTransform, plane.anchor()).dot(normal));
+            }
+            
+            static const BBoxf scalarBounds(const Mat4f& transformation, const Vec3f::List& points) {
+                BBoxf result;
+                result.min = result.max = scalarMultiply(transformation, points[0]);
+                for (size_t i = 1; i < points.size(); i++) {
+                    const Vec3f point = scalarMultiply(transformation, points[i]);
+                    for (size_t j = 0; j < 3; j++) {
+                        result.min[j] = std::min(result.min[j], point[j]);
+                        result.max[j] = std::max(result.max[j], point[j]);
+                    }
+                }
+                return result;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BatchTransformTest::testVec4fArithmetic);
+                registerTestCase(&BatchTransformTest::testMatrixMultiply);
+                registerTestCase(&BatchTransformTest::testVec4fRightMultiply);
+                registerTestCase(&BatchTransformTest::testVec3fRightMultiply);
+                registerTestCase(&BatchTransformTest::testPerspectiveRightMultiply);
+                registerTestCase(&BatchTransformTest::testTransformPoints);
+                registerTestCase(&BatchTransformTest::testTransformPointList);
+                registerTestCase(&BatchTransformTest::testTransformPlanes);
+                registerTestCase(&BatchTransformTest::testTransformedBounds);
+                registerTestCase(&BatchTransformTest::testTransformedBBox);
+            }
+            
+            void setup() {
+                m_seed = 1;
+            }
+        public:
+            void testVec4fArithmetic() {
+                for (size_t i = 0; i < 1000; i++) {
+                    const Vec4f l(nextFloat(), nextFloat(), nextFloat(), nextFloat());
+                    const Vec4f r(nextFloat(), nextFloat(), nextFloat(), nextFloat());
+                    const float f = nextFloat();
+                    
+                    for (size_t j = 0; j < 4; j++) {
+                        assert((-l)[j] == -l[j]);
+                        assert((l + r)[j] == l[j] + r[j]);
+                        assert((l - r)[j] == l[j] - r[j]);
+                        assert((l * f)[j] == l[j] * f);
+                        assert((l / f)[j] == l[j] / f);
+                    }
+                    
+                    Vec4f v = l;
+                    v += r;
+                    assert(v == l + r);
+                    v = l;
+                    v -= r;
+                    assert(v == l - r);
+                    v = l;
+                    v *= f;
+                    assert(v == l * f);
+                    v = l;
+                    v /= f;
+                    assert(v == l / f);
+                }
+            }
+            
+            void testMatrixMultiply() {
+                for (size_t i = 0; i < 1000; i++) {
+                    const Mat4f l = nextTransformation();
+                    const Mat4f r = nextTransformation();
+                    assert(l * r == scalarMultiply(l, r));
+                }
+            }
+            
+            void testVec4fRightMultiply() {
+                for (size_t i = 0; i < 1000; i++) {
+                    const Mat4f m = nextTransformation();
+                    const Vec4f v(nextFloat(), nextFloat(), nextFloat(), nextFloat());
+                    assert(m * v == scalarMultiply(m, v));
+                }
+            }
+            
+            void testVec3fRightMultiply() {
+                for (size_t i = 0; i < 1000; i++) {
+                    const Mat4f m = nextTransformation();
+                    const Vec3f v = nextVec3f();
+                    assert(m * v == scalarMultiply(m, v));
+                }
+            }
+            
+            void testPerspectiveRightMultiply() {
+                const Mat4f projection = perspectiveMatrix(90.0f, 1.0f, 8192.0f, 1024, 768);
+                for (size_t i = 0; i < 1000; i++) {
+                    Vec3f v = nextVec3f();
+                    v[2] = -std::abs(v[2]) - 1.0f;
+                    assert(projection * v == scalarMultiply(projection, v));
+                }
+            }
+            
+            void testTransformPoints() {
+                const Mat4f m = nextTransformation();
+                Vec3f::List points;
+                for (size_t i = 0; i < 1001; i++)
+                    points.push_back(nextVec3f());
+                
+                Vec3f::List result(points.size());
+                transformPoints(m, &points[0], points.size(), &result[0]);
+                for (size_t i = 0; i < points.size(); i++)
+                    assert(result[i] == scalarMultiply(m, points[i]));
+                
+                // in place
+                Vec3f::List copy = points;
+                transformPoints(m, copy);
+                assert(copy == result);
+            }
+            
+            void testTransformPointList() {
+                const Mat4f m = nextTransformation();
+                Vec3f::List points;
+                for (size_t i = 0; i < 1001; i++)
+                    points.push_back(nextVec3f());
+                
+                const Vec3f::List result = m * points;
+                assert(result.size() == points.size());
+                for (size_t i = 0; i < points.size(); i++)
+                    assert(result[i] == scalarMultiply(m, points[i]));
+                
+                assert((m * Vec3f::List()).empty());
+            }
+            
+            void testTransformPlanes() {
+                const Vec3f axis = nextVec3f().normalized();
+                const Mat4f vectorTransform = rotationMatrix(nextFloat() / 100.0f, axis);
+                const Mat4f pointTransform = translationMatrix(nextVec3f()) * vectorTransform;
+                
+                std::vector<Planef> planes;
+                for (size_t i = 0; i < 1001; i++)
+                    planes.push_back(Planef(nextVec3f().normalized(), nextFloat()));
+                
+                std::vector<Planef> result(planes.size());
+                transformPlanes(pointTransform, vectorTransform, &planes[0], planes.size(), &result[0]);
+                for (size_t i = 0; i < planes.size(); i++) {
+                    const Planef expected = scalarTransform(pointTransform, vectorTransform, planes[i]);
+                    assert(result[i].normal == expected.normal);
+                    assert(result[i].distance == expected.distance);
+                    
+                    const Planef single = planes[i].transformed(pointTransform, vectorTransform);
+                    assert(result[i].normal == single.normal);
+                    assert(result[i].distance == single.distance);
+                }
+                
+                // in place
+                transformPlanes(pointTransform, vectorTransform, planes);
+                for (size_t i = 0; i < planes.size(); i++) {
+                    assert(planes[i].normal == result[i].normal);
+                    assert(planes[i].distance == result[i].distance);
+                }
+            }
+            
+            void testTransformedBounds() {
+                for (size_t i = 0; i < 100; i++) {
+                    const Mat4f m = nextTransformation();
+                    Vec3f::List points;
+                    for (size_t j = 0; j <= i; j++)
+                        points.push_back(nextVec3f());
+                    
+                    assert(transformedBounds(m, &points[0], points.size()) == scalarBounds(m, points));
+                }
+            }
+            
+            void testTransformedBBox() {
+                const BBoxf bounds(-16.0f, -32.0f, -64.0f, 16.0f, 32.0f, 64.0f);
+                const BBoxf result = bounds.transformed(translationMatrix(Vec3f(1.0f, 2.0f, 3.0f)) * Mat4f::Rot90ZCW);
+                assert(result.min.equals(Vec3f(-31.0f, -14.0f, -61.0f)));
+                assert(result.max.equals(Vec3f( 33.0f,  18.0f,  67.0f)));
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_InstanceBufferTest_h
+#define TrenchBroom_InstanceBufferTest_h
+
+#include "TestSuite.h"
+#include "Utility/InstanceBuffer.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class InstanceBufferTest : public TestSuite<InstanceBufferTest> {
+        private:
+            inline bool consistent(const InstanceBuffer& buffer) {
+                const Vec4f::List& instances = buffer.instances();
+                for (size_t i = 0; i < instances.size(); i++) {
+                    if (!buffer.contains(instances[i].xyz()))
+                        return false;
+                    if (buffer.selected(instances[i].xyz()) != (instances[i].w() > 0.5f))
+                        return false;
+                }
+                return true;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&InstanceBufferTest::testAddAndRemove);
+                registerTestCase(&InstanceBufferTest::testSetSelected);
+                registerTestCase(&InstanceBufferTest::testDirtyRange);
+            }
+        public:
+            void testAddAndRemove() {
+                InstanceBuffer buffer;
+                for (size_t i = 0; i < 100; i++)
+                    assert(buffer.add(Vec3f(static_cast<float>(i), 0.0f, 0.0f)));
+                assert(!buffer.add(Vec3f(3.0f, 0.0f, 0.0f)));
+                assert(buffer.size() == 100);
+                
+                assert(!buffer.remove(Vec3f(0.5f, 0.0f, 0.0f)));
+                for (size_t i = 0; i < 100; i += 3)
+                    assert(buffer.remove(Vec3f(static_cast<float>(i), 0.0f, 0.0f)));
+                assert(buffer.size() == 66);
+                assert(consistent(buffer));
+                
+                for (size_t i = 0; i < 100; i++)
+                    assert(buffer.contains(Vec3f(static_cast<float>(i), 0.0f, 0.0f)) == (i % 3 != 0));
+                
+                buffer.clear();
+                assert(buffer.empty());
+                assert(!buffer.contains(Vec3f(1.0f, 0.0f, 0.0f)));
+            }
+            
+            void testSetSelected() {
+                InstanceBuffer buffer;
+                buffer.add(Vec3f(1.0f, 2.0f, 3.0f));
+                buffer.add(Vec3f(4.0f, 5.0f, 6.0f), true);
+                assert(!buffer.selected(Vec3f(1.0f, 2.0f, 3.0f)));
+                assert(buffer.selected(Vec3f(4.0f, 5.0f, 6.0f)));
+                
+                assert(buffer.setSelected(Vec3f(1.0f, 2.0f, 3.0f), true));
+                assert(!buffer.setSelected(Vec3f(7.0f, 8.0f, 9.0f), true));
+                assert(buffer.selected(Vec3f(1.0f, 2.0f, 3.0f)));
+                
+                // the moved instance keeps its state
+                buffer.remove(Vec3f(1.0f, 2.0f, 3.0f));
+                assert(buffer.selected(Vec3f(4.0f, 5.0f, 6.0f)));
+                assert(consistent(buffer));
+            }
+            
+            void testDirtyRange() {
+                InstanceBuffer buffer;
+                for (size_t i = 0; i < 10; i++)
+                    buffer.add(Vec3f(static_cast<float>(i), 0.0f, 0.0f));
+                assert(buffer.dirty());
+                assert(buffer.dirtyBegin() == 0 && buffer.dirtyEnd() == 10);
+                
+                buffer.clean();
+                assert(!buffer.dirty());
+                
+                buffer.setSelected(Vec3f(5.0f, 0.0f, 0.0f), false);
+                assert(!buffer.dirty());
+                buffer.setSelected(Vec3f(5.0f, 0.0f, 0.0f), true);
+                assert(buffer.dirtyBegin() == 5 && buffer.dirtyEnd() == 6);
+                
+                buffer.clean();
+                buffer.remove(Vec3f(2.0f, 0.0f, 0.0f));
+                assert(buffer.dirtyBegin() == 2 && buffer.dirtyEnd() == 3);
+                assert(buffer.instances()[2].x() == 9.0f);
+                
+                // removing the last instance only shrinks the buffer
+                buffer.clean();
+                buffer.remove(Vec3f(8.0f, 0.0f, 0.0f));
+                assert(!buffer.dirty());
+                assert(buffer.size() == 8);
+                
+                buffer.add(Vec3f(20.0f, 0.0f, 0.0f));
+                assert(buffer.dirtyBegin() == 8 && buffer.dirtyEnd() == 9);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_PointGridTest_h
+#define TrenchBroom_PointGridTest_h
+
+#include "TestSuite.h"
+#include "Utility/PointGrid.h"
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class PointGridTest : public TestSuite<PointGridTest> {
+        private:
+            unsigned int m_seed;
+            
+            inline float nextFloat() {
+                m_seed = m_seed * 1103515245u + 12345u;
+                return static_cast<float>((m_seed >> 8) % 40000) / 10.0f - 2000.0f;
+            }
+            
+            inline Vec3f nextVec3f() {
+                const float x = nextFloat();
+                const float y = nextFloat();
+                const float z = nextFloat();
+                return Vec3f(x, y, z);
+            }
+            
+            inline Vec3f::List randomPoints(const size_t count) {
+                Vec3f::Set points;
+                while (points.size() < count)
+                    points.insert(nextVec3f());
+                return Vec3f::List(points.begin(), points.end());
+            }
+            
+            inline bool contains(const Vec3f::List& points, const Vec3f& point) {
+                return std::find(points.begin(), points.end(), point) != points.end();
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&PointGridTest::testAddAndRemove);
+                registerTestCase(&PointGridTest::testFindInSphere);
+                registerTestCase(&PointGridTest::testFindInCone);
+            }
+            
+            void setup() {
+                m_seed = 1;
+            }
+        public:
+            void testAddAndRemove() {
+                PointGrid grid(64.0f);
+                const Vec3f::List points = randomPoints(1000);
+                for (size_t i = 0; i < points.size(); i++)
+                    grid.add(points[i]);
+                assert(grid.size() == points.size());
+                
+                assert(!grid.remove(Vec3f(0.05f, 0.05f, 0.05f)));
+                for (size_t i = 0; i < points.size(); i += 2)
+                    assert(grid.remove(points[i]));
+                assert(grid.size() == points.size() / 2);
+                
+                Vec3f::List found;
+                grid.findInSphere(Vec3f::Null, 10000.0f, found);
+                assert(found.size() == points.size() / 2);
+                for (size_t i = 0; i < points.size(); i++)
+                    assert(contains(found, points[i]) == (i % 2 == 1));
+                
+                grid.clear();
+                assert(grid.empty());
+            }
+            
+            void testFindInSphere() {
+                PointGrid grid(64.0f);
+                const Vec3f::List points = randomPoints(5000);
+                for (size_t i = 0; i < points.size(); i++)
+                    grid.add(points[i]);
+                
+                for (size_t i = 0; i < 20; i++) {
+                    const Vec3f center = nextVec3f();
+                    const float radius = std::abs(nextFloat()) / 2.0f;
+                    
+                    Vec3f::List found;
+                    grid.findInSphere(center, radius, found);
+                    
+                    size_t expected = 0;
+                    for (size_t j = 0; j < points.size(); j++) {
+                        if (points[j].distanceTo(center) <= radius) {
+                            assert(contains(found, points[j]));
+                            expected++;
+                        }
+                    }
+                    assert(found.size() == expected);
+                }
+            }
+            
+            void testFindInCone() {
+                const float handleRadius = 3.0f;
+                const float scalingFactor = 1.0f / 300.0f;
+                const float maxDistance = 1000.0f;
+                
+                PointGrid grid(64.0f);
+                const Vec3f::List points = randomPoints(5000);
+                for (size_t i = 0; i < points.size(); i++)
+                    grid.add(points[i]);
+                
+                for (size_t i = 0; i < 200; i++) {
+                    // aim at a point so that there is something to hit
+                    const Vec3f origin = nextVec3f() / 4.0f;
+                    const Vec3f& target = points[i * 17 % points.size()];
+                    const Rayf ray(origin, (target - origin).normalized());
+                    
+                    Vec3f::List found;
+                    grid.findInCone(ray, 2.0f * handleRadius * scalingFactor, maxDistance, found);
+                    assert(found.size() < points.size());
+                    
+                    for (size_t j = 0; j < points.size(); j++) {
+                        const float distance = ray.intersectWithSphere(points[j], 2.0f * handleRadius, scalingFactor, maxDistance);
+                        if (!Math<float>::isnan(distance))
+                            assert(contains(found, points[j]));
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif
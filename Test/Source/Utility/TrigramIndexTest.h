@@ -0,0 +1,166 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TrigramIndexTest_h
+#define TrenchBroom_TrigramIndexTest_h
+
+#include "TestSuite.h"
+#include "Utility/String.h"
+#include "Utility/TrigramIndex.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class TrigramIndexTest : public TestSuite<TrigramIndexTest> {
+        protected:
+            void registerTestCases() {
+                registerTestCase(&TrigramIndexTest::testFind);
+                registerTestCase(&TrigramIndexTest::testFindShortPattern);
+                registerTestCase(&TrigramIndexTest::testRemove);
+                registerTestCase(&TrigramIndexTest::testRemoveSharedString);
+            }
+        public:
+            void testFind() {
+                TrigramIndex<int> index;
+                index.insert("METAL1_2", 1);
+                index.insert("metal2_1", 2);
+                index.insert("+0button", 3);
+                index.insert("tech_metal", 4);
+                index.insert("sky1", 5);
+                index.insert("tech_metal", 6);
+                assert(index.size() == 5);
+                
+                TrigramIndex<int>::ValueList result;
+                index.find("Metal", result);
+                assert(result.size() == 4);
+                assert(result[0] == 1 && result[1] == 2 && result[2] == 4 && result[3] == 6);
+                
+                // all trigrams occur, but not in this order
+                result.clear();
+                index.find("tal1_2met", result);
+                assert(result.empty());
+                
+                result.clear();
+                index.find("TTON", result);
+                assert(result.size() == 1 && result[0] == 3);
+                
+                result.clear();
+                index.find("brick", result);
+                assert(result.empty());
+            }
+            
+            void testFindShortPattern() {
+                TrigramIndex<int> index;
+                index.insert("sky1", 1);
+                index.insert("sky4", 2);
+                index.insert("wall1", 3);
+                index.insert("wall1", 1);
+                
+                TrigramIndex<int>::ValueList result;
+                index.find("1", result);
+                assert(result.size() == 2);
+                assert(result[0] == 1 && result[1] == 3);
+                
+                result.clear();
+                index.find("Y4", result);
+                assert(result.size() == 1 && result[0] == 2);
+                
+                result.clear();
+                index.find("", result);
+                assert(result.size() == 3);
+            }
+            
+            void testRemove() {
+                TrigramIndex<int> index;
+                index.insert("classname", 1);
+                index.insert("classname", 2);
+                index.insert("light", 2);
+                index.insert("ClassName", 2);
+                assert(index.size() == 2);
+                
+                TrigramIndex<int>::ValueList result;
+                index.remove("classname", 2);
+                index.find("class", result);
+                assert(result.size() == 2);
+                
+                index.remove("CLASSNAME", 2);
+                index.remove("classname", 3);
+                result.clear();
+                index.find("class", result);
+                assert(result.size() == 1 && result[0] == 1);
+                
+                index.remove("classname", 1);
+                assert(index.size() == 1);
+                result.clear();
+                index.find("ass", result);
+                assert(result.empty());
+                
+                // the freed string id is reused
+                index.insert("assembly", 4);
+                result.clear();
+                index.find("ass", result);
+                assert(result.size() == 1 && result[0] == 4);
+                result.clear();
+                index.find("igh", result);
+                assert(result.size() == 1 && result[0] == 2);
+            }
+            
+            void testRemoveSharedString() {
+                TrigramIndex<int> index;
+                const int count = 10000;
+                for (int i = 0; i < count; i++) {
+                    index.insert("classname", i);
+                    index.insert("origin", i);
+                }
+                index.insert("classname", 42);
+                assert(index.size() == 2);
+                
+                for (int i = 0; i < count; i += 2)
+                    index.remove("classname", i);
+                
+                TrigramIndex<int>::ValueList result;
+                index.find("classname", result);
+                assert(result.size() == count / 2 + 1);
+                for (size_t i = 0; i < result.size() - 1; i++)
+                    assert(result[i] < result[i + 1]);
+                assert(std::binary_search(result.begin(), result.end(), 42));
+                assert(!std::binary_search(result.begin(), result.end(), 44));
+                assert(std::binary_search(result.begin(), result.end(), 45));
+                
+                index.remove("classname", 42);
+                result.clear();
+                index.find("classname", result);
+                assert(result.size() == count / 2);
+                assert(!std::binary_search(result.begin(), result.end(), 42));
+                
+                for (int i = 1; i < count; i += 2)
+                    index.remove("classname", i);
+                assert(index.size() == 1);
+                
+                result.clear();
+                index.find("origin", result);
+                assert(result.size() == count);
+            }
+        };
+    }
+}
+
+#endif
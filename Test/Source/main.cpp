@@ -20,9 +20,15 @@
 #include <iostream>
 
 #include "TestSuite.h"
+#include "IO/EntityThumbnailCacheTest.h"
+#include "Model/BrushCSGTest.h"
+#include "Utility/BatchTransformTest.h"
 #include "Utility/FindIntegerPlanePointsTest.h"
+#include "Utility/InstanceBufferTest.h"
 #include "Utility/MatTest.h"
 #include "Utility/PlaneTest.h"
+#include "Utility/PointGridTest.h"
+#include "Utility/TrigramIndexTest.h"
 #include "Utility/VecTest.h"
 
 int main(int argc, const char * argv[]) {
@@ -37,6 +43,24 @@ int main(int argc, const char * argv[]) {
     VecMath::PlaneTest planeTest;
     planeTest.run();
     
+    VecMath::BatchTransformTest batchTransformTest;
+    batchTransformTest.run();
+    
+    Utility::PointGridTest pointGridTest;
+    pointGridTest.run();
+    
+    Utility::InstanceBufferTest instanceBufferTest;
+    instanceBufferTest.run();
+    
+    Utility::TrigramIndexTest trigramIndexTest;
+    trigramIndexTest.run();
+    
+    IO::EntityThumbnailCacheTest entityThumbnailCacheTest;
+    entityThumbnailCacheTest.run();
+    
+    Model::BrushCSGTest brushCSGTest;
+    brushCSGTest.run();
+    
     /*
     VecMath::FindIntegerPlanePointsTest planePointsTest;
     planePointsTest.run();